@@ -0,0 +1,243 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Benchmark example
+
+  Measures the CPU cycles of the API hot paths on the board and prints a
+  table over Serial, to compare cores and to catch regressions. The cycles
+  are counted by the DWT cycle counter on the Due (Cortex-M3), by SysTick on
+  SAMD (Cortex-M0+ has no cycle counter) and by Timer1 on AVR.
+
+  Open an empty text editor and send any character over the Serial monitor
+  to start: the keyboard rows type into the focused window. The RawHID write
+  row needs a host that reads the reports, like extras/rawhid/rawhid_test,
+  otherwise it measures the timeout of the core.
+
+  Calls that send a report include the USB transfer, so their cycles depend
+  on the polling interval of the host. The host-side microbenchmarks in
+  extras/hostbench measure the same paths without USB.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+
+// Calls per row, the table shows the fastest and the average call
+const uint8_t runs = 32;
+
+uint8_t rawhidData[64];
+uint8_t rawhidReport[64];
+
+// TeensyLookup.cpp, it cannot share the report types of HID-Project.h
+uint16_t teensyLookup(uint16_t unicode);
+
+//================================================================================
+// Cycle counter
+//================================================================================
+
+#if defined(ARDUINO_ARCH_AVR)
+// Timer1 without prescaler, the overflows extend it to 32 bit
+volatile uint16_t cyclesHigh;
+
+ISR(TIMER1_OVF_vect) {
+  cyclesHigh++;
+}
+
+void counterBegin() {
+  TCCR1A = 0;
+  TCCR1B = (1 << CS10);
+  TIMSK1 = (1 << TOIE1);
+}
+
+uint32_t cycles() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t low = TCNT1;
+  uint16_t high = cyclesHigh;
+  // An overflow that was not handled yet
+  if ((TIFR1 & (1 << TOV1)) && low < 0x8000) {
+    high++;
+  }
+  SREG = oldSREG;
+  return ((uint32_t)high << 16) | low;
+}
+
+#elif defined(ARDUINO_ARCH_SAM)
+void counterBegin() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t cycles() {
+  return DWT->CYCCNT;
+}
+
+#elif defined(ARDUINO_ARCH_SAMD)
+void counterBegin() {
+}
+
+// SysTick counts down from LOAD every ms and millis() counts the wraps
+uint32_t cycles() {
+  uint32_t ms, value;
+  do {
+    ms = millis();
+    value = SysTick->VAL;
+  } while (ms != millis());
+  return ms * (SysTick->LOAD + 1) + (SysTick->LOAD - value);
+}
+
+#else
+void counterBegin() {
+}
+
+// TinyUSB cores, only with the resolution of micros()
+uint32_t cycles() {
+  return micros() * (F_CPU / 1000000L);
+}
+#endif
+
+//================================================================================
+// Benchmarks
+//================================================================================
+
+uint8_t step;
+volatile uint16_t sink;
+
+void keyboardWrite() {
+  Keyboard.write('a' + (step++ % 26));
+}
+
+void nkroSet() {
+  // Changes the key bitmap only, nothing is sent
+  NKROKeyboard.add(KeyboardKeycode(KEY_A + (step++ % 26)));
+}
+
+void teensyUnicode() {
+  // Umlauts need the dead key table of the German layout
+  static const uint16_t characters[] = { 'a', 'Z', '@', 0xE4, 0xF6, 0xFC, 0xDF, 0x20AC };
+  sink += teensyLookup(characters[step++ % (sizeof(characters) / sizeof(characters[0]))]);
+}
+
+void consumerPress() {
+  // Up and down in turns, the volume of the host stays the same
+  Consumer.press((step++ & 1) ? MEDIA_VOLUME_UP : MEDIA_VOLUME_DOWN);
+}
+
+void gamepadWrite() {
+  Gamepad.xAxis(step++ * 257);
+  Gamepad.write();
+}
+
+void rawhidRead() {
+  sink += RawHID.read();
+}
+
+void rawhidWrite() {
+  rawhidReport[0] = step++;
+  RawHID.write(rawhidReport, sizeof(rawhidReport));
+}
+
+void empty() {
+}
+
+// Cycles of the measurement itself
+uint32_t overhead;
+
+void measure(const __FlashStringHelper* name, void (*fn)(), void (*after)() = NULL) {
+  uint32_t fastest = 0xFFFFFFFF;
+  uint32_t total = 0;
+
+  for (uint8_t i = 0; i < runs; i++) {
+    uint32_t start = cycles();
+    fn();
+    uint32_t took = cycles() - start;
+    took = took > overhead ? took - overhead : 0;
+    if (took < fastest) {
+      fastest = took;
+    }
+    total += took;
+
+    // Cleanup is not measured
+    if (after) {
+      after();
+    }
+  }
+
+  uint32_t average = total / runs;
+  Serial.print(name);
+  for (int i = strlen_P((const char*)name); i < 36; i++) {
+    Serial.write(' ');
+  }
+  Serial.print(fastest);
+  Serial.write('\t');
+  Serial.print(average);
+  Serial.write('\t');
+  Serial.println(average / (F_CPU / 1000000UL));
+}
+
+void nkroClear() {
+  NKROKeyboard.removeAll();
+}
+
+void consumerRelease() {
+  Consumer.releaseAll();
+}
+
+void runBenchmarks() {
+  // The fastest empty measurement is the cost of cycles() itself
+  overhead = 0xFFFFFFFF;
+  for (uint8_t i = 0; i < runs; i++) {
+    uint32_t start = cycles();
+    empty();
+    uint32_t took = cycles() - start;
+    if (took < overhead) {
+      overhead = took;
+    }
+  }
+
+  Serial.print(F("Core at "));
+  Serial.print(F_CPU / 1000000UL);
+  Serial.print(F(" MHz, counter overhead "));
+  Serial.print(overhead);
+  Serial.println(F(" cycles"));
+  Serial.println(F("function                            min\tavg\tavg us"));
+
+  measure(F("KeyboardAPI::write(uint8_t)"), keyboardWrite);
+  measure(F("NKROKeyboardAPI::set"), nkroSet, nkroClear);
+  measure(F("TeensyKeyboardAPI::unicode_to_keycode"), teensyUnicode);
+  measure(F("ConsumerAPI::press"), consumerPress, consumerRelease);
+  measure(F("GamepadAPI::write"), gamepadWrite);
+  measure(F("RawHID_::read"), rawhidRead);
+  measure(F("RawHID_::write (64 bytes)"), rawhidWrite);
+  Serial.println();
+}
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  Serial.begin(115200);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Keyboard.begin();
+  NKROKeyboard.begin();
+  Consumer.begin();
+  Gamepad.begin();
+  RawHID.begin(rawhidData, sizeof(rawhidData));
+
+  counterBegin();
+}
+
+void loop() {
+  if (Serial.available()) {
+    while (Serial.available()) {
+      Serial.read();
+    }
+    digitalWrite(pinLed, HIGH);
+    runBenchmarks();
+    digitalWrite(pinLed, LOW);
+  }
+}
@@ -0,0 +1,27 @@
+/*
+  Lookup of the TeensyKeyboardAPI without its transport, in its own file
+  because its report type clashes with the one of HID-Project.h.
+*/
+
+#define LAYOUT_GERMAN
+#include "HID-APIs/TeensyKeyboardAPI.h"
+
+class TeensyLookup : public TeensyKeyboardAPI
+{
+public:
+  // The benchmark only measures the keycode lookup
+  virtual void sendReport(void* data, int length) override {
+    (void)data;
+    (void)length;
+  }
+
+  uint16_t lookup(uint16_t unicode) {
+    return unicode_to_keycode(unicode);
+  }
+};
+
+static TeensyLookup teensy;
+
+uint16_t teensyLookup(uint16_t unicode) {
+  return teensy.lookup(unicode);
+}
@@ -0,0 +1,46 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  HIDBridge example
+
+  Runs on the USB chip (16u2 or 32u4) and forwards the reports that a main
+  MCU without USB sends over Serial1, see the HIDBridgeSender example.
+
+  Every record on the serial link is one complete report with a CRC,
+  it is sent to the host as it is. Lost or broken records are sent again
+  by the main MCU, so no report is lost or sent twice.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+
+// Buffer to hold RawHID data
+uint8_t rawhidData[64];
+
+HIDBridge bridge;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Keyboard.begin();
+  Mouse.begin();
+  Consumer.begin();
+  Gamepad.begin();
+  RawHID.begin(rawhidData, sizeof(rawhidData));
+
+  // Use the same baud rate on both sides, fast enough for a full report per ms
+  Serial1.begin(1000000);
+  bridge.begin(Serial1);
+  bridge.attach(&Keyboard, &Mouse, &Consumer, &Gamepad, &RawHID);
+}
+
+void loop() {
+  // Light the led while reports are forwarded
+  digitalWrite(pinLed, bridge.poll() > 0);
+}
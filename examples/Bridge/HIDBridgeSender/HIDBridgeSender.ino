@@ -0,0 +1,53 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  HIDBridgeSender example
+
+  Runs on the main MCU and sends keyboard and mouse reports over Serial1
+  to a USB chip that runs the HIDBridge example.
+
+  Up to HID_BRIDGE_WINDOW reports are sent before the first ack returns,
+  send() returns false while they are all unacknowledged (and until the
+  USB chip acknowledged the start of the link).
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+const int pinButton = 2;
+
+HIDBridgeSender bridge;
+
+HID_KeyboardReport_Data_t keyboardReport;
+HID_MouseReport_Data_t mouseReport;
+bool pressed = false;
+
+void setup() {
+  pinMode(pinButton, INPUT_PULLUP);
+
+  Serial1.begin(1000000);
+  bridge.begin(Serial1);
+}
+
+void loop() {
+  // Read the acks and send lost reports again
+  bridge.poll();
+
+  bool button = !digitalRead(pinButton);
+  if (button != pressed && bridge.pending() + 2 <= HID_BRIDGE_WINDOW) {
+    pressed = button;
+
+    // Hold shift and move the mouse while the button is pressed
+    memset(&keyboardReport, 0, sizeof(keyboardReport));
+    memset(&mouseReport, 0, sizeof(mouseReport));
+    if (pressed) {
+      keyboardReport.modifiers = 0x02;
+      mouseReport.xAxis = 10;
+    }
+    bridge.send(HID_BRIDGE_KEYBOARD, &keyboardReport, sizeof(keyboardReport));
+    bridge.send(HID_BRIDGE_MOUSE, &mouseReport, sizeof(mouseReport));
+  }
+}
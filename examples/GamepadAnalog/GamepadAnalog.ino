@@ -0,0 +1,39 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Gamepad Analog example
+  Two analog sticks on A0-A3 without analogRead() in the loop.
+
+  The ADC samples the sticks in the background, the loop only pushes
+  the axes which moved and sends a report if anything changed.
+  Each stick gets a small dead zone around its center, so it reads 0
+  when released. Measure the center and the end positions of your
+  sticks with read() to calibrate them.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki/Gamepad-API
+*/
+
+#include "HID-Project.h"
+
+const uint8_t pins[] = { A0, A1, A2, A3 };
+const uint8_t axes[] = { HID_ANALOG_X, HID_ANALOG_Y, HID_ANALOG_RX, HID_ANALOG_RY };
+
+HIDAnalogBuffer<4> sticks(pins, axes);
+
+void setup() {
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Gamepad.begin();
+
+  // Full range with a dead zone of 2% around the center
+  for (uint8_t i = 0; i < 4; i++) {
+    sticks.setCalibration(i, 0, HID_ANALOG_MAX / 2, HID_ANALOG_MAX, HID_ANALOG_MAX / 50);
+  }
+  sticks.setFilter(2);
+  sticks.begin();
+}
+
+void loop() {
+  sticks.poll(Gamepad);
+}
@@ -0,0 +1,62 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Gamepad Cabinet example
+  Four players with 4 buttons each on a single board.
+
+  Every player is a gamepad with its own report ID on the multi report
+  endpoint, no extra endpoint is needed. The single report Gamepad1-4
+  work the same way, with one endpoint each.
+  HIDReportUpdate::updateAll() sends the reports of all changed gamepads.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki/Gamepad-API
+*/
+
+#include "HID-Project.h"
+#include "MultiReport/MultiGamepad.h"
+
+// Buttons of player 1 on pin 2-5, player 2 on pin 6-9 and so on
+const int pinButtons = 2;
+const int players = 4;
+const int buttons = 4;
+
+// Any report IDs which are not used by another device
+MultiGamepad<11> Player1;
+MultiGamepad<12> Player2;
+MultiGamepad<13> Player3;
+MultiGamepad<14> Player4;
+
+// Pressed buttons of a player
+uint32_t readButtons(int player) {
+  uint32_t pressed = 0;
+  for (int i = 0; i < buttons; i++) {
+    if (!digitalRead(pinButtons + player * buttons + i)) {
+      pressed |= 1UL << i;
+    }
+  }
+  return pressed;
+}
+
+void setup() {
+  for (int i = 0; i < players * buttons; i++) {
+    pinMode(pinButtons + i, INPUT_PULLUP);
+  }
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Player1.begin();
+  Player2.begin();
+  Player3.begin();
+  Player4.begin();
+}
+
+void loop() {
+  Player1.buttons(readButtons(0));
+  Player2.buttons(readButtons(1));
+  Player3.buttons(readButtons(2));
+  Player4.buttons(readButtons(3));
+
+  // Only the changed gamepads are sent
+  HIDReportUpdate::updateAll();
+}
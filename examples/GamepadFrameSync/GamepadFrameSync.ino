@@ -0,0 +1,56 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Gamepad Frame Sync example
+  Samples 8 buttons once per USB frame, shortly before the host polls.
+
+  Sending whenever a button changes gives 0 - 1ms of random latency,
+  because the host only polls once per frame. Building the report at a
+  fixed point of the frame gives a constant latency instead.
+  Tune the offset for your host, a later offset samples closer to the poll.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki/Gamepad-API
+*/
+
+#include "HID-Project.h"
+
+// Buttons on pin 2-9
+const int pinButtons = 2;
+const int offset = 700;
+
+uint8_t lastButtons = 0;
+
+void sampleButtons() {
+  uint8_t buttons = 0;
+  for (int i = 0; i < 8; i++) {
+    if (!digitalRead(pinButtons + i)) {
+      buttons |= 1 << i;
+    }
+  }
+
+  // Only send changes
+  if (buttons != lastButtons) {
+    lastButtons = buttons;
+    Gamepad.buttons(buttons);
+    Gamepad.write();
+  }
+}
+
+void setup() {
+  for (int i = 0; i < 8; i++) {
+    pinMode(pinButtons + i, INPUT_PULLUP);
+  }
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Gamepad.begin();
+
+  // Sample the buttons offset us after every start of frame
+  HIDFrame::onFrame(sampleButtons, offset);
+}
+
+void loop() {
+  // Keep loop() short, the callback is only as exact as this is called
+  HIDFrame::poll();
+}
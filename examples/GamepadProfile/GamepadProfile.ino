@@ -0,0 +1,49 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Gamepad Profile example
+  A gamepad with only the inputs it needs: 8 buttons,
+  2 axes with 10 bit (the resolution of the ADC) and a d-pad.
+  The report is 5 bytes instead of the 15 bytes of the default Gamepad.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki/Gamepad-API
+*/
+
+#include "HID-Project.h"
+#include "MultiReport/CustomGamepad.h"
+
+// Buttons on pin 2-9, axes on A0 and A1
+const int pinButtons = 2;
+
+// Any report ID which is not used by another device
+CustomGamepad<GamepadProfile<8, 2, 10, 1>, 11> Pad;
+
+void setup() {
+  for (int i = 0; i < 8; i++) {
+    pinMode(pinButtons + i, INPUT_PULLUP);
+  }
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Pad.begin();
+}
+
+void loop() {
+  for (int i = 0; i < 8; i++) {
+    if (!digitalRead(pinButtons + i)) {
+      Pad.press(i + 1);
+    }
+    else {
+      Pad.release(i + 1);
+    }
+  }
+
+  // Center the 0 - 1023 ADC range
+  Pad.axis(0, analogRead(A0) - 512);
+  Pad.axis(1, analogRead(A1) - 512);
+  Pad.dPad(0, GAMEPAD_DPAD_CENTERED);
+
+  // Only sends if something changed
+  Pad.update();
+}
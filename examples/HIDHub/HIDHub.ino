@@ -0,0 +1,66 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  HID Hub example
+  Keyboard, mouse, consumer, system and gamepad on one endpoint.
+
+  Every SingleReport device needs its own endpoint and a 32u4 only has
+  a few of them. The hub shares one endpoint between all devices through
+  report IDs and sends keyboard reports first. Each device keeps one
+  pending report, HIDHub().poll() sends them when the endpoint is free.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+HubKeyboard<> hubKeyboard;
+HubMouse<> hubMouse;
+HubConsumer<> hubConsumer;
+HubSystem<> hubSystem;
+HubGamepad<> hubGamepad;
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  hubKeyboard.begin();
+  hubMouse.begin();
+  hubConsumer.begin();
+  hubSystem.begin();
+  hubGamepad.begin();
+
+  // Keep only the latest mouse movement while the endpoint is busy
+  hubMouse.setCoalescing(true);
+}
+
+void loop() {
+  if (!digitalRead(pinButton)) {
+    digitalWrite(pinLed, HIGH);
+
+    // All devices change at once, the keyboard report goes first
+    hubKeyboard.write(KEY_ENTER);
+    hubConsumer.write(MEDIA_VOLUME_UP);
+    hubMouse.move(10, 0);
+    hubGamepad.press(1);
+    hubGamepad.write();
+    hubGamepad.release(1);
+    hubGamepad.write();
+
+    // Simple debounce
+    delay(300);
+    digitalWrite(pinLed, LOW);
+  }
+
+  // Send the pending reports and the rest of the mouse movement
+  HIDHub().poll();
+  if (hubMouse.ReadyToSend()) {
+    hubMouse.flush();
+  }
+}
@@ -0,0 +1,82 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  HID Task example (FreeRTOS, SAMD21/SAMD51)
+
+  Two tasks use the keyboard and the media keys at the same time.
+  They never call the HID APIs themselves but post intents to their own
+  queue, a single HID task sends the merged reports. Posting does not block,
+  so a task that polls an encoder keeps its timing while USB is busy.
+
+  Requires the FreeRTOS_SAMD21 or FreeRTOS_SAMD51 library and HID_RTOS
+  set to 1 in HID-Settings.h.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+const int pinButton = 2;
+const int pinEncoderA = 3;
+const int pinEncoderB = 4;
+
+HIDTask<> hidTask;
+HIDIntentQueueBuffer<> buttonQueue;
+HIDIntentQueueBuffer<> encoderQueue;
+
+// Types a text when the button is pressed
+void buttonTask(void* unused) {
+  bool last = false;
+  for (;;) {
+    bool pressed = !digitalRead(pinButton);
+    if (pressed && !last) {
+      for (const char* s = "Hello RTOS\n"; *s; s++) {
+        // Wait for space instead of dropping characters
+        while (!buttonQueue.write((uint8_t)*s)) {
+          vTaskDelay(1);
+        }
+      }
+    }
+    last = pressed;
+    vTaskDelay(10);
+  }
+}
+
+// Changes the volume with a rotary encoder
+void encoderTask(void* unused) {
+  bool lastA = digitalRead(pinEncoderA);
+  for (;;) {
+    bool a = digitalRead(pinEncoderA);
+    if (a != lastA && !a) {
+      encoderQueue.write(digitalRead(pinEncoderB) ? MEDIA_VOLUME_UP : MEDIA_VOLUME_DOWN);
+    }
+    lastA = a;
+    vTaskDelay(1);
+  }
+}
+
+void setup() {
+  pinMode(pinButton, INPUT_PULLUP);
+  pinMode(pinEncoderA, INPUT_PULLUP);
+  pinMode(pinEncoderB, INPUT_PULLUP);
+
+  Keyboard.begin();
+  Consumer.begin();
+
+  hidTask.setKeyboard(Keyboard);
+  hidTask.setConsumer(Consumer);
+  hidTask.add(buttonQueue);
+  hidTask.add(encoderQueue);
+
+  // The HID task gets the highest priority, it only runs when there are intents
+  xTaskCreate(HIDTask<>::task, "HID", 256, &hidTask, tskIDLE_PRIORITY + 3, NULL);
+  xTaskCreate(buttonTask, "Button", 256, NULL, tskIDLE_PRIORITY + 1, NULL);
+  xTaskCreate(encoderTask, "Encoder", 256, NULL, tskIDLE_PRIORITY + 2, NULL);
+  vTaskStartScheduler();
+}
+
+void loop() {
+  // Not reached, the scheduler runs the tasks
+}
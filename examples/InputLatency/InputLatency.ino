@@ -0,0 +1,105 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  InputLatency example
+
+  Device side of the input latency benchmark.
+  Run extras/rawhid/input_latency on a Linux host, it sends one
+  trigger byte via Serial and timestamps the resulting input event.
+
+  'p' ping, answered with 'p' to measure the Serial trigger delay
+  'b' BootKeyboard (single report)
+  'k' Keyboard (multi report)
+  'n' NKROKeyboard (multi report)
+  'm' Mouse (multi report)
+  'g' Gamepad (multi report)
+  'G' Gamepad1 (single report, if USE_SINGLE_GAMEPAD is set)
+  'l' toggle load: a Gamepad axis report is sent in every loop
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+// Gamepad1 needs one more endpoint, which is not free on every board
+#define USE_SINGLE_GAMEPAD 0
+
+const int pinLed = LED_BUILTIN;
+
+bool load = false;
+int8_t mouseStep = 1;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+
+  Serial.begin(115200);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  BootKeyboard.begin();
+  Keyboard.begin();
+  NKROKeyboard.begin();
+  Mouse.begin();
+  Gamepad.begin();
+#if USE_SINGLE_GAMEPAD
+  Gamepad1.begin();
+#endif
+}
+
+void loop() {
+  if (Serial.available()) {
+    digitalWrite(pinLed, HIGH);
+    switch (Serial.read()) {
+      case 'p':
+        Serial.write('p');
+        break;
+
+      case 'b':
+        BootKeyboard.write(KEY_A);
+        break;
+
+      case 'k':
+        Keyboard.write(KEY_B);
+        break;
+
+      case 'n':
+        NKROKeyboard.write(KEY_C);
+        break;
+
+      case 'm':
+        // Move back and forth, so the cursor stays in place
+        Mouse.move(mouseStep, 0);
+        mouseStep = -mouseStep;
+        break;
+
+      case 'g':
+        Gamepad.press(1);
+        Gamepad.write();
+        Gamepad.release(1);
+        Gamepad.write();
+        break;
+
+#if USE_SINGLE_GAMEPAD
+      case 'G':
+        Gamepad1.press(1);
+        Gamepad1.write();
+        Gamepad1.release(1);
+        Gamepad1.write();
+        break;
+#endif
+
+      case 'l':
+        load = !load;
+        break;
+    }
+    digitalWrite(pinLed, LOW);
+  }
+
+  // Keep the multi report endpoint busy
+  if (load) {
+    static uint8_t axis = 0;
+    Gamepad.zAxis(axis++);
+    Gamepad.write();
+  }
+}
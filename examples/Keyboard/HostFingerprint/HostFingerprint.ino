@@ -0,0 +1,59 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  HostFingerprint example
+
+  Guesses the host OS from its descriptor requests and types it.
+  Desktop hosts get the NKRO keyboard, unknown hosts (BIOS, KVM switches)
+  the 6KRO BootKeyboard, the only one they are sure to understand.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/Keyboard-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+KeyboardAPI& keyboard() {
+  if (HIDFingerprint.nkro()) {
+    return NKROKeyboard;
+  }
+  return BootKeyboard;
+}
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  NKROKeyboard.begin();
+  BootKeyboard.begin();
+}
+
+void loop() {
+  if (!digitalRead(pinButton)) {
+    digitalWrite(pinLed, HIGH);
+
+    switch (HIDFingerprint.os()) {
+      case HID_OS_WINDOWS:
+        keyboard().println(F("Windows"));
+        break;
+      case HID_OS_LINUX:
+        keyboard().println(F("Linux"));
+        break;
+      case HID_OS_MACOS:
+        keyboard().println(F("macOS"));
+        break;
+      default:
+        keyboard().println(F("Unknown host"));
+        break;
+    }
+
+    // Simple debounce
+    delay(300);
+    digitalWrite(pinLed, LOW);
+  }
+}
@@ -0,0 +1,47 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  HybridKeyboard example
+
+  Press a button to hold a lot of keys at the same time.
+  The first 6 keys are sent with the small 8 byte keyboard report,
+  every further key is added to an NKRO bitmap report.
+  Normal typing only sends the small report.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/Keyboard-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  HybridKeyboard.begin();
+}
+
+void loop() {
+  // Hold a lot of keys at the same time
+  if (!digitalRead(pinButton)) {
+    digitalWrite(pinLed, HIGH);
+
+    // '0' - '5' fill the keyboard report, '6' - '9' overflow
+    for (char c = '0'; c <= '9'; c++) {
+      HybridKeyboard.press(c);
+    }
+
+    // Release all keys and hit enter
+    HybridKeyboard.releaseAll();
+    HybridKeyboard.println();
+
+    // Simple debounce
+    delay(300);
+    digitalWrite(pinLed, LOW);
+  }
+}
@@ -0,0 +1,41 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  KeyMatrix example
+
+  Scans a 3x4 key matrix and sends the keys with the NKRO keyboard.
+  The rows are pulled low one after another and the columns are read
+  with the internal pullups. With diodes the cathodes face the rows.
+  Every scan that finds a debounced change sends a single report.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/Keyboard-API#nkro-keyboard
+*/
+
+#include "HID-Project.h"
+
+const uint8_t rowPins[] = { 2, 3, 4 };
+const uint8_t columnPins[] = { 5, 6, 7, 8 };
+
+// A numpad, each row lists the keys of its columns
+const uint8_t keymap[] PROGMEM = {
+  KEYPAD_7, KEYPAD_8, KEYPAD_9, KEYPAD_DIVIDE,
+  KEYPAD_4, KEYPAD_5, KEYPAD_6, KEYPAD_MULTIPLY,
+  KEYPAD_1, KEYPAD_2, KEYPAD_3, KEYPAD_SUBTRACT,
+};
+
+HIDMatrixBuffer<3, 4> matrix(rowPins, columnPins, keymap);
+
+void setup() {
+  // Sends a clean report to the host. This is important on any Arduino type.
+  NKROKeyboard.begin();
+
+  // 5ms debounce time
+  matrix.setDebounce(5000);
+  matrix.begin(&NKROKeyboard);
+}
+
+void loop() {
+  matrix.scan();
+}
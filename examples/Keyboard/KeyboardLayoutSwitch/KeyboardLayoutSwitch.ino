@@ -0,0 +1,58 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Keyboard layout switch example
+
+  Selects the keyboard layout at runtime, so the same firmware types
+  correctly on hosts with different input methods.
+  Send 'u' (US), 'g' (German) or 'f' (French) over Serial to select the layout
+  of the host, then press the button to type a test text.
+
+  Press a button to write some text to your pc.
+  See official and HID-Project documentation for more information:
+  https://github.com/NicoHood/HID/wiki/Keyboard-API#improved-keyboard
+*/
+
+#include "HID-Project.h"
+#include "KeyboardLayouts/ImprovedKeylayoutsRegistry.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  Serial.begin(115200);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Keyboard.begin();
+}
+
+
+void loop() {
+  // Only the tables of the selected layouts are stored in flash
+  switch (Serial.read()) {
+    case 'u':
+      Keyboard.setLayout(KeyboardLayoutUsEnglish);
+      break;
+    case 'g':
+      Keyboard.setLayout(KeyboardLayoutGerman);
+      break;
+    case 'f':
+      Keyboard.setLayout(KeyboardLayoutFrench);
+      break;
+  }
+
+  if (!digitalRead(pinButton)) {
+    digitalWrite(pinLed, HIGH);
+
+    // Same text on every layout
+    Keyboard.println("Hello World! yz @ {brackets}");
+
+    // Simple debounce
+    delay(300);
+    digitalWrite(pinLed, LOW);
+  }
+}
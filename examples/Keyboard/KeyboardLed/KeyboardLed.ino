@@ -7,6 +7,11 @@
   Press a button to toogle caps lock.
   Caps lock state is represented by the onboard led.
   Leds are only supported on single report HID devices.
+  The led is updated from a callback as soon as the host sends a new state,
+  instead of polling getLeds() in every loop.
+  The second button types a text with lock-state-aware typing: uppercase
+  runs toggle caps lock if that takes fewer reports than shift, and the
+  text comes out right whatever the caps lock state is.
 
   See HID Project documentation for more information.
   https://github.com/NicoHood/HID/wiki/Keyboard-API
@@ -16,24 +21,31 @@
 
 const int pinLed = LED_BUILTIN;
 const int pinButton = 2;
+const int pinText = 3;
+
+// Called from the USB interrupt, keep it short.
+// Keep in mind that on a 16u2 and Arduino Micro HIGH and LOW for TX/RX Leds are inverted.
+void updateLeds(uint8_t leds) {
+  digitalWrite(pinLed, (leds & LED_CAPS_LOCK) ? HIGH : LOW);
+}
 
 void setup() {
   pinMode(pinLed, OUTPUT);
   pinMode(pinButton, INPUT_PULLUP);
+  pinMode(pinText, INPUT_PULLUP);
 
   // Sends a clean report to the host. This is important on any Arduino type.
   BootKeyboard.begin();
+
+  // Update Led equal to the caps lock state.
+  BootKeyboard.onLeds(updateLeds);
+
+  // Toggle caps lock for uppercase runs when it saves reports
+  BootKeyboard.setLockTyping(true);
 }
 
 
 void loop() {
-  // Update Led equal to the caps lock state.
-  // Keep in mind that on a 16u2 and Arduino Micro HIGH and LOW for TX/RX Leds are inverted.
-  if (BootKeyboard.getLeds() & LED_CAPS_LOCK)
-    digitalWrite(pinLed, HIGH);
-  else
-    digitalWrite(pinLed, LOW);
-
   // Trigger caps lock manually via button
   if (!digitalRead(pinButton)) {
     BootKeyboard.write(KEY_CAPS_LOCK);
@@ -41,4 +53,11 @@ void loop() {
     // Simple debounce
     delay(300);
   }
+
+  if (!digitalRead(pinText)) {
+    BootKeyboard.println(F("Caps lock is restored after THIS LOUD PART of the text."));
+
+    // Simple debounce
+    delay(300);
+  }
 }
@@ -0,0 +1,56 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Keyboard Macro example
+
+  Press a button to play back a timed macro.
+  The sequencer runs from loop() without blocking it,
+  the led keeps blinking while the macro is typed.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/Keyboard-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+// Types "hi", selects it with shift + home and mutes the volume
+const HIDSequenceStep macro[] PROGMEM = {
+  HID_SEQ_KEYBOARD_WRITE(KEY_H, HID_SEQ_MS(20)),
+  HID_SEQ_KEYBOARD_WRITE(KEY_I, HID_SEQ_MS(20)),
+  HID_SEQ_KEYBOARD_PRESS(KEY_LEFT_SHIFT, HID_SEQ_US(500)),
+  HID_SEQ_KEYBOARD_WRITE(KEY_HOME, HID_SEQ_US(500)),
+  HID_SEQ_KEYBOARD_RELEASE_ALL(HID_SEQ_MS(100)),
+  HID_SEQ_CONSUMER_WRITE(MEDIA_VOLUME_MUTE, 0),
+  HID_SEQ_END()
+};
+
+HIDSequencer sequencer;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Keyboard.begin();
+  Consumer.begin();
+
+  sequencer.begin(&Keyboard, &Consumer);
+}
+
+
+void loop() {
+  // Start the macro via button
+  if (!digitalRead(pinButton) && !sequencer.playing()) {
+    sequencer.play(macro);
+  }
+
+  // Run the due steps of the macro
+  sequencer.poll();
+
+  // Other work is not blocked
+  digitalWrite(pinLed, (millis() / 250) & 1);
+}
@@ -0,0 +1,50 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Keyboard wakeup example
+
+  Press a button to wake a sleeping PC and type a character.
+  The remote wakeup works on AVR, SAMD and SAM boards.
+
+  Build the library with HID_SUSPEND_QUEUE (e.g. 32 bytes) to hold the
+  reports while the PC sleeps, they are sent as soon as it resumed.
+  Otherwise the character is typed when the PC is awake again.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki/Keyboard-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Keyboard.begin();
+
+  // Held reports wake the host up
+  HIDSuspend::setWakeup(true);
+}
+
+void loop() {
+  // Light the led while the host sleeps
+  digitalWrite(pinLed, HIDSuspend::suspended());
+
+  // Send the held reports after a resume
+  HIDSuspend::poll();
+
+  if (!digitalRead(pinButton)) {
+    if (HIDSuspend::suspended() && !HIDSuspend::pending()) {
+      Keyboard.wakeupHost();
+    }
+    Keyboard.write('a');
+
+    // Simple debounce
+    delay(300);
+  }
+}
@@ -0,0 +1,52 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  JoystickMouse example
+  Moves the mouse with an analog joystick and an acceleration curve.
+
+  The curve is a table of gains in PROGMEM, the speed of every move
+  looks up its gain with integers only. The pot on A2 sets the
+  sensitivity. Small deflections move the pointer slower than one count
+  per move, the fractions add up instead of getting lost.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki/Mouse-API
+*/
+
+#include "HID-Project.h"
+
+const int pinX = A0;
+const int pinY = A1;
+const int pinSensitivity = A2;
+const int deadZone = 24;
+
+// Gain per 16 counts of deflection (shift 4), 8.8 fixed point:
+// 1/8 for fine moves, rising to 2.0 at a full deflection
+const uint16_t curve[] PROGMEM = {
+  32, 32, 40, 56, 80, 112, 152, 200, 256, 320, 384, 448, 512
+};
+
+MouseAcceleration acceleration;
+
+void setup() {
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Mouse.begin();
+  acceleration.setCurve(curve, sizeof(curve) / sizeof(curve[0]), 4);
+}
+
+// Deflection of -200 to 200 from the center
+int16_t axis(int pin) {
+  int16_t value = (analogRead(pin) - 512) / 2;
+  if (abs(value) < deadZone) {
+    return 0;
+  }
+  return constrain(value, -200, 200);
+}
+
+void loop() {
+  // 1/4 to 4x
+  acceleration.setScale(64 + (analogRead(pinSensitivity) * 15 / 16));
+  acceleration.move(Mouse, axis(pinX), axis(pinY));
+  delay(5);
+}
@@ -0,0 +1,49 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  MouseTrajectory example
+  Glides the pointer around the corners of the screen without blocking.
+
+  The trajectory sends one report per ms with the interpolated position,
+  loop() keeps running and reads the button while the pointer moves.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki/AbsoluteMouse-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+HIDTrajectory trajectory;
+
+// Corners of the screen, (0, 0) is the center
+const int16_t corners[][2] = {
+  { -24000, -24000 },
+  { 24000, -24000 },
+  { 24000, 24000 },
+  { -24000, 24000 },
+};
+uint8_t corner = 0;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  AbsoluteMouse.begin();
+  Mouse.begin();
+  trajectory.begin(&AbsoluteMouse, &Mouse);
+}
+
+void loop() {
+  // Next corner when the last move finished
+  if (!trajectory.poll() && !digitalRead(pinButton)) {
+    trajectory.moveTo(corners[corner][0], corners[corner][1], 800);
+    corner = (corner + 1) % 4;
+  }
+
+  digitalWrite(pinLed, trajectory.moving());
+}
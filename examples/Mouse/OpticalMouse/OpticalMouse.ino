@@ -0,0 +1,60 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  OpticalMouse example
+
+  Reads a PMW3360 sensor with motion bursts on SPI, chip select on pin 10.
+  The loop reads the sensor as fast as it can and the counts are summed up
+  until the host polls the mouse, so no counts are lost between reports.
+  Set HID_MOUSE_HIGH_RESOLUTION to 1 in HID-Settings.h for 16 bit movement
+  at high CPI settings.
+
+  The sensor needs its SROM firmware of the vendor, pass it to begin():
+  sensor.begin(srom, sizeof(srom)) with const uint8_t srom[] PROGMEM.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/Mouse-API
+*/
+
+#include "HID-Project.h"
+#include "HID-Optical.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButtonLeft = 2;
+const int pinButtonRight = 3;
+
+HIDOpticalSensor sensor(10);
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButtonLeft, INPUT_PULLUP);
+  pinMode(pinButtonRight, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  BootMouse.begin();
+
+  // The led shows that no sensor answered
+  if (!sensor.begin()) {
+    digitalWrite(pinLed, HIGH);
+  }
+  sensor.setCPI(1600);
+}
+
+void loop() {
+  sensor.poll(BootMouse);
+
+  // Buttons are sent right away
+  if (!digitalRead(pinButtonLeft)) {
+    BootMouse.press(MOUSE_LEFT);
+  }
+  else {
+    BootMouse.release(MOUSE_LEFT);
+  }
+  if (!digitalRead(pinButtonRight)) {
+    BootMouse.press(MOUSE_RIGHT);
+  }
+  else {
+    BootMouse.release(MOUSE_RIGHT);
+  }
+}
@@ -0,0 +1,131 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  RawHIDBenchmark example
+
+  Device side of the RawHID throughput and latency benchmark.
+  Run extras/rawhid/rawhid_bench on the host, it sends the commands below.
+
+  Every host report starts with a command byte:
+  'E' echo:   byte 5 = reply length, the report is sent back (RTT)
+  'T' stream: byte 1-4 = count, byte 5 = length, send count numbered reports
+  'D' data:   byte 1-4 = sequence number, counted and checked for gaps
+  'S' stats:  reply with the received data reports, lost reports and bytes
+  'Z' reset:  clear the counters and stop streaming
+
+  To compare polling intervals, rebuild the library with HID_INTERVAL_RAWHID.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/RawHID-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+
+// Buffer to hold RawHID data.
+uint8_t rawhidData[RAWHID_RX_SIZE];
+
+// Received data reports
+uint32_t expectedSeq = 0;
+uint32_t received = 0;
+uint32_t lost = 0;
+uint32_t bytes = 0;
+
+// Reports left to stream to the host
+uint32_t streamSeq = 0;
+uint32_t streamRemaining = 0;
+uint8_t streamLength = RAWHID_TX_SIZE;
+
+static uint32_t read32(const uint8_t* p) {
+  return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void write32(uint8_t* p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+static uint8_t replyLength(uint8_t length) {
+  if (length < 5 || length > RAWHID_TX_SIZE) {
+    return RAWHID_TX_SIZE;
+  }
+  return length;
+}
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+
+  // Set the RawHID OUT report array.
+  RawHID.begin(rawhidData, sizeof(rawhidData));
+}
+
+void loop() {
+  // Handle the next host report without copying it
+  const uint8_t* report;
+  int length = RawHID.readPacket(&report);
+  if (length >= 6) {
+    uint8_t* reply;
+    switch (report[0]) {
+      case 'E':
+        reply = RawHID.acquirePacket();
+        memcpy(reply, report, length);
+        RawHID.commitPacket(replyLength(report[5]));
+        break;
+
+      case 'T':
+        streamSeq = 0;
+        streamRemaining = read32(report + 1);
+        streamLength = replyLength(report[5]);
+        break;
+
+      case 'D': {
+          uint32_t seq = read32(report + 1);
+          if (seq > expectedSeq) {
+            lost += seq - expectedSeq;
+          }
+          expectedSeq = seq + 1;
+          received++;
+          bytes += length;
+          break;
+        }
+
+      case 'S':
+        reply = RawHID.acquirePacket();
+        memset(reply, 0, RAWHID_TX_SIZE);
+        reply[0] = 'S';
+        write32(reply + 1, received);
+        write32(reply + 5, lost);
+        write32(reply + 9, bytes);
+        RawHID.commitPacket();
+        break;
+
+      case 'Z':
+        expectedSeq = 0;
+        received = 0;
+        lost = 0;
+        bytes = 0;
+        streamRemaining = 0;
+        break;
+    }
+  }
+  RawHID.releasePacket();
+
+  // Stream numbered reports as fast as the host polls them
+  if (streamRemaining) {
+    digitalWrite(pinLed, HIGH);
+    uint8_t* reply = RawHID.acquirePacket();
+    reply[0] = 'T';
+    write32(reply + 1, streamSeq);
+    if (RawHID.commitPacket(streamLength) > 0) {
+      streamSeq++;
+      streamRemaining--;
+    }
+    if (!streamRemaining) {
+      digitalWrite(pinLed, LOW);
+    }
+  }
+}
@@ -0,0 +1,71 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  RawHIDChannels example
+
+  Echoes messages on two channels of one RawHID interface.
+  Run extras/rawhid/rawhid_ch_test on the host.
+
+  Channel 0 carries short commands, channel 1 bulk data. Commands are
+  sent between the reports of a bulk message, so their round trip does
+  not grow with the size of the bulk messages.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/RawHID-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+
+// Buffer to hold RawHID data, one slot per report
+uint8_t rawhidData[RAWHID_RX_SLOTS * RAWHID_RX_SIZE];
+
+// Longest messages that can be received
+uint8_t commandData[64];
+#ifdef __AVR__
+uint8_t bulkData[1024];
+#else
+uint8_t bulkData[16384];
+#endif
+
+RawHIDChannels channels;
+bool replying = false;
+bool echoing = false;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+
+  // Set the RawHID OUT report array.
+  RawHID.begin(rawhidData, sizeof(rawhidData));
+  channels.begin(0, commandData, sizeof(commandData));
+  channels.begin(1, bulkData, sizeof(bulkData));
+}
+
+void loop() {
+  channels.poll();
+
+  // Commands are answered right away, the reply is sent from the
+  // receive buffer, which is released once it was sent
+  if (!replying && channels.complete(0)) {
+    channels.send(0, channels.message(0), channels.available(0));
+    replying = true;
+  }
+  if (replying && !channels.queued(0)) {
+    channels.release(0);
+    replying = false;
+  }
+
+  // Send the bulk message back, it has to stay valid until it was sent
+  if (!echoing && channels.complete(1)) {
+    digitalWrite(pinLed, HIGH);
+    channels.send(1, channels.message(1), channels.available(1));
+    echoing = true;
+  }
+  if (echoing && !channels.queued(1)) {
+    digitalWrite(pinLed, LOW);
+    channels.release(1);
+    echoing = false;
+  }
+}
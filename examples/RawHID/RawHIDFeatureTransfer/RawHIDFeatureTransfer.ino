@@ -0,0 +1,69 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  RawHIDFeatureTransfer example
+
+  Receives a configuration of up to 1 KB with feature reports and writes it
+  to the EEPROM page by page, the host can read it back the same way.
+  Run extras/rawhid/feature_transfer.py on the host (Linux, hidraw).
+
+  The host sends the next reports while a page is written, only when both
+  pages are full it has to try again. Windows only sends feature reports of
+  the declared size, build the library with RAWHID_FEATURE_SIZE 64 there.
+  BootKeyboard.setFeatureTransfer() works the same.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/RawHID-API
+*/
+
+#include "HID-Project.h"
+#include <EEPROM.h>
+
+const int pinLed = LED_BUILTIN;
+
+// Buffer to hold RawHID data
+uint8_t rawhidData[RAWHID_RX_SLOTS * RAWHID_RX_SIZE];
+
+// Two pages of the upload
+const uint16_t pageSize = 64;
+uint8_t pages[2 * pageSize];
+
+HIDFeatureTransfer transfer;
+
+// Called from the USB interrupt for downloads
+uint8_t readConfig(uint32_t offset, uint8_t* data, uint8_t length) {
+  uint32_t end = min(uint32_t(EEPROM.length()), uint32_t(1024));
+  if (offset >= end) {
+    return 0;
+  }
+  length = min(uint32_t(length), end - offset);
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = EEPROM.read(offset + i);
+  }
+  return length;
+}
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+
+  RawHID.begin(rawhidData, sizeof(rawhidData));
+  transfer.begin(pages, pageSize);
+  transfer.onRead(readConfig);
+  RawHID.setFeatureTransfer(&transfer);
+}
+
+void loop() {
+  // Write the received pages, the host keeps sending meanwhile
+  uint16_t length = transfer.available();
+  if (length) {
+    digitalWrite(pinLed, HIGH);
+    uint32_t offset = transfer.offset();
+    const uint8_t* data = transfer.data();
+    for (uint16_t i = 0; i < length && offset + i < EEPROM.length(); i++) {
+      EEPROM.update(offset + i, data[i]);
+    }
+    transfer.release();
+    digitalWrite(pinLed, LOW);
+  }
+}
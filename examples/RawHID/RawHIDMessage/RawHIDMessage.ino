@@ -0,0 +1,62 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  RawHIDMessage example
+
+  Receives messages larger than one report and sends them back.
+  Run extras/rawhid/rawhid_msg_test on the host.
+
+  Each message is split into numbered reports that are sent back to back.
+  Echoed messages are packed if they have runs of equal bytes (rawhid_msg_test -p).
+  The number of reports the host sends ahead is RAWHID_RX_SLOTS,
+  rebuild the library with more slots for a higher throughput.
+
+  See HID Project documentation for more information.
+  https://github.com/NicoHood/HID/wiki/RawHID-API
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+
+// Buffer to hold RawHID data, one slot per report
+uint8_t rawhidData[RAWHID_RX_SLOTS * RAWHID_RX_SIZE];
+
+// Longest message that can be received
+#ifdef __AVR__
+uint8_t messageData[1024];
+#else
+uint8_t messageData[16384];
+#endif
+
+RawHIDMessage message;
+bool echoing = false;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+
+  // Set the RawHID OUT report array.
+  RawHID.begin(rawhidData, sizeof(rawhidData));
+  message.begin(messageData, sizeof(messageData));
+  message.setCRC(true);
+  message.setCompression(true);
+}
+
+void loop() {
+  message.poll();
+
+  // Send the message back, it has to stay valid until it was sent
+  if (!echoing && message.available()) {
+    digitalWrite(pinLed, HIGH);
+    message.send(message.message(), message.available());
+    echoing = true;
+  }
+
+  // Receive the next message
+  if (echoing && !message.sending()) {
+    digitalWrite(pinLed, LOW);
+    message.release();
+    echoing = false;
+  }
+}
@@ -60,26 +60,23 @@ void setup() {
 }
 
 void loop() {
-  // Check if there is new data from the RawHID device
-  auto bytesAvailable = RawHID.available();
+  // Check if there is new data from the RawHID device.
+  // The report is accessed in place, without reading it byte by byte.
+  const uint8_t* report;
+  auto bytesAvailable = RawHID.readPacket(&report);
   if (bytesAvailable == sizeof(rawhidData))
   {
     digitalWrite(pinLed, HIGH);
 
     // Check header for errors
-    if (RawHID.read() != 3) {
-      return;
-    }
-    if (RawHID.read() != 0) {
+    if (report[0] != 3 || report[1] != 0) {
+      RawHID.releasePacket();
       return;
     }
 
-    // Write data to led array
-    uint8_t* ptr = (uint8_t*)leds;
-    for (int i = 0; i < sizeof(leds); i++) {
-      *ptr = RawHID.read();
-      ptr++;
-    }
+    // Write data to led array and free the buffer for the next report
+    memcpy(leds, report + 2, sizeof(leds));
+    RawHID.releasePacket();
 
     // Update leds, do not update in the loop, to avoid corrupted data.
     // For example if you write (0, 0, 0) and the interrupt
@@ -0,0 +1,57 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  HIDReplay example
+
+  Press a button to replay a trace of reports at its original timing,
+  for example to load test a game or to reproduce a bug report.
+
+  Capture a trace on the host with extras/rawhid/rawhid_capture, like
+      rawhid_capture -t 10 -d /dev/hidraw2 trace.bin
+  and convert it into an array with
+      xxd -i trace.bin
+  Larger traces can be replayed from an SD card, pass the File to begin().
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+// Types "a" and moves the mouse right four times, 100ms apart
+const uint8_t trace[] PROGMEM = {
+  'H', 'I', 'D', 'T', 1, 0, 0, 0,
+  // delay in us, type, length, report
+  0x00, 0x00, 0x00, 0x00, HID_BRIDGE_KEYBOARD, 8, 0, 0, 0x04, 0, 0, 0, 0, 0,
+  0xA0, 0x86, 0x01, 0x00, HID_BRIDGE_KEYBOARD, 8, 0, 0, 0, 0, 0, 0, 0, 0,
+  0xA0, 0x86, 0x01, 0x00, HID_BRIDGE_MOUSE, 4, 0, 40, 0, 0,
+  0xA0, 0x86, 0x01, 0x00, HID_BRIDGE_MOUSE, 4, 0, 40, 0, 0,
+  0xA0, 0x86, 0x01, 0x00, HID_BRIDGE_MOUSE, 4, 0, 40, 0, 0,
+  0xA0, 0x86, 0x01, 0x00, HID_BRIDGE_MOUSE, 4, 0, 40, 0, 0,
+};
+
+HIDReplay replay;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Keyboard.begin();
+  Mouse.begin();
+  replay.attach(&Keyboard, &Mouse);
+}
+
+void loop() {
+  if (!replay.playing() && !digitalRead(pinButton)) {
+    replay.begin_P(trace, sizeof(trace));
+  }
+
+  // Light the led while the trace plays
+  replay.poll();
+  digitalWrite(pinLed, replay.playing());
+}
@@ -38,6 +38,9 @@ void setup() {
   attachInterrupt(digitalPinToInterrupt(pinB), changed, CHANGE);
   
   SurfaceDial.begin();
+
+  // Sum up fast turns instead of sending a report per step
+  SurfaceDial.setCoalescing(true);
 }
 
 void changed() {
@@ -82,4 +85,7 @@ void loop(){
     SurfaceDial.rotate(-10);
     counter += 4;
   } 
+
+  // Send the rest of the rotation
+  SurfaceDial.flush();
 }
@@ -0,0 +1,48 @@
+/*
+  Copyright (c) 2014-2015 NicoHood
+  See the readme for credit to other people.
+
+  Touchscreen example
+  Press a button to pinch two fingers together on the screen.
+
+  All contacts are updated first and sent with one send() per scan.
+  Up to HID_TOUCH_CONTACTS_PER_REPORT contacts share one report.
+  Windows needs SingleTouchscreen, because it reads the maximum
+  contact count as feature report.
+
+  See HID Project documentation for more infos
+  https://github.com/NicoHood/HID/wiki
+*/
+
+#include "HID-Project.h"
+
+const int pinLed = LED_BUILTIN;
+const int pinButton = 2;
+
+void setup() {
+  pinMode(pinLed, OUTPUT);
+  pinMode(pinButton, INPUT_PULLUP);
+
+  // Sends a clean report to the host. This is important on any Arduino type.
+  Touchscreen.begin();
+}
+
+void loop() {
+  if (!digitalRead(pinButton)) {
+    digitalWrite(pinLed, HIGH);
+
+    // Two fingers from the edges to the center
+    for (uint16_t d = 12000; d > 1000; d -= 250) {
+      Touchscreen.press(0, 16384 - d, 16384);
+      Touchscreen.press(1, 16384 + d, 16384);
+      Touchscreen.send();
+      delay(10);
+    }
+    Touchscreen.releaseAll();
+    Touchscreen.send();
+
+    // Simple debounce
+    delay(300);
+    digitalWrite(pinLed, LOW);
+  }
+}
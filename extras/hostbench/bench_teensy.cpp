@@ -0,0 +1,31 @@
+#include "HID-APIs/TeensyKeyboardAPI.h"
+
+#include "hostbench.h"
+
+class BenchTeensyKeyboard : public TeensyKeyboardAPI
+{
+public:
+	virtual void sendReport(void* data, int length) override {
+		sendMock(data, length);
+	}
+};
+
+static BenchTeensyKeyboard teensy;
+static uint8_t step;
+
+static const char text[] = "The quick brown fox jumps over the lazy dog 0123456789!\n";
+// Keys of the layout with dead keys and composed characters
+static const char unicode[] = "\xC3\xA4\xC3\xB6\xC3\xBC \xC3\xA9\xC3\xA8 \xC2\xB0 ~^`";
+
+static void teensyWrite(void) { teensy.write('a' + (step++ & 15)); }
+static void teensyPrint(void) { teensy.print(text); }
+static void teensyUnicode(void) { teensy.print(unicode); }
+static void teensyUnicodeFlash(void) { teensy.print(F("\xC3\xA4\xC3\xB6\xC3\xBC \xC3\xA9\xC3\xA8 \xC2\xB0 ~^`")); }
+
+void benchTeensy(void)
+{
+	bench("TeensyKeyboardAPI::write", teensyWrite);
+	bench("TeensyKeyboardAPI::print (56 chars)", teensyPrint);
+	bench("TeensyKeyboardAPI::print (UTF-8)", teensyUnicode);
+	bench("TeensyKeyboardAPI::print F() (UTF-8)", teensyUnicodeFlash);
+}
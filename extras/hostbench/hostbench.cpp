@@ -0,0 +1,322 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "HID-APIs/DefaultKeyboardAPI.h"
+#include "HID-APIs/NKROKeyboardAPI.h"
+#include "HID-APIs/AbsoluteMouseAPI.h"
+#include "HID-APIs/MouseAPI.h"
+#include "HID-APIs/MouseAcceleration.h"
+#include "HID-APIs/ConsumerAPI.h"
+#include "HID-APIs/GamepadAPI.h"
+#include "HID-APIs/SystemAPI.h"
+#include "HID-Task.h"
+
+#include "hostbench.h"
+
+// Microbenchmarks of the API hot paths, built for the host with a mock
+// transport instead of USB (make; ./hostbench [filter]).
+//
+// The APIs only depend on the core through the report transport and
+// pgm_read_*(), mock/ has just enough Arduino for them. The numbers are
+// host cycles, use them to compare changes and to profile with perf,
+// gprof or valgrind --tool=callgrind, not as the cost on the MCU. The
+// examples/Benchmark sketch measures on the board.
+
+uint32_t reports;
+uint32_t reportBytes;
+
+static const char* filter;
+static volatile uint32_t sink;
+
+using Clock = std::chrono::steady_clock;
+
+//================================================================================
+// Mock transport
+//================================================================================
+
+int sendMock(const void* data, int length)
+{
+	// Something has to read the report, or the compiler drops it
+	reports++;
+	reportBytes += length;
+	sink += ((const uint8_t*)data)[length - 1];
+	return length;
+}
+
+int HID_::SendReport(uint8_t id, const void* data, int len)
+{
+	(void)id;
+	return sendMock(data, len);
+}
+
+HID_& HID()
+{
+	static HID_ hid;
+	return hid;
+}
+
+int USB_Send(uint8_t ep, const void* data, int len)
+{
+	(void)ep;
+	return sendMock(data, len);
+}
+
+unsigned long millis(void)
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+}
+
+unsigned long micros(void)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+void delay(unsigned long ms)
+{
+	// Benchmarks do not wait
+	(void)ms;
+}
+
+void yield(void)
+{
+}
+
+//================================================================================
+// Devices
+//================================================================================
+
+class BenchKeyboard : public DefaultKeyboardAPI
+{
+public:
+	virtual int send(void) override {
+		return sendMock(&_keyReport, sizeof(_keyReport));
+	}
+};
+
+// Answers Caps Lock presses with an LED report like a host
+class BenchLockKeyboard : public DefaultKeyboardAPI
+{
+public:
+	BenchLockKeyboard(void) : leds(0), capsPressed(false) {}
+
+	virtual int send(void) override {
+		bool caps = false;
+		for (uint8_t i = 0; i < 6; i++) {
+			caps |= _keyReport.keycodes[i] == KEY_CAPS_LOCK;
+		}
+		if (caps && !capsPressed) {
+			leds ^= LED_CAPS_LOCK;
+		}
+		capsPressed = caps;
+		return sendMock(&_keyReport, sizeof(_keyReport));
+	}
+
+protected:
+	virtual bool readLeds(uint8_t& state) override {
+		state = leds;
+		return true;
+	}
+
+	uint8_t leds;
+	bool capsPressed;
+};
+
+class BenchNKROKeyboard : public NKROKeyboardAPI
+{
+public:
+	virtual int send(void) override {
+		return sendMock(&_keyReport, sizeof(_keyReport));
+	}
+};
+
+class BenchAbsoluteMouse : public AbsoluteMouseAPI
+{
+public:
+	virtual void SendReport(void* data, int length) override {
+		sendMock(data, length);
+	}
+
+	int16_t add(int16_t base, int16_t increment){
+		return qadd16(base, increment);
+	}
+};
+
+class BenchMouse : public MouseAPI
+{
+public:
+	virtual void SendReport(void* data, int length) override {
+		sendMock(data, length);
+	}
+};
+
+class BenchConsumer : public ConsumerAPI
+{
+public:
+	virtual void SendReport(void* data, int length) override {
+		sendMock(data, length);
+	}
+};
+
+class BenchGamepad : public GamepadAPI
+{
+public:
+	virtual void SendReport(void* data, int length) override {
+		sendMock(data, length);
+	}
+};
+
+class BenchSystem : public SystemAPI
+{
+public:
+	virtual void SendReport(void* data, int length) override {
+		sendMock(data, length);
+	}
+};
+
+static BenchKeyboard keyboard;
+static BenchNKROKeyboard nkro;
+static BenchLockKeyboard lockKeyboard;
+static BenchAbsoluteMouse absoluteMouse;
+static BenchMouse mouse;
+static MouseAcceleration acceleration;
+static BenchConsumer consumer;
+static BenchGamepad gamepad;
+static BenchSystem systemControl;
+static HIDTask<> hidTask;
+static HIDIntentQueueBuffer<16> taskQueues[4];
+
+//================================================================================
+// Benchmarks
+//================================================================================
+
+static const char text[] = "The quick brown fox jumps over the lazy dog 0123456789!\n";
+
+static const char capsText[] = "WARNING: THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG!\n";
+
+static uint8_t step;
+
+static void keyboardWrite(void) { keyboard.write('a' + (step++ & 15)); }
+static void keyboardPrint(void) { keyboard.print(text); }
+static void keyboardPrintFlash(void) { keyboard.print(F("The quick brown fox jumps over the lazy dog 0123456789!\n")); }
+static void keyboardPrintCaps(void) { keyboard.print(capsText); }
+static void keyboardPrintLocked(void) { lockKeyboard.print(capsText); }
+static void keyboardPressRelease(void) {
+	keyboard.press(KeyboardKeycode(KEY_A + (step++ & 15)));
+	keyboard.releaseAll();
+}
+static void keyboardAddRemove(void) {
+	// Six keys without sending, the cost of the key array
+	for (uint8_t i = 0; i < 6; i++) {
+		keyboard.add(KeyboardKeycode(KEY_A + i));
+	}
+	keyboard.removeAll();
+}
+static void nkroSet(void) {
+	nkro.add(KeyboardKeycode(KEY_A + (step++ & 63)));
+	sink += nkro.remove(KeyboardKeycode(KEY_A + (step & 63)));
+}
+static void nkroRemoveAll(void) {
+	nkro.add(KEY_A);
+	sink += nkro.removeAll();
+}
+static void nkroWrite(void) { nkro.write('a' + (step++ & 15)); }
+static void absoluteMove(void) { absoluteMouse.move(3, -2); }
+static void absoluteAdd(void) {
+	// Saturating coordinate updates
+	int16_t v = step++;
+	for (uint8_t i = 0; i < 16; i++) {
+		v = absoluteMouse.add(v, 4001);
+	}
+	sink += v;
+}
+static void mouseMove(void) { mouse.move(1, -1); }
+static void mouseAccelerated(void) {
+	// Speeds along the whole curve, with fractions to carry
+	int16_t v = (step++ & 63) - 32;
+	acceleration.move(mouse, v, v / 3);
+}
+static void consumerPressRelease(void) {
+	consumer.press(MEDIA_VOLUME_UP);
+	consumer.release(MEDIA_VOLUME_UP);
+}
+static void gamepadWrite(void) {
+	gamepad.xAxis(step++ * 257);
+	gamepad.press(1 + (step & 31));
+	gamepad.write();
+}
+static void systemWrite(void) { systemControl.write(SYSTEM_SLEEP); }
+static void taskMerge(void) {
+	// A key of every task, merged into one press and one release report
+	for (uint8_t i = 0; i < 4; i++) {
+		taskQueues[i].press(KeyboardKeycode(KEY_A + i));
+	}
+	hidTask.process();
+	for (uint8_t i = 0; i < 4; i++) {
+		taskQueues[i].release(KeyboardKeycode(KEY_A + i));
+	}
+	hidTask.process();
+}
+
+void bench(const char* name, void (*fn)(void))
+{
+	if (filter && !strstr(name, filter)) {
+		return;
+	}
+
+	// Warm up the caches, then run at least 100ms
+	for (int i = 0; i < 1000; i++) {
+		fn();
+	}
+	uint32_t calls = 0;
+	uint32_t start = reports;
+	Clock::time_point begin = Clock::now();
+	Clock::duration took;
+	do {
+		for (int i = 0; i < 1000; i++) {
+			fn();
+		}
+		calls += 1000;
+		took = Clock::now() - begin;
+	} while (took < std::chrono::milliseconds(100));
+
+	double ns = std::chrono::duration<double, std::nano>(took).count() / calls;
+	printf("%-36s %10.1f %9.2f\n", name, ns, double(reports - start) / calls);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1) {
+		filter = argv[1];
+	}
+	acceleration.setCurve(mouseAccelerationDefault, sizeof(mouseAccelerationDefault) / sizeof(mouseAccelerationDefault[0]));
+	acceleration.setScale(MOUSE_ACCELERATION_ONE * 3 / 4);
+	lockKeyboard.setLockTyping(true);
+	hidTask.setKeyboard(keyboard);
+	hidTask.setConsumer(consumer);
+	for (uint8_t i = 0; i < 4; i++) {
+		hidTask.add(taskQueues[i]);
+	}
+
+	printf("%-36s %10s %9s\n", "", "ns/call", "reports");
+	bench("DefaultKeyboardAPI::write", keyboardWrite);
+	bench("DefaultKeyboardAPI::print (56 chars)", keyboardPrint);
+	bench("DefaultKeyboardAPI::print F() (56)", keyboardPrintFlash);
+	bench("DefaultKeyboardAPI::print caps (54)", keyboardPrintCaps);
+	bench("DefaultKeyboardAPI::print locked (54)", keyboardPrintLocked);
+	bench("DefaultKeyboardAPI::press+releaseAll", keyboardPressRelease);
+	bench("DefaultKeyboardAPI::add (6)+removeAll", keyboardAddRemove);
+	bench("NKROKeyboardAPI::add+remove", nkroSet);
+	bench("NKROKeyboardAPI::removeAll", nkroRemoveAll);
+	bench("NKROKeyboardAPI::write", nkroWrite);
+	bench("AbsoluteMouseAPI::move", absoluteMove);
+	bench("AbsoluteMouseAPI::qadd16 (16)", absoluteAdd);
+	bench("MouseAPI::move", mouseMove);
+	bench("MouseAcceleration::move", mouseAccelerated);
+	bench("ConsumerAPI::press+release", consumerPressRelease);
+	bench("GamepadAPI::write", gamepadWrite);
+	bench("SystemAPI::write", systemWrite);
+	bench("HIDTask::process (4 queues)", taskMerge);
+	benchTeensy();
+	return 0;
+}
@@ -0,0 +1,18 @@
+// Microbenchmarks of the HID-APIs on the host, see hostbench.cpp
+#pragma once
+
+#include <stdint.h>
+
+// Reports the mock transport took, and their bytes
+extern uint32_t reports;
+extern uint32_t reportBytes;
+
+// Counts a report like the USB transport would send it
+int sendMock(const void* data, int length);
+
+// Runs fn until it took enough time and prints ns and reports per call
+void bench(const char* name, void (*fn)(void));
+
+// Benchmarks of the TeensyKeyboardAPI, it has its own report type and
+// needs its own translation unit
+void benchTeensy(void);
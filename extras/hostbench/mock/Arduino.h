@@ -0,0 +1,75 @@
+// Just enough of the Arduino core to build the HID-APIs on the host, the
+// reports go to the mock devices of hostbench.cpp instead of USB.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <avr/pgmspace.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(x, low, high) ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void yield(void);
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+
+class Print
+{
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size){
+		size_t n = 0;
+		while (size--) {
+			if (!write(*buffer++)) break;
+			n++;
+		}
+		return n;
+	}
+	size_t write(const char *str){
+		return str ? write((const uint8_t *)str, strlen(str)) : 0;
+	}
+	size_t print(const char *str){
+		return write(str);
+	}
+	size_t print(const __FlashStringHelper *str){
+		return write((const char *)str);
+	}
+	size_t print(char c){
+		return write((uint8_t)c);
+	}
+	size_t println(const char *str){
+		return print(str) + write("\r\n");
+	}
+
+	int getWriteError(){
+		return write_error;
+	}
+	void clearWriteError(){
+		write_error = 0;
+	}
+
+protected:
+	void setWriteError(int err = 1){
+		write_error = err;
+	}
+
+private:
+	int write_error = 0;
+};
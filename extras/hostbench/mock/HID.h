@@ -0,0 +1,16 @@
+// The USB transport of the core, hostbench.cpp counts the reports instead
+#pragma once
+
+#include <stdint.h>
+
+#define TRANSFER_RELEASE 0x40
+
+class HID_
+{
+public:
+	int SendReport(uint8_t id, const void* data, int len);
+};
+
+HID_& HID();
+
+int USB_Send(uint8_t ep, const void* data, int len);
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+# Uploads a file with feature reports and reads it back, run it against the
+# examples/RawHID/RawHIDFeatureTransfer sketch. Linux only, hidraw.
+#
+#	feature_transfer.py /dev/hidrawN upload config.bin
+#	feature_transfer.py /dev/hidrawN download config.bin [length]
+#
+# The protocol is described in src/HID-Transfer.h of the library.
+
+import fcntl
+import struct
+import sys
+import time
+
+START = 0x01
+WRITE = 0x02
+END = 0x03
+READ = 0x04
+
+HEADER = 5
+# HID_TRANSFER_SIZE of the library
+REPORT = 64
+RETRY_S = 0.002
+TIMEOUT_S = 5.0
+
+
+def _ioc(nr, size):
+	# _IOC(_IOC_READ | _IOC_WRITE, 'H', nr, size)
+	return (3 << 30) | (size << 16) | (ord("H") << 8) | nr
+
+
+def set_feature(fd, op, offset, payload=b""):
+	# report number 0, RawHID has no report ID
+	report = bytes([0, op]) + struct.pack("<I", offset)[:3] + bytes([len(payload)]) + payload
+	report = report.ljust(REPORT + 1, b"\0")
+	begin = time.monotonic()
+	while True:
+		try:
+			fcntl.ioctl(fd, _ioc(0x06, len(report)), report)
+			return
+		except OSError:
+			# stalled while the device writes its pages
+			if time.monotonic() - begin > TIMEOUT_S:
+				raise
+			time.sleep(RETRY_S)
+
+
+def get_feature(fd):
+	report = bytearray(REPORT + 1)
+	fcntl.ioctl(fd, _ioc(0x07, len(report)), report, True)
+	return bytes(report[1:])
+
+
+def upload(fd, data):
+	set_feature(fd, START, 0, struct.pack("<I", len(data)))
+	chunk = REPORT - HEADER
+	for offset in range(0, len(data), chunk):
+		set_feature(fd, WRITE, offset, data[offset:offset + chunk])
+	set_feature(fd, END, len(data))
+
+
+def download(fd, length):
+	data = bytearray()
+	set_feature(fd, READ, 0)
+	while len(data) < length:
+		report = get_feature(fd)
+		offset = report[1] | (report[2] << 8) | (report[3] << 16)
+		n = report[4]
+		if offset != len(data):
+			# a lost reply, start again at our offset
+			set_feature(fd, READ, len(data))
+			continue
+		if not n:
+			break
+		data += report[HEADER:HEADER + n]
+	return bytes(data[:length])
+
+
+def main():
+	if len(sys.argv) < 4 or sys.argv[2] not in ("upload", "download"):
+		print("usage: %s /dev/hidrawN upload|download file [length]" % sys.argv[0])
+		return 1
+	with open(sys.argv[1], "rb+", buffering=0) as dev:
+		fd = dev.fileno()
+		begin = time.monotonic()
+		if sys.argv[2] == "upload":
+			with open(sys.argv[3], "rb") as f:
+				data = f.read()
+			upload(fd, data)
+		else:
+			length = int(sys.argv[4]) if len(sys.argv) > 4 else 1 << 24
+			data = download(fd, length)
+			with open(sys.argv[3], "wb") as f:
+				f.write(data)
+		s = time.monotonic() - begin
+		print("%d bytes in %.3f s, %.1f KB/s" % (len(data), s, len(data) / s / 1024.0 if s else 0))
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main())
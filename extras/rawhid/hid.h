@@ -4,3 +4,30 @@ int rawhid_recv(int num, void *buf, int len, int timeout);
 int rawhid_send(int num, void *buf, int len, int timeout);
 void rawhid_close(int num);
 
+// Feature report via GET_REPORT, starts with the report ID if id is not 0
+int rawhid_get_feature(int num, int id, void *buf, int len, int timeout);
+
+// Report descriptor of the interface, returns the length or -1 (not on Windows)
+int rawhid_get_descriptor(int num, void *buf, int len);
+
+
+// Batched transfers of count packets of len bytes each, stored back to back
+int rawhid_recv_many(int num, void *buf, int len, int count, int *lengths, int timeout);
+int rawhid_send_many(int num, const void *buf, int len, int count, int timeout);
+
+
+// Cached discovery with hotplug notifications (Linux only)
+int rawhid_hotplug(int enable);
+int rawhid_changed(void);
+
+
+// Asynchronous receiving with several transfers in flight (Linux and Windows)
+typedef void (*rawhid_callback_t)(int num, const void *buf, int len, void *ctx);
+int rawhid_async_start(int num, int transfers, int len, rawhid_callback_t callback, void *ctx);
+int rawhid_async_recv(int num, void *buf, int len, int timeout);
+int rawhid_async_peek(int num, const void **buf, int timeout);
+void rawhid_async_release(int num);
+int rawhid_async_wait(int timeout);
+// on macOS also counts the reports lost by the receive ring of rawhid_recv()
+int rawhid_async_dropped(int num);
+void rawhid_async_stop(int num);
@@ -0,0 +1,724 @@
+/* Raw HID functions for Linux with the hidraw driver
+ *
+ *  rawhid_open - open 1 or more devices
+ *  rawhid_recv - receive a packet
+ *  rawhid_send - send a packet
+ *  rawhid_close - close a device
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above description, website URL and copyright notice and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <linux/hidraw.h>
+
+#include "hid.h"
+
+// The hidraw driver keeps the kernel HID driver attached, the interface is not
+// claimed. Devices are matched with the report descriptor from sysfs, so only
+// matching devices are opened. All reads are non-blocking, the kernel queues
+// the reports that arrive between two reads.
+//
+// Access to /dev/hidraw* needs the hidraw rule of extras/ArduinoRawHID.rules.
+// The Makefile builds this backend with "make BACKEND=hidraw".
+
+#define printf(...)  // comment this out for lots of info
+
+// maximum number of devices opened at once
+#define MAX_DEVICES 256
+
+// largest report descriptor read from sysfs (HID_MAX_DESCRIPTOR_SIZE)
+#define MAX_DESCRIPTOR 4096
+
+// largest report that is sent or read by the event thread
+#define MAX_REPORT 4096
+
+// a table of all opened HID devices, so the caller can
+// simply refer to them by number
+typedef struct hid_struct hid_t;
+static hid_t *hid_table[MAX_DEVICES];
+static int hid_count = 0;
+struct hid_struct {
+	int fd;
+	int open;
+	int num;
+	int report_ids;		// reports start with their ID, otherwise a 0 is sent first
+	// asynchronous receiving, see rawhid_async_start()
+	int async;
+	rawhid_callback_t callback;
+	void *ctx;
+	uint8_t *peek;		// packet returned by rawhid_async_peek()
+	int peek_len;
+	int async_len;
+};
+
+// async devices without a callback, see rawhid_async_wait()
+static int wait_epoll = -1;
+
+// one thread reads all async devices with a callback
+static int callback_epoll = -1;
+static pthread_t event_thread;
+static int event_thread_running = 0;
+static volatile int event_thread_stop = 0;
+static pthread_mutex_t callback_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// hotplug mode, see rawhid_hotplug()
+static int hotplug_fd = -1;
+static int hotplug_changes = 0;
+
+
+// private functions, not intended to be used from outside this file
+static void add_hid(hid_t *h);
+static hid_t * get_hid(int num);
+static void free_all_hid(void);
+static void hid_close(hid_t *hid);
+static int hid_parse_item(uint32_t *val, uint8_t **data, const uint8_t *end);
+static int hid_probe(const char *name, int *vid, int *pid, uint32_t *usage_page, uint32_t *usage, int *report_ids);
+static int wait_fd(int fd, short events, int timeout);
+static void * async_event_loop(void *arg);
+static int event_thread_start(void);
+static void hotplug_read(void);
+
+//  rawhid_recv - receive a packet
+//	Inputs:
+//	num = device to receive from (zero based)
+//	buf = buffer to receive packet
+//	len = buffer's size
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_recv(int num, void *buf, int len, int timeout)
+{
+	hid_t *hid;
+	int n, r;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+
+	// reports that arrived meanwhile are queued by the kernel
+	while (1) {
+		n = read(hid->fd, buf, len);
+		if (n >= 0) return n;
+		if (errno == EINTR) continue;
+		if (errno != EAGAIN) return -1;
+		r = wait_fd(hid->fd, POLLIN, timeout);
+		if (r <= 0) return r;
+		timeout = 0;
+	}
+}
+
+//  rawhid_send - send a packet
+//	Inputs:
+//	num = device to transmit to (zero based)
+//	buf = buffer containing packet to send
+//	len = number of bytes to transmit
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes sent, or -1 on error
+//
+int rawhid_send(int num, void *buf, int len, int timeout)
+{
+	hid_t *hid;
+	uint8_t out[MAX_REPORT + 1];
+	int n, r;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	if (len < 1 || len > MAX_REPORT) return -1;
+
+	// the first byte is the report ID, 0 is removed by the kernel
+	if (!hid->report_ids) {
+		out[0] = 0;
+		memcpy(out + 1, buf, len);
+	} else {
+		memcpy(out, buf, len);
+	}
+
+	r = wait_fd(hid->fd, POLLOUT, timeout);
+	if (r <= 0) return r;
+	do {
+		n = write(hid->fd, out, hid->report_ids ? len : len + 1);
+	} while (n < 0 && errno == EINTR);
+	if (n < 0) return errno == EAGAIN ? 0 : -1;
+	return hid->report_ids ? n : n - 1;
+}
+
+//  rawhid_get_feature - read a feature report with GET_REPORT
+//	Inputs:
+//	num = device to read from (zero based)
+//	id = report ID, 0 if the device does not use report IDs
+//	buf = buffer to store the report, starting with the ID if not 0
+//	len = size of the buffer
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_get_feature(int num, int id, void *buf, int len, int timeout)
+{
+	hid_t *hid;
+	uint8_t in[MAX_REPORT + 1];
+	int n;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	if (len < 1 || len > MAX_REPORT) return -1;
+
+	// the kernel waits for the control transfer itself
+	(void)timeout;
+	in[0] = id;
+	do {
+		n = ioctl(hid->fd, HIDIOCGFEATURE(len + 1), in);
+	} while (n < 0 && errno == EINTR);
+	if (n < 0) return -1;
+
+	// without an ID the data follows the report number, with an ID the
+	// report starts with it, as sent by the device
+	if (!id) {
+		if (n > 0) n--;
+		memcpy(buf, in + 1, n);
+	} else {
+		memcpy(buf, in, n);
+	}
+	return n;
+}
+
+//  rawhid_get_descriptor - read the report descriptor
+//	Inputs:
+//	num = device (zero based)
+//	buf = buffer to store the descriptor
+//	len = size of the buffer
+//	Output:
+//	length of the descriptor, or -1 on error
+//
+int rawhid_get_descriptor(int num, void *buf, int len)
+{
+	hid_t *hid;
+	struct hidraw_report_descriptor desc;
+	int size;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	if (ioctl(hid->fd, HIDIOCGRDESCSIZE, &size) < 0) return -1;
+	if (size > len || size > HID_MAX_DESCRIPTOR_SIZE) return -1;
+	desc.size = size;
+	if (ioctl(hid->fd, HIDIOCGRDESC, &desc) < 0) return -1;
+	memcpy(buf, desc.value, size);
+	return size;
+}
+
+//  rawhid_async_start - receive with the kernel report queue
+//
+//	Inputs:
+//	num = device to receive from (zero based)
+//	transfers = unused, the kernel queues the reports
+//	len = size of each packet (the report size)
+//	callback = called from the event thread for every packet,
+//	           or NULL to read the packets with rawhid_async_recv()
+//	ctx = passed to the callback
+//	Output:
+//	0 on success, or -1 on error
+//
+int rawhid_async_start(int num, int transfers, int len, rawhid_callback_t callback, void *ctx)
+{
+	struct epoll_event ev;
+	hid_t *hid;
+	int *epoll_fd;
+
+	(void)transfers;
+	hid = get_hid(num);
+	if (!hid || !hid->open || hid->async) return -1;
+	if (len < 1) return -1;
+
+	hid->peek = (uint8_t *)malloc(len);
+	if (!hid->peek) return -1;
+	hid->peek_len = 0;
+	hid->async_len = len;
+	hid->callback = callback;
+	hid->ctx = ctx;
+
+	// devices with a callback are read by the event thread
+	epoll_fd = callback ? &callback_epoll : &wait_epoll;
+	if (*epoll_fd < 0) *epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = num;
+	if (*epoll_fd < 0 || epoll_ctl(*epoll_fd, EPOLL_CTL_ADD, hid->fd, &ev) < 0 ||
+	  (callback && event_thread_start() < 0)) {
+		if (*epoll_fd >= 0) epoll_ctl(*epoll_fd, EPOLL_CTL_DEL, hid->fd, NULL);
+		free(hid->peek);
+		hid->peek = NULL;
+		return -1;
+	}
+	hid->async = 1;
+	return 0;
+}
+
+//  rawhid_async_recv - receive a packet of an async device
+//	Inputs:
+//	num = device to receive from (zero based)
+//	buf = buffer to receive packet
+//	len = buffer's size
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_async_recv(int num, void *buf, int len, int timeout)
+{
+	const void *p;
+	int n;
+
+	n = rawhid_async_peek(num, &p, timeout);
+	if (n <= 0) return n;
+	if (n > len) n = len;
+	memcpy(buf, p, n);
+	rawhid_async_release(num);
+	return n;
+}
+
+//  rawhid_async_peek - get the next packet without copying it again
+//	Inputs:
+//	num = device to receive from (zero based)
+//	buf = set to the packet data, valid until rawhid_async_release()
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes received, 0 on timeout, or -1 on error
+//
+int rawhid_async_peek(int num, const void **buf, int timeout)
+{
+	hid_t *hid;
+	int n;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async || hid->callback) return -1;
+
+	if (!hid->peek_len) {
+		n = rawhid_recv(num, hid->peek, hid->async_len, timeout);
+		if (n <= 0) return n;
+		hid->peek_len = n;
+	}
+	*buf = hid->peek;
+	return hid->peek_len;
+}
+
+//  rawhid_async_release - free the packet returned by rawhid_async_peek()
+//
+void rawhid_async_release(int num)
+{
+	hid_t *hid;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return;
+	hid->peek_len = 0;
+}
+
+//  rawhid_async_wait - wait until any async device received a packet
+//
+//	Inputs:
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of the device (zero based), or -1 if none is ready
+//
+//	A device is returned as long as the kernel has packets queued for it.
+//	Read all its packets with rawhid_async_recv(num, buf, len, 0) afterwards.
+//
+int rawhid_async_wait(int timeout)
+{
+	struct epoll_event ev;
+	int n;
+
+	if (wait_epoll < 0) return -1;
+	do {
+		n = epoll_wait(wait_epoll, &ev, 1, timeout);
+	} while (n < 0 && errno == EINTR);
+	return n == 1 ? (int)ev.data.u32 : -1;
+}
+
+//  rawhid_async_dropped - packets dropped because the queue was full
+//
+//	The kernel drops the oldest reports of a full queue without counting them.
+//
+int rawhid_async_dropped(int num)
+{
+	hid_t *hid;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return -1;
+	return 0;
+}
+
+//  rawhid_async_stop - stop receiving with the async functions
+//
+void rawhid_async_stop(int num)
+{
+	hid_t *hid;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return;
+
+	// the event thread does not call the callback anymore afterwards
+	pthread_mutex_lock(&callback_lock);
+	epoll_ctl(hid->callback ? callback_epoll : wait_epoll, EPOLL_CTL_DEL, hid->fd, NULL);
+	hid->async = 0;
+	pthread_mutex_unlock(&callback_lock);
+
+	free(hid->peek);
+	hid->peek = NULL;
+	hid->peek_len = 0;
+	hid->callback = NULL;
+}
+
+//  rawhid_hotplug - watch for devices arriving and leaving
+//
+//	Inputs:
+//	enable = 1 to watch /dev for hidraw devices, 0 to stop it
+//	Output:
+//	0 on success, or -1 if inotify is not available
+//
+//	Devices that left return -1 from rawhid_recv() and rawhid_send(),
+//	call rawhid_open() again to open the new ones.
+//
+int rawhid_hotplug(int enable)
+{
+	if (!enable) {
+		if (hotplug_fd >= 0) {
+			close(hotplug_fd);
+			hotplug_fd = -1;
+		}
+		return 0;
+	}
+	if (hotplug_fd >= 0) return 0;
+
+	hotplug_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (hotplug_fd < 0) return -1;
+	if (inotify_add_watch(hotplug_fd, "/dev", IN_CREATE | IN_DELETE) < 0) {
+		rawhid_hotplug(0);
+		return -1;
+	}
+	return 0;
+}
+
+//  rawhid_changed - devices arrived or left since rawhid_open()
+//
+//	Output:
+//	number of hotplug events since rawhid_open() or the last call
+//
+int rawhid_changed(void)
+{
+	int changes;
+
+	hotplug_read();
+	changes = hotplug_changes;
+	hotplug_changes = 0;
+	return changes;
+}
+
+//  rawhid_open - open 1 or more devices
+//
+//	Inputs:
+//	max = maximum number of devices to open
+//	vid = Vendor ID, or -1 if any
+//	pid = Product ID, or -1 if any
+//	usage_page = top level usage page, or -1 if any
+//	usage = top level usage number, or -1 if any
+//	Output:
+//	actual number of devices opened
+//
+int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
+{
+	struct dirent **names;
+	char path[300];
+	int count = 0, n, i, fd;
+	int dev_vid, dev_pid, report_ids;
+	uint32_t parsed_usage_page, parsed_usage;
+	hid_t *hid;
+
+	if (hid_count) free_all_hid();
+	hotplug_read();
+	hotplug_changes = 0;
+	printf("rawhid_open, max=%d\n", max);
+	if (max < 1) return 0;
+	if (max > MAX_DEVICES) max = MAX_DEVICES;
+
+	// sorted, so the device numbers follow the hidraw numbers
+	n = scandir("/sys/class/hidraw", &names, NULL, versionsort);
+	if (n < 0) return 0;
+
+	for (i = 0; i < n; i++) {
+		if (count >= max || strncmp(names[i]->d_name, "hidraw", 6)) continue;
+		if (hid_probe(names[i]->d_name, &dev_vid, &dev_pid, &parsed_usage_page,
+			&parsed_usage, &report_ids) < 0) continue;
+
+		printf("%s: vid=%04X, pid=%04X, usage %X:%X\n", names[i]->d_name,
+			dev_vid, dev_pid, parsed_usage_page, parsed_usage);
+		if (vid > 0 && dev_vid != vid) continue;
+		if (pid > 0 && dev_pid != pid) continue;
+		if ((!parsed_usage_page) || (!parsed_usage) ||
+			(usage_page > 0 && parsed_usage_page != (uint32_t)usage_page) ||
+			(usage > 0 && parsed_usage != (uint32_t)usage)) continue;
+
+		snprintf(path, sizeof(path), "/dev/%s", names[i]->d_name);
+		fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+		if (fd < 0) {
+			printf("  unable to open %s\n", path);
+			continue;
+		}
+
+		hid = (hid_t *)calloc(1, sizeof(hid_t));
+		if (!hid) {
+			close(fd);
+			continue;
+		}
+		hid->fd = fd;
+		hid->report_ids = report_ids;
+		hid->open = 1;
+		add_hid(hid);
+		count++;
+	}
+
+	for (i = 0; i < n; i++) free(names[i]);
+	free(names);
+	return count;
+}
+
+//  rawhid_close - close a device
+//
+//	Inputs:
+//	num = device to close (zero based)
+//	Output
+//	(nothing)
+//
+// cppcheck-suppress unusedFunction
+void rawhid_close(int num)
+{
+	hid_t *hid;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return;
+	hid_close(hid);
+}
+
+// ids and top level usage of a hidraw device from sysfs, it is not opened
+static int hid_probe(const char *name, int *vid, int *pid, uint32_t *usage_page, uint32_t *usage, int *report_ids)
+{
+	uint8_t buf[MAX_DESCRIPTOR];
+	uint8_t *p = buf;
+	char path[300], line[256];
+	unsigned int bus, v, d;
+	uint32_t val;
+	FILE *f;
+	int fd, len, found = 0;
+
+	// HID_ID=0003:00002341:00008036
+	snprintf(path, sizeof(path), "/sys/class/hidraw/%s/device/uevent", name);
+	f = fopen(path, "r");
+	if (!f) return -1;
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "HID_ID=%x:%x:%x", &bus, &v, &d) == 3) {
+			*vid = v;
+			*pid = d;
+			found = 1;
+		}
+	}
+	fclose(f);
+	if (!found) return -1;
+
+	snprintf(path, sizeof(path), "/sys/class/hidraw/%s/device/report_descriptor", name);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return -1;
+	len = read(fd, buf, sizeof(buf));
+	close(fd);
+	printf("  descriptor, len=%d\n", len);
+	if (len < 0) return -1;
+
+	// the whole descriptor is parsed for report ID items
+	*usage_page = *usage = 0;
+	*report_ids = 0;
+	while (p < buf + len) {
+		int tag = hid_parse_item(&val, &p, buf + len);
+		if (tag < 0) break;
+		if (tag == 4 && !*usage_page) *usage_page = val;
+		if (tag == 8 && !*usage) *usage = val;
+		if (tag == 0x84) *report_ids = 1;
+	}
+	return 0;
+}
+
+
+static int hid_parse_item(uint32_t *val, uint8_t **data, const uint8_t *end)
+{
+	const uint8_t *p = *data;
+	uint8_t tag;
+	const int table[4] = {0, 1, 2, 4};
+	int len;
+
+	if (p >= end) return -1;
+	if (p[0] == 0xFE) {
+		// long item, HID 1.11, 6.2.2.3, page 27
+		if (p + 3 > end || p + 3 + p[1] > end) return -1;
+		tag = p[2];
+		*val = 0;
+		len = p[1] + 2;
+	} else {
+		// short item, HID 1.11, 6.2.2.2, page 26
+		tag = p[0] & 0xFC;
+		len = table[p[0] & 0x03];
+		if (p + len + 1 > end) return -1;
+		switch (p[0] & 0x03) {
+			case 3: *val = p[1] | (p[2] << 8) | (p[3] << 16) | ((uint32_t)p[4] << 24); break;
+			case 2: *val = p[1] | (p[2] << 8); break;
+			case 1: *val = p[1]; break;
+			case 0: *val = 0; break;
+		}
+	}
+	*data += len + 1;
+	return tag;
+}
+
+
+// 1 if ready, 0 on timeout, -1 if the device is gone
+static int wait_fd(int fd, short events, int timeout)
+{
+	struct pollfd pfd;
+	int r;
+
+	pfd.fd = fd;
+	pfd.events = events;
+	do {
+		r = poll(&pfd, 1, timeout);
+	} while (r < 0 && errno == EINTR);
+	if (r < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) return -1;
+	return r;
+}
+
+
+static void add_hid(hid_t *h)
+{
+	h->num = hid_count;
+	hid_table[hid_count++] = h;
+}
+
+
+static hid_t * get_hid(int num)
+{
+	if (num < 0 || num >= hid_count) return NULL;
+	return hid_table[num];
+}
+
+
+static void free_all_hid(void)
+{
+	int i;
+
+	for (i = 0; i < hid_count; i++) {
+		hid_close(hid_table[i]);
+		free(hid_table[i]);
+		hid_table[i] = NULL;
+	}
+	hid_count = 0;
+
+	if (event_thread_running) {
+		event_thread_stop = 1;
+		pthread_join(event_thread, NULL);
+		event_thread_running = 0;
+	}
+}
+
+
+static void * async_event_loop(void *arg)
+{
+	struct epoll_event events[16];
+	uint8_t buf[MAX_REPORT];
+	hid_t *hid;
+	int n, i, len;
+
+	(void)arg;
+	while (!event_thread_stop) {
+		n = epoll_wait(callback_epoll, events, 16, 100);
+		for (i = 0; i < n; i++) {
+			pthread_mutex_lock(&callback_lock);
+			hid = get_hid(events[i].data.u32);
+			// all queued reports of the device, then the next one
+			while (hid && hid->async && hid->callback) {
+				len = read(hid->fd, buf, hid->async_len < (int)sizeof(buf) ? hid->async_len : (int)sizeof(buf));
+				if (len < 0) {
+					// gone, the callback is not called again
+					if (errno != EAGAIN && errno != EINTR) {
+						epoll_ctl(callback_epoll, EPOLL_CTL_DEL, hid->fd, NULL);
+					}
+					break;
+				}
+				hid->callback(hid->num, buf, len, hid->ctx);
+			}
+			pthread_mutex_unlock(&callback_lock);
+		}
+	}
+	return NULL;
+}
+
+
+static int event_thread_start(void)
+{
+	if (event_thread_running) return 0;
+	event_thread_stop = 0;
+	if (pthread_create(&event_thread, NULL, async_event_loop, NULL) != 0) return -1;
+	event_thread_running = 1;
+	return 0;
+}
+
+
+// count the hidraw nodes created and removed in /dev
+static void hotplug_read(void)
+{
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event *ev;
+	int n, i;
+
+	if (hotplug_fd < 0) return;
+	while ((n = read(hotplug_fd, buf, sizeof(buf))) > 0) {
+		for (i = 0; i < n; i += sizeof(struct inotify_event) + ev->len) {
+			ev = (const struct inotify_event *)(buf + i);
+			if (ev->len && !strncmp(ev->name, "hidraw", 6)) hotplug_changes++;
+		}
+	}
+}
+
+
+static void hid_close(hid_t *hid)
+{
+	if (hid->fd < 0) return;
+	if (hid->async) rawhid_async_stop(hid->num);
+
+	close(hid->fd);
+	hid->fd = -1;
+	hid->open = 0;
+}
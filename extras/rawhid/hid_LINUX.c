@@ -31,6 +31,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
 #include <libusb-1.0/libusb.h>
 
 #include "hid.h"
@@ -50,21 +53,85 @@
 
 #define printf(...)  // comment this out for lots of info
 
-// a list of all opened HID devices, so the caller can
+// number of received packets the async engine can hold per device (power of two)
+#define ASYNC_RING_SIZE 64
+
+// asynchronous receive state of a device, see rawhid_async_start()
+typedef struct hid_async_struct {
+	struct libusb_transfer **transfers;
+	int num_transfers;
+	int active;		// transfers still owned by libusb
+	int stopping;
+	int num;
+	int len;
+	rawhid_callback_t callback;
+	void *ctx;
+	// single producer (event thread) single consumer (caller) ring
+	uint8_t *ring;
+	int ring_len[ASYNC_RING_SIZE];
+	unsigned int head;
+	unsigned int tail;
+	unsigned int dropped;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} hid_async_t;
+
+// maximum number of devices opened at once (power of two)
+#define MAX_DEVICES 256
+
+// a table of all opened HID devices, so the caller can
 // simply refer to them by number
 typedef struct hid_struct hid_t;
-static hid_t *first_hid = NULL;
-static hid_t *last_hid = NULL;
+static hid_t *hid_table[MAX_DEVICES];
+static int hid_count = 0;
 struct hid_struct {
 	libusb_device_handle *handle;
 	int open;
+	int num;
 	int iface;
 	int ep_in;
 	int ep_out;
-	struct hid_struct *prev;
-	struct hid_struct *next;
+	hid_async_t *async;
+	int ready_queued;	// device is in the ready queue
 };
 
+// devices with received packets, see rawhid_async_wait().
+// Every device is queued at most once, so MAX_DEVICES entries always fit.
+static int ready_queue[MAX_DEVICES];
+static unsigned int ready_head = 0;
+static unsigned int ready_tail = 0;
+static pthread_mutex_t ready_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ready_cond = PTHREAD_COND_INITIALIZER;
+
+// interfaces probed by rawhid_open(), so a reconnect does not fetch and
+// parse the report descriptor of unchanged devices again
+#define MAX_PROBES 256
+typedef struct probe_struct {
+	uint8_t bus;
+	uint8_t ports[7];
+	int num_ports;
+	uint16_t vid;
+	uint16_t pid;
+	uint16_t release;
+	int iface;
+	uint32_t usage_page;
+	uint32_t usage;
+} probe_t;
+static probe_t probe_cache[MAX_PROBES];
+static int probe_count = 0;
+static int probe_next = 0;	// entry to replace when the cache is full
+static pthread_mutex_t probe_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// hotplug mode, see rawhid_hotplug()
+static libusb_hotplug_callback_handle hotplug_handle;
+static int hotplug_enabled = 0;
+static int hotplug_changes = 0;
+
+// one thread handles the libusb events of all async devices
+static pthread_t event_thread;
+static int event_thread_running = 0;
+static volatile int event_thread_stop = 0;
+
 
 // private functions, not intended to be used from outside this file
 static void add_hid(hid_t *h);
@@ -72,6 +139,19 @@ static hid_t * get_hid(int num);
 static void free_all_hid(void);
 static void hid_close(hid_t *hid);
 static int hid_parse_item(uint32_t *val, uint8_t **data, const uint8_t *end);
+static int hid_probe_usage(libusb_device_handle *handle, int iface, uint32_t *usage_page, uint32_t *usage);
+static void * async_event_loop(void *arg);
+static int event_thread_start(void);
+static void probe_key(probe_t *key, libusb_device *dev, const struct libusb_device_descriptor *desc, int iface);
+static int probe_find(libusb_device *dev, const struct libusb_device_descriptor *desc, int iface,
+	uint32_t *usage_page, uint32_t *usage);
+static void probe_add(libusb_device *dev, const struct libusb_device_descriptor *desc, int iface,
+	uint32_t usage_page, uint32_t usage);
+static void probe_forget(libusb_device *dev);
+static int LIBUSB_CALL hotplug_done(libusb_context *ctx, libusb_device *dev,
+	libusb_hotplug_event event, void *user_data);
+static void LIBUSB_CALL async_recv_done(struct libusb_transfer *transfer);
+static void async_free(hid_t *hid);
 
 //  rawhid_recv - receive a packet
 //	Inputs:
@@ -131,6 +211,338 @@ int rawhid_send(int num, void *buf, int len, int timeout)
 	return (r >= 0) ? transferred : -1;
 }
 
+//  rawhid_get_feature - read a feature report with GET_REPORT
+//	Inputs:
+//	num = device to read from (zero based)
+//	id = report ID, 0 if the device does not use report IDs
+//	buf = buffer to store the report, starting with the ID if not 0
+//	len = size of the buffer
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_get_feature(int num, int id, void *buf, int len, int timeout)
+{
+	hid_t *hid;
+	int r;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+
+	r = libusb_control_transfer(hid->handle,
+							  LIBUSB_REQUEST_TYPE_CLASS | LIBUSB_RECIPIENT_INTERFACE | LIBUSB_ENDPOINT_IN,
+							  0x01, 0x300 | (id & 0xFF), hid->iface,
+							  buf, len, timeout);
+	return (r >= 0) ? r : -1;
+}
+
+//  rawhid_get_descriptor - read the report descriptor
+//	Inputs:
+//	num = device (zero based)
+//	buf = buffer to store the descriptor
+//	len = size of the buffer
+//	Output:
+//	length of the descriptor, or -1 on error
+//
+int rawhid_get_descriptor(int num, void *buf, int len)
+{
+	hid_t *hid;
+	int r;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+
+	r = libusb_control_transfer(hid->handle,
+		LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_STANDARD | LIBUSB_RECIPIENT_INTERFACE,
+		LIBUSB_REQUEST_GET_DESCRIPTOR,
+		(LIBUSB_DT_REPORT << 8), hid->iface,
+		buf, len, 1000);
+	return (r >= 0) ? r : -1;
+}
+
+//  rawhid_async_start - keep several receive transfers in flight
+//
+//	Inputs:
+//	num = device to receive from (zero based)
+//	transfers = number of IN transfers to keep submitted
+//	len = size of each transfer (the report size)
+//	callback = called from the event thread for every packet,
+//	           or NULL to queue the packets for rawhid_async_recv()
+//	ctx = passed to the callback
+//	Output:
+//	0 on success, or -1 on error
+//
+int rawhid_async_start(int num, int transfers, int len, rawhid_callback_t callback, void *ctx)
+{
+	hid_t *hid;
+	hid_async_t *a;
+	int i;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open || hid->async) return -1;
+	if (transfers < 1 || len < 1) return -1;
+
+	a = (hid_async_t *)calloc(1, sizeof(hid_async_t));
+	if (!a) return -1;
+	a->num = num;
+	a->len = len;
+	a->callback = callback;
+	a->ctx = ctx;
+	a->ring = (uint8_t *)malloc(ASYNC_RING_SIZE * len);
+	a->transfers = (struct libusb_transfer **)calloc(transfers, sizeof(*a->transfers));
+	pthread_mutex_init(&a->lock, NULL);
+	pthread_cond_init(&a->cond, NULL);
+	hid->async = a;
+	if (!a->ring || !a->transfers) {
+		async_free(hid);
+		return -1;
+	}
+
+	// the event thread has to run before the first transfer completes
+	if (event_thread_start() < 0) {
+		async_free(hid);
+		return -1;
+	}
+
+	// pre-submit all transfers, so there is no gap between two packets
+	for (i = 0; i < transfers; i++) {
+		struct libusb_transfer *t = libusb_alloc_transfer(0);
+		uint8_t *buf = (uint8_t *)malloc(len);
+		if (!t || !buf) {
+			if (t) libusb_free_transfer(t);
+			free(buf);
+			break;
+		}
+		libusb_fill_interrupt_transfer(t, hid->handle, hid->ep_in | LIBUSB_ENDPOINT_IN,
+			buf, len, async_recv_done, hid, 0);
+		t->flags = LIBUSB_TRANSFER_FREE_BUFFER;
+		a->transfers[a->num_transfers++] = t;
+
+		pthread_mutex_lock(&a->lock);
+		if (libusb_submit_transfer(t) == 0) a->active++;
+		pthread_mutex_unlock(&a->lock);
+	}
+
+	if (!a->active) {
+		rawhid_async_stop(num);
+		return -1;
+	}
+	return 0;
+}
+
+//  rawhid_async_recv - receive a packet queued by the async engine
+//	Inputs:
+//	num = device to receive from (zero based)
+//	buf = buffer to receive packet
+//	len = buffer's size
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_async_recv(int num, void *buf, int len, int timeout)
+{
+	const void *p;
+	int n;
+
+	n = rawhid_async_peek(num, &p, timeout);
+	if (n <= 0) return n;
+	if (n > len) n = len;
+	memcpy(buf, p, n);
+	rawhid_async_release(num);
+	return n;
+}
+
+//  rawhid_async_peek - get the next queued packet without copying it
+//	Inputs:
+//	num = device to receive from (zero based)
+//	buf = set to the packet data, valid until rawhid_async_release()
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of bytes received, 0 on timeout, or -1 on error
+//
+int rawhid_async_peek(int num, const void **buf, int timeout)
+{
+	hid_t *hid;
+	hid_async_t *a;
+	unsigned int tail;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return -1;
+	a = hid->async;
+
+	tail = a->tail;
+	if (__atomic_load_n(&a->head, __ATOMIC_ACQUIRE) == tail) {
+		struct timeval now;
+		struct timespec end;
+		gettimeofday(&now, NULL);
+		end.tv_sec = now.tv_sec + timeout / 1000;
+		end.tv_nsec = now.tv_usec * 1000 + (timeout % 1000) * 1000000L;
+		if (end.tv_nsec >= 1000000000L) {
+			end.tv_sec++;
+			end.tv_nsec -= 1000000000L;
+		}
+
+		pthread_mutex_lock(&a->lock);
+		while (__atomic_load_n(&a->head, __ATOMIC_ACQUIRE) == tail && a->active) {
+			if (pthread_cond_timedwait(&a->cond, &a->lock, &end) == ETIMEDOUT) break;
+		}
+		pthread_mutex_unlock(&a->lock);
+
+		if (__atomic_load_n(&a->head, __ATOMIC_ACQUIRE) == tail) {
+			// device went offline if no transfer is left
+			return a->active ? 0 : -1;
+		}
+	}
+
+	// the event thread never writes the slot at the tail
+	*buf = a->ring + (tail % ASYNC_RING_SIZE) * a->len;
+	return a->ring_len[tail % ASYNC_RING_SIZE];
+}
+
+//  rawhid_async_release - free the packet returned by rawhid_async_peek()
+//
+void rawhid_async_release(int num)
+{
+	hid_t *hid;
+	hid_async_t *a;
+	unsigned int tail;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return;
+	a = hid->async;
+
+	tail = a->tail;
+	if (__atomic_load_n(&a->head, __ATOMIC_ACQUIRE) == tail) return;
+	__atomic_store_n(&a->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+//  rawhid_async_wait - wait until any async device received a packet
+//
+//	Inputs:
+//	timeout = time to wait, in milliseconds
+//	Output:
+//	number of the device (zero based), or -1 if none is ready
+//
+//	Each device is returned once, until it was taken from the queue.
+//	Read all its packets with rawhid_async_recv(num, buf, len, 0) afterwards.
+//
+int rawhid_async_wait(int timeout)
+{
+	struct timeval now;
+	struct timespec end;
+	hid_t *hid;
+	int num = -1;
+
+	gettimeofday(&now, NULL);
+	end.tv_sec = now.tv_sec + timeout / 1000;
+	end.tv_nsec = now.tv_usec * 1000 + (timeout % 1000) * 1000000L;
+	if (end.tv_nsec >= 1000000000L) {
+		end.tv_sec++;
+		end.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&ready_lock);
+	while (ready_head == ready_tail) {
+		if (pthread_cond_timedwait(&ready_cond, &ready_lock, &end) == ETIMEDOUT) break;
+	}
+	if (ready_head != ready_tail) {
+		num = ready_queue[ready_tail++ % MAX_DEVICES];
+	}
+	pthread_mutex_unlock(&ready_lock);
+
+	// rearm before the caller reads, so no packet gets missed
+	hid = get_hid(num);
+	if (hid) __atomic_store_n(&hid->ready_queued, 0, __ATOMIC_RELEASE);
+	return num;
+}
+
+//  rawhid_async_dropped - packets dropped because the queue was full
+//
+int rawhid_async_dropped(int num)
+{
+	hid_t *hid;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return -1;
+	return __atomic_load_n(&hid->async->dropped, __ATOMIC_RELAXED);
+}
+
+//  rawhid_async_stop - cancel all transfers of the async engine
+//
+void rawhid_async_stop(int num)
+{
+	hid_t *hid;
+	hid_async_t *a;
+	int i;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return;
+	a = hid->async;
+
+	pthread_mutex_lock(&a->lock);
+	a->stopping = 1;
+	for (i = 0; i < a->num_transfers; i++) {
+		libusb_cancel_transfer(a->transfers[i]);
+	}
+	// the event thread reports the cancelled transfers
+	while (a->active) {
+		pthread_cond_wait(&a->cond, &a->lock);
+	}
+	pthread_mutex_unlock(&a->lock);
+
+	async_free(hid);
+}
+
+//  rawhid_hotplug - watch for devices arriving and leaving
+//
+//	Inputs:
+//	enable = 1 to register the libusb hotplug callback, 0 to remove it
+//	Output:
+//	0 on success, or -1 if hotplug is not supported
+//
+//	Reconnected devices are probed again by the next rawhid_open(),
+//	devices that stayed connected are matched from the discovery cache.
+//	Devices that left are closed for rawhid_recv() and rawhid_send().
+//
+int rawhid_hotplug(int enable)
+{
+	if (!enable) {
+		if (hotplug_enabled) {
+			libusb_hotplug_deregister_callback(NULL, hotplug_handle);
+			hotplug_enabled = 0;
+		}
+		return 0;
+	}
+	if (hotplug_enabled) return 0;
+
+	libusb_init(NULL);
+	if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) return -1;
+	if (libusb_hotplug_register_callback(NULL,
+		LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+		LIBUSB_HOTPLUG_NO_FLAGS, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+		LIBUSB_HOTPLUG_MATCH_ANY, hotplug_done, NULL, &hotplug_handle) != LIBUSB_SUCCESS) {
+		return -1;
+	}
+	hotplug_enabled = 1;
+
+	// hotplug events are delivered by the event thread
+	if (event_thread_start() < 0) {
+		rawhid_hotplug(0);
+		return -1;
+	}
+	return 0;
+}
+
+//  rawhid_changed - devices arrived or left since rawhid_open()
+//
+//	Output:
+//	number of hotplug events since rawhid_open() or the last call
+//
+int rawhid_changed(void)
+{
+	return __atomic_exchange_n(&hotplug_changes, 0, __ATOMIC_RELAXED);
+}
+
 /**
  * Scans for the given vid and pid, and returns the number of devices found
  */
@@ -189,14 +601,15 @@ int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 	ssize_t cnt;
 	int i, j, k;
 	int count = 0;
-	uint8_t buf[1024];
-	int len;
-	uint32_t parsed_usage_page = 0, parsed_usage = 0;
+	uint32_t parsed_usage_page, parsed_usage;
+	int cached;
 	hid_t *hid;
 
-	if (first_hid) free_all_hid();
+	if (hid_count) free_all_hid();
+	__atomic_store_n(&hotplug_changes, 0, __ATOMIC_RELAXED);
 	printf("rawhid_open, max=%d\n", max);
 	if (max < 1) return 0;
+	if (max > MAX_DEVICES) max = MAX_DEVICES;
 
 	libusb_init(NULL);
 	cnt = libusb_get_device_list(NULL, &devs);
@@ -245,6 +658,15 @@ int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 
 				if (!ep_in) continue;
 
+				// skip known interfaces with other usages without opening them
+				cached = probe_find(dev, &desc, j, &parsed_usage_page, &parsed_usage);
+				if (cached && ((!parsed_usage_page) || (!parsed_usage) ||
+					(usage_page > 0 && parsed_usage_page != usage_page) ||
+					(usage > 0 && parsed_usage != usage))) {
+					printf("  cached, usage %X:%X\n", parsed_usage_page, parsed_usage);
+					continue;
+				}
+
 				if (libusb_open(dev, &handle) < 0) {
 					printf("  unable to open device\n");
 					continue;
@@ -268,31 +690,14 @@ int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 					continue;
 				}
 
-				// Get HID report descriptor
-				len = libusb_control_transfer(handle,
-					LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_STANDARD | LIBUSB_RECIPIENT_INTERFACE,
-					LIBUSB_REQUEST_GET_DESCRIPTOR,
-					(LIBUSB_DT_REPORT << 8), j,
-					buf, sizeof(buf), 1000);
-
-				printf("  descriptor, len=%d\n", len);
-
-				if (len < 0) {
-					libusb_release_interface(handle, j);
-					libusb_close(handle);
-					continue;
-				}
-
-				// Parse HID report descriptor
-				uint8_t *p = buf;
-				uint32_t val;
-				while (p < buf + len) {
-					int tag = hid_parse_item(&val, &p, buf + len);
-					if (tag < 0) break;
-					printf("  tag: %X, val %X\n", tag, val);
-					if (tag == 4) parsed_usage_page = val;
-					if (tag == 8) parsed_usage = val;
-					if (parsed_usage_page && parsed_usage) break;
+				// Get and parse the HID report descriptor of new interfaces
+				if (!cached) {
+					if (hid_probe_usage(handle, j, &parsed_usage_page, &parsed_usage) < 0) {
+						libusb_release_interface(handle, j);
+						libusb_close(handle);
+						continue;
+					}
+					probe_add(dev, &desc, j, parsed_usage_page, parsed_usage);
 				}
 
 				if ((!parsed_usage_page) || (!parsed_usage) ||
@@ -315,6 +720,8 @@ int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 				hid->iface = j;
 				hid->ep_in = ep_in;
 				hid->ep_out = ep_out;
+				hid->async = NULL;
+				hid->ready_queued = 0;
 				hid->open = 1;
 				add_hid(hid);
 				count++;
@@ -344,12 +751,42 @@ void rawhid_close(int num)
 	hid_close(hid);
 }
 
+// read the top level usage page and usage from the report descriptor
+static int hid_probe_usage(libusb_device_handle *handle, int iface, uint32_t *usage_page, uint32_t *usage)
+{
+	uint8_t buf[1024];
+	uint8_t *p = buf;
+	uint32_t val;
+	int len;
+
+	len = libusb_control_transfer(handle,
+		LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_STANDARD | LIBUSB_RECIPIENT_INTERFACE,
+		LIBUSB_REQUEST_GET_DESCRIPTOR,
+		(LIBUSB_DT_REPORT << 8), iface,
+		buf, sizeof(buf), 1000);
+
+	printf("  descriptor, len=%d\n", len);
+	if (len < 0) return -1;
+
+	*usage_page = *usage = 0;
+	while (p < buf + len) {
+		int tag = hid_parse_item(&val, &p, buf + len);
+		if (tag < 0) break;
+		printf("  tag: %X, val %X\n", tag, val);
+		if (tag == 4) *usage_page = val;
+		if (tag == 8) *usage = val;
+		if (*usage_page && *usage) break;
+	}
+	return 0;
+}
+
 // Chuck Robey wrote a real HID report parser
 // (chuckr@telenix.org) chuckr@chuckr.org
 // http://people.freebsd.org/~chuckr/code/python/uhidParser-0.2.tbz
 // this tiny thing only needs to extract the top-level usage page
 // and usage, and even then is may not be truly correct, but it does
 // work with the Teensy Raw HID example.
+// rawhid_desc.c parses the whole descriptor for the report decoder.
 static int hid_parse_item(uint32_t *val, uint8_t **data, const uint8_t *end)
 {
 	const uint8_t *p = *data;
@@ -360,17 +797,17 @@ static int hid_parse_item(uint32_t *val, uint8_t **data, const uint8_t *end)
 	if (p >= end) return -1;
 	if (p[0] == 0xFE) {
 		// long item, HID 1.11, 6.2.2.3, page 27
-		if (p + 5 >= end || p + p[1] >= end) return -1;
+		if (p + 3 > end || p + 3 + p[1] > end) return -1;
 		tag = p[2];
 		*val = 0;
-		len = p[1] + 5;
+		len = p[1] + 2;
 	} else {
 		// short item, HID 1.11, 6.2.2.2, page 26
 		tag = p[0] & 0xFC;
 		len = table[p[0] & 0x03];
-		if (p + len + 1 >= end) return -1;
+		if (p + len + 1 > end) return -1;
 		switch (p[0] & 0x03) {
-			case 3: *val = p[1] | (p[2] << 8) | (p[3] << 16) | (p[4] << 24); break;
+			case 3: *val = p[1] | (p[2] << 8) | (p[3] << 16) | ((uint32_t)p[4] << 24); break;
 			case 2: *val = p[1] | (p[2] << 8); break;
 			case 1: *val = p[1]; break;
 			case 0: *val = 0; break;
@@ -383,46 +820,238 @@ static int hid_parse_item(uint32_t *val, uint8_t **data, const uint8_t *end)
 
 static void add_hid(hid_t *h)
 {
-	if (!first_hid || !last_hid) {
-		first_hid = last_hid = h;
-		h->next = h->prev = NULL;
-		return;
-	}
-	last_hid->next = h;
-	h->prev = last_hid;
-	h->next = NULL;
-	last_hid = h;
+	h->num = hid_count;
+	hid_table[hid_count++] = h;
 }
 
 
 static hid_t * get_hid(int num)
 {
-	hid_t *p;
-	for (p = first_hid; p && num > 0; p = p->next, num--) ;
-	return p;
+	if (num < 0 || num >= hid_count) return NULL;
+	return hid_table[num];
 }
 
 
 static void free_all_hid(void)
 {
-    // cppcheck-suppress variableScope
-	hid_t *p, *q;
+	int i;
+
+	for (i = 0; i < hid_count; i++) {
+		hid_close(hid_table[i]);
+		free(hid_table[i]);
+		hid_table[i] = NULL;
+	}
+	hid_count = 0;
 
-	for (p = first_hid; p; p = p->next) {
-		hid_close(p);
+	// no async device is left
+	if (event_thread_running && !hotplug_enabled) {
+		event_thread_stop = 1;
+		pthread_join(event_thread, NULL);
+		event_thread_running = 0;
 	}
-	p = first_hid;
-	while (p) { 
-		q = p;
-		p = p->next;
-		free(q);
+	ready_head = ready_tail = 0;
+}
+
+static void async_free(hid_t *hid)
+{
+	hid_async_t *a = hid->async;
+	int i;
+
+	for (i = 0; i < a->num_transfers; i++) {
+		libusb_free_transfer(a->transfers[i]);
+	}
+	pthread_mutex_destroy(&a->lock);
+	pthread_cond_destroy(&a->cond);
+	free(a->transfers);
+	free(a->ring);
+	free(a);
+	hid->async = NULL;
+}
+
+static void * async_event_loop(void *arg)
+{
+	struct timeval tv;
+
+	(void)arg;
+	while (!event_thread_stop) {
+		tv.tv_sec = 0;
+		tv.tv_usec = 100000;
+		libusb_handle_events_timeout_completed(NULL, &tv, NULL);
+	}
+	return NULL;
+}
+
+
+static int event_thread_start(void)
+{
+	if (event_thread_running) return 0;
+	event_thread_stop = 0;
+	if (pthread_create(&event_thread, NULL, async_event_loop, NULL) != 0) return -1;
+	event_thread_running = 1;
+	return 0;
+}
+
+
+static void probe_key(probe_t *key, libusb_device *dev, const struct libusb_device_descriptor *desc, int iface)
+{
+	int n;
+
+	memset(key, 0, sizeof(probe_t));
+	key->bus = libusb_get_bus_number(dev);
+	n = libusb_get_port_numbers(dev, key->ports, sizeof(key->ports));
+	key->num_ports = n > 0 ? n : 0;
+	key->vid = desc->idVendor;
+	key->pid = desc->idProduct;
+	key->release = desc->bcdDevice;
+	key->iface = iface;
+}
+
+
+static int probe_match(const probe_t *a, const probe_t *b)
+{
+	return a->bus == b->bus && a->num_ports == b->num_ports &&
+		!memcmp(a->ports, b->ports, a->num_ports) &&
+		a->vid == b->vid && a->pid == b->pid &&
+		a->release == b->release && a->iface == b->iface;
+}
+
+
+static int probe_find(libusb_device *dev, const struct libusb_device_descriptor *desc, int iface,
+	uint32_t *usage_page, uint32_t *usage)
+{
+	probe_t key;
+	int i, found = 0;
+
+	probe_key(&key, dev, desc, iface);
+	pthread_mutex_lock(&probe_lock);
+	for (i = 0; i < probe_count; i++) {
+		if (probe_match(&probe_cache[i], &key)) {
+			*usage_page = probe_cache[i].usage_page;
+			*usage = probe_cache[i].usage;
+			found = 1;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&probe_lock);
+	return found;
+}
+
+
+static void probe_add(libusb_device *dev, const struct libusb_device_descriptor *desc, int iface,
+	uint32_t usage_page, uint32_t usage)
+{
+	probe_t key;
+	int i;
+
+	probe_key(&key, dev, desc, iface);
+	key.usage_page = usage_page;
+	key.usage = usage;
+	pthread_mutex_lock(&probe_lock);
+	for (i = 0; i < probe_count; i++) {
+		if (probe_match(&probe_cache[i], &key)) break;
+	}
+	if (i == probe_count) {
+		if (probe_count < MAX_PROBES) {
+			probe_count++;
+		} else {
+			i = probe_next;
+			probe_next = (probe_next + 1) % MAX_PROBES;
+		}
+	}
+	probe_cache[i] = key;
+	pthread_mutex_unlock(&probe_lock);
+}
+
+
+// drop all interfaces of the device on this port
+static void probe_forget(libusb_device *dev)
+{
+	uint8_t ports[7];
+	uint8_t bus;
+	int n, i;
+
+	bus = libusb_get_bus_number(dev);
+	n = libusb_get_port_numbers(dev, ports, sizeof(ports));
+	if (n < 0) n = 0;
+	pthread_mutex_lock(&probe_lock);
+	for (i = 0; i < probe_count; ) {
+		probe_t *c = &probe_cache[i];
+		if (c->bus == bus && c->num_ports == n && !memcmp(c->ports, ports, n)) {
+			*c = probe_cache[--probe_count];
+			probe_next = 0;
+		} else {
+			i++;
+		}
+	}
+	pthread_mutex_unlock(&probe_lock);
+}
+
+
+static int LIBUSB_CALL hotplug_done(libusb_context *ctx, libusb_device *dev,
+	libusb_hotplug_event event, void *user_data)
+{
+	int i;
+
+	(void)ctx;
+	(void)user_data;
+	probe_forget(dev);
+	if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT) {
+		for (i = 0; i < hid_count; i++) {
+			hid_t *hid = hid_table[i];
+			if (hid->handle && libusb_get_device(hid->handle) == dev) {
+				__atomic_store_n(&hid->open, 0, __ATOMIC_RELAXED);
+			}
+		}
+	}
+	__atomic_add_fetch(&hotplug_changes, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+static void LIBUSB_CALL async_recv_done(struct libusb_transfer *transfer)
+{
+	hid_t *hid = (hid_t *)transfer->user_data;
+	hid_async_t *a = hid->async;
+	unsigned int head;
+
+	if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+		if (a->callback) {
+			a->callback(a->num, transfer->buffer, transfer->actual_length, a->ctx);
+		} else {
+			head = a->head;
+			if (head - __atomic_load_n(&a->tail, __ATOMIC_ACQUIRE) < ASYNC_RING_SIZE) {
+				memcpy(a->ring + (head % ASYNC_RING_SIZE) * a->len,
+					transfer->buffer, transfer->actual_length);
+				a->ring_len[head % ASYNC_RING_SIZE] = transfer->actual_length;
+				__atomic_store_n(&a->head, head + 1, __ATOMIC_RELEASE);
+
+				// let rawhid_async_wait() know, once per device until it was taken
+				if (!__atomic_exchange_n(&hid->ready_queued, 1, __ATOMIC_ACQ_REL)) {
+					pthread_mutex_lock(&ready_lock);
+					ready_queue[ready_head++ % MAX_DEVICES] = hid->num;
+					pthread_cond_signal(&ready_cond);
+					pthread_mutex_unlock(&ready_lock);
+				}
+			} else {
+				__atomic_add_fetch(&a->dropped, 1, __ATOMIC_RELAXED);
+			}
+		}
+	}
+
+	pthread_mutex_lock(&a->lock);
+	// resubmit right away, unless stopped or the device is gone
+	if (a->stopping || transfer->status == LIBUSB_TRANSFER_CANCELLED ||
+		transfer->status == LIBUSB_TRANSFER_NO_DEVICE ||
+		libusb_submit_transfer(transfer) < 0) {
+		a->active--;
 	}
-	first_hid = last_hid = NULL;
+	pthread_cond_broadcast(&a->cond);
+	pthread_mutex_unlock(&a->lock);
 }
 
 static void hid_close(hid_t *hid)
 {
 	if (!hid->handle) return;
+	if (hid->async) rawhid_async_stop(hid->num);
 	
 	libusb_release_interface(hid->handle, hid->iface);
 	libusb_close(hid->handle);
@@ -32,6 +32,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
 #include <IOKit/IOKitLib.h>
 #include <IOKit/hid/IOHIDLib.h>
 
@@ -39,38 +42,53 @@
 
 #define BUFFER_SIZE 64
 
+// number of received packets buffered per device (power of two)
+#define RING_SIZE 64
+
 #define printf(...) // comment this out to get lots of info printed
 
 
 // a list of all opened HID devices, so the caller can
 // simply refer to them by number
 typedef struct hid_struct hid_t;
-typedef struct buffer_struct buffer_t;
 static hid_t *first_hid = NULL;
 static hid_t *last_hid = NULL;
 struct hid_struct {
 	IOHIDDeviceRef ref;
 	int open;
+	int closing;
 	uint8_t buffer[BUFFER_SIZE];
-	buffer_t *first_buffer;
-	buffer_t *last_buffer;
+	// single producer (run loop thread) single consumer (caller) ring
+	uint8_t ring[RING_SIZE][BUFFER_SIZE];
+	uint32_t ring_len[RING_SIZE];
+	unsigned int head;
+	unsigned int tail;
+	unsigned int dropped;
 	struct hid_struct *prev;
 	struct hid_struct *next;
 };
-struct buffer_struct {
-	struct buffer_struct *next;
-	uint32_t len;
-	uint8_t buf[BUFFER_SIZE];
-};
+
+// all device callbacks run on one thread with its own run loop, so
+// reports are received while the caller is busy. The lock protects the
+// device list, the cond is signalled for every received report.
+static pthread_t run_loop_thread;
+static CFRunLoopRef run_loop = NULL;
+static CFRunLoopSourceRef close_source = NULL;
+static IOHIDManagerRef hid_manager = NULL;
+static volatile int run_loop_stop = 0;
+static int run_loop_ready = 0;
+static pthread_mutex_t hid_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t hid_cond = PTHREAD_COND_INITIALIZER;
 
 // private functions, not intended to be used from outside this file
 static void add_hid(hid_t *);
 static hid_t * get_hid(int);
 static void free_all_hid(void);
 static void hid_close(hid_t *);
+static void * run_loop_main(void *);
+static void close_perform(void *);
 static void attach_callback(void *, IOReturn, void *, IOHIDDeviceRef);
 static void detach_callback(void *, IOReturn, void *hid_mgr, IOHIDDeviceRef dev);
-static void timeout_callback(CFRunLoopTimerRef, void *);
 static void input_callback(void *, IOReturn, void *, IOHIDReportType,
 	 uint32_t, uint8_t *, CFIndex);
 
@@ -88,78 +106,77 @@ static void input_callback(void *, IOReturn, void *, IOHIDReportType,
 int rawhid_recv(int num, void *buf, int len, int timeout)
 {
 	hid_t *hid;
-	buffer_t *b;
-	CFRunLoopTimerRef timer=NULL;
-	CFRunLoopTimerContext context;
-	int ret=0, timeout_occurred=0;
+	struct timeval now;
+	struct timespec end;
+	unsigned int tail;
+	int ret=0;
 
 	if (len < 1) return 0;
 	hid = get_hid(num);
 	if (!hid || !hid->open) return -1;
-	if ((b = hid->first_buffer) != NULL) {
-		if (len > b->len) len = b->len;
-		memcpy(buf, b->buf, len);
-		hid->first_buffer = b->next;
-		free(b);
-		return len;
-	}
-	memset(&context, 0, sizeof(context));
-	context.info = &timeout_occurred;
-	timer = CFRunLoopTimerCreate(NULL, CFAbsoluteTimeGetCurrent() +
-		(double)timeout / 1000.0, 0, 0, 0, timeout_callback, &context);
-	CFRunLoopAddTimer(CFRunLoopGetCurrent(), timer, kCFRunLoopDefaultMode);
-	while (1) {
-		CFRunLoopRun();
-		if ((b = hid->first_buffer) != NULL) {
-			if (len > b->len) len = b->len;
-			memcpy(buf, b->buf, len);
-			hid->first_buffer = b->next;
-			free(b);
-			ret = len;
-			break;
+	tail = hid->tail;
+	if (__atomic_load_n(&hid->head, __ATOMIC_ACQUIRE) == tail) {
+		gettimeofday(&now, NULL);
+		end.tv_sec = now.tv_sec + timeout / 1000;
+		end.tv_nsec = now.tv_usec * 1000 + (timeout % 1000) * 1000000L;
+		if (end.tv_nsec >= 1000000000L) {
+			end.tv_sec++;
+			end.tv_nsec -= 1000000000L;
 		}
-		if (!hid->open) {
-			printf("rawhid_recv, device not open\n");
-			ret = -1;
-			break;
+		pthread_mutex_lock(&hid_lock);
+		while (__atomic_load_n(&hid->head, __ATOMIC_ACQUIRE) == tail && hid->open) {
+			if (pthread_cond_timedwait(&hid_cond, &hid_lock, &end) == ETIMEDOUT) break;
+		}
+		pthread_mutex_unlock(&hid_lock);
+		if (__atomic_load_n(&hid->head, __ATOMIC_ACQUIRE) == tail) {
+			if (!hid->open) {
+				printf("rawhid_recv, device not open\n");
+				ret = -1;
+			}
+			return ret;
 		}
-		if (timeout_occurred) break;
 	}
-	CFRunLoopTimerInvalidate(timer);
-	CFRelease(timer);
-	return ret;
+	if (len > hid->ring_len[tail % RING_SIZE]) len = hid->ring_len[tail % RING_SIZE];
+	memcpy(buf, hid->ring[tail % RING_SIZE], len);
+	__atomic_store_n(&hid->tail, tail + 1, __ATOMIC_RELEASE);
+	return len;
 }
 
 static void input_callback(void *context, IOReturn ret, void *sender,
 	IOHIDReportType type, uint32_t id, uint8_t *data, CFIndex len)
 {
-	buffer_t *n;
 	hid_t *hid;
+	unsigned int head;
 
 	printf("input_callback\n");
 	if (ret != kIOReturnSuccess || len < 1) return;
 	hid = context;
 	if (!hid || hid->ref != sender) return;
-	n = (buffer_t *)malloc(sizeof(buffer_t));
-	if (!n) return;
-	if (len > BUFFER_SIZE) len = BUFFER_SIZE;
-	memcpy(n->buf, data, len);
-	n->len = len;
-	n->next = NULL;
-	if (!hid->first_buffer || !hid->last_buffer) {
-		hid->first_buffer = hid->last_buffer = n;
-	} else {
-		hid->last_buffer->next = n;
-		hid->last_buffer = n;
+	head = hid->head;
+	if (head - __atomic_load_n(&hid->tail, __ATOMIC_ACQUIRE) >= RING_SIZE) {
+		// the caller does not keep up, drop the newest report
+		__atomic_add_fetch(&hid->dropped, 1, __ATOMIC_RELAXED);
+		return;
 	}
-	CFRunLoopStop(CFRunLoopGetCurrent());
+	if (len > BUFFER_SIZE) len = BUFFER_SIZE;
+	memcpy(hid->ring[head % RING_SIZE], data, len);
+	hid->ring_len[head % RING_SIZE] = len;
+	__atomic_store_n(&hid->head, head + 1, __ATOMIC_RELEASE);
+
+	pthread_mutex_lock(&hid_lock);
+	pthread_cond_broadcast(&hid_cond);
+	pthread_mutex_unlock(&hid_lock);
 }
 
-static void timeout_callback(CFRunLoopTimerRef timer, void *info)
+//  rawhid_async_dropped - reports lost because the receive ring was full
+//
+int rawhid_async_dropped(int num)
 {
-	printf("timeout_callback\n");
-	*(int *)info = 1;
-	CFRunLoopStop(CFRunLoopGetCurrent());
+	hid_t *hid;
+
+	hid = get_hid(num);
+	if (!hid) return -1;
+	return __atomic_load_n(&hid->dropped, __ATOMIC_RELAXED);
 }
 
 
@@ -229,6 +246,56 @@ int rawhid_send(int num, void *buf, int len, int timeout)
 }
 
 
+//  rawhid_get_feature - read a feature report with GET_REPORT
+//    Inputs:
+//	num = device to read from (zero based)
+//	id = report ID, 0 if the device does not use report IDs
+//	buf = buffer to store the report, starting with the ID if not 0
+//	len = size of the buffer
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_get_feature(int num, int id, void *buf, int len, int timeout)
+{
+	hid_t *hid;
+	CFIndex n = len;
+	IOReturn ret;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	// the synchronous call waits for the control transfer
+	(void)timeout;
+	ret = IOHIDDeviceGetReport(hid->ref, kIOHIDReportTypeFeature, id, buf, &n);
+	return (ret == kIOReturnSuccess) ? (int)n : -1;
+}
+
+
+//  rawhid_get_descriptor - read the report descriptor
+//    Inputs:
+//	num = device (zero based)
+//	buf = buffer to store the descriptor
+//	len = size of the buffer
+//    Output:
+//	length of the descriptor, or -1 on error
+//
+int rawhid_get_descriptor(int num, void *buf, int len)
+{
+	hid_t *hid;
+	CFTypeRef data;
+	CFIndex size;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	data = IOHIDDeviceGetProperty(hid->ref, CFSTR(kIOHIDReportDescriptorKey));
+	if (!data || CFGetTypeID(data) != CFDataGetTypeID()) return -1;
+	size = CFDataGetLength((CFDataRef)data);
+	if (size > len) return -1;
+	CFDataGetBytes((CFDataRef)data, CFRangeMake(0, size), buf);
+	return (int)size;
+}
+
+
 //  rawhid_open - open 1 or more devices
 //
 //    Inputs:
@@ -242,14 +309,13 @@ int rawhid_send(int num, void *buf, int len, int timeout)
 //
 int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 {
-        static IOHIDManagerRef hid_manager=NULL;
         CFMutableDictionaryRef dict;
         CFNumberRef num;
         IOReturn ret;
 	hid_t *p;
 	int count=0;
 
-	if (first_hid) free_all_hid();
+	if (first_hid || run_loop) free_all_hid();
 	printf("rawhid_open, max=%d\n", max);
 	if (max < 1) return 0;
         // Start the HID Manager
@@ -292,22 +358,29 @@ int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
         	IOHIDManagerSetDeviceMatching(hid_manager, NULL);
 	}
 	// set up a callbacks for device attach & detach
-        IOHIDManagerScheduleWithRunLoop(hid_manager, CFRunLoopGetCurrent(),
-		kCFRunLoopDefaultMode);
         IOHIDManagerRegisterDeviceMatchingCallback(hid_manager, attach_callback, NULL);
 	IOHIDManagerRegisterDeviceRemovalCallback(hid_manager, detach_callback, NULL);
         ret = IOHIDManagerOpen(hid_manager, kIOHIDOptionsTypeNone);
         if (ret != kIOReturnSuccess) {
-                IOHIDManagerUnscheduleFromRunLoop(hid_manager,
-                        CFRunLoopGetCurrent(), kCFRunLoopDefaultMode);
                 CFRelease(hid_manager);
+                hid_manager = NULL;
                 return 0;
         }
 	printf("run loop\n");
-	// let it do the callback for all devices
-	while (CFRunLoopRunInMode(kCFRunLoopDefaultMode, 0, true) == kCFRunLoopRunHandledSource) ;
+	// the run loop thread does the callback for all devices, then keeps running
+	run_loop_stop = 0;
+	run_loop_ready = 0;
+	if (pthread_create(&run_loop_thread, NULL, run_loop_main, NULL) != 0) {
+		IOHIDManagerClose(hid_manager, kIOHIDOptionsTypeNone);
+		CFRelease(hid_manager);
+		hid_manager = NULL;
+		return 0;
+	}
+	pthread_mutex_lock(&hid_lock);
+	while (!run_loop_ready) pthread_cond_wait(&hid_cond, &hid_lock);
 	// count up how many were added by the callback
-	for (p = first_hid; p; p = p->next) count++;
+	for (p = first_hid; p && count < max; p = p->next) count++;
+	pthread_mutex_unlock(&hid_lock);
 	return count;
 }
 
@@ -325,29 +398,40 @@ void rawhid_close(int num)
 
 	hid = get_hid(num);
 	if (!hid || !hid->open) return;
-	hid_close(hid);
-	hid->open = 0;
+
+	// devices are scheduled on the run loop thread, so close it there
+	pthread_mutex_lock(&hid_lock);
+	hid->closing = 1;
+	CFRunLoopSourceSignal(close_source);
+	CFRunLoopWakeUp(run_loop);
+	while (hid->ref) pthread_cond_wait(&hid_cond, &hid_lock);
+	pthread_mutex_unlock(&hid_lock);
 }
 
 
 static void add_hid(hid_t *h)
 {
+	pthread_mutex_lock(&hid_lock);
 	if (!first_hid || !last_hid) {
 		first_hid = last_hid = h;
 		h->next = h->prev = NULL;
-		return;
+	} else {
+		last_hid->next = h;
+		h->prev = last_hid;
+		h->next = NULL;
+		last_hid = h;
 	}
-	last_hid->next = h;
-	h->prev = last_hid;
-	h->next = NULL;
-	last_hid = h;
+	pthread_mutex_unlock(&hid_lock);
 }
 
 
 static hid_t * get_hid(int num)
 {
 	hid_t *p;
+
+	pthread_mutex_lock(&hid_lock);
 	for (p = first_hid; p && num > 0; p = p->next, num--) ;
+	pthread_mutex_unlock(&hid_lock);
 	return p;
 }
 
@@ -356,9 +440,29 @@ static void free_all_hid(void)
 {
 	hid_t *p, *q;
 
+	// stop the run loop thread first, nothing is called back after this
+	if (run_loop) {
+		run_loop_stop = 1;
+		CFRunLoopStop(run_loop);
+		CFRunLoopWakeUp(run_loop);
+		pthread_join(run_loop_thread, NULL);
+	}
 	for (p = first_hid; p; p = p->next) {
 		hid_close(p);
 	}
+	if (hid_manager) {
+		IOHIDManagerUnscheduleFromRunLoop(hid_manager, run_loop, kCFRunLoopDefaultMode);
+		IOHIDManagerClose(hid_manager, kIOHIDOptionsTypeNone);
+		CFRelease(hid_manager);
+		hid_manager = NULL;
+	}
+	if (run_loop) {
+		CFRunLoopRemoveSource(run_loop, close_source, kCFRunLoopDefaultMode);
+		CFRelease(close_source);
+		CFRelease(run_loop);
+		close_source = NULL;
+		run_loop = NULL;
+	}
 	p = first_hid;
 	while (p) {
 		q = p;
@@ -371,10 +475,51 @@ static void free_all_hid(void)
 
 static void hid_close(hid_t *hid)
 {
-	if (!hid || !hid->open || !hid->ref) return;
-	IOHIDDeviceUnscheduleFromRunLoop(hid->ref, CFRunLoopGetCurrent( ), kCFRunLoopDefaultMode);
+	if (!hid || !hid->ref) return;
+	IOHIDDeviceUnscheduleFromRunLoop(hid->ref, run_loop, kCFRunLoopDefaultMode);
 	IOHIDDeviceClose(hid->ref, kIOHIDOptionsTypeNone);
 	hid->ref = NULL;
+	hid->open = 0;
+}
+
+// runs on the run loop thread when rawhid_close() signalled the close source
+static void close_perform(void *info)
+{
+	hid_t *p;
+
+	pthread_mutex_lock(&hid_lock);
+	for (p = first_hid; p; p = p->next) {
+		if (p->closing) {
+			hid_close(p);
+			p->closing = 0;
+		}
+	}
+	pthread_cond_broadcast(&hid_cond);
+	pthread_mutex_unlock(&hid_lock);
+}
+
+static void * run_loop_main(void *arg)
+{
+	CFRunLoopSourceContext context;
+
+	run_loop = (CFRunLoopRef)CFRetain(CFRunLoopGetCurrent());
+	// the source also keeps the run loop from returning when no device is attached
+	memset(&context, 0, sizeof(context));
+	context.perform = close_perform;
+	close_source = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &context);
+	CFRunLoopAddSource(run_loop, close_source, kCFRunLoopDefaultMode);
+	IOHIDManagerScheduleWithRunLoop(hid_manager, run_loop, kCFRunLoopDefaultMode);
+
+	// let it do the callback for all devices
+	while (CFRunLoopRunInMode(kCFRunLoopDefaultMode, 0, true) == kCFRunLoopRunHandledSource) ;
+	pthread_mutex_lock(&hid_lock);
+	run_loop_ready = 1;
+	pthread_cond_broadcast(&hid_cond);
+	pthread_mutex_unlock(&hid_lock);
+
+	// CFRunLoopStop() ends a run early, the interval only bounds a missed stop
+	while (!run_loop_stop) CFRunLoopRunInMode(kCFRunLoopDefaultMode, 1.0, false);
+	return NULL;
 }
 
 static void detach_callback(void *context, IOReturn r, void *hid_mgr, IOHIDDeviceRef dev)
@@ -384,8 +529,10 @@ static void detach_callback(void *context, IOReturn r, void *hid_mgr, IOHIDDevic
 	printf("detach callback\n");
 	for (p = first_hid; p; p = p->next) {
 		if (p->ref == dev) {
+			pthread_mutex_lock(&hid_lock);
 			p->open = 0;
-			CFRunLoopStop(CFRunLoopGetCurrent());
+			pthread_cond_broadcast(&hid_cond);
+			pthread_mutex_unlock(&hid_lock);
 			return;
 		}
 	}
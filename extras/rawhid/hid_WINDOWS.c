@@ -6,6 +6,7 @@
  *  rawhid_recv - receive a packet
  *  rawhid_send - send a packet
  *  rawhid_close - close a device
+ *  rawhid_async_start - keep several overlapped reads pending
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -39,6 +40,21 @@
 #include "hid.h"
 
 
+// number of input reports the HID driver buffers per device (default 32, max 512)
+#define ASYNC_INPUT_BUFFERS 256
+
+// pending overlapped reads of a device, see rawhid_async_start().
+// HID reads complete in the order they were posted, so the oldest
+// read (at the tail) always holds the next report.
+typedef struct hid_async_struct {
+	int num_reads;
+	int len;		// report size plus the report ID byte
+	unsigned char *bufs;
+	OVERLAPPED *ov;
+	unsigned int tail;
+	int peeked;		// the read at the tail was handed out
+} hid_async_t;
+
 // a list of all opened HID devices, so the caller can
 // simply refer to them by number
 typedef struct hid_struct hid_t;
@@ -47,6 +63,7 @@ static hid_t *last_hid = NULL;
 struct hid_struct {
 	HANDLE handle;
 	int open;
+	hid_async_t *async;
 	struct hid_struct *prev;
 	struct hid_struct *next;
 };
@@ -61,6 +78,8 @@ static void add_hid(hid_t *h);
 static hid_t * get_hid(int num);
 static void free_all_hid(void);
 static void hid_close(hid_t *hid);
+static int async_post(hid_t *hid, int i);
+static void async_free(hid_async_t *a);
 void print_win32_err(void);
 
 
@@ -157,6 +176,54 @@ return_error:
 	return -1;
 }
 
+//  rawhid_get_feature - read a feature report with GET_REPORT
+//    Inputs:
+//	num = device to read from (zero based)
+//	id = report ID, 0 if the device does not use report IDs
+//	buf = buffer to store the report, starting with the ID if not 0
+//	len = size of the buffer
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_get_feature(int num, int id, void *buf, int len, int timeout)
+{
+	hid_t *hid;
+	unsigned char tmpbuf[516];
+
+	if (sizeof(tmpbuf) < len + 1) return -1;
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	// hid.dll only reads reports declared in the report descriptor
+	(void)timeout;
+	memset(tmpbuf, 0, len + 1);
+	tmpbuf[0] = id;
+	if (!HidD_GetFeature(hid->handle, tmpbuf, len + 1)) {
+		print_win32_err();
+		return -1;
+	}
+	if (!id) {
+		memcpy(buf, tmpbuf + 1, len);
+	} else {
+		memcpy(buf, tmpbuf, len);
+	}
+	return len;
+}
+
+//  rawhid_get_descriptor - read the report descriptor
+//    Inputs:
+//	num = device (zero based)
+//	buf = buffer to store the descriptor
+//	len = size of the buffer
+//    Output:
+//	length of the descriptor, or -1 on error
+//
+int rawhid_get_descriptor(int num, void *buf, int len)
+{
+	// hid.dll only returns the preparsed data, not the descriptor
+	return -1;
+}
+
 //  rawhid_open - open 1 or more devices
 //
 //    Inputs:
@@ -239,6 +306,7 @@ int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 		}
 		hid->handle = h;
 		hid->open = 1;
+		hid->async = NULL;
 		add_hid(hid);
 		count++;
 		if (count >= max) return count;
@@ -247,6 +315,200 @@ int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 }
 
 
+//  rawhid_async_start - keep several overlapped reads pending
+//
+//    Inputs:
+//	num = device to receive from (zero based)
+//	transfers = number of reads to keep pending
+//	len = size of each read (the report size)
+//	callback = must be NULL, packets are queued for rawhid_async_recv()
+//	ctx = unused
+//    Output:
+//	0 on success, or -1 on error
+//
+//	The reads are posted and collected by the calling thread,
+//	use all rawhid_async functions of a device from the same thread.
+//
+int rawhid_async_start(int num, int transfers, int len, rawhid_callback_t callback, void *ctx)
+{
+	hid_t *hid;
+	hid_async_t *a;
+	int i;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open || hid->async) return -1;
+	if (transfers < 1 || len < 1 || callback) return -1;
+
+	// let the driver hold more reports while no read is pending
+	HidD_SetNumInputBuffers(hid->handle, ASYNC_INPUT_BUFFERS);
+
+	a = (hid_async_t *)calloc(1, sizeof(hid_async_t));
+	if (!a) return -1;
+	a->len = len + 1;
+	a->bufs = (unsigned char *)malloc(transfers * a->len);
+	a->ov = (OVERLAPPED *)calloc(transfers, sizeof(OVERLAPPED));
+	if (!a->bufs || !a->ov) {
+		async_free(a);
+		return -1;
+	}
+	for (i = 0; i < transfers; i++) {
+		a->ov[i].hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		if (!a->ov[i].hEvent) break;
+		a->num_reads++;
+	}
+	hid->async = a;
+
+	// post all reads, so there is no gap between two reports
+	for (i = 0; i < a->num_reads; i++) {
+		if (async_post(hid, i) < 0) {
+			rawhid_async_stop(num);
+			return -1;
+		}
+	}
+	if (!a->num_reads) {
+		rawhid_async_stop(num);
+		return -1;
+	}
+	return 0;
+}
+
+//  rawhid_async_recv - receive a packet from the pending reads
+//    Inputs:
+//	num = device to receive from (zero based)
+//	buf = buffer to receive packet
+//	len = buffer's size
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	number of bytes received, or -1 on error
+//
+int rawhid_async_recv(int num, void *buf, int len, int timeout)
+{
+	const void *p;
+	int n;
+
+	n = rawhid_async_peek(num, &p, timeout);
+	if (n <= 0) return n;
+	if (n > len) n = len;
+	memcpy(buf, p, n);
+	rawhid_async_release(num);
+	return n;
+}
+
+//  rawhid_async_peek - get the next packet without copying it
+//    Inputs:
+//	num = device to receive from (zero based)
+//	buf = set to the packet data, valid until rawhid_async_release()
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	number of bytes received, 0 on timeout, or -1 on error
+//
+int rawhid_async_peek(int num, const void **buf, int timeout)
+{
+	hid_t *hid;
+	hid_async_t *a;
+	DWORD n, r;
+	int i;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return -1;
+	a = hid->async;
+
+	i = a->tail % a->num_reads;
+	if (!a->peeked) {
+		r = WaitForSingleObject(a->ov[i].hEvent, timeout);
+		if (r == WAIT_TIMEOUT) return 0;
+		if (r != WAIT_OBJECT_0) goto return_error;
+		a->peeked = 1;
+	}
+	if (!GetOverlappedResult(hid->handle, &a->ov[i], &n, FALSE)) goto return_error;
+	if (n <= 0) return -1;
+
+	// skip the report ID
+	*buf = a->bufs + i * a->len + 1;
+	return n - 1;
+return_error:
+	print_win32_err();
+	return -1;
+}
+
+//  rawhid_async_release - post the read of the packet from rawhid_async_peek() again
+//
+void rawhid_async_release(int num)
+{
+	hid_t *hid;
+	hid_async_t *a;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async || !hid->async->peeked) return;
+	a = hid->async;
+
+	async_post(hid, a->tail % a->num_reads);
+	a->peeked = 0;
+	a->tail++;
+}
+
+//  rawhid_async_wait - wait until any async device received a packet
+//
+//    Inputs:
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	number of the device (zero based), or -1 if none is ready
+//
+int rawhid_async_wait(int timeout)
+{
+	HANDLE events[MAXIMUM_WAIT_OBJECTS];
+	int nums[MAXIMUM_WAIT_OBJECTS];
+	hid_t *p;
+	DWORD r;
+	int num, count = 0;
+
+	for (p = first_hid, num = 0; p && count < MAXIMUM_WAIT_OBJECTS; p = p->next, num++) {
+		if (!p->async) continue;
+		if (p->async->peeked) return num;
+		events[count] = p->async->ov[p->async->tail % p->async->num_reads].hEvent;
+		nums[count++] = num;
+	}
+	if (!count) return -1;
+
+	r = WaitForMultipleObjects(count, events, FALSE, timeout);
+	if (r >= WAIT_OBJECT_0 + count) return -1;
+	return nums[r - WAIT_OBJECT_0];
+}
+
+//  rawhid_async_dropped - reports lost by the HID driver are not counted on Windows
+//
+int rawhid_async_dropped(int num)
+{
+	hid_t *hid;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return -1;
+	return 0;
+}
+
+//  rawhid_async_stop - cancel all pending reads
+//
+void rawhid_async_stop(int num)
+{
+	hid_t *hid;
+	hid_async_t *a;
+	DWORD n;
+	int i;
+
+	hid = get_hid(num);
+	if (!hid || !hid->async) return;
+	a = hid->async;
+
+	// CancelIo() only cancels the reads posted by this thread
+	CancelIo(hid->handle);
+	for (i = 0; i < a->num_reads; i++) {
+		GetOverlappedResult(hid->handle, &a->ov[i], &n, TRUE);
+	}
+	hid->async = NULL;
+	async_free(a);
+}
+
+
 //  rawhid_close - close a device
 //
 //    Inputs:
@@ -304,8 +566,42 @@ static void free_all_hid(void)
 }
 
 
+static int async_post(hid_t *hid, int i)
+{
+	hid_async_t *a = hid->async;
+	HANDLE event = a->ov[i].hEvent;
+
+	memset(&a->ov[i], 0, sizeof(OVERLAPPED));
+	a->ov[i].hEvent = event;
+	ResetEvent(event);
+	if (!ReadFile(hid->handle, a->bufs + i * a->len, a->len, NULL, &a->ov[i])) {
+		if (GetLastError() != ERROR_IO_PENDING) return -1;
+	}
+	return 0;
+}
+
+
+static void async_free(hid_async_t *a)
+{
+	int i;
+
+	for (i = 0; i < a->num_reads; i++) {
+		CloseHandle(a->ov[i].hEvent);
+	}
+	free(a->ov);
+	free(a->bufs);
+	free(a);
+}
+
+
 static void hid_close(hid_t *hid)
 {
+	if (hid->async) {
+		hid_t *p;
+		int num = 0;
+		for (p = first_hid; p && p != hid; p = p->next) num++;
+		rawhid_async_stop(num);
+	}
 	CloseHandle(hid->handle);
 	hid->handle = NULL;
 }
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <termios.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+
+// Host side of the input latency benchmark (Linux only), run it against the
+// examples/InputLatency sketch.
+//
+//	input_latency [-n count] [-l] [-v vid] [serial port]
+//
+// Every trigger is written to the Serial port of the sketch. The latency is
+// the difference between the kernel timestamp of the input event (evdev,
+// CLOCK_MONOTONIC) and the time before the trigger was written. That includes
+// the Serial OUT transfer, its share is estimated by half of the ping RTT.
+// -l keeps the multi report endpoint busy with Gamepad reports.
+
+#define MAX_INPUTS 16
+
+typedef struct {
+	char cmd;
+	const char *name;
+	int type;	// expected event type
+} bench_t;
+
+static const bench_t benches[] = {
+	{ 'b', "BootKeyboard (single)", EV_KEY },
+	{ 'k', "Keyboard (multi)", EV_KEY },
+	{ 'n', "NKROKeyboard (multi)", EV_KEY },
+	{ 'm', "Mouse (multi)", EV_REL },
+	{ 'g', "Gamepad (multi)", EV_KEY },
+	{ 'G', "Gamepad1 (single)", EV_KEY },
+};
+
+static int inputs[MAX_INPUTS];
+static int num_inputs = 0;
+
+
+static double now_us(void);
+static int open_serial(const char *port);
+static int open_inputs(int vid);
+static void drain(int serial, int ms);
+static double wait_event(int type, double start, int timeout);
+static int compare_double(const void *a, const void *b);
+static void print_stats(const char *name, double *us, int done, int lost);
+
+
+int main(int argc, char **argv)
+{
+	const char *port = "/dev/ttyACM0";
+	int count = 200, vid = 0x2341, load = 0;
+	int serial, i, b, done, lost;
+	double *us, start, end;
+	char c;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) count = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-v") && i + 1 < argc) vid = strtol(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-l")) load = 1;
+		else if (argv[i][0] != '-') port = argv[i];
+		else break;
+	}
+	if (i < argc || count < 1) {
+		printf("usage: %s [-n count] [-l] [-v vid] [serial port]\n", argv[0]);
+		return -1;
+	}
+
+	serial = open_serial(port);
+	if (serial < 0) {
+		printf("unable to open %s\n", port);
+		return -1;
+	}
+	if (open_inputs(vid) <= 0) {
+		printf("no input device with vid %04X found (needs read access to /dev/input)\n", vid);
+		return -1;
+	}
+	us = (double *)malloc(count * sizeof(double));
+	if (!us) return -1;
+	drain(serial, 100);
+
+	// the Serial trigger itself takes part of every measurement
+	for (i = 0, done = 0, lost = 0; i < count; i++) {
+		struct pollfd pfd = { serial, POLLIN, 0 };
+		start = now_us();
+		if (write(serial, "p", 1) != 1) break;
+		if (poll(&pfd, 1, 100) > 0 && read(serial, &c, 1) == 1 && c == 'p') {
+			end = now_us();
+			us[done++] = end - start;
+		} else {
+			lost++;
+		}
+	}
+	print_stats("Serial ping RTT", us, done, lost);
+
+	if (load) {
+		if (write(serial, "l", 1) != 1) return -1;
+		printf("load enabled\n");
+	}
+	for (b = 0; b < (int)(sizeof(benches) / sizeof(benches[0])); b++) {
+		for (i = 0, done = 0, lost = 0; i < count; i++) {
+			double t;
+			drain(serial, 5);
+			start = now_us();
+			if (write(serial, &benches[b].cmd, 1) != 1) break;
+			t = wait_event(benches[b].type, start, 100);
+			if (t < 0) {
+				lost++;
+				// the module is not part of the sketch
+				if (!done && lost >= 3) break;
+			} else {
+				us[done++] = t;
+			}
+		}
+		print_stats(benches[b].name, us, done, lost);
+	}
+	if (load && write(serial, "l", 1) != 1) return -1;
+
+	free(us);
+	close(serial);
+	for (i = 0; i < num_inputs; i++) close(inputs[i]);
+	return 0;
+}
+
+// latency of the next event of this type, or -1 on timeout
+static double wait_event(int type, double start, int timeout)
+{
+	struct pollfd pfd[MAX_INPUTS];
+	struct input_event ev;
+	int i;
+
+	for (i = 0; i < num_inputs; i++) {
+		pfd[i].fd = inputs[i];
+		pfd[i].events = POLLIN;
+	}
+	while (now_us() - start < timeout * 1000.0) {
+		if (poll(pfd, num_inputs, timeout) <= 0) return -1;
+		for (i = 0; i < num_inputs; i++) {
+			if (!(pfd[i].revents & POLLIN)) continue;
+			while (read(inputs[i], &ev, sizeof(ev)) == sizeof(ev)) {
+				if (ev.type != type) continue;
+				if (type == EV_KEY && ev.value != 1) continue;
+				return ev.input_event_sec * 1000000.0 + ev.input_event_usec - start;
+			}
+		}
+	}
+	return -1;
+}
+
+// skip the release events and Serial replies of the last trigger
+static void drain(int serial, int ms)
+{
+	struct input_event ev;
+	char buf[64];
+	int i;
+
+	usleep(ms * 1000);
+	while (read(serial, buf, sizeof(buf)) > 0) ;
+	for (i = 0; i < num_inputs; i++) {
+		while (read(inputs[i], &ev, sizeof(ev)) == sizeof(ev)) ;
+	}
+}
+
+static int open_inputs(int vid)
+{
+	struct input_id id;
+	struct dirent *d;
+	char path[300];
+	int fd, clock = CLOCK_MONOTONIC;
+	DIR *dir;
+
+	dir = opendir("/dev/input");
+	if (!dir) return 0;
+	while ((d = readdir(dir)) != NULL && num_inputs < MAX_INPUTS) {
+		if (strncmp(d->d_name, "event", 5)) continue;
+		snprintf(path, sizeof(path), "/dev/input/%s", d->d_name);
+		fd = open(path, O_RDONLY | O_NONBLOCK);
+		if (fd < 0) continue;
+		if (ioctl(fd, EVIOCGID, &id) < 0 || id.vendor != vid ||
+		  ioctl(fd, EVIOCSCLOCKID, &clock) < 0) {
+			close(fd);
+			continue;
+		}
+		inputs[num_inputs++] = fd;
+	}
+	closedir(dir);
+	return num_inputs;
+}
+
+static int open_serial(const char *port)
+{
+	struct termios term;
+	int fd;
+
+	fd = open(port, O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (fd < 0) return -1;
+	tcgetattr(fd, &term);
+	cfmakeraw(&term);
+	cfsetspeed(&term, B115200);
+	tcsetattr(fd, TCSANOW, &term);
+	return fd;
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static void print_stats(const char *name, double *us, int done, int lost)
+{
+	double sum = 0;
+	int i;
+
+	if (!done) {
+		printf("%-24s not available (%d lost)\n", name, lost);
+		return;
+	}
+	qsort(us, done, sizeof(double), compare_double);
+	for (i = 0; i < done; i++) sum += us[i];
+	printf("%-24s mean %7.0f  p50 %7.0f  p90 %7.0f  p99 %7.0f  max %7.0f us, lost %d\n",
+		name, sum / done, us[done / 2], us[(done * 9) / 10], us[(done * 99) / 100],
+		us[done - 1], lost);
+}
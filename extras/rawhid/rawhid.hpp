@@ -0,0 +1,100 @@
+// C++ wrapper of the rawhid library, link it with hid.o and rawhid_batch.o.
+//
+//	rawhid::Devices devices(1, -1, -1, 0xFFC0, 0x0C00);
+//	rawhid::Batch batch(64, 1000);
+//	int n = devices[0].recv(batch, 100);
+//
+// The devices are closed when the Devices object goes out of scope.
+// rawhid_open() replaces all opened devices, so keep one Devices object.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+extern "C" {
+#include "hid.h"
+}
+
+namespace rawhid {
+
+// Packets of one report size, stored back to back
+class Batch
+{
+public:
+	Batch(int len, int count) : len_(len), count_(count), data_(len * count), lengths_(count, len) {}
+
+	int len() const { return len_; }
+	int count() const { return count_; }
+	uint8_t *data() { return data_.data(); }
+	const uint8_t *data() const { return data_.data(); }
+
+	uint8_t *packet(int i) { return data_.data() + i * len_; }
+	const uint8_t *packet(int i) const { return data_.data() + i * len_; }
+	// bytes received into a packet
+	int length(int i) const { return lengths_[i]; }
+	int *lengths() { return lengths_.data(); }
+
+private:
+	int len_;
+	int count_;
+	std::vector<uint8_t> data_;
+	std::vector<int> lengths_;
+};
+
+class Device
+{
+public:
+	explicit Device(int num) : num_(num) {}
+
+	int num() const { return num_; }
+
+	int recv(void *buf, int len, int timeout) { return rawhid_recv(num_, buf, len, timeout); }
+	int send(const void *buf, int len, int timeout) { return rawhid_send(num_, const_cast<void *>(buf), len, timeout); }
+
+	// All packets of the batch, returns the number of packets or -1
+	int recv(Batch &batch, int timeout) {
+		return rawhid_recv_many(num_, batch.data(), batch.len(), batch.count(), batch.lengths(), timeout);
+	}
+	int send(const Batch &batch, int timeout) { return send(batch, batch.count(), timeout); }
+	int send(const Batch &batch, int count, int timeout) {
+		return rawhid_send_many(num_, batch.data(), batch.len(), count, timeout);
+	}
+
+private:
+	int num_;
+};
+
+class Devices
+{
+public:
+	Devices(int max, int vid = -1, int pid = -1, int usage_page = -1, int usage = -1)
+		: count_(rawhid_open(max, vid, pid, usage_page, usage)) {}
+	~Devices() { close(); }
+
+	Devices(const Devices &) = delete;
+	Devices &operator=(const Devices &) = delete;
+	Devices(Devices &&other) : count_(other.count_) { other.count_ = 0; }
+	Devices &operator=(Devices &&other) {
+		if (this != &other) {
+			close();
+			count_ = other.count_;
+			other.count_ = 0;
+		}
+		return *this;
+	}
+
+	int count() const { return count_; }
+	explicit operator bool() const { return count_ > 0; }
+	Device operator[](int num) const { return Device(num); }
+
+	void close() {
+		for (int i = 0; i < count_; i++) rawhid_close(i);
+		count_ = 0;
+	}
+
+private:
+	int count_;
+};
+
+} // namespace rawhid
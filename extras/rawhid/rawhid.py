@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# Python binding of the rawhid library (ctypes), build the shared library
+# with "make lib" first. RAWHID_LIB overrides the path of the library.
+#
+#	import rawhid
+#	with rawhid.open(usage_page=0xFFC0, usage=0x0C00) as devices:
+#		packets = devices[0].recv_many(64, 1000, timeout=100)
+#		devices[0].send_many([bytes(64)] * 1000)
+#
+# The batched calls move all packets with one call into the library.
+
+import ctypes
+import os
+import sys
+
+if sys.platform == "darwin":
+	_NAME = "librawhid.dylib"
+elif sys.platform == "win32":
+	_NAME = "rawhid.dll"
+else:
+	_NAME = "librawhid.so"
+
+_lib = ctypes.CDLL(os.environ.get("RAWHID_LIB", os.path.join(os.path.dirname(os.path.abspath(__file__)), _NAME)))
+
+_lib.rawhid_open.argtypes = [ctypes.c_int] * 5
+_lib.rawhid_recv.argtypes = [ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_lib.rawhid_send.argtypes = [ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_lib.rawhid_close.argtypes = [ctypes.c_int]
+_lib.rawhid_close.restype = None
+_lib.rawhid_recv_many.argtypes = [ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_int,
+	ctypes.POINTER(ctypes.c_int), ctypes.c_int]
+_lib.rawhid_send_many.argtypes = [ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+
+
+class OfflineError(IOError):
+	pass
+
+
+class Device:
+	def __init__(self, num):
+		self.num = num
+
+	def recv(self, length, timeout=100):
+		"""One packet, None on timeout."""
+		buf = ctypes.create_string_buffer(length)
+		n = _lib.rawhid_recv(self.num, buf, length, timeout)
+		if n < 0:
+			raise OfflineError("device %d went offline" % self.num)
+		return buf.raw[:n] if n else None
+
+	def send(self, data, timeout=100):
+		"""Returns False on timeout."""
+		n = _lib.rawhid_send(self.num, data, len(data), timeout)
+		if n < 0:
+			raise OfflineError("device %d went offline" % self.num)
+		return n > 0
+
+	def recv_many(self, length, count, timeout=100):
+		"""Up to count packets of at most length bytes, fewer on timeout."""
+		buf = ctypes.create_string_buffer(length * count)
+		lengths = (ctypes.c_int * count)()
+		n = _lib.rawhid_recv_many(self.num, buf, length, count, lengths, timeout)
+		if n < 0:
+			raise OfflineError("device %d went offline" % self.num)
+		raw = buf.raw
+		return [raw[i * length:i * length + lengths[i]] for i in range(n)]
+
+	def send_many(self, packets, timeout=100):
+		"""Packets of equal length, returns the number that was sent."""
+		if not packets:
+			return 0
+		length = len(packets[0])
+		if any(len(p) != length for p in packets):
+			raise ValueError("all packets need the same length")
+		data = b"".join(packets)
+		n = _lib.rawhid_send_many(self.num, data, length, len(packets), timeout)
+		if n < 0:
+			raise OfflineError("device %d went offline" % self.num)
+		return n
+
+
+class Devices:
+	"""Opened devices, closed when leaving the with block.
+	rawhid_open() replaces all opened devices, so keep only one."""
+
+	def __init__(self, max_devices=1, vid=-1, pid=-1, usage_page=-1, usage=-1):
+		self.count = _lib.rawhid_open(max_devices, vid, pid, usage_page, usage)
+
+	def __len__(self):
+		return self.count
+
+	def __getitem__(self, num):
+		if not 0 <= num < self.count:
+			raise IndexError(num)
+		return Device(num)
+
+	def close(self):
+		for i in range(self.count):
+			_lib.rawhid_close(i)
+		self.count = 0
+
+	def __enter__(self):
+		return self
+
+	def __exit__(self, *args):
+		self.close()
+
+	def __del__(self):
+		self.close()
+
+
+def open(max_devices=1, vid=-1, pid=-1, usage_page=-1, usage=-1):
+	return Devices(max_devices, vid, pid, usage_page, usage)
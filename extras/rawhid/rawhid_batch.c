@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+#include <sys/time.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+#include "hid.h"
+
+// Batched transfers on top of rawhid_recv() and rawhid_send(), so bindings
+// to other languages cross into C once per batch instead of once per packet.
+
+
+static double now_ms(void);
+
+
+//  rawhid_recv_many - receive several packets
+//	Inputs:
+//	num = device to receive from (zero based)
+//	buf = count buffers of len bytes each, back to back
+//	len = size of each buffer (the report size)
+//	count = number of packets to receive
+//	lengths = set to the length of every received packet, may be NULL
+//	timeout = time to wait for all packets, in milliseconds
+//	Output:
+//	number of packets received, or -1 on error
+//
+//	Returns early when all packets arrived, on timeout the packets
+//	received so far are returned.
+//
+int rawhid_recv_many(int num, void *buf, int len, int count, int *lengths, int timeout)
+{
+	uint8_t *p = (uint8_t *)buf;
+	double begin;
+	int done, remain, n;
+
+	if (len < 1 || count < 0) return -1;
+	begin = now_ms();
+	for (done = 0; done < count; done++, p += len) {
+		// a timeout of 0 waits forever on some systems
+		remain = timeout - (int)(now_ms() - begin);
+		if (remain < 1) remain = 1;
+		n = rawhid_recv(num, p, len, remain);
+		if (n < 0) return done ? done : -1;
+		if (n == 0) break;
+		if (lengths) lengths[done] = n;
+	}
+	return done;
+}
+
+//  rawhid_send_many - send several packets
+//	Inputs:
+//	num = device to transmit to (zero based)
+//	buf = count packets of len bytes each, back to back
+//	len = number of bytes of each packet
+//	count = number of packets to send
+//	timeout = time to wait for each packet, in milliseconds
+//	Output:
+//	number of packets sent, or -1 on error
+//
+int rawhid_send_many(int num, const void *buf, int len, int count, int timeout)
+{
+	const uint8_t *p = (const uint8_t *)buf;
+	int done, n;
+
+	if (len < 1 || count < 0) return -1;
+	for (done = 0; done < count; done++, p += len) {
+		n = rawhid_send(num, (void *)p, len, timeout);
+		if (n < 0) return done ? done : -1;
+		if (n == 0) break;
+	}
+	return done;
+}
+
+
+static double now_ms(void)
+{
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#elif defined(OS_WINDOWS)
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#endif
+}
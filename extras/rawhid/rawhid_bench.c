@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+#include <time.h>
+#include <sys/time.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+#include "hid.h"
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+#include "rawhid_rt.h"
+#define HAVE_RT
+#endif
+
+// Host side of the RawHID benchmark, run it against the
+// examples/RawHID/RawHIDBenchmark sketch.
+//
+//	rawhid_bench [-n count] [-r report size] [-i interval in us]
+//	             [-t priority] [-c cpu] [-b]
+//
+// For every IN report length it measures the round-trip time of an echo
+// and the device to host throughput. The host to device throughput is
+// measured with full reports, paced by the interval (0 = as fast as possible).
+//
+// -t receives with a thread of the realtime priority (0 for the normal
+// one), -c pins it to a CPU and -b lets it spin instead of sleeping in the
+// OS, see rawhid_rt.h. The benchmark spins on the ring of the thread.
+
+#define MAX_REPORT 512
+
+
+static double now_us(void);
+static void sleep_us(double us);
+static void put32(uint8_t *p, uint32_t v);
+static uint32_t get32(const uint8_t *p);
+static int compare_double(const void *a, const void *b);
+static int bench_rtt(int report, int length, int count);
+static int bench_rx(int report, int length, int count);
+static int bench_tx(int report, int count, int interval);
+static int recv_report(void *buf, int len, int timeout);
+
+// receiving with the thread of rawhid_rt_start()
+static int rt = 0;
+
+
+int main(int argc, char **argv)
+{
+	int count = 1000, report = 64, interval = 0;
+	int length, i;
+#ifdef HAVE_RT
+	rawhid_rt_options_t options = {0, -1, 0, 0};
+#endif
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) count = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r") && i + 1 < argc) report = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-i") && i + 1 < argc) interval = atoi(argv[++i]);
+#ifdef HAVE_RT
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+			rt = 1;
+			options.priority = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc) options.cpu = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-b")) options.busy_poll = 1;
+#endif
+		else break;
+	}
+	if (i < argc || count < 1 || report < 8 || report > MAX_REPORT) {
+		printf("usage: %s [-n count] [-r report size] [-i interval in us] [-t priority] [-c cpu] [-b]\n", argv[0]);
+		return -1;
+	}
+
+	// Arduino-based example is 0x2341:XXXX:FFC0:0C00
+	if (rawhid_open(1, -1, -1, 0xFFC0, 0x0C00) <= 0) {
+		printf("no rawhid device found\n");
+		return -1;
+	}
+	printf("found rawhid device, %d byte reports, %d runs\n", report, count);
+#ifdef HAVE_RT
+	if (rt || options.cpu >= 0 || options.busy_poll) {
+		rt = 1;
+		i = rawhid_rt_start(0, report, &options);
+		if (i < 0) {
+			printf("receive thread failed to start\n");
+			rawhid_close(0);
+			return -1;
+		}
+		printf("receive thread%s%s\n", options.busy_poll ? ", busy polling" : "",
+			i ? "" : ", without the requested priority or cpu");
+	}
+#endif
+	printf("\n");
+
+	printf(" length   p50 us   p99 us   max us  lost |   rx KB/s  lost\n");
+	for (length = 8; length <= report; length *= 2) {
+		printf("%7d ", length);
+		if (bench_rtt(report, length, count) < 0) goto offline;
+		printf(" | ");
+		if (bench_rx(report, length, count) < 0) goto offline;
+		printf("\n");
+	}
+	printf("\n");
+	if (bench_tx(report, count, interval) < 0) goto offline;
+#ifdef HAVE_RT
+	if (rt) {
+		printf("receive thread dropped %d packets\n", rawhid_rt_dropped(0));
+		rawhid_rt_stop(0);
+	}
+#endif
+	rawhid_close(0);
+	return 0;
+
+offline:
+	printf("\nerror, device went offline\n");
+#ifdef HAVE_RT
+	if (rt) rawhid_rt_stop(0);
+#endif
+	rawhid_close(0);
+	return -1;
+}
+
+// from the device or the ring of the receive thread
+static int recv_report(void *buf, int len, int timeout)
+{
+#ifdef HAVE_RT
+	double end;
+	int n;
+
+	if (rt) {
+		end = now_us() + timeout * 1000.0;
+		while ((n = rawhid_rt_recv(0, buf, len, NULL)) == 0) {
+			if (now_us() >= end) return 0;
+		}
+		return n;
+	}
+#endif
+	return rawhid_recv(0, buf, len, timeout);
+}
+
+// echo round-trip time, lost echoes are not counted in the percentiles
+static int bench_rtt(int report, int length, int count)
+{
+	uint8_t buf[MAX_REPORT];
+	double *rtt, start;
+	int i, n, done = 0, lost = 0;
+
+	rtt = (double *)malloc(count * sizeof(double));
+	if (!rtt) return -1;
+	for (i = 0; i < count; i++) {
+		memset(buf, 0, report);
+		buf[0] = 'E';
+		put32(buf + 1, i);
+		buf[5] = length;
+		start = now_us();
+		if (rawhid_send(0, buf, report, 100) <= 0) {
+			free(rtt);
+			return -1;
+		}
+		// skip stale echoes of earlier timeouts
+		while (1) {
+			n = recv_report(buf, report, 100);
+			if (n < 0) {
+				free(rtt);
+				return -1;
+			}
+			if (n == 0) {
+				lost++;
+				break;
+			}
+			if (buf[0] == 'E' && get32(buf + 1) == (uint32_t)i) {
+				rtt[done++] = now_us() - start;
+				break;
+			}
+		}
+	}
+
+	if (done) {
+		qsort(rtt, done, sizeof(double), compare_double);
+		printf("%8.0f %8.0f %8.0f %5d", rtt[done / 2], rtt[(done * 99) / 100], rtt[done - 1], lost);
+	} else {
+		printf("       -        -        - %5d", lost);
+	}
+	free(rtt);
+	return 0;
+}
+
+// device to host throughput, gaps in the sequence numbers are lost reports
+static int bench_rx(int report, int length, int count)
+{
+	uint8_t buf[MAX_REPORT];
+	uint32_t expected = 0, seq;
+	double start, end;
+	long bytes = 0;
+	int n, got = 0;
+
+	memset(buf, 0, report);
+	buf[0] = 'T';
+	put32(buf + 1, count);
+	buf[5] = length;
+	if (rawhid_send(0, buf, report, 100) <= 0) return -1;
+
+	start = end = now_us();
+	while (expected < (uint32_t)count) {
+		n = recv_report(buf, report, 200);
+		if (n < 0) return -1;
+		if (n == 0) break;
+		if (buf[0] != 'T') continue;
+		seq = get32(buf + 1);
+		if (seq < expected) continue;
+		expected = seq + 1;
+		end = now_us();
+		bytes += n;
+		got++;
+	}
+	if (end > start) {
+		printf("%9.1f %5d", bytes / (end - start) * 1000000.0 / 1024.0, count - got);
+	} else {
+		printf("        - %5d", count - got);
+	}
+	return 0;
+}
+
+// host to device throughput, the device counts the reports it got
+static int bench_tx(int report, int count, int interval)
+{
+	uint8_t buf[MAX_REPORT];
+	double start, end;
+	uint32_t received, lost, bytes;
+	int i, n;
+
+	memset(buf, 0, report);
+	buf[0] = 'Z';
+	if (rawhid_send(0, buf, report, 100) <= 0) return -1;
+
+	start = now_us();
+	for (i = 0; i < count; i++) {
+		memset(buf, 0, report);
+		buf[0] = 'D';
+		put32(buf + 1, i);
+		if (rawhid_send(0, buf, report, 100) <= 0) return -1;
+		if (interval > 0) sleep_us(start + (double)(i + 1) * interval - now_us());
+	}
+	end = now_us();
+
+	memset(buf, 0, report);
+	buf[0] = 'S';
+	if (rawhid_send(0, buf, report, 100) <= 0) return -1;
+	do {
+		n = recv_report(buf, report, 500);
+		if (n <= 0) return -1;
+	} while (buf[0] != 'S');
+	received = get32(buf + 1);
+	lost = get32(buf + 5);
+	bytes = get32(buf + 9);
+
+	printf("tx: %d reports, %.1f KB/s, device got %u (%u bytes), %u gaps, lost %u\n",
+		count, (double)count * report / (end - start) * 1000000.0 / 1024.0,
+		received, bytes, lost, count - received);
+	return 0;
+}
+
+
+static double now_us(void)
+{
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#elif defined(OS_WINDOWS)
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000000.0 / (double)freq.QuadPart;
+#endif
+}
+
+static void sleep_us(double us)
+{
+	if (us <= 0) return;
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+	struct timespec ts;
+	ts.tv_sec = (time_t)(us / 1000000.0);
+	ts.tv_nsec = (long)(us - ts.tv_sec * 1000000.0) * 1000;
+	nanosleep(&ts, NULL);
+#elif defined(OS_WINDOWS)
+	Sleep((DWORD)(us / 1000));
+#endif
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+	return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hid.h"
+#include "rawhid_trace.h"
+
+// Captures reports into a trace for HIDReplay (src/HID-Replay.h) and prints
+// traces (Linux and macOS, hidraw devices Linux only).
+//
+//	rawhid_capture [-t seconds] trace
+//	rawhid_capture [-t seconds] -d /dev/hidraw2 [-d /dev/hidraw3:keyboard] trace
+//	rawhid_capture -p trace
+//
+// Without -d the RawHID reports of the library (0xFFC0:0x0C00) are captured.
+// hidraw devices keep their kernel driver, so the capture sees the reports
+// exactly as the host gets them. The multi report devices have the report ID
+// in front and are mapped with the default IDs of src/HID-Settings.h, a
+// SingleReport device has no ID and needs its type after the path (keyboard,
+// mouse, consumer, gamepad or rawhid).
+//
+// Every record is appended with one write(), so a trace stays valid when the
+// capture is killed and several captures into one file play back to back.
+
+#define MAX_DEVICES 8
+#define MAX_REPORT 255
+
+typedef struct {
+	const char *name;
+	int type;
+} type_t;
+
+static const type_t types[] = {
+	{ "keyboard", RAWHID_TRACE_KEYBOARD },
+	{ "mouse", RAWHID_TRACE_MOUSE },
+	{ "consumer", RAWHID_TRACE_CONSUMER },
+	{ "gamepad", RAWHID_TRACE_GAMEPAD },
+	{ "rawhid", RAWHID_TRACE_RAWHID },
+};
+
+// Default report IDs of the multi report devices
+static const int report_ids[][2] = {
+	{ 1, RAWHID_TRACE_MOUSE },
+	{ 2, RAWHID_TRACE_KEYBOARD },
+	{ 4, RAWHID_TRACE_CONSUMER },
+	{ 6, RAWHID_TRACE_GAMEPAD },
+};
+
+static volatile sig_atomic_t stop;
+static uint64_t last_us;
+static int records;
+
+static uint64_t now_us(void);
+static void on_signal(int sig);
+static int open_trace(const char *path);
+static int append(int fd, int type, const uint8_t *data, int len);
+static int type_of_name(const char *name);
+static const char *name_of_type(int type);
+static int type_of_id(int id);
+static int capture_rawhid(int fd, int seconds);
+static int capture_hidraw(int fd, char **paths, int count, int seconds);
+static int print_trace(const char *path);
+
+
+int main(int argc, char **argv)
+{
+	char *paths[MAX_DEVICES];
+	int count = 0, seconds = 0, print = 0;
+	int fd, r, i;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-p")) print = 1;
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) seconds = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-d") && i + 1 < argc && count < MAX_DEVICES) paths[count++] = argv[++i];
+		else break;
+	}
+	if (i + 1 != argc) {
+		printf("usage: %s [-t seconds] [-d hidraw[:type]]... trace\n", argv[0]);
+		printf("       %s -p trace\n", argv[0]);
+		return -1;
+	}
+	if (print) return print_trace(argv[i]);
+
+	fd = open_trace(argv[i]);
+	if (fd < 0) return -1;
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	if (count) r = capture_hidraw(fd, paths, count, seconds);
+	else r = capture_rawhid(fd, seconds);
+	close(fd);
+	printf("%d reports captured\n", records);
+	return r;
+}
+
+static int capture_rawhid(int fd, int seconds)
+{
+	uint8_t buf[64];
+	uint64_t end = now_us() + seconds * 1000000ULL;
+	int n;
+
+	// Arduino-based example is 0x2341:XXXX:FFC0:0C00
+	if (rawhid_open(1, -1, -1, 0xFFC0, 0x0C00) <= 0) {
+		printf("no rawhid device found\n");
+		return -1;
+	}
+	printf("capturing rawhid reports, ctrl-c to stop\n");
+	while (!stop && (!seconds || now_us() < end)) {
+		n = rawhid_recv(0, buf, sizeof(buf), 100);
+		if (n < 0) {
+			printf("error, device went offline\n");
+			break;
+		}
+		if (n > 0 && append(fd, RAWHID_TRACE_RAWHID, buf, n) < 0) break;
+	}
+	rawhid_close(0);
+	return 0;
+}
+
+static int capture_hidraw(int fd, char **paths, int count, int seconds)
+{
+#if defined(OS_LINUX)
+	struct pollfd fds[MAX_DEVICES];
+	int type[MAX_DEVICES];
+	uint8_t buf[MAX_REPORT + 1];
+	uint64_t end = now_us() + seconds * 1000000ULL;
+	int i, n, t;
+	char *sep;
+
+	for (i = 0; i < count; i++) {
+		// An explicit type means no report ID
+		type[i] = 0;
+		sep = strrchr(paths[i], ':');
+		if (sep) {
+			*sep = 0;
+			type[i] = type_of_name(sep + 1);
+			if (!type[i]) {
+				printf("unknown type %s\n", sep + 1);
+				return -1;
+			}
+		}
+		fds[i].fd = open(paths[i], O_RDONLY);
+		fds[i].events = POLLIN;
+		if (fds[i].fd < 0) {
+			perror(paths[i]);
+			return -1;
+		}
+	}
+	printf("capturing %d devices, ctrl-c to stop\n", count);
+	while (!stop && (!seconds || now_us() < end)) {
+		if (poll(fds, count, 100) <= 0) continue;
+		for (i = 0; i < count; i++) {
+			if (!(fds[i].revents & POLLIN)) continue;
+			n = read(fds[i].fd, buf, sizeof(buf));
+			if (n <= 0) {
+				printf("error, %s went offline\n", paths[i]);
+				stop = 1;
+				break;
+			}
+			if (type[i]) {
+				t = append(fd, type[i], buf, n);
+			} else {
+				// Reports of other devices are not replayed
+				t = type_of_id(buf[0]);
+				if (t && n > 1) t = append(fd, t, buf + 1, n - 1);
+			}
+			if (t < 0) {
+				stop = 1;
+				break;
+			}
+		}
+	}
+	for (i = 0; i < count; i++) close(fds[i].fd);
+	return 0;
+#else
+	(void)fd;
+	(void)paths;
+	(void)count;
+	(void)seconds;
+	printf("hidraw devices are only supported on Linux\n");
+	return -1;
+#endif
+}
+
+static int print_trace(const char *path)
+{
+	rawhid_trace_record_t r;
+	const uint8_t *trace;
+	struct stat st;
+	uint64_t time = 0;
+	long pos = RAWHID_TRACE_HEADER;
+	int fd, n, i;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror(path);
+		return -1;
+	}
+	if (st.st_size < RAWHID_TRACE_HEADER) {
+		printf("%s is no trace\n", path);
+		close(fd);
+		return -1;
+	}
+	// The file is read in place, it may be larger than the memory
+	trace = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (trace == MAP_FAILED) {
+		perror(path);
+		return -1;
+	}
+	if (memcmp(trace, RAWHID_TRACE_MAGIC, 4) || trace[4] != RAWHID_TRACE_VERSION) {
+		printf("%s is no trace of version %d\n", path, RAWHID_TRACE_VERSION);
+		munmap((void *)trace, st.st_size);
+		return -1;
+	}
+	while ((n = rawhid_trace_next(trace, st.st_size, &pos, &r)) > 0) {
+		time += r.delay;
+		printf("%12.3f ms  %-8s %3d:", time / 1000.0, name_of_type(r.type), r.len);
+		for (i = 0; i < r.len; i++) printf(" %02X", r.data[i]);
+		printf("\n");
+		records++;
+	}
+	if (n < 0) printf("last record is cut off at offset %ld\n", pos);
+	printf("%d reports, %.3f s\n", records, time / 1000000.0);
+	munmap((void *)trace, st.st_size);
+	return 0;
+}
+
+static int open_trace(const char *path)
+{
+	static const uint8_t header[RAWHID_TRACE_HEADER] = { 'H', 'I', 'D', 'T', RAWHID_TRACE_VERSION };
+	uint8_t buf[RAWHID_TRACE_HEADER];
+	struct stat st;
+	int fd;
+
+	// O_APPEND writes every record at the end, even with several writers
+	fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror(path);
+		return -1;
+	}
+	if (st.st_size == 0) {
+		if (write(fd, header, sizeof(header)) != sizeof(header)) {
+			perror(path);
+			close(fd);
+			return -1;
+		}
+	} else if (pread(fd, buf, sizeof(buf), 0) != sizeof(buf) || memcmp(buf, header, 5)) {
+		printf("%s is no trace of version %d\n", path, RAWHID_TRACE_VERSION);
+		close(fd);
+		return -1;
+	}
+	// The first record of a capture follows the previous one immediately
+	last_us = 0;
+	return fd;
+}
+
+static int append(int fd, int type, const uint8_t *data, int len)
+{
+	uint8_t rec[RAWHID_TRACE_RECORD + MAX_REPORT];
+	uint64_t now = now_us();
+	uint32_t delay = 0;
+
+	if (len > MAX_REPORT) len = MAX_REPORT;
+	if (last_us) {
+		// Pauses longer than the delay field are cut to its maximum
+		delay = now - last_us > UINT32_MAX ? UINT32_MAX : (uint32_t)(now - last_us);
+	}
+	last_us = now;
+	rec[0] = delay;
+	rec[1] = delay >> 8;
+	rec[2] = delay >> 16;
+	rec[3] = delay >> 24;
+	rec[4] = type;
+	rec[5] = len;
+	memcpy(rec + RAWHID_TRACE_RECORD, data, len);
+	if (write(fd, rec, RAWHID_TRACE_RECORD + len) != RAWHID_TRACE_RECORD + len) {
+		perror("write");
+		return -1;
+	}
+	records++;
+	return 0;
+}
+
+static int type_of_name(const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+		if (!strcmp(types[i].name, name)) return types[i].type;
+	}
+	return 0;
+}
+
+static const char *name_of_type(int type)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+		if (types[i].type == type) return types[i].name;
+	}
+	return "unknown";
+}
+
+static int type_of_id(int id)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(report_ids) / sizeof(report_ids[0]); i++) {
+		if (report_ids[i][0] == id) return report_ids[i][1];
+	}
+	return 0;
+}
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+#include <sys/time.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+#include "hid.h"
+#include "rawhid_channel.h"
+
+// Host side of the RawHID channels, run it against the
+// examples/RawHID/RawHIDChannels sketch.
+//
+//	rawhid_ch_test [-n count] [-s max size] [-r report size]
+//
+// Sends bulk messages of doubling length up to the max size on channel 1
+// and a short command on channel 0 after the first reports of each one.
+// The sketch echoes both, the command round trip is measured while the
+// bulk message is on its way.
+
+#define MAX_MESSAGE 65535
+#define COMMAND 8
+
+
+static double now_us(void);
+
+
+int main(int argc, char **argv)
+{
+	int count = 100, max = 1024, report = 64;
+	int length, i, j, n, bad, got_cmd, got_bulk;
+	uint8_t *out, *in, cmd[COMMAND], reply[COMMAND];
+	double start, sent, us, cmd_us, cmd_max;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) count = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) max = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r") && i + 1 < argc) report = atoi(argv[++i]);
+		else break;
+	}
+	if (i < argc || count < 1 || max < 1 || max > MAX_MESSAGE || report < 8 || report > 512) {
+		printf("usage: %s [-n count] [-s max size] [-r report size]\n", argv[0]);
+		return -1;
+	}
+
+	// Arduino-based example is 0x2341:XXXX:FFC0:0C00
+	if (rawhid_open(1, -1, -1, 0xFFC0, 0x0C00) <= 0) {
+		printf("no rawhid device found\n");
+		return -1;
+	}
+	out = (uint8_t *)malloc(max);
+	in = (uint8_t *)malloc(max);
+	if (!out || !in) return -1;
+	printf("found rawhid device, %d byte reports, %d runs\n\n", report, count);
+
+	printf(" length  echo KB/s  cmd avg ms  cmd max ms   bad\n");
+	for (length = 1; ; length *= 2) {
+		if (length > max) length = max;
+		cmd_us = cmd_max = 0;
+		start = now_us();
+		for (i = 0, bad = 0; i < count; i++) {
+			for (j = 0; j < length; j++) out[j] = rand();
+			for (j = 0; j < COMMAND; j++) cmd[j] = i + j;
+
+			// the command is queued after the bulk message was started
+			if (rawhid_ch_send(0, 1, out, length) < 0) goto offline;
+			if (rawhid_ch_poll(0, report, 1) < 0) goto offline;
+			if (rawhid_ch_send(0, 0, cmd, COMMAND) < 0) goto offline;
+			sent = now_us();
+
+			for (got_cmd = got_bulk = 0; !got_cmd || !got_bulk; ) {
+				if (rawhid_ch_poll(0, report, 1000) < 0) goto offline;
+				if (!got_cmd && (n = rawhid_ch_recv(0, 0, reply, COMMAND)) != 0) {
+					us = now_us() - sent;
+					cmd_us += us;
+					if (us > cmd_max) cmd_max = us;
+					if (n != COMMAND || memcmp(reply, cmd, COMMAND)) bad++;
+					got_cmd = 1;
+				}
+				if (!got_bulk && (n = rawhid_ch_recv(0, 1, in, max)) != 0) {
+					if (n != length || memcmp(in, out, length)) bad++;
+					got_bulk = 1;
+				}
+				if (now_us() - sent > 5000000.0) goto offline;
+			}
+		}
+		us = now_us() - start;
+		printf("%7d %10.1f %11.3f %11.3f %5d\n", length, 2.0 * length * count / us * 1000000.0 / 1024.0,
+			cmd_us / count / 1000.0, cmd_max / 1000.0, bad);
+		if (length == max) break;
+	}
+	free(out);
+	free(in);
+	rawhid_close(0);
+	return 0;
+
+offline:
+	printf("\nerror, device went offline or timed out\n");
+	rawhid_close(0);
+	return -1;
+}
+
+static double now_us(void)
+{
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#elif defined(OS_WINDOWS)
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000000.0 / (double)freq.QuadPart;
+#endif
+}
@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+#include <sys/time.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+#include "hid.h"
+#include "rawhid_channel.h"
+
+#define CH_START	0x10
+#define CH_END		0x20
+#define CH_MASK		0x0F
+#define CH_LENGTH_MASK	0xC0
+
+#define MAX_DEVICES	16
+#define MAX_REPORT	512
+
+typedef struct msg_struct msg_t;
+struct msg_struct {
+	msg_t *next;
+	int len;
+	uint8_t data[1];
+};
+
+typedef struct {
+	// sending, the head message is sent from offset
+	msg_t *tx_head;
+	msg_t *tx_tail;
+	int tx_offset;
+	int priority;
+	// receiving, completed messages wait in a list
+	msg_t *rx_head;
+	msg_t *rx_tail;
+	uint8_t *rx_buf;
+	int rx_len;
+	int rx_size;
+	int rx_active;
+} channel_t;
+
+typedef struct {
+	channel_t ch[RAWHID_CH_MAX];
+	int last;
+	int init;
+} ch_state_t;
+
+static ch_state_t states[MAX_DEVICES];
+
+
+static ch_state_t *get_state(int num);
+static int schedule(ch_state_t *st);
+static int transmit(int num, ch_state_t *st, int report);
+static int receive(ch_state_t *st, const uint8_t *in, int n);
+static msg_t *new_msg(const void *buf, int len);
+static void free_list(msg_t *msg);
+static double now_ms(void);
+
+
+int rawhid_ch_priority(int num, int channel, int priority)
+{
+	ch_state_t *st = get_state(num);
+
+	if (!st || channel < 0 || channel >= RAWHID_CH_MAX) return -1;
+	st->ch[channel].priority = priority;
+	return 0;
+}
+
+int rawhid_ch_send(int num, int channel, const void *buf, int len)
+{
+	ch_state_t *st = get_state(num);
+	channel_t *ch;
+	msg_t *msg;
+
+	if (!st || channel < 0 || channel >= RAWHID_CH_MAX || len < 0 || len > 0xFFFF) return -1;
+	msg = new_msg(buf, len);
+	if (!msg) return -1;
+	ch = &st->ch[channel];
+	if (ch->tx_tail) ch->tx_tail->next = msg;
+	else ch->tx_head = msg;
+	ch->tx_tail = msg;
+	return len;
+}
+
+int rawhid_ch_poll(int num, int report, int timeout)
+{
+	ch_state_t *st = get_state(num);
+	uint8_t in[MAX_REPORT];
+	int i, n, remain, queued, done = 0;
+	msg_t *msg;
+	double begin;
+
+	if (!st || report < 8 || report > MAX_REPORT) return -1;
+
+	// a burst of reports, the priorities are checked for every report
+	for (i = 0; i < RAWHID_CH_HOST_BURST && schedule(st) >= 0; i++) {
+		if (transmit(num, st, report) < 0) return -1;
+	}
+
+	// reports of the device until a message is complete, libusb waits
+	// forever with a timeout of 0
+	begin = now_ms();
+	if (timeout < 1) timeout = 1;
+	while (!done && (remain = timeout - (int)(now_ms() - begin)) > 0) {
+		n = rawhid_recv(num, in, report, remain);
+		if (n < 0) return -1;
+		if (n == 0) break;
+		done = receive(st, in, n);
+	}
+
+	for (queued = 0, i = 0; i < RAWHID_CH_MAX; i++) {
+		for (msg = st->ch[i].tx_head; msg; msg = msg->next) queued++;
+	}
+	return queued;
+}
+
+int rawhid_ch_recv(int num, int channel, void *buf, int len)
+{
+	ch_state_t *st = get_state(num);
+	channel_t *ch;
+	msg_t *msg;
+	int result;
+
+	if (!st || channel < 0 || channel >= RAWHID_CH_MAX) return 0;
+	ch = &st->ch[channel];
+	msg = ch->rx_head;
+	if (!msg) return 0;
+	ch->rx_head = msg->next;
+	if (!ch->rx_head) ch->rx_tail = NULL;
+
+	result = -2;
+	if (msg->len <= len) {
+		memcpy(buf, msg->data, msg->len);
+		result = msg->len;
+	}
+	free(msg);
+	return result;
+}
+
+void rawhid_ch_reset(int num)
+{
+	ch_state_t *st;
+	int i;
+
+	if (num < 0 || num >= MAX_DEVICES) return;
+	st = &states[num];
+	if (st->init) {
+		for (i = 0; i < RAWHID_CH_MAX; i++) {
+			free_list(st->ch[i].tx_head);
+			free_list(st->ch[i].rx_head);
+			free(st->ch[i].rx_buf);
+		}
+	}
+	memset(st, 0, sizeof(ch_state_t));
+}
+
+static ch_state_t *get_state(int num)
+{
+	ch_state_t *st;
+	int i;
+
+	if (num < 0 || num >= MAX_DEVICES) return NULL;
+	st = &states[num];
+	if (!st->init) {
+		for (i = 0; i < RAWHID_CH_MAX; i++) st->ch[i].priority = i;
+		st->last = RAWHID_CH_MAX - 1;
+		st->init = 1;
+	}
+	return st;
+}
+
+// the channel with the highest priority, equal ones start after the last sent one
+static int schedule(ch_state_t *st)
+{
+	int i, channel, best = -1;
+
+	for (i = 1; i <= RAWHID_CH_MAX; i++) {
+		channel = (st->last + i) % RAWHID_CH_MAX;
+		if (st->ch[channel].tx_head &&
+		  (best < 0 || st->ch[channel].priority < st->ch[best].priority)) best = channel;
+	}
+	return best;
+}
+
+static int transmit(int num, ch_state_t *st, int report)
+{
+	uint8_t out[MAX_REPORT];
+	int channel = schedule(st);
+	channel_t *ch = &st->ch[channel];
+	msg_t *msg = ch->tx_head;
+	int payload = msg->len - ch->tx_offset;
+
+	if (payload > report - 2) payload = report - 2;
+	memset(out, 0, report);
+	out[0] = channel | ((payload >> 2) & CH_LENGTH_MASK);
+	if (!ch->tx_offset) out[0] |= CH_START;
+	if (ch->tx_offset + payload == msg->len) out[0] |= CH_END;
+	out[1] = payload;
+	memcpy(out + 2, msg->data + ch->tx_offset, payload);
+	if (rawhid_send(num, out, report, 100) <= 0) return -1;
+
+	st->last = channel;
+	ch->tx_offset += payload;
+	if (ch->tx_offset == msg->len) {
+		ch->tx_offset = 0;
+		ch->tx_head = msg->next;
+		if (!ch->tx_head) ch->tx_tail = NULL;
+		free(msg);
+	}
+	return 0;
+}
+
+// reassembles the messages of the channel, returns 1 if one is complete
+static int receive(ch_state_t *st, const uint8_t *in, int n)
+{
+	channel_t *ch;
+	msg_t *msg;
+	uint8_t *buf;
+	int payload, size;
+
+	if (n < 2) return 0;
+	payload = in[1] | ((in[0] & CH_LENGTH_MASK) << 2);
+	if (payload > n - 2) return 0;
+	ch = &st->ch[in[0] & CH_MASK];
+
+	if (in[0] & CH_START) {
+		ch->rx_len = 0;
+		ch->rx_active = 1;
+	} else if (!ch->rx_active) {
+		// middle of a message we never saw the start of
+		return 0;
+	}
+	if (ch->rx_len + payload > ch->rx_size) {
+		size = ch->rx_size ? ch->rx_size * 2 : 1024;
+		while (size < ch->rx_len + payload) size *= 2;
+		buf = (uint8_t *)realloc(ch->rx_buf, size);
+		if (!buf) {
+			ch->rx_active = 0;
+			return 0;
+		}
+		ch->rx_buf = buf;
+		ch->rx_size = size;
+	}
+	memcpy(ch->rx_buf + ch->rx_len, in + 2, payload);
+	ch->rx_len += payload;
+	if (!(in[0] & CH_END)) return 0;
+
+	ch->rx_active = 0;
+	msg = new_msg(ch->rx_buf, ch->rx_len);
+	if (!msg) return 0;
+	if (ch->rx_tail) ch->rx_tail->next = msg;
+	else ch->rx_head = msg;
+	ch->rx_tail = msg;
+	return 1;
+}
+
+static msg_t *new_msg(const void *buf, int len)
+{
+	msg_t *msg = (msg_t *)malloc(sizeof(msg_t) + len);
+
+	if (!msg) return NULL;
+	msg->next = NULL;
+	msg->len = len;
+	if (len) memcpy(msg->data, buf, len);
+	return msg;
+}
+
+static void free_list(msg_t *msg)
+{
+	msg_t *next;
+
+	for (; msg; msg = next) {
+		next = msg->next;
+		free(msg);
+	}
+}
+
+static double now_ms(void)
+{
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#elif defined(OS_WINDOWS)
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#endif
+}
@@ -0,0 +1,27 @@
+// Logical channels multiplexed over one RawHID interface, the protocol is
+// described in src/HID-Channel.h of the library. report is the RawHID report size.
+
+#define RAWHID_CH_MAX		16
+
+// Reports rawhid_ch_poll() sends before it looks at incoming reports
+#define RAWHID_CH_HOST_BURST	8
+
+// Channels with a lower priority value are sent first, equal ones take turns.
+// The default priority is the channel number. Returns -1 for a bad channel.
+int rawhid_ch_priority(int num, int channel, int priority);
+
+// Queues a copy of the message, sent by rawhid_ch_poll().
+// Returns len or -1 for a bad channel or without memory.
+int rawhid_ch_send(int num, int channel, const void *buf, int len);
+
+// Sends queued reports by priority and receives reports for up to timeout ms,
+// returns early once a message is complete. Returns the number of messages
+// still queued or -1 if the device went offline.
+int rawhid_ch_poll(int num, int report, int timeout);
+
+// Returns the length of the oldest received message of the channel, 0 if
+// there is none (or it was empty) or -2 if it was longer than len (it is dropped).
+int rawhid_ch_recv(int num, int channel, void *buf, int len);
+
+// Drops all queued and received messages of the device
+void rawhid_ch_reset(int num);
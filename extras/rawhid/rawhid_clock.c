@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(OS_WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "hid.h"
+#include "rawhid_clock.h"
+
+// Clock reads should finish within a few frames
+#define CLOCK_TIMEOUT 100
+
+
+static void fit(rawhid_clock_t *clock);
+
+
+//  rawhid_clock_now - monotonic host time
+//
+//	Output:
+//	time in us, for differences only
+//
+double rawhid_clock_now(void)
+{
+#if defined(OS_WINDOWS)
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1e6 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+#endif
+}
+
+void rawhid_clock_init(rawhid_clock_t *clock, int num)
+{
+	memset(clock, 0, sizeof(*clock));
+	clock->num = num;
+	clock->rate = 1.0;
+}
+
+//  rawhid_clock_sync - measure the device clock
+//
+//	Inputs:
+//	clock = state of the device, see rawhid_clock_init()
+//	exchanges = number of clock reads, the best one is used
+//	Output:
+//	round trip of the best read in us, or -1 on error
+//
+double rawhid_clock_sync(rawhid_clock_t *clock, int exchanges)
+{
+	uint8_t report[RAWHID_CLOCK_SIZE];
+	rawhid_clock_sample_t best, sample;
+	double t1, t4;
+	uint32_t raw;
+	int i, n, found = 0;
+
+	for (i = 0; i < exchanges; i++) {
+		t1 = rawhid_clock_now();
+		n = rawhid_get_feature(clock->num, RAWHID_CLOCK_ID, report, sizeof(report), CLOCK_TIMEOUT);
+		t4 = rawhid_clock_now();
+		if (n < 5 || report[0] != RAWHID_CLOCK_ID) continue;
+
+		// The device read its clock somewhere during the round trip,
+		// symmetric delays put it in the middle
+		raw = report[1] | (report[2] << 8) | (report[3] << 16) | ((uint32_t)report[4] << 24);
+		sample.device = (double)rawhid_clock_unwrap(clock, raw);
+		sample.host = (t1 + t4) / 2;
+		sample.rtt = t4 - t1;
+		if (!found || sample.rtt < best.rtt) {
+			best = sample;
+			found = 1;
+		}
+	}
+	if (!found) return -1;
+
+	clock->history[clock->next] = best;
+	clock->next = (clock->next + 1) % RAWHID_CLOCK_HISTORY;
+	if (clock->samples < RAWHID_CLOCK_HISTORY) clock->samples++;
+	clock->rtt = best.rtt;
+	clock->error = best.rtt / 2;
+	fit(clock);
+	return best.rtt;
+}
+
+//  rawhid_clock_unwrap - extend the 32 bit device clock
+//
+//	Inputs:
+//	clock = state of the device
+//	device_us = micros() of the device
+//	Output:
+//	micros() without overflows
+//
+int64_t rawhid_clock_unwrap(rawhid_clock_t *clock, uint32_t device_us)
+{
+	int64_t t;
+
+	if (!clock->valid) {
+		clock->valid = 1;
+		clock->last_raw = device_us;
+		clock->last = device_us;
+		return clock->last;
+	}
+
+	// Signed distance to the newest value, older values are fine too
+	t = clock->last + (int32_t)(device_us - clock->last_raw);
+	if (t > clock->last) {
+		clock->last = t;
+		clock->last_raw = device_us;
+	}
+	return t;
+}
+
+//  rawhid_clock_to_host - convert a device timestamp
+//
+//	Inputs:
+//	clock = synced state of the device
+//	device_us = micros() of the device, e.g. from a report trailer
+//	Output:
+//	host time in us, comparable to rawhid_clock_now()
+//
+double rawhid_clock_to_host(rawhid_clock_t *clock, uint32_t device_us)
+{
+	double device = (double)rawhid_clock_unwrap(clock, device_us);
+
+	return clock->base_host + clock->offset + clock->rate * (device - clock->base_device);
+}
+
+int rawhid_trailer(const void *report, int len, rawhid_trailer_t *trailer)
+{
+	const uint8_t *p;
+
+	if (len < RAWHID_TRAILER_SIZE) return -1;
+	p = (const uint8_t *)report + len - RAWHID_TRAILER_SIZE;
+	trailer->device_us = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+	trailer->queued_us = p[4] | (p[5] << 8);
+	trailer->seq = p[6] | (p[7] << 8);
+	return 0;
+}
+
+// Least squares line through the history. The values are taken relative to
+// the oldest sample, absolute microseconds would lose the precision of the
+// products. With a single sample or a short baseline the drift is kept.
+static void fit(rawhid_clock_t *clock)
+{
+	rawhid_clock_sample_t *s;
+	double x, y, mx = 0, my = 0, sxx = 0, sxy = 0;
+	int i, first;
+
+	first = (clock->next - clock->samples + RAWHID_CLOCK_HISTORY) % RAWHID_CLOCK_HISTORY;
+	clock->base_device = clock->history[first].device;
+	clock->base_host = clock->history[first].host;
+
+	for (i = 0; i < clock->samples; i++) {
+		s = &clock->history[(first + i) % RAWHID_CLOCK_HISTORY];
+		mx += s->device - clock->base_device;
+		my += s->host - clock->base_host;
+	}
+	mx /= clock->samples;
+	my /= clock->samples;
+	for (i = 0; i < clock->samples; i++) {
+		s = &clock->history[(first + i) % RAWHID_CLOCK_HISTORY];
+		x = s->device - clock->base_device - mx;
+		y = s->host - clock->base_host - my;
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	// Until the baseline is 1000 round trips long the drift would be off by
+	// more than 0.1%, which is more than a ceramic resonator drifts
+	if (clock->samples >= 2 && sxx > 0 && (mx * 2) > clock->rtt * 1000) {
+		clock->rate = sxy / sxx;
+	}
+	clock->offset = my - clock->rate * mx;
+}
@@ -0,0 +1,74 @@
+
+// Synchronization with the device clock of a sketch built with
+// RAWHID_TIMESTAMP. The device answers a feature report with its micros(),
+// the host estimates the offset and the drift of the two clocks from the
+// exchanges with the shortest round trip, like NTP. The timestamps of the
+// report trailers can then be converted to host time, which splits the
+// latency of every report into the time it waited in the firmware and the
+// time on the bus and in the host stack.
+//
+// Windows only reads feature reports declared in the report descriptor,
+// the clock report is not, so the synchronization needs Linux or macOS.
+
+#include <stdint.h>
+
+// Report ID and size of the clock report, RAWHID_CLOCK_ID of RawHID.h
+#define RAWHID_CLOCK_ID		0x43
+#define RAWHID_CLOCK_SIZE	8
+#define RAWHID_TRAILER_SIZE	8
+
+// Best exchanges of the last syncs used for the drift estimate
+#define RAWHID_CLOCK_HISTORY	32
+
+typedef struct {
+	double device;	// unwrapped device time, us
+	double host;	// host time in the middle of the round trip, us
+	double rtt;	// round trip of the exchange, us
+} rawhid_clock_sample_t;
+
+typedef struct {
+	int num;
+	// host = base_host + offset + rate * (device - base_device)
+	double base_device;
+	double base_host;
+	double offset;
+	double rate;
+	// round trip and uncertainty (half the round trip) of the last sync, us
+	double rtt;
+	double error;
+	// micros() wraps after 71.6 minutes, it is extended to 64 bits
+	uint32_t last_raw;
+	int64_t last;
+	int valid;
+	rawhid_clock_sample_t history[RAWHID_CLOCK_HISTORY];
+	int samples;
+	int next;
+} rawhid_clock_t;
+
+typedef struct {
+	uint32_t device_us;	// micros() when the report was handed to the USB core
+	uint16_t queued_us;	// time it waited since write(), 65535 if longer
+	uint16_t seq;		// sequence number, counts every report
+} rawhid_trailer_t;
+
+// Monotonic host time in us, the time base of all conversions
+double rawhid_clock_now(void);
+
+void rawhid_clock_init(rawhid_clock_t *clock, int num);
+
+// Runs exchanges clock reads and adds the one with the shortest round trip to
+// the history, then fits offset and drift over the history. Call it again
+// every few seconds to follow the drift. Returns the round trip in us of the
+// best exchange or -1 on errors.
+double rawhid_clock_sync(rawhid_clock_t *clock, int exchanges);
+
+// Device micros() extended to 64 bits. Values may be up to 35 minutes older
+// than the newest one seen, the clock has to be synced or fed at least every
+// 35 minutes.
+int64_t rawhid_clock_unwrap(rawhid_clock_t *clock, uint32_t device_us);
+
+// Host time of a device micros() value
+double rawhid_clock_to_host(rawhid_clock_t *clock, uint32_t device_us);
+
+// Reads the trailer at the end of a report of len bytes, returns 0 or -1
+int rawhid_trailer(const void *report, int len, rawhid_trailer_t *trailer);
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hid.h"
+#include "rawhid_clock.h"
+
+// Per hop latency of RawHID reports, for sketches built with RAWHID_TIMESTAMP
+// that send reports continuously, e.g. examples/RawHID/RawHIDBenchmark.
+//
+//	rawhid_clock_test [-n reports] [-r report size] [-s sync interval ms]
+//
+// Syncs the clocks, then splits the latency of every report into the time
+// it waited in the firmware (trailer) and the time from the USB core to
+// rawhid_recv() returning (bus, host controller and OS). Lost reports are
+// counted with the sequence numbers.
+
+#define MAX_REPORT 512
+
+
+typedef struct {
+	double sum, min, max;
+	int count;
+} stat_t;
+
+static void stat_add(stat_t *s, double v);
+static void stat_print(const char *name, const stat_t *s);
+
+
+int main(int argc, char **argv)
+{
+	int count = 10000, report = 64, interval = 1000;
+	int i, n, lost = 0, first = 1;
+	uint8_t buf[MAX_REPORT];
+	rawhid_clock_t clock;
+	rawhid_trailer_t t;
+	stat_t queue, bus, total;
+	double rtt, now, last_sync;
+	uint16_t seq = 0;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) count = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r") && i + 1 < argc) report = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) interval = atoi(argv[++i]);
+		else break;
+	}
+	if (i < argc || count < 1 || report < RAWHID_TRAILER_SIZE || report > MAX_REPORT || interval < 1) {
+		printf("usage: %s [-n reports] [-r report size] [-s sync interval ms]\n", argv[0]);
+		return -1;
+	}
+
+	// Arduino-based example is 0x2341:XXXX:FFC0:0C00
+	if (rawhid_open(1, -1, -1, 0xFFC0, 0x0C00) <= 0) {
+		printf("no rawhid device found\n");
+		return -1;
+	}
+
+	rawhid_clock_init(&clock, 0);
+	rtt = rawhid_clock_sync(&clock, 32);
+	if (rtt < 0) {
+		printf("the device does not answer the clock report (RAWHID_TIMESTAMP)\n");
+		return -1;
+	}
+	printf("clock synced, round trip %.1f us\n", rtt);
+	last_sync = rawhid_clock_now();
+
+	memset(&queue, 0, sizeof(queue));
+	memset(&bus, 0, sizeof(bus));
+	memset(&total, 0, sizeof(total));
+	for (i = 0; i < count; ) {
+		n = rawhid_recv(0, buf, report, 220);
+		now = rawhid_clock_now();
+		if (n < 0) {
+			printf("error reading, device went offline\n");
+			return -1;
+		}
+		if (n < report) continue;
+		rawhid_trailer(buf, n, &t);
+
+		if (!first) lost += (uint16_t)(t.seq - seq - 1);
+		first = 0;
+		seq = t.seq;
+		stat_add(&queue, t.queued_us);
+		stat_add(&bus, now - rawhid_clock_to_host(&clock, t.device_us));
+		stat_add(&total, now - rawhid_clock_to_host(&clock, t.device_us) + t.queued_us);
+		i++;
+
+		// Reports that arrive meanwhile wait in the host queue, which
+		// shows up in the bus time of the next ones
+		if (now - last_sync > interval * 1000.0) {
+			rawhid_clock_sync(&clock, 8);
+			last_sync = rawhid_clock_now();
+		}
+	}
+
+	printf("%d reports, %d lost, drift %.1f ppm, sync error +-%.1f us\n\n",
+		count, lost, (clock.rate - 1.0) * 1e6, clock.error);
+	printf("              avg us    min us    max us\n");
+	stat_print("firmware", &queue);
+	stat_print("bus + host", &bus);
+	stat_print("total", &total);
+	rawhid_close(0);
+	return 0;
+}
+
+static void stat_add(stat_t *s, double v)
+{
+	if (!s->count || v < s->min) s->min = v;
+	if (!s->count || v > s->max) s->max = v;
+	s->sum += v;
+	s->count++;
+}
+
+static void stat_print(const char *name, const stat_t *s)
+{
+	printf("%-10s %9.1f %9.1f %9.1f\n", name, s->sum / s->count, s->min, s->max);
+}
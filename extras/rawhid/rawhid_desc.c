@@ -0,0 +1,477 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hid.h"
+#include "rawhid_desc.h"
+
+// largest report descriptor of the kernel (HID_MAX_DESCRIPTOR_SIZE)
+#define MAX_DESCRIPTOR	4096
+// local usages per main item and depth of push and collections
+#define MAX_USAGES	256
+#define MAX_STACK	8
+
+#define SLOT_BUTTONS	0
+#define SLOT_AXIS	1
+#define SLOT_HAT	2
+#define SLOT_MODIFIERS	3
+#define SLOT_KEYBITS	4
+#define SLOT_KEYARRAY	5
+
+typedef struct {
+	uint16_t usage_page;
+	int32_t logical_min;
+	int32_t logical_max;
+	uint32_t logical_max_raw;
+	uint32_t report_size;
+	uint32_t report_count;
+	uint8_t report_id;
+} global_t;
+
+
+static int parse_item(const uint8_t **data, const uint8_t *end, uint32_t *val, int *size);
+static int32_t sign_extend(uint32_t val, int size);
+static uint32_t get_bits(const uint8_t *report, uint32_t bit, int size);
+static rawhid_field_t * add_field(rawhid_desc_t *desc);
+static int add_slot(rawhid_decoder_t *decoder, const rawhid_field_t *field, int kind, int index);
+static void add_key(rawhid_input_t *input, int usage);
+
+
+//  rawhid_desc_parse - compile a report descriptor
+//
+//	Inputs:
+//	desc = field table to fill, freed with rawhid_desc_free()
+//	data = report descriptor
+//	len = length of the descriptor
+//	Output:
+//	number of fields, or -1 on error
+//
+int rawhid_desc_parse(rawhid_desc_t *desc, const void *data, int len)
+{
+	const uint8_t *p = (const uint8_t *)data, *end = p + len;
+	global_t global, stack[MAX_STACK];
+	uint32_t usages[MAX_USAGES];
+	uint32_t bits[3][256];
+	uint32_t val, usage, usage_min = 0, usage_max = 0;
+	int apps[MAX_STACK];
+	int tag, size, type, i, n_usages = 0, has_range = 0, depth = 0, sp = 0;
+	rawhid_field_t *f;
+	rawhid_collection_t *c;
+
+	memset(desc, 0, sizeof(*desc));
+	memset(&global, 0, sizeof(global));
+	memset(bits, 0, sizeof(bits));
+	apps[0] = -1;
+
+	while (p < end) {
+		tag = parse_item(&p, end, &val, &size);
+		if (tag < 0) goto error;
+
+		switch (tag) {
+		// Main items, HID 1.11, 6.2.2.4
+		case 0x80: // Input
+		case 0x90: // Output
+		case 0xB0: // Feature
+			type = tag == 0x80 ? RAWHID_FIELD_INPUT :
+				tag == 0x90 ? RAWHID_FIELD_OUTPUT : RAWHID_FIELD_FEATURE;
+			// constants and fields without usages are padding
+			if (!(val & RAWHID_FIELD_CONSTANT) && (n_usages || has_range)) {
+				for (i = 0; i < (int)global.report_count; i++) {
+					f = add_field(desc);
+					if (!f) goto error;
+					f->type = type;
+					f->report_id = global.report_id;
+					f->flags = val;
+					f->offset = bits[type][global.report_id] + i * global.report_size;
+					f->size = global.report_size;
+					f->count = 1;
+					f->collection = apps[depth] < 0 ? 0xFFFF : apps[depth];
+					f->logical_min = global.logical_min;
+					f->logical_max = global.logical_max;
+					// bytes like 0xFF mean 255 if the range is not signed
+					if (f->logical_max < f->logical_min) f->logical_max = global.logical_max_raw;
+
+					if (!(val & RAWHID_FIELD_VARIABLE)) {
+						// an array is one field with a range of usages
+						usage = n_usages ? usages[0] : usage_min;
+						f->count = global.report_count;
+						f->usage_page = usage >> 16;
+						f->usage = usage;
+						f->usage_max = n_usages ? usages[n_usages - 1] : usage_max;
+						break;
+					}
+					// a variable per element, the last usage repeats
+					if (n_usages) usage = usages[i < n_usages ? i : n_usages - 1];
+					else usage = usage_min + i > usage_max ? usage_max : usage_min + i;
+					f->usage_page = usage >> 16;
+					f->usage = usage;
+					f->usage_max = usage;
+				}
+			}
+			bits[type][global.report_id] += global.report_size * global.report_count;
+			n_usages = has_range = 0;
+			break;
+		case 0xA0: // Collection
+			if (depth + 1 >= MAX_STACK) goto error;
+			apps[depth + 1] = apps[depth];
+			if (val == 0x01) {
+				// Application
+				c = (rawhid_collection_t *)realloc(desc->collections,
+					(desc->collection_count + 1) * sizeof(rawhid_collection_t));
+				if (!c) goto error;
+				desc->collections = c;
+				usage = n_usages ? usages[0] : usage_min;
+				c[desc->collection_count].usage_page = usage >> 16;
+				c[desc->collection_count].usage = usage;
+				apps[depth + 1] = desc->collection_count++;
+			}
+			depth++;
+			n_usages = has_range = 0;
+			break;
+		case 0xC0: // End Collection
+			if (depth > 0) depth--;
+			n_usages = has_range = 0;
+			break;
+
+		// Global items, HID 1.11, 6.2.2.7
+		case 0x04: global.usage_page = val; break;
+		case 0x14: global.logical_min = sign_extend(val, size); break;
+		case 0x24:
+			global.logical_max = sign_extend(val, size);
+			global.logical_max_raw = val;
+			break;
+		case 0x74: global.report_size = val; break;
+		case 0x84:
+			if (val < 1 || val > 255) goto error;
+			global.report_id = val;
+			desc->report_ids = 1;
+			break;
+		case 0x94: global.report_count = val; break;
+		case 0xA4: // Push
+			if (sp >= MAX_STACK) goto error;
+			stack[sp++] = global;
+			break;
+		case 0xB4: // Pop
+			if (sp <= 0) goto error;
+			global = stack[--sp];
+			break;
+
+		// Local items, HID 1.11, 6.2.2.8, 4 byte usages include the page
+		case 0x08:
+			if (n_usages < MAX_USAGES) {
+				usages[n_usages++] = size == 4 ? val : ((uint32_t)global.usage_page << 16) | val;
+			}
+			break;
+		case 0x18:
+			usage_min = size == 4 ? val : ((uint32_t)global.usage_page << 16) | val;
+			has_range = 1;
+			break;
+		case 0x28:
+			usage_max = size == 4 ? val : ((uint32_t)global.usage_page << 16) | val;
+			has_range = 1;
+			break;
+		}
+	}
+
+	for (type = 0; type < 3; type++) {
+		for (i = 0; i < 256; i++) {
+			desc->report_size[type][i] = (bits[type][i] + 7) / 8;
+		}
+	}
+	return desc->count;
+
+error:
+	rawhid_desc_free(desc);
+	return -1;
+}
+
+//  rawhid_desc_open - parse the descriptor of a device
+//
+//	Inputs:
+//	desc = field table to fill, freed with rawhid_desc_free()
+//	num = device to read from (zero based)
+//	Output:
+//	number of fields, or -1 on error
+//
+int rawhid_desc_open(rawhid_desc_t *desc, int num)
+{
+	uint8_t *buf;
+	int len;
+
+	memset(desc, 0, sizeof(*desc));
+	buf = (uint8_t *)malloc(MAX_DESCRIPTOR);
+	if (!buf) return -1;
+	len = rawhid_get_descriptor(num, buf, MAX_DESCRIPTOR);
+	len = len > 0 ? rawhid_desc_parse(desc, buf, len) : -1;
+	free(buf);
+	return len;
+}
+
+void rawhid_desc_free(rawhid_desc_t *desc)
+{
+	free(desc->fields);
+	free(desc->collections);
+	memset(desc, 0, sizeof(*desc));
+}
+
+int rawhid_desc_find(const rawhid_desc_t *desc, int usage_page, int usage)
+{
+	int i;
+
+	for (i = 0; i < desc->collection_count; i++) {
+		if (desc->collections[i].usage_page == usage_page &&
+			desc->collections[i].usage == usage) return i;
+	}
+	return -1;
+}
+
+int32_t rawhid_field_get(const rawhid_desc_t *desc, const rawhid_field_t *field,
+	const void *report, int index)
+{
+	const uint8_t *p = (const uint8_t *)report + (desc->report_ids ? 1 : 0);
+	uint32_t val = get_bits(p, field->offset + index * field->size, field->size);
+
+	if (field->logical_min < 0 && field->size < 32 && (val >> (field->size - 1)) & 1) {
+		val |= ~0u << field->size;
+	}
+	return (int32_t)val;
+}
+
+//  rawhid_decoder_init - resolve the fields of an input report
+//
+//	Inputs:
+//	decoder = freed with rawhid_decoder_free()
+//	desc = parsed descriptor, only used here
+//	usage_page, usage = the application collection
+//	Output:
+//	0 on success, or -1 if the collection has no known input fields
+//
+int rawhid_decoder_init(rawhid_decoder_t *decoder, const rawhid_desc_t *desc,
+	int usage_page, int usage)
+{
+	const rawhid_field_t *f;
+	int app, i, ok;
+
+	memset(decoder, 0, sizeof(*decoder));
+	decoder->report_id = -1;
+	app = rawhid_desc_find(desc, usage_page, usage);
+	if (app < 0) return -1;
+
+	for (i = 0; i < desc->count; i++) {
+		f = &desc->fields[i];
+		if (f->type != RAWHID_FIELD_INPUT || f->collection != app || f->size > 32) continue;
+		if (decoder->report_id < 0) decoder->report_id = f->report_id;
+		if (f->report_id != decoder->report_id) continue;
+
+		ok = 0;
+		if (f->flags & RAWHID_FIELD_VARIABLE) {
+			if (f->usage_page == 0x09 && f->usage >= 1 && f->usage <= 32 && f->size == 1) {
+				ok = add_slot(decoder, f, SLOT_BUTTONS, f->usage - 1);
+			} else if (f->usage_page == 0x01 && f->usage >= 0x30 && f->usage <= 0x38) {
+				ok = add_slot(decoder, f, SLOT_AXIS, f->usage - 0x30);
+			} else if (f->usage_page == 0x01 && f->usage == 0x39) {
+				// the first two hat switches
+				ok = add_slot(decoder, f, SLOT_HAT, decoder->count && decoder->slots[decoder->count - 1].kind == SLOT_HAT);
+			} else if (f->usage_page == 0x07 && f->usage >= 0xE0 && f->usage <= 0xE7 && f->size == 1) {
+				ok = add_slot(decoder, f, SLOT_MODIFIERS, f->usage - 0xE0);
+			} else if (f->usage_page == 0x07 && f->usage < 0xE0 && f->size == 1) {
+				ok = add_slot(decoder, f, SLOT_KEYBITS, f->usage);
+			}
+		} else if (f->usage_page == 0x07) {
+			ok = add_slot(decoder, f, SLOT_KEYARRAY, f->usage);
+		}
+		if (ok < 0) {
+			rawhid_decoder_free(decoder);
+			return -1;
+		}
+	}
+	if (!decoder->count) {
+		rawhid_decoder_free(decoder);
+		return -1;
+	}
+	decoder->size = desc->report_size[RAWHID_FIELD_INPUT][decoder->report_id] + (desc->report_ids ? 1 : 0);
+	return 0;
+}
+
+//  rawhid_decode - decode a received report
+//
+//	Inputs:
+//	decoder = from rawhid_decoder_init()
+//	report = received report, with the report ID if the device uses IDs
+//	len = length of the report
+//	input = decoded values
+//	Output:
+//	1 if decoded, 0 if it is another report, or -1 if it is too short
+//
+int rawhid_decode(const rawhid_decoder_t *decoder, const void *report, int len,
+	rawhid_input_t *input)
+{
+	const uint8_t *p = (const uint8_t *)report;
+	const rawhid_slot_t *s;
+	uint32_t val, mask;
+	int i, j;
+
+	if (decoder->report_id) {
+		if (len < 1 || p[0] != decoder->report_id) return 0;
+		p++;
+	}
+	if (len < decoder->size) return -1;
+
+	input->report_id = decoder->report_id;
+	if (decoder->keys) {
+		input->modifiers = 0;
+		input->key_count = 0;
+	}
+	for (i = 0; i < decoder->count; i++) {
+		s = &decoder->slots[i];
+		switch (s->kind) {
+		case SLOT_BUTTONS:
+			val = get_bits(p, s->offset, s->count);
+			mask = (s->count < 32 ? (1u << s->count) - 1 : ~0u) << s->index;
+			input->buttons = (input->buttons & ~mask) | ((val << s->index) & mask);
+			break;
+		case SLOT_AXIS:
+			val = get_bits(p, s->offset, s->size);
+			if (s->sign && s->size < 32 && (val >> (s->size - 1)) & 1) val |= ~0u << s->size;
+			input->axis[s->index] = (int32_t)val;
+			break;
+		case SLOT_HAT:
+			input->hat[s->index] = get_bits(p, s->offset, s->size);
+			break;
+		case SLOT_MODIFIERS:
+			input->modifiers |= get_bits(p, s->offset, s->count) << s->index;
+			break;
+		case SLOT_KEYBITS:
+			val = get_bits(p, s->offset, s->count);
+			for (j = 0; val; j++, val >>= 1) {
+				if (val & 1) add_key(input, s->index + j);
+			}
+			break;
+		case SLOT_KEYARRAY:
+			for (j = 0; j < s->count; j++) {
+				val = get_bits(p, s->offset + j * s->size, s->size);
+				if ((int32_t)val < s->min || (int32_t)val > s->max) continue;
+				add_key(input, s->index + val - s->min);
+			}
+			break;
+		}
+	}
+	return 1;
+}
+
+void rawhid_decoder_free(rawhid_decoder_t *decoder)
+{
+	free(decoder->slots);
+	memset(decoder, 0, sizeof(*decoder));
+}
+
+
+// Short items and long items, HID 1.11, 6.2.2.2 and 6.2.2.3. Returns the
+// tag with the type bits (the size bits cleared), long items return 0xFC.
+static int parse_item(const uint8_t **data, const uint8_t *end, uint32_t *val, int *size)
+{
+	const uint8_t *p = *data;
+	const int table[4] = {0, 1, 2, 4};
+	int len;
+
+	if (p >= end) return -1;
+	if (p[0] == 0xFE) {
+		if (p + 3 > end || p + 3 + p[1] > end) return -1;
+		*val = 0;
+		*size = 0;
+		*data += 3 + p[1];
+		return 0xFC;
+	}
+	len = table[p[0] & 0x03];
+	if (p + 1 + len > end) return -1;
+	switch (len) {
+		case 4: *val = p[1] | (p[2] << 8) | (p[3] << 16) | ((uint32_t)p[4] << 24); break;
+		case 2: *val = p[1] | (p[2] << 8); break;
+		case 1: *val = p[1]; break;
+		default: *val = 0; break;
+	}
+	*size = len;
+	*data += 1 + len;
+	return p[0] & 0xFC;
+}
+
+static int32_t sign_extend(uint32_t val, int size)
+{
+	switch (size) {
+		case 1: return (int8_t)val;
+		case 2: return (int16_t)val;
+		default: return (int32_t)val;
+	}
+}
+
+// Reports are little endian bit streams, HID 1.11, 5.8
+static uint32_t get_bits(const uint8_t *report, uint32_t bit, int size)
+{
+	const uint8_t *p = report + (bit >> 3);
+	uint64_t val = 0;
+	int shift = bit & 7, n;
+
+	for (n = 0; n < size + shift; n += 8) {
+		val |= (uint64_t)*p++ << n;
+	}
+	val >>= shift;
+	return size < 32 ? (uint32_t)val & ((1u << size) - 1) : (uint32_t)val;
+}
+
+static rawhid_field_t * add_field(rawhid_desc_t *desc)
+{
+	rawhid_field_t *f;
+	int n;
+
+	if (desc->count == desc->allocated) {
+		n = desc->allocated ? desc->allocated * 2 : 64;
+		f = (rawhid_field_t *)realloc(desc->fields, n * sizeof(rawhid_field_t));
+		if (!f) return NULL;
+		desc->fields = f;
+		desc->allocated = n;
+	}
+	f = &desc->fields[desc->count++];
+	memset(f, 0, sizeof(*f));
+	return f;
+}
+
+// Consecutive bits of buttons, modifiers and key bitmaps are read at once
+static int add_slot(rawhid_decoder_t *decoder, const rawhid_field_t *field, int kind, int index)
+{
+	rawhid_slot_t *s;
+
+	if (decoder->count) {
+		s = &decoder->slots[decoder->count - 1];
+		if ((kind == SLOT_BUTTONS || kind == SLOT_MODIFIERS || kind == SLOT_KEYBITS) &&
+			s->kind == kind && s->count < 32 &&
+			s->offset + s->count == field->offset && s->index + s->count == index) {
+			s->count++;
+			return 1;
+		}
+	}
+	s = (rawhid_slot_t *)realloc(decoder->slots, (decoder->count + 1) * sizeof(rawhid_slot_t));
+	if (!s) return -1;
+	decoder->slots = s;
+	s = &decoder->slots[decoder->count++];
+	s->offset = field->offset;
+	s->size = field->size;
+	s->count = field->count;
+	s->kind = kind;
+	s->sign = field->logical_min < 0;
+	s->index = index;
+	s->min = field->logical_min;
+	s->max = field->logical_max;
+	if (kind >= SLOT_MODIFIERS) decoder->keys = 1;
+	return 1;
+}
+
+// Usages 0 - 3 are no key and the rollover errors
+static void add_key(rawhid_input_t *input, int usage)
+{
+	if (usage >= 0xE0 && usage <= 0xE7) {
+		input->modifiers |= 1 << (usage - 0xE0);
+	} else if (usage > 3 && input->key_count < RAWHID_INPUT_KEYS) {
+		input->keys[input->key_count++] = usage;
+	}
+}
@@ -0,0 +1,117 @@
+
+// HID report descriptor parser and report decoder.
+//
+// rawhid_desc_parse() compiles a report descriptor once into a flat table
+// of fields with their bit offset, size, usage and logical range. A
+// rawhid_decoder_t then picks the fields of one application collection
+// (keyboard, gamepad, mouse) and decodes its input reports straight from
+// the receive buffer into a rawhid_input_t, without looking at the
+// descriptor again.
+//
+// The descriptor is read with rawhid_get_descriptor(), which is not
+// available on Windows (hid.dll only exposes the preparsed data).
+
+#include <stdint.h>
+
+#define RAWHID_FIELD_INPUT	0
+#define RAWHID_FIELD_OUTPUT	1
+#define RAWHID_FIELD_FEATURE	2
+
+// Main item flags of a field, HID 1.11, 6.2.2.5
+#define RAWHID_FIELD_CONSTANT	0x01
+#define RAWHID_FIELD_VARIABLE	0x02
+#define RAWHID_FIELD_RELATIVE	0x04
+
+// Keys of all arrays and bitmaps of a keyboard report
+#define RAWHID_INPUT_KEYS	32
+
+typedef struct {
+	uint8_t type;		// RAWHID_FIELD_INPUT, _OUTPUT or _FEATURE
+	uint8_t report_id;	// 0 without report IDs
+	uint16_t flags;		// main item data
+	uint32_t offset;	// bit offset, after the report ID byte
+	uint16_t size;		// bits of one element
+	uint16_t count;		// elements, 1 for variables
+	uint16_t usage_page;
+	uint16_t usage;		// variables: the usage, arrays: first usage
+	uint16_t usage_max;	// arrays: last usage
+	uint16_t collection;	// index of the application collection, 0xFFFF if none
+	int32_t logical_min;
+	int32_t logical_max;
+} rawhid_field_t;
+
+typedef struct {
+	uint16_t usage_page;
+	uint16_t usage;
+} rawhid_collection_t;
+
+typedef struct {
+	rawhid_field_t *fields;
+	int count;
+	int allocated;
+	int report_ids;		// reports start with their ID
+	rawhid_collection_t *collections;	// application collections
+	int collection_count;
+	// report sizes in bytes by type and ID, without the ID byte
+	uint16_t report_size[3][256];
+} rawhid_desc_t;
+
+// Decoded input report of a keyboard, gamepad or mouse. Members without
+// a field in the report keep their value.
+typedef struct {
+	uint8_t report_id;
+	uint32_t buttons;	// button page, bit 0 is button 1
+	int32_t axis[9];	// generic desktop X, Y, Z, Rx, Ry, Rz, Slider, Dial, Wheel
+	uint8_t hat[2];		// hat switches
+	uint8_t modifiers;	// keyboard modifier bits (0xE0 - 0xE7)
+	uint8_t key_count;	// pressed keys of the keyboard page
+	uint8_t keys[RAWHID_INPUT_KEYS];
+} rawhid_input_t;
+
+// One read of the decoder, resolved from the field table
+typedef struct {
+	uint32_t offset;
+	uint16_t size;
+	uint16_t count;
+	uint8_t kind;
+	uint8_t sign;
+	uint16_t index;		// bit, axis or hat number, or the first key usage
+	int32_t min, max;	// valid array values
+} rawhid_slot_t;
+
+typedef struct {
+	int report_id;
+	int size;		// report bytes, with the ID byte
+	int keys;		// keys and modifiers are reset by every report
+	int count;
+	rawhid_slot_t *slots;
+} rawhid_decoder_t;
+
+// Compiles the descriptor into desc, returns the number of fields or -1
+int rawhid_desc_parse(rawhid_desc_t *desc, const void *data, int len);
+
+// Reads the descriptor of an opened device and parses it
+int rawhid_desc_open(rawhid_desc_t *desc, int num);
+
+void rawhid_desc_free(rawhid_desc_t *desc);
+
+// Index of the application collection with the usage, or -1
+int rawhid_desc_find(const rawhid_desc_t *desc, int usage_page, int usage);
+
+// Extracts element index of a field from a report (with its ID byte).
+// Signed fields (negative logical minimum) are sign extended.
+int32_t rawhid_field_get(const rawhid_desc_t *desc, const rawhid_field_t *field,
+	const void *report, int index);
+
+// Decoder for the input report of an application collection, e.g.
+// 0x01:0x06 keyboard, 0x01:0x05 gamepad, 0x01:0x02 mouse. If the collection
+// spans several reports the first one is used. Returns 0 or -1.
+int rawhid_decoder_init(rawhid_decoder_t *decoder, const rawhid_desc_t *desc,
+	int usage_page, int usage);
+
+// Decodes a received report, returns 1, 0 if it is another report or -1
+// if it is too short
+int rawhid_decode(const rawhid_decoder_t *decoder, const void *report, int len,
+	rawhid_input_t *input);
+
+void rawhid_decoder_free(rawhid_decoder_t *decoder);
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hid.h"
+#include "rawhid_desc.h"
+
+// Prints the field table of a device and decodes its input reports.
+//
+//	rawhid_desc_test [-d usage page:usage] [-c usage page:usage] [-n reports]
+//
+// -d selects the device (top level usage, default the gamepad 1:5), -c the
+// application collection to decode (default the same). A composite HID-Project
+// device is opened by its first collection, e.g. -d 1:2 -c 1:6 for the
+// keyboard of the multi report interface. Use the hidraw backend on Linux
+// to keep the kernel driver attached.
+
+#define MAX_REPORT 512
+
+
+static const char *type_names[3] = {"in", "out", "feat"};
+
+
+int main(int argc, char **argv)
+{
+	int page = 0x01, usage = 0x05, app_page = -1, app_usage = -1, count = 100;
+	int i, n;
+	uint8_t buf[MAX_REPORT];
+	rawhid_desc_t desc;
+	rawhid_decoder_t decoder;
+	rawhid_input_t input;
+	rawhid_field_t *f;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+			if (sscanf(argv[++i], "%x:%x", &page, &usage) != 2) break;
+		} else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+			if (sscanf(argv[++i], "%x:%x", &app_page, &app_usage) != 2) break;
+		} else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+			count = atoi(argv[++i]);
+		} else break;
+	}
+	if (i < argc || count < 0) {
+		printf("usage: %s [-d usage page:usage] [-c usage page:usage] [-n reports]\n", argv[0]);
+		return -1;
+	}
+	if (app_page < 0) {
+		app_page = page;
+		app_usage = usage;
+	}
+
+	if (rawhid_open(1, -1, -1, page, usage) <= 0) {
+		printf("no device %X:%X found\n", page, usage);
+		return -1;
+	}
+	if (rawhid_desc_open(&desc, 0) < 0) {
+		printf("can not read the report descriptor\n");
+		return -1;
+	}
+
+	printf(" type  id  offset  size  count  usage         logical\n");
+	for (i = 0; i < desc.count; i++) {
+		f = &desc.fields[i];
+		printf(" %-4s %3d %7u %5u %6u  %04X:%04X", type_names[f->type], f->report_id,
+			f->offset, f->size, f->count, f->usage_page, f->usage);
+		if (f->usage_max != f->usage) printf("-%04X", f->usage_max);
+		else printf("     ");
+		printf(" %d..%d\n", f->logical_min, f->logical_max);
+	}
+
+	if (rawhid_decoder_init(&decoder, &desc, app_page, app_usage) < 0) {
+		printf("\nno decodable input report in collection %X:%X\n", app_page, app_usage);
+		return -1;
+	}
+	printf("\ndecoding report %d, %d bytes\n", decoder.report_id, decoder.size);
+
+	memset(&input, 0, sizeof(input));
+	while (count--) {
+		n = rawhid_recv(0, buf, sizeof(buf), 1000);
+		if (n < 0) {
+			printf("error reading, device went offline\n");
+			break;
+		}
+		if (rawhid_decode(&decoder, buf, n, &input) <= 0) {
+			count++;
+			continue;
+		}
+		printf("buttons %08X  axes", input.buttons);
+		for (i = 0; i < 9; i++) printf(" %d", input.axis[i]);
+		printf("  hats %d %d  mods %02X  keys", input.hat[0], input.hat[1], input.modifiers);
+		for (i = 0; i < input.key_count; i++) printf(" %02X", input.keys[i]);
+		printf("\n");
+	}
+
+	rawhid_decoder_free(&decoder);
+	rawhid_desc_free(&desc);
+	rawhid_close(0);
+	return 0;
+}
@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+#include <sys/time.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+#include "hid.h"
+#include "rawhid_message.h"
+
+#define MSG_DATA	0x10
+#define MSG_ACK		0x20
+#define MSG_NAK		0x30
+#define MSG_TYPE_MASK	0xF0
+#define MSG_START	0x01
+#define MSG_END		0x02
+#define MSG_CRC		0x04
+#define MSG_PACKED	0x08
+
+#define MAX_DEVICES	16
+#define MAX_REPORT	512
+
+// reports that were not acked are sent again after this time
+#define RETRY_MS	100
+
+typedef struct {
+	uint8_t tx_seq;
+	uint8_t tx_window;
+	uint8_t rx_seq;
+	int rx_synced;
+} msg_state_t;
+
+static msg_state_t states[MAX_DEVICES];
+
+
+static double now_ms(void);
+static uint16_t crc16(uint16_t crc, uint8_t data);
+static uint32_t payload_offset(int report, int packet);
+static int pack(uint8_t *out, int space, const uint8_t *stream, uint32_t start, uint32_t end);
+static void receive_byte(uint8_t *data, uint32_t *off, uint32_t stream, int msg_len, int drop, uint16_t *sum, uint8_t b);
+static int send_ack(int num, int type, int report);
+
+
+int rawhid_msg_send(int num, const void *buf, int len, int report, int options, int timeout)
+{
+	msg_state_t *st;
+	uint8_t out[MAX_REPORT], in[MAX_REPORT];
+	uint8_t *data;
+	uint32_t stream, off, *packed = NULL;
+	uint16_t sum = 0xFFFF;
+	int crc = options & RAWHID_MSG_SEND_CRC;
+	int packets, acked = 0, next = 0, header, i, n, result;
+	uint8_t start, type;
+	double begin, last;
+
+	if (num < 0 || num >= MAX_DEVICES || len < 1 || len > 0xFFFF || report < 8 || report > MAX_REPORT) return -1;
+	st = &states[num];
+	if (!st->tx_window) st->tx_window = 1;
+
+	// the message followed by its CRC
+	data = (uint8_t *)malloc(len + 2);
+	if (!data) return -1;
+	memcpy(data, buf, len);
+	if (crc) {
+		for (i = 0; i < len; i++) sum = crc16(sum, data[i]);
+		data[len] = sum & 0xFF;
+		data[len + 1] = sum >> 8;
+	}
+	stream = len + (crc ? 2 : 0);
+	packets = 1;
+	if (stream > (uint32_t)(report - 4)) packets += (stream - (report - 4) + (report - 3)) / (report - 2);
+
+	// stream offsets of the packed reports, only used if it saves reports
+	if (options & RAWHID_MSG_SEND_PACK) {
+		packed = (uint32_t *)malloc((packets + 1) * sizeof(uint32_t));
+		if (!packed) {
+			free(data);
+			return -1;
+		}
+		for (n = 0, off = 0; off < stream && n < packets; n++) {
+			packed[n] = off;
+			off += pack(NULL, report - (n ? 2 : 4), data, off, stream);
+		}
+		if (n < packets) {
+			packets = n;
+		} else {
+			free(packed);
+			packed = NULL;
+		}
+	}
+	start = st->tx_seq;
+	st->tx_seq += packets;
+
+	begin = last = now_ms();
+	while (acked < packets) {
+		while (next < packets && next - acked < st->tx_window) {
+			memset(out, 0, report);
+			out[0] = MSG_DATA;
+			out[1] = start + next;
+			header = 2;
+			if (!next) {
+				out[0] |= MSG_START | (crc ? MSG_CRC : 0) | (packed ? MSG_PACKED : 0);
+				out[2] = len;
+				out[3] = len >> 8;
+				header = 4;
+			}
+			if (next == packets - 1) out[0] |= MSG_END;
+			if (packed) {
+				memset(out + header, 0x80, report - header);
+				pack(out + header, report - header, data, packed[next], stream);
+			} else {
+				off = payload_offset(report, next);
+				for (i = header; i < report && off < stream; i++, off++) out[i] = data[off];
+			}
+			if (rawhid_send(num, out, report, 100) <= 0) goto offline;
+			next++;
+		}
+
+		n = rawhid_recv(num, in, report, 5);
+		if (n < 0) goto offline;
+		type = n >= 3 ? (in[0] & MSG_TYPE_MASK) : 0;
+		if (type == MSG_DATA && st->rx_synced &&
+		  (uint8_t)(st->rx_seq - in[1] - 1) < RAWHID_MSG_HOST_WINDOW) {
+			// the device did not get our last ack, it waits for it
+			if (send_ack(num, MSG_ACK, report) < 0) goto offline;
+		} else if (type == MSG_ACK || type == MSG_NAK) {
+			// acks outside of the reports in flight are stale
+			int a = acked + (uint8_t)(in[1] - (uint8_t)(start + acked));
+			if (a <= next) {
+				acked = a;
+				st->tx_window = in[2] ? in[2] : 1;
+				last = now_ms();
+				if (type == MSG_NAK) next = acked;
+			}
+		}
+		if (acked < packets && now_ms() - last >= RETRY_MS) {
+			next = acked;
+			last = now_ms();
+		}
+		if (now_ms() - begin >= timeout) {
+			result = 0;
+			goto done;
+		}
+	}
+	result = len;
+	goto done;
+
+offline:
+	result = -1;
+done:
+	free(data);
+	free(packed);
+	return result;
+}
+
+int rawhid_msg_recv(int num, void *buf, int len, int report, int timeout)
+{
+	msg_state_t *st;
+	uint8_t *data = (uint8_t *)buf;
+	uint8_t in[MAX_REPORT];
+	uint32_t stream = 0, off = 0;
+	uint16_t sum = 0xFFFF;
+	int active = 0, nak = 0, unacked = 0, msg_len = 0, has_crc = 0, packed = 0, drop = 0;
+	int n, i, header, remain;
+	uint8_t flags, seq;
+	double begin;
+
+	if (num < 0 || num >= MAX_DEVICES || report < 8 || report > MAX_REPORT) return -1;
+	st = &states[num];
+
+	begin = now_ms();
+	while ((remain = timeout - (int)(now_ms() - begin)) > 0) {
+		n = rawhid_recv(num, in, report, remain);
+		if (n < 0) return -1;
+		if (n < 3 || (in[0] & MSG_TYPE_MASK) != MSG_DATA) continue;
+		flags = in[0];
+		seq = in[1];
+
+		if (st->rx_synced && seq != st->rx_seq) {
+			// sent again after a lost ack
+			if ((uint8_t)(st->rx_seq - seq) <= RAWHID_MSG_HOST_WINDOW) {
+				if (send_ack(num, MSG_ACK, report) < 0) return -1;
+				continue;
+			}
+			// a report is missing, a new start means the device started over
+			if (!(flags & MSG_START)) {
+				if (!nak) {
+					nak = 1;
+					if (send_ack(num, MSG_NAK, report) < 0) return -1;
+				}
+				continue;
+			}
+		}
+
+		header = 2;
+		if (flags & MSG_START) {
+			if (n < 4) continue;
+			msg_len = in[2] | (in[3] << 8);
+			has_crc = flags & MSG_CRC;
+			packed = flags & MSG_PACKED;
+			stream = msg_len + (has_crc ? 2 : 0);
+			sum = 0xFFFF;
+			off = 0;
+			active = 1;
+			drop = msg_len > len;
+			header = 4;
+		} else if (!active) {
+			continue;
+		}
+		st->rx_synced = 1;
+		st->rx_seq = seq + 1;
+		nak = 0;
+
+		for (i = header; i < n; ) {
+			if (!packed) {
+				receive_byte(data, &off, stream, msg_len, drop, &sum, in[i++]);
+			} else if (in[i] < 128) {
+				int literal = in[i++] + 1;
+				for (; literal && i < n; literal--) receive_byte(data, &off, stream, msg_len, drop, &sum, in[i++]);
+			} else if (in[i] > 128 && i + 1 < n) {
+				int run = 257 - in[i];
+				for (; run; run--) receive_byte(data, &off, stream, msg_len, drop, &sum, in[i + 1]);
+				i += 2;
+			} else {
+				i++;
+			}
+		}
+
+		if (flags & MSG_END) {
+			if (send_ack(num, MSG_ACK, report) < 0) return -1;
+			if (off < stream || drop || (has_crc && sum)) return -2;
+			return msg_len;
+		}
+		if (++unacked >= RAWHID_MSG_HOST_WINDOW / 2) {
+			if (send_ack(num, MSG_ACK, report) < 0) return -1;
+			unacked = 0;
+		}
+	}
+	return 0;
+}
+
+// store the message and check the trailing CRC, padding is ignored
+static void receive_byte(uint8_t *data, uint32_t *off, uint32_t stream, int msg_len, int drop, uint16_t *sum, uint8_t b)
+{
+	if (*off >= stream) return;
+	if (*off < (uint32_t)msg_len) {
+		if (!drop) data[*off] = b;
+		*sum = crc16(*sum, b);
+	} else if (*off == (uint32_t)msg_len) {
+		*sum ^= b;
+	} else {
+		*sum ^= b << 8;
+	}
+	(*off)++;
+}
+
+// PackBits coding of as much of the stream as fits into space bytes,
+// returns the number of stream bytes, out may be NULL to count them
+static int pack(uint8_t *out, int space, const uint8_t *stream, uint32_t start, uint32_t end)
+{
+	uint32_t pos = start;
+	int used = 0, run, n, limit;
+
+	while (pos < end && used + 2 <= space) {
+		for (run = 1; run < 128 && pos + run < end && stream[pos + run] == stream[pos]; run++) ;
+		if (run >= 3) {
+			if (out) {
+				out[used] = 257 - run;
+				out[used + 1] = stream[pos];
+			}
+			used += 2;
+			pos += run;
+			continue;
+		}
+		// literals up to the next run of three
+		limit = space - used - 1;
+		if (limit > 128) limit = 128;
+		for (n = 0; n < limit && pos + n < end; n++) {
+			if (pos + n + 2 < end && stream[pos + n] == stream[pos + n + 1] &&
+			  stream[pos + n] == stream[pos + n + 2]) break;
+		}
+		if (out) {
+			out[used] = n - 1;
+			memcpy(out + used + 1, stream + pos, n);
+		}
+		used += n + 1;
+		pos += n;
+	}
+	return pos - start;
+}
+
+static int send_ack(int num, int type, int report)
+{
+	uint8_t out[MAX_REPORT];
+
+	memset(out, 0, report);
+	out[0] = type;
+	out[1] = states[num].rx_seq;
+	out[2] = RAWHID_MSG_HOST_WINDOW;
+	return rawhid_send(num, out, report, 100) <= 0 ? -1 : 0;
+}
+
+// payload offset of a data report, the first one also carries the length
+static uint32_t payload_offset(int report, int packet)
+{
+	return packet ? (report - 4) + (uint32_t)(packet - 1) * (report - 2) : 0;
+}
+
+// CRC-16 with the reflected CCITT polynomial (0x8408), like _crc_ccitt_update() of avr-libc
+static uint16_t crc16(uint16_t crc, uint8_t data)
+{
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	return (((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3);
+}
+
+static double now_ms(void)
+{
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#elif defined(OS_WINDOWS)
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#endif
+}
@@ -0,0 +1,17 @@
+// Framed messages larger than one report, the protocol is described in
+// src/HID-Message.h of the library. report is the RawHID report size.
+
+// Reports the device may send ahead of our acks
+#define RAWHID_MSG_HOST_WINDOW 16
+
+// Options of rawhid_msg_send()
+#define RAWHID_MSG_SEND_CRC	1	// append a CRC-16
+#define RAWHID_MSG_SEND_PACK	2	// run-length coding, if it saves reports
+
+// Returns len, 0 on timeout or -1 if the device went offline
+int rawhid_msg_send(int num, const void *buf, int len, int report, int options, int timeout);
+
+// Returns the message length, 0 on timeout, -1 if the device went offline
+// or -2 if the message was longer than len or its CRC was wrong.
+// Packed messages are unpacked.
+int rawhid_msg_recv(int num, void *buf, int len, int report, int timeout);
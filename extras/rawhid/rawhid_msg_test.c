@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+#include <sys/time.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+#include "hid.h"
+#include "rawhid_message.h"
+
+// Host side of the RawHID message framing, run it against the
+// examples/RawHID/RawHIDMessage sketch.
+//
+//	rawhid_msg_test [-n count] [-s max size] [-r report size] [-c] [-p]
+//
+// Sends messages of doubling length up to the max size, the sketch echoes
+// them back. -c appends a CRC to every message. -p sends runs of equal
+// bytes instead of random data and packs them, the sketch packs its echo.
+
+#define MAX_MESSAGE 65535
+
+
+static double now_us(void);
+
+
+int main(int argc, char **argv)
+{
+	int count = 100, max = 1024, report = 64, options = 0;
+	int length, i, j, k, n, bad;
+	uint8_t *out, *in;
+	double start, us;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) count = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) max = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r") && i + 1 < argc) report = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-c")) options |= RAWHID_MSG_SEND_CRC;
+		else if (!strcmp(argv[i], "-p")) options |= RAWHID_MSG_SEND_PACK;
+		else break;
+	}
+	if (i < argc || count < 1 || max < 1 || max > MAX_MESSAGE || report < 8 || report > 512) {
+		printf("usage: %s [-n count] [-s max size] [-r report size] [-c] [-p]\n", argv[0]);
+		return -1;
+	}
+
+	// Arduino-based example is 0x2341:XXXX:FFC0:0C00
+	if (rawhid_open(1, -1, -1, 0xFFC0, 0x0C00) <= 0) {
+		printf("no rawhid device found\n");
+		return -1;
+	}
+	out = (uint8_t *)malloc(max);
+	in = (uint8_t *)malloc(max);
+	if (!out || !in) return -1;
+	printf("found rawhid device, %d byte reports, %d runs%s%s\n\n", report, count,
+		(options & RAWHID_MSG_SEND_CRC) ? ", crc" : "", (options & RAWHID_MSG_SEND_PACK) ? ", packed" : "");
+
+	printf(" length  echo KB/s   bad\n");
+	for (length = 1; ; length *= 2) {
+		if (length > max) length = max;
+		start = now_us();
+		for (i = 0, bad = 0; i < count; i++) {
+			if (options & RAWHID_MSG_SEND_PACK) {
+				for (j = 0; j < length; ) {
+					n = rand() % 32 + 1;
+					for (k = rand(); n && j < length; n--) out[j++] = k;
+				}
+			} else {
+				for (j = 0; j < length; j++) out[j] = rand();
+			}
+			if (rawhid_msg_send(0, out, length, report, options, 1000) <= 0) goto offline;
+			n = rawhid_msg_recv(0, in, max, report, 1000);
+			if (n == -1) goto offline;
+			if (n != length || memcmp(in, out, length)) bad++;
+		}
+		us = now_us() - start;
+		printf("%7d %10.1f %5d\n", length, 2.0 * length * count / us * 1000000.0 / 1024.0, bad);
+		if (length == max) break;
+	}
+	free(out);
+	free(in);
+	rawhid_close(0);
+	return 0;
+
+offline:
+	printf("\nerror, device went offline or timed out\n");
+	rawhid_close(0);
+	return -1;
+}
+
+static double now_us(void)
+{
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#elif defined(OS_WINDOWS)
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000000.0 / (double)freq.QuadPart;
+#endif
+}
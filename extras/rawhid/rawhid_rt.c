@@ -0,0 +1,221 @@
+#if defined(OS_LINUX)
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "hid.h"
+#include "rawhid_rt.h"
+
+#define MAX_DEVICES	16
+#define DEFAULT_PACKETS	256
+
+// timeout of the sleeping receive, to see a stop request
+#define WAIT_MS		100
+
+typedef struct {
+	pthread_t thread;
+	int num;
+	int len;
+	int busy_poll;
+	// the ring, the thread writes head and the application tail
+	uint8_t *data;
+	int *lengths;
+	uint64_t *times;
+	unsigned int mask;
+	unsigned int head;
+	unsigned int tail;
+	int dropped;
+	int offline;
+	int stop;
+} rt_state_t;
+
+static rt_state_t *states[MAX_DEVICES];
+
+
+static void * receive_loop(void *arg);
+static uint64_t now_ns(void);
+static void rt_free(rt_state_t *rt);
+
+
+int rawhid_rt_start(int num, int len, const rawhid_rt_options_t *options)
+{
+	rawhid_rt_options_t defaults = {0, -1, 0, 0};
+	pthread_attr_t attr;
+	struct sched_param param;
+	rt_state_t *rt;
+	int packets, result = 1;
+
+	if (num < 0 || num >= MAX_DEVICES || states[num] || len < 1) return -1;
+	if (!options) options = &defaults;
+#if defined(OS_LINUX) && !defined(RAWHID_HIDRAW)
+	// libusb waits without limit for a timeout of 0
+	if (options->busy_poll) return -1;
+#endif
+	packets = options->packets ? options->packets : DEFAULT_PACKETS;
+	if (packets & (packets - 1)) return -1;
+
+	rt = (rt_state_t *)calloc(1, sizeof(rt_state_t));
+	if (!rt) return -1;
+	rt->num = num;
+	rt->len = len;
+	rt->busy_poll = options->busy_poll;
+	rt->mask = packets - 1;
+	rt->data = (uint8_t *)malloc((size_t)packets * len);
+	rt->lengths = (int *)malloc(packets * sizeof(int));
+	rt->times = (uint64_t *)malloc(packets * sizeof(uint64_t));
+	if (!rt->data || !rt->lengths || !rt->times) {
+		rt_free(rt);
+		return -1;
+	}
+	// no page faults in the receive path
+	memset(rt->data, 0, (size_t)packets * len);
+	memset(rt->lengths, 0, packets * sizeof(int));
+	memset(rt->times, 0, packets * sizeof(uint64_t));
+
+	// realtime scheduling is set at creation, without the permission
+	// the thread runs with the normal scheduling
+	pthread_attr_init(&attr);
+	if (options->priority > 0) {
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = options->priority;
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &param);
+	}
+	if (pthread_create(&rt->thread, &attr, receive_loop, rt) != 0) {
+		pthread_attr_destroy(&attr);
+		if (options->priority <= 0 || pthread_create(&rt->thread, NULL, receive_loop, rt) != 0) {
+			rt_free(rt);
+			return -1;
+		}
+		result = 0;
+	} else {
+		pthread_attr_destroy(&attr);
+	}
+
+	if (options->cpu >= 0) {
+#if defined(OS_LINUX)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(options->cpu, &set);
+		if (pthread_setaffinity_np(rt->thread, sizeof(set), &set) != 0) result = 0;
+#else
+		result = 0;
+#endif
+	}
+	states[num] = rt;
+	return result;
+}
+
+int rawhid_rt_recv(int num, void *buf, int len, uint64_t *time)
+{
+	const void *p;
+	int n;
+
+	n = rawhid_rt_peek(num, &p, time);
+	if (n <= 0) return n;
+	if (n > len) n = len;
+	memcpy(buf, p, n);
+	rawhid_rt_release(num);
+	return n;
+}
+
+int rawhid_rt_peek(int num, const void **buf, uint64_t *time)
+{
+	rt_state_t *rt;
+	unsigned int tail, slot;
+
+	if (num < 0 || num >= MAX_DEVICES || !(rt = states[num])) return -1;
+	tail = rt->tail;
+	if (__atomic_load_n(&rt->head, __ATOMIC_ACQUIRE) == tail) {
+		// the thread stores its last packet before it goes offline
+		if (__atomic_load_n(&rt->offline, __ATOMIC_ACQUIRE) &&
+		  __atomic_load_n(&rt->head, __ATOMIC_ACQUIRE) == tail) return -1;
+		return 0;
+	}
+	slot = tail & rt->mask;
+	*buf = rt->data + (size_t)slot * rt->len;
+	if (time) *time = rt->times[slot];
+	return rt->lengths[slot];
+}
+
+void rawhid_rt_release(int num)
+{
+	rt_state_t *rt;
+
+	if (num < 0 || num >= MAX_DEVICES || !(rt = states[num])) return;
+	if (__atomic_load_n(&rt->head, __ATOMIC_ACQUIRE) == rt->tail) return;
+	__atomic_store_n(&rt->tail, rt->tail + 1, __ATOMIC_RELEASE);
+}
+
+int rawhid_rt_dropped(int num)
+{
+	if (num < 0 || num >= MAX_DEVICES || !states[num]) return 0;
+	return __atomic_load_n(&states[num]->dropped, __ATOMIC_RELAXED);
+}
+
+void rawhid_rt_stop(int num)
+{
+	rt_state_t *rt;
+
+	if (num < 0 || num >= MAX_DEVICES || !(rt = states[num])) return;
+	__atomic_store_n(&rt->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(rt->thread, NULL);
+	states[num] = NULL;
+	rt_free(rt);
+}
+
+static void * receive_loop(void *arg)
+{
+	rt_state_t *rt = (rt_state_t *)arg;
+	unsigned int head, slot;
+	uint8_t *buf;
+	int n, timeout = rt->busy_poll ? 0 : WAIT_MS;
+
+	head = rt->head;
+	while (!__atomic_load_n(&rt->stop, __ATOMIC_ACQUIRE)) {
+		// a full ring drops the newest packets, the application
+		// still gets the packets in order
+		slot = head & rt->mask;
+		buf = rt->data + (size_t)slot * rt->len;
+		if (head - __atomic_load_n(&rt->tail, __ATOMIC_ACQUIRE) > rt->mask) {
+			uint8_t scratch[512];
+			n = rawhid_recv(rt->num, scratch, rt->len < 512 ? rt->len : 512, timeout);
+			if (n > 0) __atomic_fetch_add(&rt->dropped, 1, __ATOMIC_RELAXED);
+		} else {
+			n = rawhid_recv(rt->num, buf, rt->len, timeout);
+			if (n > 0) {
+				rt->lengths[slot] = n;
+				rt->times[slot] = now_ns();
+				__atomic_store_n(&rt->head, ++head, __ATOMIC_RELEASE);
+			}
+		}
+		if (n < 0) {
+			__atomic_store_n(&rt->offline, 1, __ATOMIC_RELEASE);
+			break;
+		}
+	}
+	return NULL;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void rt_free(rt_state_t *rt)
+{
+	free(rt->data);
+	free(rt->lengths);
+	free(rt->times);
+	free(rt);
+}
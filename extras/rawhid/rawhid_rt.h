@@ -0,0 +1,33 @@
+// Low latency receiving with a dedicated thread per device (Linux and macOS).
+// The thread receives with rawhid_recv() and hands the packets to the
+// application through a lock-free single producer, single consumer ring,
+// the application only reads it and never waits for the thread.
+
+#include <stdint.h>
+
+typedef struct {
+	int priority;	// SCHED_FIFO priority 1 - 99, 0 keeps the normal scheduling
+	int cpu;	// CPU the thread is pinned to, -1 for any (Linux only)
+	int busy_poll;	// spin on rawhid_recv() instead of sleeping in the OS,
+			// needs the hidraw backend on Linux (make BACKEND=hidraw)
+	int packets;	// size of the ring, a power of two, 0 for 256
+} rawhid_rt_options_t;
+
+// Starts the receive thread for packets of up to len bytes. Returns 1, 0 if
+// the thread runs without the requested priority or CPU (the priority needs
+// CAP_SYS_NICE or an rtprio limit), or -1 on errors.
+int rawhid_rt_start(int num, int len, const rawhid_rt_options_t *options);
+
+// The next packet and the CLOCK_MONOTONIC time it was received in ns (time
+// may be NULL). Returns the length, 0 if the ring is empty or -1 if the
+// device went offline and all packets were read. Never blocks.
+int rawhid_rt_recv(int num, void *buf, int len, uint64_t *time);
+
+// The next packet without copying it, valid until rawhid_rt_release()
+int rawhid_rt_peek(int num, const void **buf, uint64_t *time);
+void rawhid_rt_release(int num);
+
+// Packets lost because the ring was full
+int rawhid_rt_dropped(int num);
+
+void rawhid_rt_stop(int num);
@@ -0,0 +1,41 @@
+// Traces of timestamped reports, the format is described in src/HID-Replay.h
+// of the library. All numbers are little endian.
+
+#include <stdint.h>
+
+#define RAWHID_TRACE_MAGIC	"HIDT"
+#define RAWHID_TRACE_VERSION	1
+#define RAWHID_TRACE_HEADER	8	// magic, version, 3 reserved bytes
+#define RAWHID_TRACE_RECORD	6	// delay in us, type, length
+
+// Record types, the same as HID_BRIDGE_* in src/HID-Bridge.h
+#define RAWHID_TRACE_KEYBOARD	3
+#define RAWHID_TRACE_MOUSE	4
+#define RAWHID_TRACE_CONSUMER	5
+#define RAWHID_TRACE_GAMEPAD	6
+#define RAWHID_TRACE_RAWHID	7
+
+typedef struct {
+	uint32_t delay;		// us after the previous record
+	uint8_t type;
+	uint8_t len;
+	const uint8_t *data;
+} rawhid_trace_record_t;
+
+// Next record of a trace in memory (like mmap()ed), pos starts behind the
+// header. Returns 1 and advances pos, 0 at the end or -1 if the last record
+// was cut off.
+static inline int rawhid_trace_next(const uint8_t *trace, long size, long *pos, rawhid_trace_record_t *r)
+{
+	const uint8_t *p = trace + *pos;
+	long left = size - *pos;
+
+	if (left <= 0) return 0;
+	if (left < RAWHID_TRACE_RECORD || left < RAWHID_TRACE_RECORD + p[5]) return -1;
+	r->delay = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+	r->type = p[4];
+	r->len = p[5];
+	r->data = p + RAWHID_TRACE_RECORD;
+	*pos += RAWHID_TRACE_RECORD + r->len;
+	return 1;
+}
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# Size benchmark of the examples, run it from anywhere with arduino-cli installed
+# and the avr, sam and samd cores set up (arduino-cli core install arduino:avr ...).
+#
+#	size_matrix.py [-b fqbn] [-D NAME=VALUE] [-o sizes.json] [-c old.json] [example ...]
+#
+# Every example is built for every board and the flash, static RAM and the largest
+# stack frame (gcc -fstack-usage, the stack high-water mark of a single function)
+# are tabulated as markdown. Save the result with -o and pass it with -c to a
+# later run to see the size change of every build.
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+BOARDS = [
+	"arduino:avr:leonardo",
+	"arduino:sam:arduino_due_x",
+	"arduino:samd:arduino_zero_native",
+]
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+
+
+def find_examples(names):
+	sketches = sorted(glob.glob(os.path.join(ROOT, "examples", "**", "*.ino"), recursive=True))
+	examples = [os.path.dirname(s) for s in sketches]
+	if names:
+		examples = [e for e in examples if os.path.basename(e) in names]
+	return examples
+
+
+def section(sections, name):
+	for s in sections:
+		if s.get("name") == name:
+			return s.get("size", 0)
+	return None
+
+
+def max_frame(build):
+	# Only frames of the library count, the core is the same for every example
+	frame = 0
+	for su in glob.glob(os.path.join(build, "libraries", "**", "*.su"), recursive=True):
+		with open(su) as f:
+			for line in f:
+				fields = line.split("\t")
+				if len(fields) >= 2 and fields[1].isdigit():
+					frame = max(frame, int(fields[1]))
+	return frame
+
+
+def build(example, fqbn, defines):
+	flags = "-fstack-usage " + " ".join("-D" + d for d in defines)
+	with tempfile.TemporaryDirectory() as path:
+		cmd = ["arduino-cli", "compile", "--format", "json", "-b", fqbn,
+			"--library", ROOT, "--build-path", path,
+			"--build-property", "compiler.cpp.extra_flags=" + flags,
+			"--build-property", "compiler.c.extra_flags=" + flags,
+			example]
+		out = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+		try:
+			result = json.loads(out.stdout)
+		except ValueError:
+			return None
+		if not result.get("success", False):
+			return None
+		sections = result.get("builder_result", result).get("executable_sections_size") or []
+		return {
+			"flash": section(sections, "text"),
+			"ram": section(sections, "data"),
+			"stack": max_frame(path),
+		}
+
+
+def cell(value, old):
+	if value is None:
+		return "-"
+	if old is None or old == value:
+		return str(value)
+	return "%d (%+d)" % (value, value - old)
+
+
+def main():
+	parser = argparse.ArgumentParser(description="Flash, RAM and stack size of every example")
+	parser.add_argument("-b", "--board", action="append", help="fqbn to build for, can be repeated")
+	parser.add_argument("-D", "--define", action="append", default=[], help="extra define, like HID_STATS=1")
+	parser.add_argument("-o", "--output", help="save the sizes as json")
+	parser.add_argument("-c", "--compare", help="sizes of an earlier run")
+	parser.add_argument("examples", nargs="*", help="example names, default all")
+	args = parser.parse_args()
+
+	boards = args.board or BOARDS
+	old = {}
+	if args.compare:
+		with open(args.compare) as f:
+			old = json.load(f)
+
+	sizes = {}
+	for fqbn in boards:
+		sizes[fqbn] = {}
+		print("\n### %s\n" % fqbn)
+		print("| Example | Flash | RAM | Max stack frame |")
+		print("|---|---:|---:|---:|")
+		for example in find_examples(args.examples):
+			name = os.path.relpath(example, os.path.join(ROOT, "examples"))
+			size = build(example, fqbn, args.define)
+			sizes[fqbn][name] = size
+			prev = old.get(fqbn, {}).get(name) or {}
+			if size is None:
+				print("| %s | failed | | |" % name)
+			else:
+				print("| %s | %s | %s | %s |" % (name,
+					cell(size["flash"], prev.get("flash")),
+					cell(size["ram"], prev.get("ram")),
+					cell(size["stack"], prev.get("stack"))))
+			sys.stdout.flush()
+
+	if args.output:
+		with open(args.output, "w") as f:
+			json.dump(sizes, f, indent=1, sort_keys=True)
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include <Arduino.h>
 #include "HID-Settings.h"
+#include "../HID-Descriptor.h"
 
 #define MOUSE_LEFT		(1 << 0)
 #define MOUSE_RIGHT		(1 << 1)
@@ -50,19 +51,62 @@ typedef union ATTRIBUTE_PACKED {
 	};
 } HID_MouseAbsoluteReport_Data_t;
 
+// Report descriptor of the multi report absolute mouse
+template<uint8_t ReportID>
+using HIDAbsoluteMouseDescriptor = HIDItems<
+	HIDUsagePage<0x01>,									/* USAGE_PAGE (Generic Desktop) */
+	HIDUsage<0x02>,										/* USAGE (Mouse) */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		/* 8 Buttons */
+		HIDUsagePage<0x09>,								/*   USAGE_PAGE (Button) */
+		HIDUsageMinimum<1>,
+		HIDUsageMaximum<8>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<1>,
+		HIDReportCount<8>,
+		HIDReportSize<1>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		/* X, Y */
+		HIDUsagePage<0x01>,								/*   USAGE_PAGE (Generic Desktop) */
+		HIDUsage<0x30>,									/*   USAGE (X) */
+		HIDUsage<0x31>,									/*   USAGE (Y) */
+		HIDReportDescriptor<0x16, 0x00, 0x00>,			/*   LOGICAL_MINIMUM (0), NOTE: Windows 7 can't handle negative values */
+		HIDLogicalMaximum<32767>,
+		HIDReportSize<16>,
+		HIDReportCount<2>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		/* Wheel */
+		HIDUsage<0x38>,									/*   USAGE (Wheel) */
+		HIDLogicalMinimum<-127>,
+		HIDLogicalMaximum<127>,
+		HIDReportSize<8>,
+		HIDReportCount<1>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_RELATIVE>
+	>
+>;
 
-class AbsoluteMouseAPI
+
+template<class Transport>
+class StaticAbsoluteMouseAPI
 {
 protected:
+	// The transport is bound at compile time, no virtual call is needed
+	Transport& transport(void) { return *static_cast<Transport*>(this); }
+
 	int16_t xAxis;
 	int16_t yAxis;
 	uint8_t _buttons;
+	bool _coalescing;
+	bool _pending;
+	int16_t _pendingWheel;
 	inline void buttons(uint8_t b);
+	inline void sendPending(void);
 
 	inline int16_t qadd16(int16_t base, int16_t increment);
 
 public:
-	inline AbsoluteMouseAPI(void);
+	inline StaticAbsoluteMouseAPI(void);
 	inline void begin(void);
 	inline void end(void);
 
@@ -74,8 +118,29 @@ public:
 	inline void releaseAll(void);
 	inline bool isPressed(uint8_t b = MOUSE_LEFT);
 
+	// Position of the last moveTo()
+	inline int16_t getX(void);
+	inline int16_t getY(void);
+
+	// Coalescing keeps only the latest position until the endpoint is ready for the next report.
+	// Call flush() to send the pending position, if the device cannot tell.
+	inline void setCoalescing(bool enable);
+	inline bool flush(void);
+
+	// Default of the transport, see AbsoluteMouseAPI
+	bool ReadyToSend(void) { return false; }
+};
+
+// Sends through virtual functions, the base of the HID-Project devices.
+// Derive from StaticAbsoluteMouseAPI<Transport> instead to bind the transport at compile time.
+class AbsoluteMouseAPI : public StaticAbsoluteMouseAPI<AbsoluteMouseAPI>
+{
+public:
 	// Sending is public in the base class for advanced users.
 	virtual void SendReport(void* data, int length) = 0;
+
+	// Returns true if a report can be sent without blocking
+	virtual bool ReadyToSend(void) { return false; }
 };
 
 // Implementation is inline
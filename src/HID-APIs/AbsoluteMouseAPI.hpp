@@ -24,14 +24,17 @@ THE SOFTWARE.
 // Include guard
 #pragma once
 
-void AbsoluteMouseAPI::buttons(uint8_t b){
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::buttons(uint8_t b){
+	// Button changes are never coalesced
 	if (b != _buttons){
 		_buttons = b;
-		moveTo(xAxis, yAxis, 0);
+		sendPending();
 	}
 }
 
-int16_t AbsoluteMouseAPI::qadd16(int16_t base, int16_t increment) {
+template<class Transport>
+int16_t StaticAbsoluteMouseAPI<Transport>::qadd16(int16_t base, int16_t increment) {
 	// Separate between subtracting and adding
 	if (increment < 0) {
 		// Subtracting more would cause an undefined overflow
@@ -50,64 +53,115 @@ int16_t AbsoluteMouseAPI::qadd16(int16_t base, int16_t increment) {
 	return base;
 }
 
-AbsoluteMouseAPI::AbsoluteMouseAPI(void):
-xAxis(0), yAxis(0), _buttons(0)
+template<class Transport>
+StaticAbsoluteMouseAPI<Transport>::StaticAbsoluteMouseAPI(void):
+xAxis(0), yAxis(0), _buttons(0), _coalescing(false), _pending(false), _pendingWheel(0)
 {
 	// Empty
 }
 
-void AbsoluteMouseAPI::begin(void){
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::begin(void){
 	// release all buttons
 	end();
 }
 
-void AbsoluteMouseAPI::end(void){
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::end(void){
 	_buttons = 0;
-	moveTo(xAxis, yAxis, 0);
+	_pendingWheel = 0;
+	sendPending();
 }
 
-void AbsoluteMouseAPI::click(uint8_t b){
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::click(uint8_t b){
 	_buttons = b;
-	moveTo(xAxis, yAxis, 0);
+	sendPending();
 	_buttons = 0;
-	moveTo(xAxis, yAxis, 0);
+	sendPending();
 }
 
-void AbsoluteMouseAPI::moveTo(int x, int y, signed char wheel){
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::moveTo(int x, int y, signed char wheel){
 	xAxis = x;
 	yAxis = y;
+	_pendingWheel = qadd16(_pendingWheel, wheel);
+	_pending = true;
+
+	if (!_coalescing || transport().ReadyToSend()) {
+		sendPending();
+	}
+}
+
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::sendPending(void){
 	HID_MouseAbsoluteReport_Data_t report;
 	report.buttons = _buttons;
 	// The range -32768...32767 is converted to 0...32767 because Windows 7
 	// does not support negative coordinates.
 	// Negative values are supported here for API compatibility reasons to keep (0,0) as a center of screen.
 	// See detauls in AbsoluteMouse sources and here: https://github.com/NicoHood/HID/pull/306
-	report.xAxis = ((int32_t)x + 32768) / 2;
-	report.yAxis = ((int32_t)y + 32768) / 2;
-	report.wheel = wheel;
-	SendReport(&report, sizeof(report));
+	report.xAxis = ((int32_t)xAxis + 32768) / 2;
+	report.yAxis = ((int32_t)yAxis + 32768) / 2;
+	// Send as much of the pending wheel movement as fits into one report
+	report.wheel = constrain(_pendingWheel, -127, 127);
+	_pendingWheel -= report.wheel;
+	_pending = _pendingWheel;
+	transport().SendReport(&report, sizeof(report));
+}
+
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::setCoalescing(bool enable){
+	_coalescing = enable;
+	if (!enable) {
+		while (flush());
+	}
 }
 
-void AbsoluteMouseAPI::move(int x, int y, signed char wheel){
+template<class Transport>
+bool StaticAbsoluteMouseAPI<Transport>::flush(void){
+	if (!_pending) {
+		return false;
+	}
+	sendPending();
+	return true;
+}
+
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::move(int x, int y, signed char wheel){
 	moveTo(qadd16(xAxis, x), qadd16(yAxis, y), wheel);
 }
 
-void AbsoluteMouseAPI::press(uint8_t b){
+template<class Transport>
+int16_t StaticAbsoluteMouseAPI<Transport>::getX(void){
+	return xAxis;
+}
+
+template<class Transport>
+int16_t StaticAbsoluteMouseAPI<Transport>::getY(void){
+	return yAxis;
+}
+
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::press(uint8_t b){
 	// press LEFT by default
 	buttons(_buttons | b);
 }
 
-void AbsoluteMouseAPI::release(uint8_t b){
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::release(uint8_t b){
 	// release LEFT by default
 	buttons(_buttons & ~b);
 }
 
-void AbsoluteMouseAPI::releaseAll(void){
+template<class Transport>
+void StaticAbsoluteMouseAPI<Transport>::releaseAll(void){
 	_buttons = 0;
-	moveTo(xAxis, yAxis, 0);
+	sendPending();
 }
 
-bool AbsoluteMouseAPI::isPressed(uint8_t b){
+template<class Transport>
+bool StaticAbsoluteMouseAPI<Transport>::isPressed(uint8_t b){
 	// check LEFT by default
 	if ((b & _buttons) > 0)
 		return true;
@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include <Arduino.h>
 #include "HID-Settings.h"
+#include "../HID-Descriptor.h"
 
 enum ConsumerKeycode : uint16_t {
 	// Some keys might only work with linux
@@ -465,22 +466,71 @@ typedef union ATTRIBUTE_PACKED {
 	};
 } HID_ConsumerControlReport_Data_t;
 
-class ConsumerAPI
+// Keys which can be pressed at the same time
+#define HID_CONSUMER_SLOTS HID_COUNT_OF(HID_ConsumerControlReport_Data_t, keys)
+
+// Report descriptor, report ID 0 for the single report device
+template<uint8_t ReportID>
+using HIDConsumerDescriptor = HIDItems<
+	HIDUsagePage<0x0C>,									/* usage page (consumer device) */
+	HIDUsage<0x01>,										/* usage -- consumer control */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		/* 4 Media Keys */
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<0x3FF>,
+		HIDUsageMinimum<0>,
+		HIDUsageMaximum<0x3FF>,
+		HIDReportCount<HID_COUNT_OF(HID_ConsumerControlReport_Data_t, keys)>,
+		HIDReportSize<sizeof(ConsumerKeycode) * 8>,
+		HIDInput<HID_DATA | HID_ARRAY | HID_ABSOLUTE>
+	>
+>;
+
+template<class Transport>
+class StaticConsumerAPI
 {
 public:
-	inline ConsumerAPI(void);
+	inline StaticConsumerAPI(void);
 	inline void begin(void);
 	inline void end(void);
 	inline void write(ConsumerKeycode m);
-	inline void press(ConsumerKeycode m);
-	inline void release(ConsumerKeycode m);
-	inline void releaseAll(void);
 
-	// Sending is public in the base class for advanced users.
-	virtual void SendReport(void* data, int length) = 0;
+	// Return 0 if all slots are in use, the key is not pressed then
+	inline size_t press(ConsumerKeycode m);
+	inline size_t release(ConsumerKeycode m);
+	inline size_t releaseAll(void);
+
+	// Change the keys without sending, send() reports them together
+	inline size_t add(ConsumerKeycode m);
+	inline size_t remove(ConsumerKeycode m);
+	inline size_t removeAll(void);
+
+	// Returns false if nothing changed since the last report
+	inline bool send(void);
+
+	inline bool isPressed(ConsumerKeycode m);
 
 protected:
+	// The transport is bound at compile time, no virtual call is needed
+	Transport& transport(void) { return *static_cast<Transport*>(this); }
+
+	inline uint8_t find(ConsumerKeycode m);
+
 	HID_ConsumerControlReport_Data_t _report;
+
+	// Bit n is set if keys[n] is in use
+	uint8_t _slots;
+	bool _changed;
+};
+
+// Sends through virtual functions, the base of the HID-Project devices.
+// Derive from StaticConsumerAPI<Transport> instead to bind the transport at compile time.
+class ConsumerAPI : public StaticConsumerAPI<ConsumerAPI>
+{
+public:
+	// Sending is public in the base class for advanced users.
+	virtual void SendReport(void* data, int length) = 0;
 };
 
 // Implementation is inline
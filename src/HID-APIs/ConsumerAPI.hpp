@@ -24,48 +24,118 @@ THE SOFTWARE.
 // Include guard
 #pragma once
 
-ConsumerAPI::ConsumerAPI(void)
+template<class Transport>
+StaticConsumerAPI<Transport>::StaticConsumerAPI(void) : _slots(0), _changed(false)
 {
-	// Empty
+	memset(&_report, 0, sizeof(_report));
 }
 
-void ConsumerAPI::begin(void) {
+template<class Transport>
+void StaticConsumerAPI<Transport>::begin(void) {
 	// release all buttons
 	end();
 }
 
-void ConsumerAPI::end(void) {
-	memset(&_report, 0, sizeof(_report));
-	SendReport(&_report, sizeof(_report));
+template<class Transport>
+void StaticConsumerAPI<Transport>::end(void) {
+	// Always sends a clean report
+	removeAll();
+	_changed = true;
+	send();
 }
 
-void ConsumerAPI::write(ConsumerKeycode m) {
+template<class Transport>
+void StaticConsumerAPI<Transport>::write(ConsumerKeycode m) {
 	press(m);
 	release(m);
 }
 
-void ConsumerAPI::press(ConsumerKeycode m) {
-	// search for a free spot
-	for (uint8_t i = 0; i < sizeof(HID_ConsumerControlReport_Data_t) / 2; i++) {
-		if (_report.keys[i] == HID_CONSUMER_UNASSIGNED) {
-			_report.keys[i] = m;
-			break;
+template<class Transport>
+uint8_t StaticConsumerAPI<Transport>::find(ConsumerKeycode m) {
+	// Only the slots in use are compared
+	for (uint8_t i = 0, slots = _slots; slots; i++, slots >>= 1) {
+		if ((slots & 1) && _report.keys[i] == m) {
+			return i;
 		}
 	}
-	SendReport(&_report, sizeof(_report));
+	return HID_CONSUMER_SLOTS;
 }
 
-void ConsumerAPI::release(ConsumerKeycode m) {
-	// search and release the keypress
-	for (uint8_t i = 0; i < sizeof(HID_ConsumerControlReport_Data_t) / 2; i++) {
-		if (_report.keys[i] == m) {
-			_report.keys[i] = HID_CONSUMER_UNASSIGNED;
-			// no break to delete multiple keys
-		}
+template<class Transport>
+size_t StaticConsumerAPI<Transport>::add(ConsumerKeycode m) {
+	if (m == HID_CONSUMER_UNASSIGNED) {
+		return 0;
+	}
+	if (find(m) < HID_CONSUMER_SLOTS) {
+		return 1;
+	}
+
+	// The lowest free slot, none left is an overflow
+	uint8_t free = ~_slots & ((1 << HID_CONSUMER_SLOTS) - 1);
+	if (!free) {
+		return 0;
 	}
-	SendReport(&_report, sizeof(_report));
+	uint8_t slot = __builtin_ctz(free);
+	_slots |= 1 << slot;
+	_report.keys[slot] = m;
+	_changed = true;
+	return 1;
 }
 
-void ConsumerAPI::releaseAll(void) {
-	end();
+template<class Transport>
+size_t StaticConsumerAPI<Transport>::remove(ConsumerKeycode m) {
+	uint8_t slot = find(m);
+	if (slot >= HID_CONSUMER_SLOTS) {
+		return 0;
+	}
+	_slots &= ~(1 << slot);
+	_report.keys[slot] = HID_CONSUMER_UNASSIGNED;
+	_changed = true;
+	return 1;
+}
+
+template<class Transport>
+size_t StaticConsumerAPI<Transport>::removeAll(void) {
+	if (_slots) {
+		memset(&_report, 0, sizeof(_report));
+		_slots = 0;
+		_changed = true;
+	}
+	return 1;
+}
+
+template<class Transport>
+bool StaticConsumerAPI<Transport>::send(void) {
+	if (!_changed) {
+		return false;
+	}
+	_changed = false;
+	transport().SendReport(&_report, sizeof(_report));
+	return true;
+}
+
+template<class Transport>
+size_t StaticConsumerAPI<Transport>::press(ConsumerKeycode m) {
+	size_t ret = add(m);
+	send();
+	return ret;
+}
+
+template<class Transport>
+size_t StaticConsumerAPI<Transport>::release(ConsumerKeycode m) {
+	size_t ret = remove(m);
+	send();
+	return ret;
+}
+
+template<class Transport>
+size_t StaticConsumerAPI<Transport>::releaseAll(void) {
+	size_t ret = removeAll();
+	send();
+	return ret;
+}
+
+template<class Transport>
+bool StaticConsumerAPI<Transport>::isPressed(ConsumerKeycode m) {
+	return find(m) < HID_CONSUMER_SLOTS;
 }
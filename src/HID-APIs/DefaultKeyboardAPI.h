@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include "KeyboardAPI.h"
 #include "ConsumerAPI.h"
+#include "../HID-Descriptor.h"
 
 typedef union ATTRIBUTE_PACKED {
 	// Low level key report: up to 6 keys and shift, ctrl etc at once
@@ -40,10 +41,61 @@ typedef union ATTRIBUTE_PACKED {
 	uint8_t keys[8];
 } HID_KeyboardReport_Data_t;
 
+// Report descriptor of the multi report keyboard, without LEDs
+template<uint8_t ReportID>
+using HIDKeyboardDescriptor = HIDItems<
+	HIDUsagePage<0x01>,									/* USAGE_PAGE (Generic Desktop) */
+	HIDUsage<0x06>,										/* USAGE (Keyboard) */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		HIDUsagePage<0x07>,								/*   USAGE_PAGE (Keyboard) */
+		/* Keyboard Modifiers (shift, alt, ...) */
+		HIDUsageMinimum<0xE0>,							/*   USAGE_MINIMUM (Keyboard LeftControl) */
+		HIDUsageMaximum<0xE7>,							/*   USAGE_MAXIMUM (Keyboard Right GUI) */
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<1>,
+		HIDReportSize<1>,
+		HIDReportCount<8>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		/* Reserved byte, used for consumer reports, only works with linux */
+		HIDUsagePage<0x0C>,								/*   USAGE_PAGE (Consumer) */
+		HIDReportCount<1>,
+		HIDReportSize<8>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<255>,
+		HIDUsageMinimum<0>,
+		HIDUsageMaximum<255>,
+		HIDInput<HID_DATA | HID_ARRAY | HID_ABSOLUTE>,
+		/* 6 Keyboard keys */
+		HIDUsagePage<0x07>,								/*   USAGE_PAGE (Keyboard) */
+		HIDReportCount<6>,
+		HIDReportSize<8>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<231>,
+		HIDUsageMinimum<0>,								/*   USAGE_MINIMUM (Reserved (no event indicated)) */
+		HIDUsageMaximum<0xE7>,							/*   USAGE_MAXIMUM (Keyboard Right GUI) */
+		HIDInput<HID_DATA | HID_ARRAY | HID_ABSOLUTE>
+	>
+>;
+
+// What to do if a key is pressed while all 6 keycode slots are in use
+enum KeyboardRollover : uint8_t {
+	ROLLOVER_IGNORE_NEW = 0,  // The new key is not added (default)
+	ROLLOVER_REPLACE_OLDEST,  // The longest pressed key is released for the new key
+};
+
 
 class DefaultKeyboardAPI : public KeyboardAPI
 {
 public:
+  inline DefaultKeyboardAPI(void);
+
+  inline void setRollover(KeyboardRollover policy);
+  inline bool isPressed(KeyboardKeycode k);
+
+  // Replace the whole report, e.g. with one from another MCU. Call send() afterwards.
+  inline void setReport(const HID_KeyboardReport_Data_t& report);
+
   // Add special consumer key API for the reserved byte
   inline size_t write(ConsumerKeycode k);
   inline size_t press(ConsumerKeycode k);
@@ -67,9 +119,19 @@ public:
 
 protected:
   HID_KeyboardReport_Data_t _keyReport;
+  KeyboardRollover _rollover;
+#if KEYBOARD_PRESENCE_BITMAP
+  uint8_t _keyBitmap[32];
+#endif
+
+  // Update the bitmap after the report was changed directly
+  inline void syncKeys(void);
 
-private:
   inline virtual size_t set(KeyboardKeycode k, bool s) override;
+
+private:
+  inline virtual size_t setModifiers(uint8_t modifiers, bool s) override;
+  inline void setBit(uint8_t k, bool s);
 };
 
 // Implementation is inline
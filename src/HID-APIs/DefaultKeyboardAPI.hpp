@@ -25,6 +25,76 @@ THE SOFTWARE.
 #pragma once
 
 
+DefaultKeyboardAPI::DefaultKeyboardAPI(void) : _rollover(ROLLOVER_IGNORE_NEW)
+{
+	// Empty
+}
+
+
+void DefaultKeyboardAPI::setRollover(KeyboardRollover policy)
+{
+	_rollover = policy;
+}
+
+
+bool DefaultKeyboardAPI::isPressed(KeyboardKeycode k)
+{
+	// It's a modifier key
+	if(k >= KEY_LEFT_CTRL && k <= KEY_RIGHT_GUI){
+		return _keyReport.modifiers & (1 << (uint8_t(k) - uint8_t(KEY_LEFT_CTRL)));
+	}
+
+#if KEYBOARD_PRESENCE_BITMAP
+	return _keyBitmap[k >> 3] & (1 << (k & 0x07));
+#else
+	for (uint8_t i = 0; i < sizeof(_keyReport.keycodes); i++)
+	{
+		if (_keyReport.keycodes[i] == k) {
+			return true;
+		}
+	}
+	return false;
+#endif
+}
+
+
+void DefaultKeyboardAPI::setBit(uint8_t k, bool s)
+{
+#if KEYBOARD_PRESENCE_BITMAP
+	if(s){
+		_keyBitmap[k >> 3] |= (1 << (k & 0x07));
+	}
+	else{
+		_keyBitmap[k >> 3] &= ~(1 << (k & 0x07));
+	}
+#else
+	(void)k;
+	(void)s;
+#endif
+}
+
+
+void DefaultKeyboardAPI::syncKeys(void)
+{
+#if KEYBOARD_PRESENCE_BITMAP
+	memset(_keyBitmap, 0x00, sizeof(_keyBitmap));
+	for (uint8_t i = 0; i < sizeof(_keyReport.keycodes); i++)
+	{
+		if (_keyReport.keycodes[i] != KEY_RESERVED) {
+			setBit(_keyReport.keycodes[i], true);
+		}
+	}
+#endif
+}
+
+
+void DefaultKeyboardAPI::setReport(const HID_KeyboardReport_Data_t& report)
+{
+	_keyReport = report;
+	syncKeys();
+}
+
+
 size_t DefaultKeyboardAPI::set(KeyboardKeycode k, bool s)
 {
 	// It's a modifier key
@@ -40,6 +110,10 @@ size_t DefaultKeyboardAPI::set(KeyboardKeycode k, bool s)
 		}
 		return 1;
 	}
+	// Nothing to add or remove
+	else if(k == KEY_RESERVED){
+		return 1;
+	}
 	// Its a normal key
 	else{
 		// get size of keycodes during compile time
@@ -47,37 +121,49 @@ size_t DefaultKeyboardAPI::set(KeyboardKeycode k, bool s)
 
 		// if we are adding an element to keycodes
 		if (s){
-			// iterate through the keycodes
-			for (uint8_t i = 0; i < keycodesSize; i++)
-			{
-				auto key = _keyReport.keycodes[i];
-				// if target key is found
-				if (key == uint8_t(k)) {
-					// do nothing and exit
-					return 1;
-				}
+			// do nothing if the key is already pressed
+			if (isPressed(k)) {
+				return 1;
 			}
-			// iterate through the keycodes again, this only happens if no existing
-			// keycodes matches k
-			for (uint8_t i = 0; i < keycodesSize; i++)
-			{
-				auto key = _keyReport.keycodes[i];
-				// if first instance of empty slot is found
-				if (key == KEY_RESERVED) {
-					// change empty slot to k and exit
-					_keyReport.keycodes[i] = k;
-					return 1;
+
+			// keys are kept in press order, find the first empty slot
+			uint8_t i = 0;
+			while (i < keycodesSize && _keyReport.keycodes[i] != KEY_RESERVED) {
+				i++;
+			}
+
+			// all slots are in use
+			if (i == keycodesSize) {
+				if (_rollover != ROLLOVER_REPLACE_OLDEST) {
+					return 0;
 				}
+
+				// release the oldest key to make room
+				setBit(_keyReport.keycodes[0], false);
+				memmove(_keyReport.keycodes, _keyReport.keycodes + 1, keycodesSize - 1);
+				i = keycodesSize - 1;
 			}
+
+			// change empty slot to k and exit
+			_keyReport.keycodes[i] = k;
+			setBit(k, true);
+			return 1;
 		} else { // we are removing k from keycodes
+#if KEYBOARD_PRESENCE_BITMAP
+			if (!isPressed(k)) {
+				return 0;
+			}
+#endif
 			// iterate through the keycodes
 			for (uint8_t i = 0; i < keycodesSize; i++)
 			{
 				auto key = _keyReport.keycodes[i];
 				// if target key is found
 				if (key == k) {
-					// remove target and exit
-					_keyReport.keycodes[i] = KEY_RESERVED;
+					// remove target and move the newer keys down to keep the press order
+					memmove(_keyReport.keycodes + i, _keyReport.keycodes + i + 1, keycodesSize - i - 1);
+					_keyReport.keycodes[keycodesSize - 1] = KEY_RESERVED;
+					setBit(k, false);
 					return 1;
 				}
 			}
@@ -100,6 +186,9 @@ size_t DefaultKeyboardAPI::removeAll(void)
 		}
 		_keyReport.keys[i] = 0x00;
 	}
+#if KEYBOARD_PRESENCE_BITMAP
+	memset(_keyBitmap, 0x00, sizeof(_keyBitmap));
+#endif
 	return ret;
 }
 
@@ -164,3 +253,16 @@ size_t DefaultKeyboardAPI::remove(ConsumerKeycode k)
 	_keyReport.reserved = HID_CONSUMER_UNASSIGNED;
 	return 1;
 }
+
+
+size_t DefaultKeyboardAPI::setModifiers(uint8_t modifiers, bool s)
+{
+	// All modifiers with one mask
+	if(s){
+		_keyReport.modifiers |= modifiers;
+	}
+	else{
+		_keyReport.modifiers &= ~modifiers;
+	}
+	return 1;
+}
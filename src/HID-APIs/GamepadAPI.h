@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include <Arduino.h>
 #include "HID-Settings.h"
+#include "../HID-Descriptor.h"
 
 // Dpad directions
 #define GAMEPAD_DPAD_CENTERED 0
@@ -97,9 +98,60 @@ typedef union ATTRIBUTE_PACKED {
 	};
 } HID_GamepadReport_Data_t;
 
-class GamepadAPI{
+// Report descriptor, report ID 0 for the single report devices
+template<uint8_t ReportID>
+using HIDGamepadDescriptor = HIDItems<
+	HIDUsagePage<0x01>,									/* USAGE_PAGE (Generic Desktop) */
+	HIDUsage<0x04>,										/* USAGE (Joystick) */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		/* 32 Buttons */
+		HIDUsagePage<0x09>,								/*   USAGE_PAGE (Button) */
+		HIDUsageMinimum<1>,
+		HIDUsageMaximum<32>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<1>,
+		HIDReportSize<1>,
+		HIDReportCount<32>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		/* 4 16bit Axis */
+		HIDUsagePage<0x01>,								/*   USAGE_PAGE (Generic Desktop) */
+		HIDCollection<HID_COLLECTION_PHYSICAL,
+			HIDUsage<0x30>,								/*     USAGE (X) */
+			HIDUsage<0x31>,								/*     USAGE (Y) */
+			HIDUsage<0x33>,								/*     USAGE (Rx) */
+			HIDUsage<0x34>,								/*     USAGE (Ry) */
+			HIDLogicalMinimum<-32768>,
+			HIDLogicalMaximum<32767>,
+			HIDReportSize<16>,
+			HIDReportCount<4>,
+			HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+			/* 2 8bit Axis */
+			HIDUsage<0x32>,								/*     USAGE (Z) */
+			HIDUsage<0x35>,								/*     USAGE (Rz) */
+			HIDLogicalMinimum<-128>,
+			HIDLogicalMaximum<127>,
+			HIDReportSize<8>,
+			HIDReportCount<2>,
+			HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+		>,
+		/* 2 Hat Switches */
+		HIDUsagePage<0x01>,								/*   USAGE_PAGE (Generic Desktop) */
+		HIDUsage<0x39>,									/*   USAGE (Hat switch) */
+		HIDUsage<0x39>,									/*   USAGE (Hat switch) */
+		HIDLogicalMinimum<1>,
+		HIDLogicalMaximum<8>,
+		HIDReportCount<2>,
+		HIDReportSize<4>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+	>
+>;
+
+template<class Transport>
+class StaticGamepadAPI
+{
 public:
-	inline GamepadAPI(void);
+	inline StaticGamepadAPI(void);
 
 	inline void begin(void);
 	inline void end(void);
@@ -118,11 +170,34 @@ public:
 	inline void dPad1(int8_t d);
 	inline void dPad2(int8_t d);
 
-	// Sending is public in the base class for advanced users.
-	virtual void SendReport(void* data, int length) = 0;
+	// Only send the report if it was changed since the last send.
+	// Returns true if the report was sent.
+	inline bool update(void);
+
+	// Call update() on every change, sending at most once per interval (ms).
+	// Changes within the interval are sent by the next update() call.
+	// 0 disables the automatic sending (default).
+	inline void setAutoSend(uint16_t interval);
 
 protected:
+	// The transport is bound at compile time, no virtual call is needed
+	Transport& transport(void) { return *static_cast<Transport*>(this); }
+
 	HID_GamepadReport_Data_t _report;
+	bool _dirty;
+	uint16_t _interval;
+	uint16_t _lastSend;
+
+	inline void changed(void);
+};
+
+// Sends through virtual functions, the base of the HID-Project devices.
+// Derive from StaticGamepadAPI<Transport> instead to bind the transport at compile time.
+class GamepadAPI : public StaticGamepadAPI<GamepadAPI>
+{
+public:
+	// Sending is public in the base class for advanced users.
+	virtual void SendReport(void* data, int length) = 0;
 };
 
 // Implementation is inline
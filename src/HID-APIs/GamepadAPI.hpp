@@ -24,81 +24,151 @@ THE SOFTWARE.
 // Include guard
 #pragma once
 
-GamepadAPI::GamepadAPI(void)
+template<class Transport>
+StaticGamepadAPI<Transport>::StaticGamepadAPI(void) : _dirty(false), _interval(0), _lastSend(0)
 {
 	// Empty
 }
 
-void GamepadAPI::begin(void){
+template<class Transport>
+void StaticGamepadAPI<Transport>::begin(void){
 	// release all buttons
 	end();
 }
 
-void GamepadAPI::end(void){
+template<class Transport>
+void StaticGamepadAPI<Transport>::end(void){
 	memset(&_report, 0x00, sizeof(_report));
-	SendReport(&_report, sizeof(_report));
+	write();
 }
 
-void GamepadAPI::write(void){ 
-	SendReport(&_report, sizeof(_report)); 
+template<class Transport>
+void StaticGamepadAPI<Transport>::write(void){ 
+	_dirty = false;
+	_lastSend = millis();
+	transport().SendReport(&_report, sizeof(_report)); 
 }
 
+template<class Transport>
+bool StaticGamepadAPI<Transport>::update(void){
+	// Nothing changed or the last report was sent too recently
+	if (!_dirty || (uint16_t)((uint16_t)millis() - _lastSend) < _interval) {
+		return false;
+	}
+	write();
+	return true;
+}
+
+template<class Transport>
+void StaticGamepadAPI<Transport>::setAutoSend(uint16_t interval){
+	_interval = interval;
+}
 
-void GamepadAPI::press(uint8_t b){ 
-	_report.buttons |= (uint32_t)1 << (b - 1); 
+template<class Transport>
+void StaticGamepadAPI<Transport>::changed(void){
+	_dirty = true;
+	if (_interval) {
+		update();
+	}
 }
 
 
-void GamepadAPI::release(uint8_t b){ 
-	_report.buttons &= ~((uint32_t)1 << (b - 1)); 
+template<class Transport>
+void StaticGamepadAPI<Transport>::press(uint8_t b){ 
+	buttons(_report.buttons | ((uint32_t)1 << (b - 1)));
 }
 
 
-void GamepadAPI::releaseAll(void){ 
+template<class Transport>
+void StaticGamepadAPI<Transport>::release(uint8_t b){ 
+	buttons(_report.buttons & ~((uint32_t)1 << (b - 1)));
+}
+
+
+template<class Transport>
+void StaticGamepadAPI<Transport>::releaseAll(void){ 
 	memset(&_report, 0x00, sizeof(_report)); 
+	changed();
 }
 
-void GamepadAPI::buttons(uint32_t b){ 
-	_report.buttons = b; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::buttons(uint32_t b){ 
+	if (_report.buttons != b) {
+		_report.buttons = b; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::xAxis(int16_t a){ 
-	_report.xAxis = a; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::xAxis(int16_t a){ 
+	if (_report.xAxis != a) {
+		_report.xAxis = a; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::yAxis(int16_t a){ 
-	_report.yAxis = a; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::yAxis(int16_t a){ 
+	if (_report.yAxis != a) {
+		_report.yAxis = a; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::zAxis(int8_t a){ 
-	_report.zAxis = a; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::zAxis(int8_t a){ 
+	if (_report.zAxis != a) {
+		_report.zAxis = a; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::rxAxis(int16_t a){ 
-	_report.rxAxis = a; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::rxAxis(int16_t a){ 
+	if (_report.rxAxis != a) {
+		_report.rxAxis = a; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::ryAxis(int16_t a){ 
-	_report.ryAxis = a; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::ryAxis(int16_t a){ 
+	if (_report.ryAxis != a) {
+		_report.ryAxis = a; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::rzAxis(int8_t a){ 
-	_report.rzAxis = a; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::rzAxis(int8_t a){ 
+	if (_report.rzAxis != a) {
+		_report.rzAxis = a; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::dPad1(int8_t d){ 
-	_report.dPad1 = d; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::dPad1(int8_t d){ 
+	// Only 4 bits are used
+	if (_report.dPad1 != (d & 0x0F)) {
+		_report.dPad1 = d; 
+		changed();
+	}
 }
 
 
-void GamepadAPI::dPad2(int8_t d){ 
-	_report.dPad2 = d; 
+template<class Transport>
+void StaticGamepadAPI<Transport>::dPad2(int8_t d){ 
+	// Only 4 bits are used
+	if (_report.dPad2 != (d & 0x0F)) {
+		_report.dPad2 = d; 
+		changed();
+	}
 }
-
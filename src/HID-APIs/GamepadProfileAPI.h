@@ -0,0 +1,193 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "../HID-Descriptor.h"
+#include "GamepadAPI.h"
+
+// X, Y, Z, Rx, Ry, Rz, then sliders
+constexpr uint16_t gamepadProfileAxisUsage(uint8_t index){
+	return index < 6 ? 0x30 + index : 0x36;
+}
+
+template<uint8_t Count>
+struct GamepadProfileAxisUsages
+{
+	typedef HIDItems<typename GamepadProfileAxisUsages<Count - 1>::type, HIDUsage<gamepadProfileAxisUsage(Count - 1)>> type;
+};
+
+template<>
+struct GamepadProfileAxisUsages<0>
+{
+	typedef HIDReportDescriptor<> type;
+};
+
+template<uint8_t Count>
+struct GamepadProfileDPadUsages
+{
+	typedef HIDItems<typename GamepadProfileDPadUsages<Count - 1>::type, HIDUsage<0x39>> type;
+};
+
+template<>
+struct GamepadProfileDPadUsages<0>
+{
+	typedef HIDReportDescriptor<> type;
+};
+
+// Layout of a gamepad report: the buttons, the signed axes with AxisBits
+// each and 4 bit d-pads. Every part is padded to full bytes and left out of
+// the descriptor and the report if its count is 0.
+template<uint8_t Buttons, uint8_t Axes = 0, uint8_t AxisBits = 16, uint8_t DPads = 0>
+struct GamepadProfile
+{
+	static_assert(Buttons <= 128, "A gamepad profile supports up to 128 buttons.");
+	static_assert(Axes <= 16, "A gamepad profile supports up to 16 axes.");
+	static_assert(AxisBits >= 2 && AxisBits <= 16, "Gamepad profile axes need 2 - 16 bits.");
+	static_assert(DPads <= 8, "A gamepad profile supports up to 8 d-pads.");
+
+	static constexpr uint8_t buttons = Buttons;
+	static constexpr uint8_t axes = Axes;
+	static constexpr uint8_t axisBits = AxisBits;
+	static constexpr uint8_t dPads = DPads;
+
+	static constexpr int16_t axisMinimum = -(1L << (AxisBits - 1));
+	static constexpr int16_t axisMaximum = (1L << (AxisBits - 1)) - 1;
+
+	typedef struct ATTRIBUTE_PACKED {
+		uint8_t buttons[(Buttons + 7) / 8];
+		uint8_t axes[(Axes * AxisBits + 7) / 8];
+		uint8_t dPads[(DPads + 1) / 2];
+	} Report;
+
+	// Report descriptor, report ID 0 for single report devices
+	template<uint8_t ReportID>
+	using Descriptor = HIDItems<
+		HIDUsagePage<0x01>,									/* USAGE_PAGE (Generic Desktop) */
+		HIDUsage<0x04>,										/* USAGE (Joystick) */
+		HIDCollection<HID_COLLECTION_APPLICATION,
+			HIDReportID<ReportID>,
+			HIDOptional<(Buttons > 0),
+				HIDUsagePage<0x09>,							/*   USAGE_PAGE (Button) */
+				HIDUsageMinimum<1>,
+				HIDUsageMaximum<Buttons>,
+				HIDLogicalMinimum<0>,
+				HIDLogicalMaximum<1>,
+				HIDReportSize<1>,
+				HIDReportCount<Buttons>,
+				HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+			>,
+			HIDOptional<(Buttons % 8 != 0),
+				HIDReportSize<8 - Buttons % 8>,
+				HIDReportCount<1>,
+				HIDInput<HID_CONSTANT>
+			>,
+			HIDOptional<(Axes > 0),
+				HIDUsagePage<0x01>,							/*   USAGE_PAGE (Generic Desktop) */
+				HIDCollection<HID_COLLECTION_PHYSICAL,
+					typename GamepadProfileAxisUsages<Axes>::type,
+					HIDLogicalMinimum<axisMinimum>,
+					HIDLogicalMaximum<axisMaximum>,
+					HIDReportSize<AxisBits>,
+					HIDReportCount<Axes>,
+					HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+				>
+			>,
+			HIDOptional<((Axes * AxisBits) % 8 != 0),
+				HIDReportSize<8 - (Axes * AxisBits) % 8>,
+				HIDReportCount<1>,
+				HIDInput<HID_CONSTANT>
+			>,
+			HIDOptional<(DPads > 0),
+				HIDUsagePage<0x01>,							/*   USAGE_PAGE (Generic Desktop) */
+				typename GamepadProfileDPadUsages<DPads>::type,	/*   USAGE (Hat switch) */
+				HIDLogicalMinimum<1>,
+				HIDLogicalMaximum<8>,
+				HIDReportCount<DPads>,
+				HIDReportSize<4>,
+				HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+			>,
+			HIDOptional<(DPads % 2 != 0),
+				HIDReportSize<4>,
+				HIDReportCount<1>,
+				HIDInput<HID_CONSTANT>
+			>
+		>
+	>;
+};
+
+template<uint8_t Buttons, uint8_t Axes, uint8_t AxisBits, uint8_t DPads>
+constexpr int16_t GamepadProfile<Buttons, Axes, AxisBits, DPads>::axisMinimum;
+
+template<uint8_t Buttons, uint8_t Axes, uint8_t AxisBits, uint8_t DPads>
+constexpr int16_t GamepadProfile<Buttons, Axes, AxisBits, DPads>::axisMaximum;
+
+template<class Profile, class Transport>
+class StaticGamepadProfileAPI
+{
+public:
+	typedef typename Profile::Report Report;
+
+	inline StaticGamepadProfileAPI(void);
+
+	inline void begin(void);
+	inline void end(void);
+	inline void write(void);
+
+	// Buttons 1 - Profile::buttons
+	inline void press(uint8_t b);
+	inline void release(uint8_t b);
+	inline void releaseAll(void);
+
+	// Axes 0 - Profile::axes - 1, the value is limited to the axis resolution
+	inline void axis(uint8_t index, int16_t value);
+
+	// D-pads 0 - Profile::dPads - 1
+	inline void dPad(uint8_t index, int8_t d);
+
+	// Only send the report if it was changed since the last send.
+	// Returns true if the report was sent.
+	inline bool update(void);
+
+	// Call update() on every change, sending at most once per interval (ms).
+	// 0 disables the automatic sending (default).
+	inline void setAutoSend(uint16_t interval);
+
+protected:
+	// The transport is bound at compile time, no virtual call is needed
+	Transport& transport(void) { return *static_cast<Transport*>(this); }
+
+	Report _report;
+	bool _dirty;
+	uint16_t _interval;
+	uint16_t _lastSend;
+
+	inline void changed(void);
+	inline void setBits(uint8_t* data, uint16_t bit, uint8_t count, uint16_t value);
+};
+
+// Implementation is inline
+#include "GamepadProfileAPI.hpp"
@@ -0,0 +1,142 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+template<class Profile, class Transport>
+StaticGamepadProfileAPI<Profile, Transport>::StaticGamepadProfileAPI(void) : _dirty(false), _interval(0), _lastSend(0)
+{
+	memset(&_report, 0x00, sizeof(_report));
+}
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::begin(void){
+	// release all buttons
+	end();
+}
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::end(void){
+	memset(&_report, 0x00, sizeof(_report));
+	write();
+}
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::write(void){
+	_dirty = false;
+	_lastSend = millis();
+	transport().SendReport(&_report, sizeof(_report));
+}
+
+template<class Profile, class Transport>
+bool StaticGamepadProfileAPI<Profile, Transport>::update(void){
+	// Nothing changed or the last report was sent too recently
+	if (!_dirty || (uint16_t)((uint16_t)millis() - _lastSend) < _interval) {
+		return false;
+	}
+	write();
+	return true;
+}
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::setAutoSend(uint16_t interval){
+	_interval = interval;
+}
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::changed(void){
+	_dirty = true;
+	if (_interval) {
+		update();
+	}
+}
+
+// Fields can start anywhere in a byte, with whole bytes this is a plain copy
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::setBits(uint8_t* data, uint16_t bit, uint8_t count, uint16_t value){
+	data += bit / 8;
+	uint8_t shift = bit % 8;
+	uint32_t mask = (((uint32_t)1 << count) - 1) << shift;
+	uint32_t bits = ((uint32_t)value << shift) & mask;
+
+	bool modified = false;
+	for (uint8_t i = 0; i < (shift + count + 7) / 8; i++) {
+		uint8_t m = mask >> (i * 8);
+		uint8_t b = bits >> (i * 8);
+		if ((data[i] & m) != b) {
+			data[i] = (data[i] & ~m) | b;
+			modified = true;
+		}
+	}
+	if (modified) {
+		changed();
+	}
+}
+
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::press(uint8_t b){
+	if (b >= 1 && b <= Profile::buttons) {
+		setBits(_report.buttons, b - 1, 1, 1);
+	}
+}
+
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::release(uint8_t b){
+	if (b >= 1 && b <= Profile::buttons) {
+		setBits(_report.buttons, b - 1, 1, 0);
+	}
+}
+
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::releaseAll(void){
+	memset(&_report, 0x00, sizeof(_report));
+	changed();
+}
+
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::axis(uint8_t index, int16_t value){
+	if (index >= Profile::axes) {
+		return;
+	}
+	if (value < Profile::axisMinimum) {
+		value = Profile::axisMinimum;
+	}
+	else if (value > Profile::axisMaximum) {
+		value = Profile::axisMaximum;
+	}
+	setBits(_report.axes, (uint16_t)index * Profile::axisBits, Profile::axisBits, value);
+}
+
+
+template<class Profile, class Transport>
+void StaticGamepadProfileAPI<Profile, Transport>::dPad(uint8_t index, int8_t d){
+	// Only 4 bits are used
+	if (index < Profile::dPads) {
+		setBits(_report.dPads, index * 4, 4, d);
+	}
+}
@@ -0,0 +1,68 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+// Include guard
+#pragma once
+
+#include "DefaultKeyboardAPI.h"
+#include "NKROKeyboardAPI.h"
+
+// 6KRO keyboard with an NKRO bitmap for the keys that do not fit.
+// Modifiers and the first six keys use the 8 byte keyboard report. Keys
+// pressed while all six keycodes are in use go to the overflow report and
+// stay there until they are released, so no key ever moves between both
+// reports while it is held. The overflow report is only sent when it changes.
+class HybridKeyboardAPI : public DefaultKeyboardAPI
+{
+public:
+  inline HybridKeyboardAPI(void);
+
+  // Also checks the overflow report
+  inline bool isPressed(KeyboardKeycode k);
+
+  // Number of keys that did not fit into the keyboard report
+  inline uint8_t overflowCount(void);
+
+  // Implement adding/removing key functions
+  inline virtual size_t removeAll(void) override;
+
+  // Sends the overflow report if it changed and the keyboard report
+  // unless only the overflow report changed
+  inline virtual int send(void) override;
+
+  // Needs to be implemented in a lower level
+  virtual int sendReport(bool overflow, const void* data, int length) = 0;
+
+protected:
+  HID_NKROKeyboardReport_Data_t _overflowReport;
+  HID_KeyboardReport_Data_t _lastReport;
+  bool _overflowChanged;
+
+  inline size_t setOverflow(KeyboardKeycode k, bool s);
+
+  inline virtual size_t set(KeyboardKeycode k, bool s) override;
+};
+
+// Implementation is inline
+#include "HybridKeyboardAPI.hpp"
@@ -0,0 +1,153 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+// Include guard
+#pragma once
+
+
+HybridKeyboardAPI::HybridKeyboardAPI(void) : _overflowChanged(false)
+{
+	memset(&_overflowReport, 0x00, sizeof(_overflowReport));
+	memset(&_lastReport, 0x00, sizeof(_lastReport));
+}
+
+
+bool HybridKeyboardAPI::isPressed(KeyboardKeycode k)
+{
+	if (k < NKRO_KEY_COUNT) {
+		if (_overflowReport.keys[k / 8] & (1 << (uint8_t(k) % 8))) {
+			return true;
+		}
+	}
+	else if (k == _overflowReport.key && k != KEY_RESERVED) {
+		return true;
+	}
+	return DefaultKeyboardAPI::isPressed(k);
+}
+
+
+uint8_t HybridKeyboardAPI::overflowCount(void)
+{
+	uint8_t ret = (_overflowReport.key != KEY_RESERVED);
+	for (uint8_t i = 0; i < sizeof(_overflowReport.keys); i++)
+	{
+		for (uint8_t bits = _overflowReport.keys[i]; bits; bits &= bits - 1) {
+			ret++;
+		}
+	}
+	return ret;
+}
+
+
+size_t HybridKeyboardAPI::setOverflow(KeyboardKeycode k, bool s)
+{
+	// Keymap key
+	if (k < NKRO_KEY_COUNT) {
+		uint8_t bit = 1 << (uint8_t(k) % 8);
+		uint8_t& keys = _overflowReport.keys[k / 8];
+		if (bool(keys & bit) == s) {
+			return s;
+		}
+		keys ^= bit;
+		_overflowChanged = true;
+		return 1;
+	}
+
+	// Custom key, only one of them fits
+	if (s && _overflowReport.key == KEY_RESERVED) {
+		_overflowReport.key = k;
+		_overflowChanged = true;
+		return 1;
+	}
+	if (!s && _overflowReport.key == k) {
+		_overflowReport.key = KEY_RESERVED;
+		_overflowChanged = true;
+		return 1;
+	}
+	return s && _overflowReport.key == k;
+}
+
+
+size_t HybridKeyboardAPI::set(KeyboardKeycode k, bool s)
+{
+	// Modifiers are always part of the keyboard report
+	if ((k >= KEY_LEFT_CTRL && k <= KEY_RIGHT_GUI) || k == KEY_RESERVED) {
+		return DefaultKeyboardAPI::set(k, s);
+	}
+
+	if (s) {
+		// Do nothing if the key is already pressed in one of the reports
+		if (isPressed(k)) {
+			return 1;
+		}
+
+		// Keys are kept in press order, the last keycode is the first to fill up
+		if (_keyReport.keycodes[sizeof(_keyReport.keycodes) - 1] == KEY_RESERVED) {
+			return DefaultKeyboardAPI::set(k, true);
+		}
+		return setOverflow(k, true);
+	}
+
+	// A released key is removed from the report that holds it
+	if (setOverflow(k, false)) {
+		return 1;
+	}
+	return DefaultKeyboardAPI::set(k, false);
+}
+
+
+size_t HybridKeyboardAPI::removeAll(void)
+{
+	// Release all keys
+	size_t ret = overflowCount();
+	if (ret) {
+		memset(&_overflowReport, 0x00, sizeof(_overflowReport));
+		_overflowChanged = true;
+	}
+	return ret + DefaultKeyboardAPI::removeAll();
+}
+
+
+int HybridKeyboardAPI::send(void)
+{
+	int ret = 0;
+	if (_overflowChanged) {
+		ret = sendReport(true, &_overflowReport, sizeof(_overflowReport));
+		if (ret < 0) {
+			return ret;
+		}
+		_overflowChanged = false;
+
+		// The keyboard report did not change with this key
+		if (!memcmp(&_lastReport, &_keyReport, sizeof(_keyReport))) {
+			return ret;
+		}
+	}
+
+	ret = sendReport(false, &_keyReport, sizeof(_keyReport));
+	if (ret >= 0) {
+		memcpy(&_lastReport, &_keyReport, sizeof(_keyReport));
+	}
+	return ret;
+}
@@ -32,8 +32,22 @@ THE SOFTWARE.
 class KeyboardAPI : public Print
 {
 public:
+  inline KeyboardAPI(void);
   inline void begin(void);
   inline void end(void);
+
+  // Select a layout of ImprovedKeylayoutsRegistry.h while no characters are pressed.
+  // NULL switches back to the layout of the LAYOUT_* define.
+  inline void setLayout(const KeyboardLayout* layout);
+
+  // Lock-state-aware typing for write(buffer, size) and print(). A run of
+  // uppercase letters toggles Caps Lock if that takes fewer reports than
+  // Shift, toggles included. Letters are typed in the case the host's Caps
+  // Lock LED gives them and the lock state is restored afterwards. Only
+  // keyboards with an LED report (BootKeyboard, SingleNKROKeyboard) know the
+  // state, after the host sent it once. Caps Lock may only change the letters
+  // A-Z of the layout, hosts that ignore short Caps Lock taps need it off.
+  void setLockTyping(bool enable){ _lockTyping = enable; }
   
   // Raw Keycode API functions
   inline size_t write(KeyboardKeycode k);
@@ -43,21 +57,78 @@ public:
   inline size_t add(KeyboardKeycode k);
   inline size_t releaseAll(void);
   //press(uint8_t key, uint8_t modifier) TODO variadic template
+
+  // Bulk API functions, sending a single report for all keys
+  inline size_t press(const KeyboardKeycode* keys, size_t count);
+  inline size_t release(const KeyboardKeycode* keys, size_t count);
+  // Replace the whole report. Bit n of modifiers is KEY_LEFT_CTRL + n.
+  inline size_t setKeys(uint8_t modifiers, const KeyboardKeycode* keys, size_t count);
   
   // Print API functions
   inline virtual size_t write(uint8_t k) override;
+  inline virtual size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
   inline size_t press(uint8_t k);
   inline size_t release(uint8_t k);
   inline size_t add(uint8_t k);
   inline size_t remove(uint8_t k);
 
+  // Type strings straight from flash, without copying them to RAM. UTF-8 is
+  // decoded to the ISO-8859-15 characters of the layout, other bytes are
+  // typed as they are. writeFlash() types size bytes of a PROGMEM array.
+  using Print::print;
+  using Print::println;
+  inline size_t print(const __FlashStringHelper* str);
+  inline size_t println(const __FlashStringHelper* str);
+  inline size_t writeFlash(const void* buffer, size_t size);
+
   // Needs to be implemented in a lower level
   virtual size_t removeAll(void) = 0;
   virtual int send(void) = 0;
 
+protected:
+  // LED state of the host, false if the keyboard does not know it
+  virtual bool readLeds(uint8_t& state){ (void)state; return false; }
+
 private:
   virtual size_t set(KeyboardKeycode k, bool s) = 0;
   inline size_t set(uint8_t k, bool s);
+
+  // Decodes the flash string in blocks for write(buffer, size)
+  inline size_t typeFlash(const uint8_t* str, size_t size, bool terminated);
+
+  // Batched typing of write(buffer, size). With capsLock the uppercase
+  // letters are typed with the keys of their lowercase letters.
+  inline size_t typeBatches(const uint8_t* buffer, size_t size, bool capsLock);
+  inline uint8_t capsCharacter(uint8_t c, bool capsLock);
+
+  // Lock-state-aware typing, caps is the current Caps Lock state and is
+  // updated by the toggles. lockBegin() returns false if the mode is off
+  // or the state is not known.
+  inline bool lockBegin(bool& caps);
+  inline size_t typeLocked(const uint8_t* buffer, size_t size, bool& caps, bool original);
+  inline void lockEnd(bool caps, bool original);
+  // Reports typeBatches() sends for the characters
+  inline size_t countReports(const uint8_t* buffer, size_t size, bool capsLock);
+  // 1 for an uppercase and -1 for a lowercase letter that Caps Lock changes
+  inline int8_t letterCase(uint8_t c);
+
+  // Character that was already looked up in the layout,
+  // the modifiers are applied as a whole byte
+  inline size_t set(KeyboardKeycode k, uint8_t modifiers, bool s);
+
+  // Bit n of modifiers is KEY_LEFT_CTRL + n
+  inline virtual size_t setModifiers(uint8_t modifiers, bool s);
+
+  // Lookups in the selected layout
+  inline uint16_t layoutSize(void);
+  inline uint8_t layoutKeycode(uint8_t c);
+  inline uint8_t layoutModifiers(uint8_t c);
+
+  // Copy of the selected layout, without keys the LAYOUT_* define is used
+  KeyboardLayout _layout;
+
+  bool _lockTyping;
 };
 
 
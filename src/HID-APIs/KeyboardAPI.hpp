@@ -25,6 +25,12 @@ THE SOFTWARE.
 #pragma once
 
 
+KeyboardAPI::KeyboardAPI(void) : _layout(), _lockTyping(false)
+{
+	// Empty
+}
+
+
 void KeyboardAPI::begin(void)
 {
 	// Force API to send a clean report.
@@ -41,6 +47,18 @@ void KeyboardAPI::end(void)
 }
 
 
+void KeyboardAPI::setLayout(const KeyboardLayout* layout)
+{
+	// The tables stay in flash, only their addresses are copied
+	if(layout){
+		memcpy_P(&_layout, layout, sizeof(_layout));
+	}
+	else{
+		memset(&_layout, 0, sizeof(_layout));
+	}
+}
+
+
 size_t KeyboardAPI::write(KeyboardKeycode k)
 {	
 	// Press and release key (if press was successfull)
@@ -99,6 +117,53 @@ size_t KeyboardAPI::releaseAll(void)
 }
 
 
+size_t KeyboardAPI::press(const KeyboardKeycode* keys, size_t count)
+{
+	// Press all keys and send a single report to host
+	size_t ret = 0;
+	for(size_t i = 0; i < count; i++){
+		ret += add(keys[i]);
+	}
+	if(ret){
+		send();
+	}
+	return ret;
+}
+
+
+size_t KeyboardAPI::release(const KeyboardKeycode* keys, size_t count)
+{
+	// Release all keys and send a single report to host
+	size_t ret = 0;
+	for(size_t i = 0; i < count; i++){
+		ret += remove(keys[i]);
+	}
+	if(ret){
+		send();
+	}
+	return ret;
+}
+
+
+size_t KeyboardAPI::setKeys(uint8_t modifiers, const KeyboardKeycode* keys, size_t count)
+{
+	// Build the new report from scratch
+	removeAll();
+	if(modifiers){
+		setModifiers(modifiers, true);
+	}
+
+	size_t ret = 0;
+	for(size_t i = 0; i < count; i++){
+		ret += add(keys[i]);
+	}
+
+	// Always send, the previous keys might have been released
+	send();
+	return ret;
+}
+
+
 size_t KeyboardAPI::write(uint8_t k)
 {	
 	// Press and release key (if press was successfull)
@@ -110,6 +175,271 @@ size_t KeyboardAPI::write(uint8_t k)
 }
 
 
+size_t KeyboardAPI::write(const uint8_t *buffer, size_t size)
+{
+	bool caps;
+	if(!lockBegin(caps)){
+		return typeBatches(buffer, size, false);
+	}
+	bool original = caps;
+	size_t ret = typeLocked(buffer, size, caps, original);
+	lockEnd(caps, original);
+	return ret;
+}
+
+
+size_t KeyboardAPI::typeBatches(const uint8_t *buffer, size_t size, bool capsLock)
+{
+	// Type the string with as few reports as possible
+	size_t ret = 0;
+	size_t i = 0;
+	while(i < size){
+		size_t start = i;
+		uint8_t modifiers = 0;
+		uint8_t lastKey = 0;
+
+		// Press as many characters as possible with a single report.
+		// Hosts process the keys of one report in keycode order (NKRO),
+		// so only ascending keys with the same modifiers can be batched.
+		for(; i < size; i++){
+			uint8_t c = capsCharacter(buffer[i], capsLock);
+			if(c >= layoutSize()){
+				setWriteError();
+				continue;
+			}
+
+			// Nothing to press
+			uint8_t keycode = layoutKeycode(c);
+			if(!keycode){
+				ret++;
+				continue;
+			}
+
+			// Repeated keys and modifier changes need a release first
+			uint8_t keyModifiers = layoutModifiers(c);
+			if(lastKey && (keycode <= lastKey || keyModifiers != modifiers)){
+				break;
+			}
+
+			if(!set(KeyboardKeycode(keycode), keyModifiers, true)){
+				// Report is full, send the batch first
+				if(lastKey){
+					break;
+				}
+				// Key cannot be pressed at all, skip it
+				start = i + 1;
+				continue;
+			}
+
+			modifiers = keyModifiers;
+			lastKey = keycode;
+			ret++;
+		}
+
+		if(lastKey){
+			send();
+
+			// Release the batch again, all keys share the same modifiers
+			for(size_t j = start; j < i; j++){
+				uint8_t c = capsCharacter(buffer[j], capsLock);
+				if(c < layoutSize()){
+					uint8_t keycode = layoutKeycode(c);
+					if(keycode){
+						set(KeyboardKeycode(keycode), false);
+					}
+				}
+			}
+			if(modifiers){
+				setModifiers(modifiers, false);
+			}
+			send();
+		}
+	}
+	return ret;
+}
+
+
+uint8_t KeyboardAPI::capsCharacter(uint8_t c, bool capsLock)
+{
+	// Caps Lock types the uppercase letter with the key of the lowercase one
+	if(capsLock && letterCase(c) > 0){
+		return c | 0x20;
+	}
+	return c;
+}
+
+
+bool KeyboardAPI::lockBegin(bool& caps)
+{
+	uint8_t leds = 0;
+	bool known = _lockTyping && readLeds(leds);
+	caps = leds & LED_CAPS_LOCK;
+	return known;
+}
+
+
+size_t KeyboardAPI::typeLocked(const uint8_t* buffer, size_t size, bool& caps, bool original)
+{
+	size_t ret = 0;
+	size_t i = 0;
+	while(i < size){
+		// A run ends before the first letter of the other case
+		int8_t run = 0;
+		size_t end = i;
+		for(; end < size; end++){
+			int8_t letter = letterCase(buffer[end]);
+			if(letter && run && letter != run){
+				break;
+			}
+			if(letter){
+				run = letter;
+			}
+		}
+
+		// With Caps Lock on Shift gives lowercase letters only on some
+		// hosts, so it is turned off for them. Uppercase runs take the lock
+		// state with fewer reports, counting the toggle for the next run.
+		bool lock = caps;
+		if(run < 0){
+			lock = false;
+		}
+		else if(run > 0){
+			bool next = (end < size) ? false : original;
+			size_t locked = countReports(buffer + i, end - i, true);
+			size_t shifted = countReports(buffer + i, end - i, false);
+			locked += (caps ? 0 : 2) + (next ? 0 : 2);
+			shifted += (caps ? 2 : 0) + (next ? 2 : 0);
+			lock = locked < shifted;
+		}
+
+		// The host takes the reports in order, no need to wait for its LEDs
+		if(lock != caps){
+			write(KEY_CAPS_LOCK);
+			caps = lock;
+		}
+		ret += typeBatches(buffer + i, end - i, caps);
+		i = end;
+	}
+	return ret;
+}
+
+
+void KeyboardAPI::lockEnd(bool caps, bool original)
+{
+	if(caps != original){
+		write(KEY_CAPS_LOCK);
+	}
+}
+
+
+size_t KeyboardAPI::countReports(const uint8_t* buffer, size_t size, bool capsLock)
+{
+	// The batches of typeBatches(), assuming the 6 keys of a boot report
+	size_t reports = 0;
+	uint8_t modifiers = 0;
+	uint8_t lastKey = 0;
+	uint8_t keys = 0;
+	for(size_t i = 0; i < size; i++){
+		uint8_t c = capsCharacter(buffer[i], capsLock);
+		if(c >= layoutSize()){
+			continue;
+		}
+		uint8_t keycode = layoutKeycode(c);
+		if(!keycode){
+			continue;
+		}
+
+		uint8_t keyModifiers = layoutModifiers(c);
+		if(!lastKey || keycode <= lastKey || keyModifiers != modifiers || keys == 6){
+			// Press and release of a new batch
+			reports += 2;
+			keys = 0;
+		}
+		modifiers = keyModifiers;
+		lastKey = keycode;
+		keys++;
+	}
+	return reports;
+}
+
+
+int8_t KeyboardAPI::letterCase(uint8_t c)
+{
+	uint8_t upper = c & ~0x20;
+	if(upper < 'A' || upper > 'Z'){
+		return 0;
+	}
+
+	// Both cases have to be on one key, the uppercase letter with Shift
+	uint8_t lower = upper | 0x20;
+	uint8_t keycode = layoutKeycode(lower);
+	if(!keycode || layoutKeycode(upper) != keycode ||
+		layoutModifiers(lower) || layoutModifiers(upper) != (MOD_LEFT_SHIFT >> 8)){
+		return 0;
+	}
+	return (c == upper) ? 1 : -1;
+}
+
+
+size_t KeyboardAPI::print(const __FlashStringHelper* str)
+{
+	return typeFlash(reinterpret_cast<const uint8_t*>(str), size_t(-1), true);
+}
+
+
+size_t KeyboardAPI::println(const __FlashStringHelper* str)
+{
+	size_t ret = print(str);
+	return ret + write("\r\n");
+}
+
+
+size_t KeyboardAPI::writeFlash(const void* buffer, size_t size)
+{
+	return typeFlash(reinterpret_cast<const uint8_t*>(buffer), size, false);
+}
+
+
+size_t KeyboardAPI::typeFlash(const uint8_t* str, size_t size, bool terminated)
+{
+	// Only one block of characters is in RAM at a time, the batches are
+	// split at the block boundaries
+	uint8_t block[KEYBOARD_FLASH_BLOCK];
+	size_t length = 0;
+	size_t ret = 0;
+
+	// The lock state is kept across the blocks
+	bool caps;
+	bool locked = lockBegin(caps);
+	bool original = caps;
+	while(size){
+		uint16_t unicode = keyboardReadUTF8_P(str, size);
+		if(!unicode && terminated){
+			break;
+		}
+
+		uint8_t c = keyboardLayoutCharacter(unicode);
+		if(!c && unicode){
+			setWriteError();
+			continue;
+		}
+
+		block[length++] = c;
+		if(length == sizeof(block)){
+			ret += locked ? typeLocked(block, length, caps, original) : typeBatches(block, length, false);
+			length = 0;
+		}
+	}
+	if(length){
+		ret += locked ? typeLocked(block, length, caps, original) : typeBatches(block, length, false);
+	}
+	if(locked){
+		lockEnd(caps, original);
+	}
+	return ret;
+}
+
+
 size_t KeyboardAPI::press(uint8_t k) 
 {
 	// Press key and send report to host
@@ -148,45 +478,52 @@ size_t KeyboardAPI::remove(uint8_t k)
 
 size_t KeyboardAPI::set(uint8_t k, bool s){
 	// Ignore invalid input
-	if(k >= sizeof(_asciimap)/sizeof(_asciimap[0])){
+	if(k >= layoutSize()){
 		setWriteError();
 		return 0;
 	}
 
 	// Read key from ascii lookup table
-	uint16_t key = pgm_read_word(_asciimap + k);
-	auto ret = set(KeyboardKeycode((uint8_t)(key & 0xFF)), s);
-	
+	return set(KeyboardKeycode(layoutKeycode(k)), layoutModifiers(k), s);
+}
+
+
+size_t KeyboardAPI::set(KeyboardKeycode k, uint8_t modifiers, bool s){
+	auto ret = set(k, s);
+
 	// Only add modifier if keycode was successfully added before.
 	// Always try to release modifier (if used).
-	if(ret || !s){
-		if (key & MOD_LEFT_CTRL) {
-			ret |= set(KEY_LEFT_CTRL, s);
-		}
-		if (key & MOD_LEFT_SHIFT) {
-			ret |= set(KEY_LEFT_SHIFT, s);
-		}
-		if (key & MOD_LEFT_ALT) {
-			ret |= set(KEY_LEFT_ALT, s);
-		}
-		if (key & MOD_LEFT_GUI) {
-			ret |= set(KEY_LEFT_GUI, s);
-		}
-		if (key & MOD_RIGHT_CTRL) {
-			ret |= set(KEY_RIGHT_CTRL, s);
-		}
-		if (key & MOD_RIGHT_SHIFT) {
-			ret |= set(KEY_RIGHT_SHIFT, s);
-		}
-		if (key & MOD_RIGHT_ALT) {
-			ret |= set(KEY_RIGHT_ALT, s);
-		}
-		if (key & MOD_RIGHT_GUI) {
-			ret |= set(KEY_RIGHT_GUI, s);
-		}
+	// All modifiers are set with one mask, not bit by bit.
+	if(modifiers && (ret || !s)){
+		ret |= setModifiers(modifiers, s);
 	}
-	
 
 	return ret;
 }
 
+
+size_t KeyboardAPI::setModifiers(uint8_t modifiers, bool s){
+	// Fallback for reports without a modifier byte
+	size_t ret = 0;
+	for(uint8_t i = 0; i < 8; i++){
+		if(modifiers & (1 << i)){
+			ret |= set(KeyboardKeycode(KEY_LEFT_CTRL + i), s);
+		}
+	}
+	return ret;
+}
+
+
+uint16_t KeyboardAPI::layoutSize(void){
+	return _layout.keys ? _layout.size : keyboardAsciiSize;
+}
+
+
+uint8_t KeyboardAPI::layoutKeycode(uint8_t c){
+	return keyboardAsciiKeycode(_layout.keys ? _layout.keys : KeyboardAsciiDatabase::tables.keys, c);
+}
+
+
+uint8_t KeyboardAPI::layoutModifiers(uint8_t c){
+	return keyboardAsciiModifiers(_layout.keys ? _layout.modifiers : KeyboardAsciiDatabase::tables.modifiers, c);
+}
@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include <Arduino.h>
 #include "HID-Settings.h"
+#include "../HID-Descriptor.h"
 
 
 #define MOUSE_LEFT		(1 << 0)
@@ -37,6 +38,9 @@ THE SOFTWARE.
 // but the last 3 wont do anything from what I tested
 #define MOUSE_ALL (MOUSE_LEFT | MOUSE_RIGHT | MOUSE_MIDDLE | MOUSE_PREV | MOUSE_NEXT)
 
+// Wheel counts per detent with the resolution multiplier enabled
+#define HID_MOUSE_WHEEL_MULTIPLIER 8
+
 typedef union ATTRIBUTE_PACKED {
 	// Mouse report: 8 buttons, position, wheel
 	uint8_t whole8[0];
@@ -44,12 +48,73 @@ typedef union ATTRIBUTE_PACKED {
 	uint32_t whole32[0];
 	struct ATTRIBUTE_PACKED {
 		uint8_t buttons;
+#if HID_MOUSE_HIGH_RESOLUTION
+		int16_t xAxis;
+		int16_t yAxis;
+		int8_t wheel;
+		int8_t pan;
+#else
 		int8_t xAxis;
 		int8_t yAxis;
 		int8_t wheel;
+#endif
 	};
 } HID_MouseReport_Data_t;
 
+// Report descriptor of the multi report mouse
+template<uint8_t ReportID>
+using HIDMouseDescriptor = HIDItems<
+	HIDUsagePage<0x01>,									/* USAGE_PAGE (Generic Desktop) */
+	HIDUsage<0x02>,										/* USAGE (Mouse) */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		/* 8 Buttons */
+		HIDUsagePage<0x09>,								/*   USAGE_PAGE (Button) */
+		HIDUsageMinimum<1>,
+		HIDUsageMaximum<8>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<1>,
+		HIDReportCount<8>,
+		HIDReportSize<1>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		HIDUsagePage<0x01>,								/*   USAGE_PAGE (Generic Desktop) */
+		HIDUsage<0x30>,									/*   USAGE (X) */
+		HIDUsage<0x31>,									/*   USAGE (Y) */
+		/* 16 bit X, Y, Wheel, Pan */
+		HIDOptional<HID_MOUSE_HIGH_RESOLUTION,
+			HIDLogicalMinimum<-32767>,
+			HIDLogicalMaximum<32767>,
+			HIDReportSize<16>,
+			HIDReportCount<2>,
+			HIDInput<HID_DATA | HID_VARIABLE | HID_RELATIVE>,
+			HIDUsage<0x38>,								/*   USAGE (Wheel) */
+			HIDLogicalMinimum<-127>,
+			HIDLogicalMaximum<127>,
+			HIDReportSize<8>,
+			HIDReportCount<1>,
+			HIDInput<HID_DATA | HID_VARIABLE | HID_RELATIVE>,
+			HIDUsagePage<0x0C>,							/*   USAGE_PAGE (Consumer) */
+			HIDUsage<0x238>,							/*   USAGE (AC Pan) */
+			HIDInput<HID_DATA | HID_VARIABLE | HID_RELATIVE>
+		>,
+		/* X, Y, Wheel */
+		HIDOptional<!HID_MOUSE_HIGH_RESOLUTION,
+			HIDUsage<0x38>,								/*   USAGE (Wheel) */
+			HIDLogicalMinimum<-127>,
+			HIDLogicalMaximum<127>,
+			HIDReportSize<8>,
+			HIDReportCount<3>,
+			HIDInput<HID_DATA | HID_VARIABLE | HID_RELATIVE>
+		>
+	>
+>;
+
+#if HID_MOUSE_HIGH_RESOLUTION
+#define HID_MOUSE_AXIS_LIMIT 32767
+#else
+#define HID_MOUSE_AXIS_LIMIT 127
+#endif
+
 typedef union ATTRIBUTE_PACKED {
 	// BootMouse report: 3 buttons, position
 	// Wheel is not supported by boot protocol
@@ -63,25 +128,73 @@ typedef union ATTRIBUTE_PACKED {
 	};
 } HID_BootMouseReport_Data_t;
 
-class MouseAPI
+template<class Transport>
+class StaticMouseAPI
 {
 public:
-  inline MouseAPI(void);
+  inline StaticMouseAPI(void);
   inline void begin(void);
   inline void end(void);
   inline void click(uint8_t b = MOUSE_LEFT);
+#if HID_MOUSE_HIGH_RESOLUTION
+  inline void move(int16_t x, int16_t y, int16_t wheel = 0, int16_t pan = 0);
+#else
   inline void move(signed char x, signed char y, signed char wheel = 0);
+#endif
   inline void press(uint8_t b = MOUSE_LEFT);   // press LEFT by default
   inline void release(uint8_t b = MOUSE_LEFT); // release LEFT by default
 	inline void releaseAll(void);
   inline bool isPressed(uint8_t b = MOUSE_LEFT); // check LEFT by default
 
-  // Sending is public in the base class for advanced users.
-  virtual void SendReport(void* data, int length) = 0;
+  // Coalescing sums up the movement until the endpoint is ready for the next report.
+  // Call flush() to send the pending movement, if the device cannot tell.
+  inline void setCoalescing(bool enable);
+  inline bool flush(void);
+
+  // Default of the transport, see MouseAPI
+  bool ReadyToSend(void) { return false; }
+#if HID_MOUSE_HIGH_RESOLUTION
+  bool HighResolutionWheel(void) { return false; }
+#endif
 
 protected:
+  // The transport is bound at compile time, no virtual call is needed
+  Transport& transport(void) { return *static_cast<Transport*>(this); }
+
   uint8_t _buttons;
+  bool _coalescing;
+  int16_t _pendingX;
+  int16_t _pendingY;
+  int16_t _pendingWheel;
+#if HID_MOUSE_HIGH_RESOLUTION
+  int16_t _pendingPan;
+  inline int8_t takeWheel(int16_t& value, int16_t multiplier);
+#endif
+  inline bool pending(void);
   inline void buttons(uint8_t b);
+  inline void sendPending(void);
+#if HID_MOUSE_HIGH_RESOLUTION
+  inline void sendMove(int16_t x, int16_t y);
+#else
+  inline void sendMove(int8_t x, int8_t y, int8_t wheel);
+#endif
+};
+
+// Sends through virtual functions, the base of the HID-Project devices.
+// Derive from StaticMouseAPI<Transport> instead to bind the transport at compile time.
+class MouseAPI : public StaticMouseAPI<MouseAPI>
+{
+public:
+  // Sending is public in the base class for advanced users.
+  virtual void SendReport(void* data, int length) = 0;
+
+  // Returns true if a report can be sent without blocking
+  virtual bool ReadyToSend(void) { return false; }
+
+#if HID_MOUSE_HIGH_RESOLUTION
+  // Returns true if the host enabled the resolution multiplier
+  virtual bool HighResolutionWheel(void) { return false; }
+#endif
 };
 
 // Implementation is inline
@@ -24,66 +24,201 @@ THE SOFTWARE.
 // Include guard
 #pragma once
 
-MouseAPI::MouseAPI(void) : _buttons(0)
+template<class Transport>
+StaticMouseAPI<Transport>::StaticMouseAPI(void) : _buttons(0), _coalescing(false),
+_pendingX(0), _pendingY(0), _pendingWheel(0)
+#if HID_MOUSE_HIGH_RESOLUTION
+, _pendingPan(0)
+#endif
 {
 	// Empty
 }
 
-void MouseAPI::begin(void)
+template<class Transport>
+void StaticMouseAPI<Transport>::begin(void)
 {
     end();
 }
 
-void MouseAPI::end(void)
+template<class Transport>
+void StaticMouseAPI<Transport>::end(void)
 {
     _buttons = 0;
-    move(0, 0, 0);
+    _pendingX = _pendingY = _pendingWheel = 0;
+#if HID_MOUSE_HIGH_RESOLUTION
+    _pendingPan = 0;
+#endif
+    sendPending();
 }
 
-void MouseAPI::click(uint8_t b)
+template<class Transport>
+void StaticMouseAPI<Transport>::click(uint8_t b)
 {
 	_buttons = b;
-	move(0,0,0);
+	sendPending();
 	_buttons = 0;
-	move(0,0,0);
+	sendPending();
 }
 
-void MouseAPI::move(signed char x, signed char y, signed char wheel)
+#if HID_MOUSE_HIGH_RESOLUTION
+template<class Transport>
+void StaticMouseAPI<Transport>::move(int16_t x, int16_t y, int16_t wheel, int16_t pan)
+{
+	// The wheel is always summed up, without the resolution multiplier
+	// the host only takes whole detents
+	_pendingWheel = constrain((int32_t)_pendingWheel + wheel, -32768, 32767);
+	_pendingPan = constrain((int32_t)_pendingPan + pan, -32768, 32767);
+
+	// Without coalescing every move is sent as it is
+	if (!_coalescing) {
+		sendMove(x, y);
+		return;
+	}
+
+	// Sum up the movement, saturating at the 16 bit limits
+	_pendingX = constrain((int32_t)_pendingX + x, -32768, 32767);
+	_pendingY = constrain((int32_t)_pendingY + y, -32768, 32767);
+#else
+template<class Transport>
+void StaticMouseAPI<Transport>::move(signed char x, signed char y, signed char wheel)
+{
+	// Without coalescing every move is sent as it is
+	if (!_coalescing) {
+		sendMove(x, y, wheel);
+		return;
+	}
+
+	// Sum up the movement, saturating at the 16 bit limits
+	_pendingX = constrain((int32_t)_pendingX + x, -32768, 32767);
+	_pendingY = constrain((int32_t)_pendingY + y, -32768, 32767);
+	_pendingWheel = constrain((int32_t)_pendingWheel + wheel, -32768, 32767);
+#endif
+
+	if (transport().ReadyToSend()) {
+		sendPending();
+	}
+}
+
+template<class Transport>
+void StaticMouseAPI<Transport>::sendPending(void)
+{
+	// Send as much of the pending movement as fits into one report
+	int16_t x = constrain(_pendingX, -HID_MOUSE_AXIS_LIMIT, HID_MOUSE_AXIS_LIMIT);
+	int16_t y = constrain(_pendingY, -HID_MOUSE_AXIS_LIMIT, HID_MOUSE_AXIS_LIMIT);
+	_pendingX -= x;
+	_pendingY -= y;
+#if HID_MOUSE_HIGH_RESOLUTION
+	sendMove(x, y);
+#else
+	int8_t wheel = constrain(_pendingWheel, -127, 127);
+	_pendingWheel -= wheel;
+	sendMove(x, y, wheel);
+#endif
+}
+
+#if HID_MOUSE_HIGH_RESOLUTION
+template<class Transport>
+void StaticMouseAPI<Transport>::sendMove(int16_t x, int16_t y)
+{
+	HID_MouseReport_Data_t report;
+	report.buttons = _buttons;
+	report.xAxis = x;
+	report.yAxis = y;
+	int16_t multiplier = transport().HighResolutionWheel() ? 1 : HID_MOUSE_WHEEL_MULTIPLIER;
+	report.wheel = takeWheel(_pendingWheel, multiplier);
+	report.pan = takeWheel(_pendingPan, multiplier);
+	transport().SendReport(&report, sizeof(report));
+}
+#else
+template<class Transport>
+void StaticMouseAPI<Transport>::sendMove(int8_t x, int8_t y, int8_t wheel)
 {
 	HID_MouseReport_Data_t report;
 	report.buttons = _buttons;
 	report.xAxis = x;
 	report.yAxis = y;
 	report.wheel = wheel;
-	SendReport(&report, sizeof(report));
+	transport().SendReport(&report, sizeof(report));
+}
+#endif
+
+#if HID_MOUSE_HIGH_RESOLUTION
+template<class Transport>
+int8_t StaticMouseAPI<Transport>::takeWheel(int16_t& value, int16_t multiplier)
+{
+	// Whole detents if the host did not enable the multiplier,
+	// the rest stays pending for the next report
+	int8_t counts = constrain(value / multiplier, -127, 127);
+	value -= counts * multiplier;
+	return counts;
+}
+#endif
+
+template<class Transport>
+bool StaticMouseAPI<Transport>::pending(void)
+{
+	if (_pendingX || _pendingY) {
+		return true;
+	}
+#if HID_MOUSE_HIGH_RESOLUTION
+	int16_t multiplier = transport().HighResolutionWheel() ? 1 : HID_MOUSE_WHEEL_MULTIPLIER;
+	return _pendingWheel / multiplier || _pendingPan / multiplier;
+#else
+	return _pendingWheel;
+#endif
+}
+
+template<class Transport>
+void StaticMouseAPI<Transport>::setCoalescing(bool enable)
+{
+	_coalescing = enable;
+	if (!enable) {
+		while (flush());
+	}
+}
+
+template<class Transport>
+bool StaticMouseAPI<Transport>::flush(void)
+{
+	if (!pending()) {
+		return false;
+	}
+	sendPending();
+	return true;
 }
 
-void MouseAPI::buttons(uint8_t b)
+template<class Transport>
+void StaticMouseAPI<Transport>::buttons(uint8_t b)
 {
+	// Button changes are never coalesced
 	if (b != _buttons)
 	{
 		_buttons = b;
-		move(0,0,0);
+		sendPending();
 	}
 }
 
-void MouseAPI::press(uint8_t b)
+template<class Transport>
+void StaticMouseAPI<Transport>::press(uint8_t b)
 {
 	buttons(_buttons | b);
 }
 
-void MouseAPI::release(uint8_t b)
+template<class Transport>
+void StaticMouseAPI<Transport>::release(uint8_t b)
 {
 	buttons(_buttons & ~b);
 }
 
-void MouseAPI::releaseAll(void)
+template<class Transport>
+void StaticMouseAPI<Transport>::releaseAll(void)
 {
   _buttons = 0;
-	move(0,0,0);
+	sendPending();
 }
 
-bool MouseAPI::isPressed(uint8_t b)
+template<class Transport>
+bool StaticMouseAPI<Transport>::isPressed(uint8_t b)
 {
 	if ((b & _buttons) > 0)
 		return true;
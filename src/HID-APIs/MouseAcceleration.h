@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "MouseAPI.h"
+#include "AbsoluteMouseAPI.h"
+
+// Gain of 1.0 in the curves and the scale
+#define MOUSE_ACCELERATION_ONE 256
+
+// Gain 1.0 up to a speed of 4, then rising to 3.0 at 48 counts per move.
+// One entry per 4 counts (shift 2), 8.8 fixed point.
+static const uint16_t mouseAccelerationDefault[] PROGMEM = {
+	256, 256, 288, 336, 400, 464, 528, 592, 640, 688, 720, 752, 768
+};
+
+// Acceleration and scaling of relative moves with integers only. The gain
+// is looked up by the speed of a move in a curve in PROGMEM and interpolated
+// between its entries. The fractions of the scaled moves are kept per axis
+// and added to the next move, so slow moves with a gain below 1.0 still
+// move the pointer and the sum of the moves is not rounded away.
+class MouseAcceleration
+{
+public:
+	inline MouseAcceleration(void);
+
+	// Gains in 8.8 fixed point, entry i is the gain at a speed of i << shift.
+	// Speeds beyond the last entry use the last gain. NULL is a gain of 1.0.
+	inline void setCurve(const uint16_t* curve, uint8_t size, uint8_t shift = 2);
+
+	// Sensitivity applied after the curve, 8.8 fixed point
+	inline void setScale(uint16_t scale);
+
+	// Drops the fractions of the last moves
+	inline void reset(void);
+
+	// Accelerates and scales a move in place
+	inline void apply(int16_t& x, int16_t& y);
+
+	// Gain of the curve and the scale at a speed, 8.8 fixed point
+	inline uint32_t gain(uint16_t speed);
+
+	// Sends an accelerated move, moves beyond the report limits of the
+	// 8 bit mouse are split into several moves
+	template<class Transport>
+	inline void move(StaticMouseAPI<Transport>& mouse, int16_t x, int16_t y);
+	template<class Transport>
+	inline void move(StaticAbsoluteMouseAPI<Transport>& mouse, int16_t x, int16_t y);
+
+protected:
+	inline int16_t scaleAxis(int16_t value, uint32_t gain, int16_t& fraction);
+
+	const uint16_t* curve;
+	uint8_t size;
+	uint8_t shift;
+	uint16_t scale;
+
+	// Fractions of the last moves in 1/256 counts
+	int16_t fractionX;
+	int16_t fractionY;
+};
+
+// Implementation is inline
+#include "MouseAcceleration.hpp"
@@ -0,0 +1,116 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+// Include guard
+#pragma once
+
+MouseAcceleration::MouseAcceleration(void) : curve(NULL), size(0), shift(0),
+scale(MOUSE_ACCELERATION_ONE), fractionX(0), fractionY(0)
+{
+	// Empty
+}
+
+void MouseAcceleration::setCurve(const uint16_t* curve, uint8_t size, uint8_t shift)
+{
+	this->curve = size ? curve : NULL;
+	this->size = size;
+	this->shift = shift;
+}
+
+void MouseAcceleration::setScale(uint16_t scale)
+{
+	this->scale = scale;
+}
+
+void MouseAcceleration::reset(void)
+{
+	fractionX = fractionY = 0;
+}
+
+uint32_t MouseAcceleration::gain(uint16_t speed)
+{
+	if (!curve) {
+		return min(scale, (uint16_t)0xFFFF);
+	}
+
+	// Linear between the two entries around the speed
+	uint16_t index = speed >> shift;
+	uint16_t g;
+	if (index >= size - 1) {
+		g = pgm_read_word(curve + size - 1);
+	}
+	else {
+		uint16_t g0 = pgm_read_word(curve + index);
+		uint16_t g1 = pgm_read_word(curve + index + 1);
+		uint16_t step = speed & ((1 << shift) - 1);
+		g = g0 + (((int32_t)g1 - g0) * step >> shift);
+	}
+	// Up to 256 so the scaled moves fit into 32 bits
+	return min(((uint32_t)g * scale) >> 8, (uint32_t)0xFFFF);
+}
+
+int16_t MouseAcceleration::scaleAxis(int16_t value, uint32_t gain, int16_t& fraction)
+{
+	// The fraction is what was rounded down last time, so the sum is exact
+	int32_t scaled = (int32_t)value * (int32_t)gain + fraction;
+	int32_t counts = scaled >> 8;
+	fraction = scaled - (counts << 8);
+	return constrain(counts, -32768, 32767);
+}
+
+void MouseAcceleration::apply(int16_t& x, int16_t& y)
+{
+	// Both axes get the same gain so the direction stays,
+	// the speed is max + 3/8 min, within 7% of the length
+	uint16_t ax = abs(x);
+	uint16_t ay = abs(y);
+	uint16_t speed = (ax > ay) ? ax + ((ay * 3) >> 3) : ay + ((ax * 3) >> 3);
+	uint32_t g = gain(speed);
+	x = scaleAxis(x, g, fractionX);
+	y = scaleAxis(y, g, fractionY);
+}
+
+template<class Transport>
+void MouseAcceleration::move(StaticMouseAPI<Transport>& mouse, int16_t x, int16_t y)
+{
+	apply(x, y);
+#if HID_MOUSE_HIGH_RESOLUTION
+	mouse.move(x, y);
+#else
+	do {
+		int8_t dx = constrain(x, -127, 127);
+		int8_t dy = constrain(y, -127, 127);
+		mouse.move(dx, dy);
+		x -= dx;
+		y -= dy;
+	} while (x || y);
+#endif
+}
+
+template<class Transport>
+void MouseAcceleration::move(StaticAbsoluteMouseAPI<Transport>& mouse, int16_t x, int16_t y)
+{
+	apply(x, y);
+	mouse.move(x, y);
+}
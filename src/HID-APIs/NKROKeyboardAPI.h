@@ -25,6 +25,7 @@ THE SOFTWARE.
 #pragma once
 
 #include "KeyboardAPI.h"
+#include "../HID-Descriptor.h"
 
 // Max value for USB EP_SIZE 16
 // +1 reportID, +1 modifier, +1 custom key
@@ -43,6 +44,41 @@ typedef union ATTRIBUTE_PACKED {
 	uint8_t allkeys[2 + NKRO_KEY_COUNT / 8];
 } HID_NKROKeyboardReport_Data_t;
 
+// Report descriptor of the multi report NKRO keyboard
+template<uint8_t ReportID>
+using HIDNKROKeyboardDescriptor = HIDItems<
+	HIDUsagePage<0x01>,									/* USAGE_PAGE (Generic Desktop) */
+	HIDUsage<0x06>,										/* USAGE (Keyboard) */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		HIDUsagePage<0x07>,								/*   USAGE_PAGE (Keyboard) */
+		/* Keyboard Modifiers (shift, alt, ...) */
+		HIDUsageMinimum<0xE0>,							/*   USAGE_MINIMUM (Keyboard LeftControl) */
+		HIDUsageMaximum<0xE7>,							/*   USAGE_MAXIMUM (Keyboard Right GUI) */
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<1>,
+		HIDReportSize<1>,
+		HIDReportCount<8>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		/* 104 Keys as bitmap */
+		HIDUsageMinimum<0>,
+		HIDUsageMaximum<NKRO_KEY_COUNT - 1>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<1>,
+		HIDReportSize<1>,
+		HIDReportCount<NKRO_KEY_COUNT>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		/* 1 Custom Keyboard key */
+		HIDReportCount<1>,
+		HIDReportSize<8>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<231>,
+		HIDUsageMinimum<0>,								/*   USAGE_MINIMUM (Reserved (no event indicated)) */
+		HIDUsageMaximum<0xE7>,							/*   USAGE_MAXIMUM (Keyboard Right GUI) */
+		HIDInput<HID_DATA | HID_ARRAY | HID_ABSOLUTE>
+	>
+>;
+
 
 class NKROKeyboardAPI : public KeyboardAPI
 {
@@ -50,14 +86,34 @@ public:
   // Implement adding/removing key functions
   inline virtual size_t removeAll(void) override;
 
+  // Bitmap helpers, including modifiers and the custom key
+  inline uint8_t pressedCount(void);
+  inline const HID_NKROKeyboardReport_Data_t& getReport(void);
+
+  // Call callback(KeyboardKeycode) for every pressed key
+  template<typename F>
+  inline void forEachPressed(F callback);
+
+  // Call callback(KeyboardKeycode, bool pressed) for every key
+  // that differs from a previous report (see getReport())
+  template<typename F>
+  inline void forEachChanged(const HID_NKROKeyboardReport_Data_t& previous, F callback);
+
   // Needs to be implemented in a lower level
   virtual int send(void) = 0;
 
 protected:
   HID_NKROKeyboardReport_Data_t _keyReport;
 
+  static inline uint8_t popcount(const uint8_t* data, uint8_t length);
+
+  // Call callback(keycode, bit) for every set bit, keys[n] bit 0 is keycode 8 * n
+  template<typename F>
+  static inline void forEachBit(const uint8_t* keys, uint8_t length, F callback);
+
 private:
   inline virtual size_t set(KeyboardKeycode k, bool s) override;
+  inline virtual size_t setModifiers(uint8_t modifiers, bool s) override;
 };
 
 // Implementation is inline
@@ -76,23 +76,122 @@ size_t NKROKeyboardAPI::set(KeyboardKeycode k, bool s)
 	return 0;
 }
 
-size_t NKROKeyboardAPI::removeAll(void)
+uint8_t NKROKeyboardAPI::popcount(const uint8_t* data, uint8_t length)
 {
-	// Release all keys
-	size_t ret = 0;
-	for (uint8_t i = 0; i < sizeof(_keyReport.allkeys); i++)
+	uint8_t ret = 0;
+#ifdef __AVR__
+	// Nibble lookup table, faster than shifting bit by bit
+	static const uint8_t bits[16] PROGMEM = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	while (length--) {
+		uint8_t b = *data++;
+		if (b) {
+			ret += pgm_read_byte(bits + (b & 0x0F)) + pgm_read_byte(bits + (b >> 4));
+		}
+	}
+#else
+	// Count 32 bit wide on ARM
+	while (length >= 4) {
+		uint32_t w;
+		memcpy(&w, data, sizeof(w));
+		ret += __builtin_popcount(w);
+		data += 4;
+		length -= 4;
+	}
+	while (length--) {
+		ret += __builtin_popcount(*data++);
+	}
+#endif
+	return ret;
+}
+
+
+template<typename F>
+void NKROKeyboardAPI::forEachBit(const uint8_t* keys, uint8_t length, F callback)
+{
+	for (uint8_t i = 0; i < length; i++)
 	{
-		// Is a key in the list or did we found an empty slot?
-		auto bits = _keyReport.allkeys[i];
-		do {
-			if(bits & 0x01){
-				ret++;
+		// Skip empty bytes and stop after the highest set bit
+		uint8_t bits = keys[i];
+		for (uint8_t n = 0; bits; n++, bits >>= 1) {
+			if (bits & 0x01) {
+				callback(uint8_t(i * 8 + n), uint8_t(1 << n));
 			}
-			bits >>=1;
 		}
-		while(bits);
-		_keyReport.allkeys[i] = 0x00;
 	}
+}
+
+
+uint8_t NKROKeyboardAPI::pressedCount(void)
+{
+	// Modifiers and keymap bits plus the custom key
+	return popcount(_keyReport.allkeys, 1 + sizeof(_keyReport.keys)) + (_keyReport.key != KEY_RESERVED);
+}
+
+
+const HID_NKROKeyboardReport_Data_t& NKROKeyboardAPI::getReport(void)
+{
+	return _keyReport;
+}
+
+
+template<typename F>
+void NKROKeyboardAPI::forEachPressed(F callback)
+{
+	forEachBit(&_keyReport.modifiers, 1, [&](uint8_t k, uint8_t) {
+		callback(KeyboardKeycode(KEY_LEFT_CTRL + k));
+	});
+	forEachBit(_keyReport.keys, sizeof(_keyReport.keys), [&](uint8_t k, uint8_t) {
+		callback(KeyboardKeycode(k));
+	});
+	if (_keyReport.key != KEY_RESERVED) {
+		callback(KeyboardKeycode(_keyReport.key));
+	}
+}
+
+
+template<typename F>
+void NKROKeyboardAPI::forEachChanged(const HID_NKROKeyboardReport_Data_t& previous, F callback)
+{
+	// Only the xor of both reports is visited
+	uint8_t changed = _keyReport.modifiers ^ previous.modifiers;
+	forEachBit(&changed, 1, [&](uint8_t k, uint8_t bit) {
+		callback(KeyboardKeycode(KEY_LEFT_CTRL + k), bool(_keyReport.modifiers & bit));
+	});
+	for (uint8_t i = 0; i < sizeof(_keyReport.keys); i++)
+	{
+		changed = _keyReport.keys[i] ^ previous.keys[i];
+		forEachBit(&changed, 1, [&](uint8_t k, uint8_t bit) {
+			callback(KeyboardKeycode(i * 8 + k), bool(_keyReport.keys[i] & bit));
+		});
+	}
+	if (_keyReport.key != previous.key) {
+		if (previous.key != KEY_RESERVED) {
+			callback(KeyboardKeycode(previous.key), false);
+		}
+		if (_keyReport.key != KEY_RESERVED) {
+			callback(KeyboardKeycode(_keyReport.key), true);
+		}
+	}
+}
+
+
+size_t NKROKeyboardAPI::removeAll(void)
+{
+	// Release all keys
+	size_t ret = pressedCount();
+	memset(&_keyReport, 0x00, sizeof(_keyReport));
 	return ret;
 }
 
+
+size_t NKROKeyboardAPI::setModifiers(uint8_t modifiers, bool s)
+{
+	// All modifiers with one mask
+	if(s){
+		_keyReport.modifiers |= modifiers;
+	}
+	else{
+		_keyReport.modifiers &= ~modifiers;
+	}
+	return 1;
+}
@@ -41,10 +41,14 @@ typedef union ATTRIBUTE_PACKED {
 	};
 } HID_SurfaceDialReport_Data_t;
 
-class SurfaceDialAPI
+// Logical range of one report in 0.1 degrees
+#define SURFACEDIAL_ROTATION_LIMIT 3600
+
+template<class Transport>
+class StaticSurfaceDialAPI
 {
 public:
-  inline SurfaceDialAPI(void);
+  inline StaticSurfaceDialAPI(void);
   inline void begin(void);
   inline void end(void);
   inline void click(void);
@@ -54,12 +58,37 @@ public:
 	inline void releaseAll(void);
   inline bool isPressed();
 
-  // Sending is public in the base class for advanced users.
-  virtual void SendReport(void* data, int length) = 0;
+  // Coalescing sums up the rotation and sends it at most once per millisecond
+  // or when the endpoint is ready. Button changes are sent immediately.
+  // Call flush() to send the rest of the rotation, if the device cannot tell.
+  inline void setCoalescing(bool enable);
+  inline bool flush(void);
+
+  // Default of the transport, see SurfaceDialAPI
+  bool ReadyToSend(void) { return false; }
 
 protected:
+  // The transport is bound at compile time, no virtual call is needed
+  Transport& transport(void) { return *static_cast<Transport*>(this); }
+
   bool _button;
+  bool _coalescing;
+  int16_t _pendingRotation;
+  uint8_t _lastSend;
   inline void button(bool b);
+  inline void sendPending(void);
+};
+
+// Sends through virtual functions, the base of the HID-Project devices.
+// Derive from StaticSurfaceDialAPI<Transport> instead to bind the transport at compile time.
+class SurfaceDialAPI : public StaticSurfaceDialAPI<SurfaceDialAPI>
+{
+public:
+  // Sending is public in the base class for advanced users.
+  virtual void SendReport(void* data, int length) = 0;
+
+  // Returns true if a report can be sent without blocking
+  virtual bool ReadyToSend(void) { return false; }
 };
 
 // Implementation is inline
@@ -24,67 +24,122 @@ THE SOFTWARE.
 // Include guard
 #pragma once
 
-SurfaceDialAPI::SurfaceDialAPI(void) : _button(false)
+template<class Transport>
+StaticSurfaceDialAPI<Transport>::StaticSurfaceDialAPI(void) :
+_button(false), _coalescing(false), _pendingRotation(0), _lastSend(0)
 {
 	// Empty
 }
 
-void SurfaceDialAPI::begin(void)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::begin(void)
 {
 	end();
 }
 
-void SurfaceDialAPI::end(void)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::end(void)
 {
 	_button = false;
-	rotate(0);
+	_pendingRotation = 0;
+	sendPending();
 }
 
-void SurfaceDialAPI::click(void)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::click(void)
 {
 	_button = true;
-	rotate(0);
+	sendPending();
 	_button = false;
-	rotate(0);
+	sendPending();
 }
 
-void SurfaceDialAPI::rotate(int16_t rotation)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::rotate(int16_t rotation)
+{
+	// Saturate instead of an undefined overflow
+	int32_t sum = (int32_t)_pendingRotation + rotation;
+	_pendingRotation = constrain(sum, (int32_t)-32768, (int32_t)32767);
+
+	if (!_coalescing) {
+		// Split large rotations into several reports
+		do {
+			sendPending();
+		} while (_pendingRotation);
+	}
+	else if (transport().ReadyToSend() || (uint8_t)millis() != _lastSend) {
+		sendPending();
+	}
+}
+
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::sendPending(void)
 {
 	HID_SurfaceDialReport_Data_t report;
 	report.button = _button;
+
+	// Send as much of the pending rotation as fits into one report
+	int16_t rotation = constrain(_pendingRotation, -SURFACEDIAL_ROTATION_LIMIT, SURFACEDIAL_ROTATION_LIMIT);
+	_pendingRotation -= rotation;
 	report.rotation = rotation;
 	//report.xAxis = x;
 	//report.yAxis = y;
 
-	SendReport(&report, sizeof(report));
+	_lastSend = millis();
+	transport().SendReport(&report, sizeof(report));
+}
+
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::setCoalescing(bool enable)
+{
+	_coalescing = enable;
+	if (!enable) {
+		while (flush());
+	}
+}
+
+template<class Transport>
+bool StaticSurfaceDialAPI<Transport>::flush(void)
+{
+	if (!_pendingRotation) {
+		return false;
+	}
+	sendPending();
+	return true;
 }
 
-void SurfaceDialAPI::button(bool b)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::button(bool b)
 {
+	// Button changes are never coalesced, they take the pending rotation along
 	if (b != _button)
 	{
 		_button = b;
-		rotate(0);
+		sendPending();
 	}
 }
 
-void SurfaceDialAPI::press(void)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::press(void)
 {
 	button(true);
 }
 
-void SurfaceDialAPI::release(void)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::release(void)
 {
 	button(false);
 }
 
-void SurfaceDialAPI::releaseAll(void)
+template<class Transport>
+void StaticSurfaceDialAPI<Transport>::releaseAll(void)
 {
 	_button = false;
-	rotate(0);
+	sendPending();
 }
 
-bool SurfaceDialAPI::isPressed()
+template<class Transport>
+bool StaticSurfaceDialAPI<Transport>::isPressed()
 {
 	return _button;	
 }
@@ -26,6 +26,8 @@ THE SOFTWARE.
 
 #include <Arduino.h>
 #include "HID-Settings.h"
+#include "../HID-Descriptor.h"
+#include "../HID-Suspend.h"
 
 enum SystemKeycode : uint8_t {
 	SYSTEM_POWER_DOWN	= 0x81,
@@ -80,9 +82,29 @@ typedef union ATTRIBUTE_PACKED {
 	uint8_t key;
 } HID_SystemControlReport_Data_t;
 
-class SystemAPI{
+// Report descriptor of the multi report system control
+template<uint8_t ReportID>
+using HIDSystemDescriptor = HIDItems<
+	HIDUsagePage<0x01>,									/* USAGE_PAGE (Generic Desktop) */
+	HIDUsage<0x80>,										/* USAGE (System Control) */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		/* 1 system key */
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<255>,
+		HIDUsageMinimum<0>,								/*   USAGE_MINIMUM (Undefined) */
+		HIDUsageMaximum<0xFF>,							/*   USAGE_MAXIMUM (System Menu Down) */
+		HIDReportCount<1>,
+		HIDReportSize<8>,
+		HIDInput<HID_DATA | HID_ARRAY | HID_ABSOLUTE>
+	>
+>;
+
+template<class Transport>
+class StaticSystemAPI
+{
 public:
-	inline SystemAPI(void);
+	inline StaticSystemAPI(void);
 	inline void begin(void);
 	inline void end(void);
 	inline void write(SystemKeycode s);
@@ -90,6 +112,16 @@ public:
 	inline void release(void);
 	inline void releaseAll(void);
 
+protected:
+	// The transport is bound at compile time, no virtual call is needed
+	Transport& transport(void) { return *static_cast<Transport*>(this); }
+};
+
+// Sends through virtual functions, the base of the HID-Project devices.
+// Derive from StaticSystemAPI<Transport> instead to bind the transport at compile time.
+class SystemAPI : public StaticSystemAPI<SystemAPI>
+{
+public:
 	// Sending is public in the base class for advanced users.
 	virtual void SendReport(void* data, int length) = 0;
 };
@@ -24,40 +24,47 @@ THE SOFTWARE.
 // Include guard
 #pragma once
 
-SystemAPI::SystemAPI(void)
+template<class Transport>
+StaticSystemAPI<Transport>::StaticSystemAPI(void)
 {
 	// Empty
 }
 
-void SystemAPI::begin(void){
+template<class Transport>
+void StaticSystemAPI<Transport>::begin(void){
 	// release all buttons
 	end();
 }
 
-void SystemAPI::end(void){
+template<class Transport>
+void StaticSystemAPI<Transport>::end(void){
 	SystemKeycode _report = HID_SYSTEM_UNASSIGNED;
-	SendReport(&_report, sizeof(_report));
+	transport().SendReport(&_report, sizeof(_report));
 }
 
-void SystemAPI::write(SystemKeycode s){
+template<class Transport>
+void StaticSystemAPI<Transport>::write(SystemKeycode s){
 	press(s);
 	release();
 }
 
-void SystemAPI::release(void){
+template<class Transport>
+void StaticSystemAPI<Transport>::release(void){
 	begin();
 }
 
-void SystemAPI::releaseAll(void){
+template<class Transport>
+void StaticSystemAPI<Transport>::releaseAll(void){
 	begin();
 }
 
-void SystemAPI::press(SystemKeycode s){
-#if defined(__AVR__) && defined(USBCON)
+template<class Transport>
+void StaticSystemAPI<Transport>::press(SystemKeycode s){
+#if defined(USBCON)
 	if (s == SYSTEM_WAKE_UP)
-		USBDevice.wakeupHost();
+		HIDSuspend::wakeupHost();
 	else
 #endif
-		SendReport(&s, sizeof(s));
+		transport().SendReport(&s, sizeof(s));
 }
 
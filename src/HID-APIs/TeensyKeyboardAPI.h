@@ -27,6 +27,14 @@ THE SOFTWARE.
 #include <Arduino.h>
 #include "HID-Settings.h"
 #include "TeensyKeylayouts.h"
+#include "../KeyboardLayouts/KeyboardLayoutDatabase.h"
+
+// Layouts of the layout database read the tables of the Keyboard APIs instead
+// of their own ASCII and ISO-8859-1 tables. Aliases keep their Teensy tables,
+// they differ from the layout they borrow.
+#if defined(KEYBOARD_LOCALE) && !defined(KEYBOARD_LOCALE_ALIAS)
+#define TEENSY_LAYOUT_DATABASE
+#endif
 
 // Keyboard Protocol 1, HID 1.11 spec, Appendix B, page 59-60
 static const uint8_t PROGMEM teensykeyboard_hid_report_desc[] = {
@@ -80,9 +88,9 @@ static const uint8_t PROGMEM teensykeyboard_hid_report_desc[] = {
 
 typedef union ATTRIBUTE_PACKED {
 	// Low level key report: up to 6 keys and shift, ctrl etc at once
-	uint8_t whole8[];
-	uint16_t whole16[];
-	uint32_t whole32[];
+	uint8_t whole8[0];
+	uint16_t whole16[0];
+	uint32_t whole32[0];
 	struct ATTRIBUTE_PACKED {
 		uint8_t modifiers;
 		uint8_t reserved;
@@ -93,12 +101,21 @@ typedef union ATTRIBUTE_PACKED {
 class TeensyKeyboardAPI : public Print
 {
 	public:
-	TeensyKeyboardAPI(void) { }
+	TeensyKeyboardAPI(void) : batch(false), typed(false) { }
 
 	void begin(void) { }
 	void end(void) { }
 	virtual size_t write(uint8_t);
+	// Strings are typed as one batch, consecutive keys share their reports
+	virtual size_t write(const uint8_t *buffer, size_t size);
 	using Print::write;
+	// Strings in flash are decoded and typed as one batch without copying
+	// them to RAM, write_flash() types size bytes of a PROGMEM array
+	using Print::print;
+	using Print::println;
+	size_t print(const __FlashStringHelper* str);
+	size_t println(const __FlashStringHelper* str);
+	size_t write_flash(const void* buffer, size_t size);
 	inline void write_unicode(uint16_t unicode) { write_keycode(unicode_to_keycode(unicode)); }
 	void set_modifier(uint8_t);
 	void set_key1(uint8_t);
@@ -116,8 +133,12 @@ class TeensyKeyboardAPI : public Print
 	// Sending is public in the base class for advanced users.
     virtual void sendReport(void* data, int length) = 0;
 	
-private:
+protected:
+	// Lookup of the layout, protected for devices and benchmarks
 	KEYCODE_TYPE unicode_to_keycode(uint16_t unicode);
+#ifdef TEENSY_LAYOUT_DATABASE
+	KEYCODE_TYPE layout_to_keycode(uint8_t c);
+#endif
 	KEYCODE_TYPE deadkey_to_keycode(KEYCODE_TYPE keycode);
 	uint8_t keycode_to_modifier(KEYCODE_TYPE keycode);
 	uint8_t keycode_to_key(KEYCODE_TYPE keycode);
@@ -125,6 +146,10 @@ private:
 	void releasekey(uint8_t key, uint8_t modifier);
 	void write_keycode(KEYCODE_TYPE key);
 	void write_key(KEYCODE_TYPE code);
+	size_t type_flash(const uint8_t* str, size_t size, bool terminated);
+	void end_batch(void);
+	bool batch;
+	bool typed;
 	uint8_t utf8_state;
 	uint16_t unicode_wchar;
 	uint8_t keyboard_report_data[8];
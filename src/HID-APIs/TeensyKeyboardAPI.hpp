@@ -59,6 +59,300 @@ size_t TeensyKeyboardAPI::write(uint8_t c)
 	return 1;
 }
 
+size_t TeensyKeyboardAPI::write(const uint8_t *buffer, size_t size)
+{
+	batch = true;
+	typed = false;
+	for (size_t i = 0; i < size; i++) {
+		write(buffer[i]);
+	}
+	end_batch();
+	return size;
+}
+
+size_t TeensyKeyboardAPI::print(const __FlashStringHelper* str)
+{
+	return type_flash(reinterpret_cast<const uint8_t*>(str), size_t(-1), true);
+}
+
+size_t TeensyKeyboardAPI::println(const __FlashStringHelper* str)
+{
+	size_t n = print(str);
+	return n + write("\r\n");
+}
+
+size_t TeensyKeyboardAPI::write_flash(const void* buffer, size_t size)
+{
+	return type_flash(reinterpret_cast<const uint8_t*>(buffer), size, false);
+}
+
+// The code points go straight to the layout lookup, the UTF-8 state of
+// write(uint8_t) is not used
+size_t TeensyKeyboardAPI::type_flash(const uint8_t* str, size_t size, bool terminated)
+{
+	size_t count = 0;
+	batch = true;
+	typed = false;
+	while (size) {
+		size_t left = size;
+		uint16_t unicode = keyboardReadUTF8_P(str, size);
+		if (!unicode && terminated) break;
+		write_unicode(unicode);
+		count += left - size;
+	}
+	end_batch();
+	return count;
+}
+
+// Release the last key of the string
+void TeensyKeyboardAPI::end_batch(void)
+{
+	batch = false;
+	if (typed) {
+		keyboard_report_data[0] = 0;
+		keyboard_report_data[2] = 0;
+		send_now();
+	}
+}
+
+
+// Lookup tables for the code points beyond ISO 8859-1 and for the dead keys,
+// generated at compile time from the layout defines
+//
+template<uint8_t... I>
+struct TeensyKeyboardIndices {};
+
+template<uint8_t N, uint8_t... I>
+struct TeensyKeyboardMakeIndices : TeensyKeyboardMakeIndices<N - 1, N - 1, I...> {};
+
+template<uint8_t... I>
+struct TeensyKeyboardMakeIndices<0, I...>
+{
+	typedef TeensyKeyboardIndices<I...> type;
+};
+
+#ifdef KEYCODE_EXTRA00
+typedef struct {
+	uint16_t unicode;
+	KEYCODE_TYPE keycode;
+} unicode_extra_t;
+
+// In the order of the layout
+static constexpr unicode_extra_t unicode_extras[] = {
+	#ifdef KEYCODE_EXTRA00
+	{ UNICODE_EXTRA00, (KEYCODE_EXTRA00) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA01
+	{ UNICODE_EXTRA01, (KEYCODE_EXTRA01) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA02
+	{ UNICODE_EXTRA02, (KEYCODE_EXTRA02) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA03
+	{ UNICODE_EXTRA03, (KEYCODE_EXTRA03) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA04
+	{ UNICODE_EXTRA04, (KEYCODE_EXTRA04) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA05
+	{ UNICODE_EXTRA05, (KEYCODE_EXTRA05) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA06
+	{ UNICODE_EXTRA06, (KEYCODE_EXTRA06) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA07
+	{ UNICODE_EXTRA07, (KEYCODE_EXTRA07) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA08
+	{ UNICODE_EXTRA08, (KEYCODE_EXTRA08) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA09
+	{ UNICODE_EXTRA09, (KEYCODE_EXTRA09) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA0A
+	{ UNICODE_EXTRA0A, (KEYCODE_EXTRA0A) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA0B
+	{ UNICODE_EXTRA0B, (KEYCODE_EXTRA0B) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA0C
+	{ UNICODE_EXTRA0C, (KEYCODE_EXTRA0C) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA0D
+	{ UNICODE_EXTRA0D, (KEYCODE_EXTRA0D) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA0E
+	{ UNICODE_EXTRA0E, (KEYCODE_EXTRA0E) & 0x3FFF },
+	#endif
+	#ifdef KEYCODE_EXTRA0F
+	{ UNICODE_EXTRA0F, (KEYCODE_EXTRA0F) & 0x3FFF },
+	#endif
+};
+
+#define UNICODE_EXTRAS (sizeof(unicode_extras) / sizeof(unicode_extras[0]))
+
+// Number of extras with a smaller code point
+constexpr uint8_t unicode_extra_rank(uint8_t i, uint8_t j = 0)
+{
+	return j >= UNICODE_EXTRAS ? 0 :
+		(unicode_extras[j].unicode < unicode_extras[i].unicode) + unicode_extra_rank(i, j + 1);
+}
+
+constexpr bool unicode_extras_unique(uint8_t i = 0, uint8_t j = 1)
+{
+	return i >= UNICODE_EXTRAS ? true :
+		j >= UNICODE_EXTRAS ? unicode_extras_unique(i + 1, i + 2) :
+		unicode_extras[i].unicode != unicode_extras[j].unicode && unicode_extras_unique(i, j + 1);
+}
+
+static_assert(unicode_extras_unique(), "Every UNICODE_EXTRA code point must be unique");
+
+// Index of the extra at this position of the sorted table
+constexpr uint8_t unicode_extra_sorted(uint8_t rank, uint8_t i = 0)
+{
+	return unicode_extra_rank(i) == rank ? i : unicode_extra_sorted(rank, i + 1);
+}
+
+template<class Indices>
+struct TeensyUnicodeExtras;
+
+template<uint8_t... I>
+struct TeensyUnicodeExtras<TeensyKeyboardIndices<I...>>
+{
+	static const uint16_t unicode[sizeof...(I)];
+	static const KEYCODE_TYPE keycode[sizeof...(I)];
+};
+
+template<uint8_t... I>
+const uint16_t TeensyUnicodeExtras<TeensyKeyboardIndices<I...>>::unicode[sizeof...(I)] PROGMEM = {
+	unicode_extras[unicode_extra_sorted(I)].unicode...
+};
+
+template<uint8_t... I>
+const KEYCODE_TYPE TeensyUnicodeExtras<TeensyKeyboardIndices<I...>>::keycode[sizeof...(I)] PROGMEM = {
+	unicode_extras[unicode_extra_sorted(I)].keycode...
+};
+
+typedef TeensyUnicodeExtras<TeensyKeyboardMakeIndices<UNICODE_EXTRAS>::type> keycodes_extra;
+#endif // KEYCODE_EXTRA00
+
+#ifdef DEADKEYS_MASK
+static_assert(sizeof(KEYCODE_TYPE) == 2, "Dead keys need 16 bit keycodes");
+
+// Lowest bit of the dead key bits
+#define DEADKEYS_UNIT (DEADKEYS_MASK & -DEADKEYS_MASK)
+
+constexpr KEYCODE_TYPE deadkey_source(uint8_t bits)
+{
+	return
+	#ifdef ACUTE_ACCENT_BITS
+		bits == (ACUTE_ACCENT_BITS) / DEADKEYS_UNIT ? (DEADKEY_ACUTE_ACCENT) :
+	#endif
+	#ifdef CEDILLA_BITS
+		bits == (CEDILLA_BITS) / DEADKEYS_UNIT ? (DEADKEY_CEDILLA) :
+	#endif
+	#ifdef CIRCUMFLEX_BITS
+		bits == (CIRCUMFLEX_BITS) / DEADKEYS_UNIT ? (DEADKEY_CIRCUMFLEX) :
+	#endif
+	#ifdef DIAERESIS_BITS
+		bits == (DIAERESIS_BITS) / DEADKEYS_UNIT ? (DEADKEY_DIAERESIS) :
+	#endif
+	#ifdef GRAVE_ACCENT_BITS
+		bits == (GRAVE_ACCENT_BITS) / DEADKEYS_UNIT ? (DEADKEY_GRAVE_ACCENT) :
+	#endif
+	#ifdef TILDE_BITS
+		bits == (TILDE_BITS) / DEADKEYS_UNIT ? (DEADKEY_TILDE) :
+	#endif
+	#ifdef RING_ABOVE_BITS
+		bits == (RING_ABOVE_BITS) / DEADKEYS_UNIT ? (DEADKEY_RING_ABOVE) :
+	#endif
+		0;
+}
+
+// Indexed by the dead key bits of a keycode
+template<class Indices>
+struct TeensyDeadkeys;
+
+template<uint8_t... I>
+struct TeensyDeadkeys<TeensyKeyboardIndices<I...>>
+{
+	static const KEYCODE_TYPE keycode[sizeof...(I)];
+};
+
+template<uint8_t... I>
+const KEYCODE_TYPE TeensyDeadkeys<TeensyKeyboardIndices<I...>>::keycode[sizeof...(I)] PROGMEM = {
+	deadkey_source(I)...
+};
+
+typedef TeensyDeadkeys<TeensyKeyboardMakeIndices<DEADKEYS_MASK / DEADKEYS_UNIT + 1>::type> keycodes_deadkey;
+#endif // DEADKEYS_MASK
+
+
+#if defined(TEENSY_LAYOUT_DATABASE) && defined(DEADKEYS_MASK)
+// Accented Latin-1 letters, typed with a dead key and the base letter.
+// Indexed by the lower 5 bits, capital and small letters share an entry.
+#define LATIN1_GRAVE		1
+#define LATIN1_ACUTE		2
+#define LATIN1_CIRCUMFLEX	3
+#define LATIN1_TILDE		4
+#define LATIN1_DIAERESIS	5
+#define LATIN1_RING_ABOVE	6
+#define LATIN1_CEDILLA		7
+#define LATIN1(accent, letter)	(((accent) << 5) | ((letter) - 'A'))
+
+static const uint8_t PROGMEM latin1_letters[32] = {
+	LATIN1(LATIN1_GRAVE, 'A'),	LATIN1(LATIN1_ACUTE, 'A'),	// À Á
+	LATIN1(LATIN1_CIRCUMFLEX, 'A'),	LATIN1(LATIN1_TILDE, 'A'),	// Â Ã
+	LATIN1(LATIN1_DIAERESIS, 'A'),	LATIN1(LATIN1_RING_ABOVE, 'A'),	// Ä Å
+	0,				LATIN1(LATIN1_CEDILLA, 'C'),	// Æ Ç
+	LATIN1(LATIN1_GRAVE, 'E'),	LATIN1(LATIN1_ACUTE, 'E'),	// È É
+	LATIN1(LATIN1_CIRCUMFLEX, 'E'),	LATIN1(LATIN1_DIAERESIS, 'E'),	// Ê Ë
+	LATIN1(LATIN1_GRAVE, 'I'),	LATIN1(LATIN1_ACUTE, 'I'),	// Ì Í
+	LATIN1(LATIN1_CIRCUMFLEX, 'I'),	LATIN1(LATIN1_DIAERESIS, 'I'),	// Î Ï
+	0,				LATIN1(LATIN1_TILDE, 'N'),	// Ð Ñ
+	LATIN1(LATIN1_GRAVE, 'O'),	LATIN1(LATIN1_ACUTE, 'O'),	// Ò Ó
+	LATIN1(LATIN1_CIRCUMFLEX, 'O'),	LATIN1(LATIN1_TILDE, 'O'),	// Ô Õ
+	LATIN1(LATIN1_DIAERESIS, 'O'),	0,				// Ö ×
+	0,				LATIN1(LATIN1_GRAVE, 'U'),	// Ø Ù
+	LATIN1(LATIN1_ACUTE, 'U'),	LATIN1(LATIN1_CIRCUMFLEX, 'U'),	// Ú Û
+	LATIN1(LATIN1_DIAERESIS, 'U'),	LATIN1(LATIN1_ACUTE, 'Y'),	// Ü Ý
+	0,				LATIN1(LATIN1_DIAERESIS, 'Y'),	// Þ ÿ, ß has no accent
+};
+
+// Dead key bits of an accent, 0 if the layout has no such dead key
+constexpr KEYCODE_TYPE latin1_deadkey_bits(uint8_t accent)
+{
+	return
+	#ifdef GRAVE_ACCENT_BITS
+		accent == LATIN1_GRAVE ? (GRAVE_ACCENT_BITS) :
+	#endif
+	#ifdef ACUTE_ACCENT_BITS
+		accent == LATIN1_ACUTE ? (ACUTE_ACCENT_BITS) :
+	#endif
+	#ifdef CIRCUMFLEX_BITS
+		accent == LATIN1_CIRCUMFLEX ? (CIRCUMFLEX_BITS) :
+	#endif
+	#ifdef TILDE_BITS
+		accent == LATIN1_TILDE ? (TILDE_BITS) :
+	#endif
+	#ifdef DIAERESIS_BITS
+		accent == LATIN1_DIAERESIS ? (DIAERESIS_BITS) :
+	#endif
+	#ifdef RING_ABOVE_BITS
+		accent == LATIN1_RING_ABOVE ? (RING_ABOVE_BITS) :
+	#endif
+	#ifdef CEDILLA_BITS
+		accent == LATIN1_CEDILLA ? (CEDILLA_BITS) :
+	#endif
+		0;
+}
+
+static const KEYCODE_TYPE PROGMEM latin1_deadkeys[8] = {
+	latin1_deadkey_bits(0), latin1_deadkey_bits(1), latin1_deadkey_bits(2), latin1_deadkey_bits(3),
+	latin1_deadkey_bits(4), latin1_deadkey_bits(5), latin1_deadkey_bits(6), latin1_deadkey_bits(7)
+};
+#endif
+
 
 // Step #2: translate Unicode code point to keystroke sequence
 //
@@ -70,6 +364,9 @@ KEYCODE_TYPE TeensyKeyboardAPI::unicode_to_keycode(uint16_t cpoint)
 		if (cpoint == 10) return KEY_ENTER & 0x3FFF;
 		return 0;
 	}
+	#ifdef TEENSY_LAYOUT_DATABASE
+	if (cpoint < 0x100) return layout_to_keycode(cpoint);
+	#else
 	if (cpoint < 128) {
 		if (sizeof(KEYCODE_TYPE) == 1) {
 			return pgm_read_byte(keycodes_ascii + (cpoint - 0x20));
@@ -89,38 +386,25 @@ KEYCODE_TYPE TeensyKeyboardAPI::unicode_to_keycode(uint16_t cpoint)
 		return 0;
 	}
 	#endif
-	//#ifdef UNICODE_20AC
-	//if (cpoint == 0x20AC) return UNICODE_20AC & 0x3FFF;
-	//#endif
+	#endif // TEENSY_LAYOUT_DATABASE
 	#ifdef KEYCODE_EXTRA00
-	if (cpoint == UNICODE_EXTRA00) return KEYCODE_EXTRA00 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA01
-	if (cpoint == UNICODE_EXTRA01) return KEYCODE_EXTRA01 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA02
-	if (cpoint == UNICODE_EXTRA02) return KEYCODE_EXTRA02 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA03
-	if (cpoint == UNICODE_EXTRA03) return KEYCODE_EXTRA03 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA04
-	if (cpoint == UNICODE_EXTRA04) return KEYCODE_EXTRA04 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA05
-	if (cpoint == UNICODE_EXTRA05) return KEYCODE_EXTRA05 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA06
-	if (cpoint == UNICODE_EXTRA06) return KEYCODE_EXTRA06 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA07
-	if (cpoint == UNICODE_EXTRA07) return KEYCODE_EXTRA07 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA08
-	if (cpoint == UNICODE_EXTRA08) return KEYCODE_EXTRA08 & 0x3FFF;
-	#endif
-	#ifdef KEYCODE_EXTRA09
-	if (cpoint == UNICODE_EXTRA09) return KEYCODE_EXTRA09 & 0x3FFF;
+	// Binary search in the sorted extras
+	uint8_t first = 0;
+	uint8_t last = UNICODE_EXTRAS;
+	while (first < last) {
+		uint8_t mid = (first + last) / 2;
+		uint16_t unicode = pgm_read_word(keycodes_extra::unicode + mid);
+		if (unicode == cpoint) {
+			if (sizeof(KEYCODE_TYPE) == 1) {
+				return pgm_read_byte(keycodes_extra::keycode + mid);
+			} else if (sizeof(KEYCODE_TYPE) == 2) {
+				return pgm_read_word(keycodes_extra::keycode + mid);
+			}
+			return 0;
+		}
+		if (unicode < cpoint) first = mid + 1;
+		else last = mid;
+	}
 	#endif
 	return 0;
 }
@@ -137,49 +421,109 @@ void TeensyKeyboardAPI::write_keycode(KEYCODE_TYPE keycode)
 	write_key(keycode);
 }
 
-KEYCODE_TYPE TeensyKeyboardAPI::deadkey_to_keycode(KEYCODE_TYPE keycode)
+#ifdef TEENSY_LAYOUT_DATABASE
+// Lookup in the table of the Keyboard APIs, the characters it does not
+// type directly are composed with the dead keys of the Teensy layout
+KEYCODE_TYPE TeensyKeyboardAPI::layout_to_keycode(uint8_t c)
 {
-	#ifdef DEADKEYS_MASK
-	keycode &= DEADKEYS_MASK;
-	if (keycode == 0) return 0;
-	#ifdef ACUTE_ACCENT_BITS
-	if (keycode == ACUTE_ACCENT_BITS) return DEADKEY_ACUTE_ACCENT;
-	#endif
-	#ifdef CEDILLA_BITS
-	if (keycode == CEDILLA_BITS) return DEADKEY_CEDILLA;
-	#endif
-	#ifdef CIRCUMFLEX_BITS
-	if (keycode == CIRCUMFLEX_BITS) return DEADKEY_CIRCUMFLEX;
-	#endif
-	#ifdef DIAERESIS_BITS
-	if (keycode == DIAERESIS_BITS) return DEADKEY_DIAERESIS;
-	#endif
-	#ifdef GRAVE_ACCENT_BITS
-	if (keycode == GRAVE_ACCENT_BITS) return DEADKEY_GRAVE_ACCENT;
-	#endif
-	#ifdef TILDE_BITS
-	if (keycode == TILDE_BITS) return DEADKEY_TILDE;
+	typedef KeyboardLayoutDatabase<KEYBOARD_LOCALE> layout;
+
+	// The table is ISO-8859-15, which replaced these ISO-8859-1 characters
+	switch (c) {
+	// Spacing accents, the Keyboard tables have the dead key or nothing
+	case '^': return (ASCII_5E) & 0x3FFF;
+	case '`': return (ASCII_60) & 0x3FFF;
+	case '~': return (ASCII_7E) & 0x3FFF;
+	case 0x7F: return (ASCII_7F) & 0x3FFF;
+	#ifdef ISO_8859_1_A0
+	case 0xA4: return (ISO_8859_1_A4) & 0x3FFF;
+	case 0xA6: return (ISO_8859_1_A6) & 0x3FFF;
+	case 0xA8: return (ISO_8859_1_A8) & 0x3FFF;
+	case 0xB4: return (ISO_8859_1_B4) & 0x3FFF;
+	case 0xB8: return (ISO_8859_1_B8) & 0x3FFF;
+	case 0xBC: return (ISO_8859_1_BC) & 0x3FFF;
+	case 0xBD: return (ISO_8859_1_BD) & 0x3FFF;
+	case 0xBE: return (ISO_8859_1_BE) & 0x3FFF;
 	#endif
-	#ifdef RING_ABOVE_BITS
-	if (keycode == RING_ABOVE_BITS) return DEADKEY_RING_ABOVE;
+	}
+	if (c >= 0x80 && c <= 0xA0) return 0;
+
+	uint8_t key = pgm_read_byte(layout::tables.keys + c);
+	if (key) {
+		#ifdef KEY_NON_US_100
+		if (key == 100) key = KEY_NON_US_100;
+		#endif
+		if (key > 0x3F) return 0;
+		KEYCODE_TYPE keycode = key;
+		uint8_t cls = keyboardLayoutClass(layout::tables.modifiers, c);
+		if (cls & KEYBOARD_LAYOUT_SHIFT) keycode |= SHIFT_MASK;
+		if (cls & KEYBOARD_LAYOUT_ALTGR) {
+			#ifdef ALTGR_MASK
+			keycode |= ALTGR_MASK;
+			#else
+			return 0;
+			#endif
+		}
+		return keycode;
+	}
+
+	#ifdef DEADKEYS_MASK
+	// Accented letters
+	if (c < 0xC0 || c == 0xDF) return 0;
+	uint8_t letter = pgm_read_byte(latin1_letters + (c & 0x1F));
+	if (!letter) return 0;
+	uint8_t base = (letter & 0x1F) + ((c & 0x20) ? 'a' : 'A');
+	uint8_t accent = letter >> 5;
+	KEYCODE_TYPE bits = pgm_read_word(latin1_deadkeys + accent);
+	if (!bits) return 0;
+	KEYCODE_TYPE keycode = layout_to_keycode(base);
+	return keycode ? (keycode | bits) : 0;
+	#else
+	return 0;
 	#endif
-	#endif // DEADKEYS_MASK
+}
+#endif // TEENSY_LAYOUT_DATABASE
+
+KEYCODE_TYPE TeensyKeyboardAPI::deadkey_to_keycode(KEYCODE_TYPE keycode)
+{
+	#ifdef DEADKEYS_MASK
+	return pgm_read_word(keycodes_deadkey::keycode + (keycode & DEADKEYS_MASK) / DEADKEYS_UNIT);
+	#else
 	return 0;
+	#endif
 }
 
 // Step #4: do each keystroke
 //
+// Within a string the next key is pressed in the same report that releases
+// the last one, so a character usually costs one report instead of two.
+// A release report is only sent first if the key repeats or if modifiers
+// have to be released, the host could apply them to the new key otherwise.
 void TeensyKeyboardAPI::write_key(KEYCODE_TYPE keycode)
 {
-	keyboard_report_data[0] = keycode_to_modifier(keycode);
+	uint8_t modifier = keycode_to_modifier(keycode);
+	uint8_t key = keycode_to_key(keycode);
+	if (batch && typed) {
+		if (key == keyboard_report_data[2] || (keyboard_report_data[0] & ~modifier)) {
+			keyboard_report_data[0] = 0;
+			keyboard_report_data[2] = 0;
+			send_now();
+		}
+	}
+	keyboard_report_data[0] = modifier;
 	keyboard_report_data[1] = 0;
-	keyboard_report_data[2] = keycode_to_key(keycode);
+	keyboard_report_data[2] = key;
 	keyboard_report_data[3] = 0;
 	keyboard_report_data[4] = 0;
 	keyboard_report_data[5] = 0;
 	keyboard_report_data[6] = 0;
 	keyboard_report_data[7] = 0;
 	send_now();
+	if (batch) {
+		// Released by the next key or at the end of the string
+		typed = true;
+		return;
+	}
 	keyboard_report_data[0] = 0;
 	keyboard_report_data[2] = 0;
 	send_now();
@@ -385,6 +729,7 @@ void TeensyKeyboardAPI::releaseAll(void)
 #endif
 #define M(n) ((n) & 0x3FFF)
 
+#ifndef TEENSY_LAYOUT_DATABASE
 const KEYCODE_TYPE PROGMEM keycodes_ascii[] = {
         M(ASCII_20), M(ASCII_21), M(ASCII_22), M(ASCII_23),
         M(ASCII_24), M(ASCII_25), M(ASCII_26), M(ASCII_27),
@@ -440,3 +785,4 @@ const KEYCODE_TYPE PROGMEM keycodes_iso_8859_1[] = {
         M(ISO_8859_1_FC), M(ISO_8859_1_FD), M(ISO_8859_1_FE), M(ISO_8859_1_FF)
 };
 #endif // ISO_8859_1_A0
+#endif // TEENSY_LAYOUT_DATABASE
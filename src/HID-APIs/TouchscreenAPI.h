@@ -0,0 +1,174 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "../HID-Descriptor.h"
+
+#if (HID_TOUCH_CONTACTS_PER_REPORT < 1) || (HID_TOUCH_CONTACTS_PER_REPORT > HID_TOUCH_CONTACTS)
+#error HID_TOUCH_CONTACTS_PER_REPORT needs to be 1 - HID_TOUCH_CONTACTS.
+#endif
+
+// Report ID, 6 bytes per contact, scan time and contact count
+#if (1 + HID_TOUCH_CONTACTS_PER_REPORT * 6 + 3) > 64
+#error The touchscreen report does not fit into a 64 byte endpoint.
+#endif
+
+// Absolute coordinates, like the AbsoluteMouse
+#define TOUCH_MAXIMUM 32767
+
+typedef struct ATTRIBUTE_PACKED {
+	uint8_t tip;
+	uint8_t id;
+	uint16_t xAxis;
+	uint16_t yAxis;
+} HID_TouchContact_Data_t;
+
+typedef union ATTRIBUTE_PACKED {
+	// Touchscreen report: contacts, scan time in 100us, contact count
+	uint8_t whole8[0];
+	uint16_t whole16[0];
+	uint32_t whole32[0];
+	struct ATTRIBUTE_PACKED {
+		HID_TouchContact_Data_t contacts[HID_TOUCH_CONTACTS_PER_REPORT];
+		uint16_t scanTime;
+		uint8_t contactCount;
+	};
+} HID_TouchscreenReport_Data_t;
+
+// Touch screen with Contacts finger collections per report. The maximum
+// contact count is a feature report, only devices which can answer
+// GET_REPORT(Feature) should declare it.
+template<uint8_t ReportID, uint8_t Contacts = HID_TOUCH_CONTACTS_PER_REPORT,
+	uint8_t MaximumContacts = HID_TOUCH_CONTACTS, bool Feature = (ReportID == 0)>
+using HIDTouchscreenDescriptor = HIDItems<
+	HIDUsagePage<0x0D>,									/* USAGE_PAGE (Digitizers) */
+	HIDUsage<0x04>,										/* USAGE (Touch Screen) */
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportID<ReportID>,
+		HIDRepeat<Contacts,
+			HIDUsagePage<0x0D>,							/*   USAGE_PAGE (Digitizers) */
+			HIDUsage<0x22>,								/*   USAGE (Finger) */
+			HIDCollection<HID_COLLECTION_LOGICAL,
+				HIDUsage<0x42>,							/*     USAGE (Tip Switch) */
+				HIDLogicalMinimum<0>,
+				HIDLogicalMaximum<1>,
+				HIDReportSize<1>,
+				HIDReportCount<1>,
+				HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+				HIDReportCount<7>,
+				HIDInput<HID_CONSTANT | HID_VARIABLE | HID_ABSOLUTE>,
+				HIDUsage<0x51>,							/*     USAGE (Contact Identifier) */
+				HIDLogicalMaximum<127>,
+				HIDReportSize<8>,
+				HIDReportCount<1>,
+				HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+				HIDUsagePage<0x01>,						/*     USAGE_PAGE (Generic Desktop) */
+				HIDUsage<0x30>,							/*     USAGE (X) */
+				HIDUsage<0x31>,							/*     USAGE (Y) */
+				HIDLogicalMaximum<TOUCH_MAXIMUM>,
+				HIDReportSize<16>,
+				HIDReportCount<2>,
+				HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+			>
+		>,
+		HIDUsagePage<0x0D>,								/*   USAGE_PAGE (Digitizers) */
+		HIDUsage<0x56>,									/*   USAGE (Scan Time) */
+		HIDUnitExponent<-4>,							/*   UNIT_EXPONENT (-4) */
+		HIDUnit<0x1001>,								/*   UNIT (Seconds, SI Linear) */
+		HIDLogicalMaximum<65535>,
+		HIDReportSize<16>,
+		HIDReportCount<1>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		HIDUnitExponent<0>,
+		HIDUnit<0>,
+		HIDUsage<0x54>,									/*   USAGE (Contact Count) */
+		HIDLogicalMaximum<127>,
+		HIDReportSize<8>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+		HIDOptional<Feature,
+			HIDUsage<0x55>,								/*   USAGE (Contact Count Maximum) */
+			HIDLogicalMaximum<MaximumContacts>,
+			HIDFeature<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+		>
+	>
+>;
+
+// Contacts are set with press(), move() and release() and sent together
+// with send(), once per scan. All touching contacts are part of every scan.
+template<class Transport>
+class StaticTouchscreenAPI
+{
+public:
+	inline StaticTouchscreenAPI(void);
+	inline void begin(void);
+	inline void end(void);
+
+	// Returns false if all HID_TOUCH_CONTACTS are in use
+	inline bool press(uint8_t id, uint16_t x, uint16_t y);
+	inline bool move(uint8_t id, uint16_t x, uint16_t y);
+	inline void release(uint8_t id);
+	inline void releaseAll(void);
+	inline bool isPressed(uint8_t id);
+
+	// Number of contacts the next send() reports, including released ones
+	inline uint8_t contacts(void);
+
+	// Send the scan in as few reports as possible
+	inline void send(void);
+
+protected:
+	// The transport is bound at compile time, no virtual call is needed
+	Transport& transport(void) { return *static_cast<Transport*>(this); }
+
+	enum {
+		TOUCH_FREE = 0,
+		TOUCH_PRESSED,
+		TOUCH_RELEASED
+	};
+
+	struct Contact {
+		uint8_t state;
+		uint8_t id;
+		uint16_t xAxis;
+		uint16_t yAxis;
+	};
+	Contact _contacts[HID_TOUCH_CONTACTS];
+
+	inline Contact* find(uint8_t id);
+};
+
+// Sends through virtual functions, the base of the HID-Project devices.
+// Derive from StaticTouchscreenAPI<Transport> instead to bind the transport at compile time.
+class TouchscreenAPI : public StaticTouchscreenAPI<TouchscreenAPI>
+{
+public:
+	// Sending is public in the base class for advanced users.
+	virtual void SendReport(void* data, int length) = 0;
+};
+
+// Implementation is inline
+#include "TouchscreenAPI.hpp"
@@ -0,0 +1,167 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+template<class Transport>
+StaticTouchscreenAPI<Transport>::StaticTouchscreenAPI(void)
+{
+	memset(_contacts, 0, sizeof(_contacts));
+}
+
+template<class Transport>
+void StaticTouchscreenAPI<Transport>::begin(void)
+{
+	end();
+}
+
+template<class Transport>
+void StaticTouchscreenAPI<Transport>::end(void)
+{
+	releaseAll();
+	send();
+}
+
+template<class Transport>
+typename StaticTouchscreenAPI<Transport>::Contact* StaticTouchscreenAPI<Transport>::find(uint8_t id)
+{
+	for (uint8_t i = 0; i < HID_TOUCH_CONTACTS; i++) {
+		if (_contacts[i].state != TOUCH_FREE && _contacts[i].id == id) {
+			return &_contacts[i];
+		}
+	}
+	return nullptr;
+}
+
+template<class Transport>
+bool StaticTouchscreenAPI<Transport>::press(uint8_t id, uint16_t x, uint16_t y)
+{
+	Contact* contact = find(id);
+
+	// A new contact takes the first free slot
+	for (uint8_t i = 0; !contact && i < HID_TOUCH_CONTACTS; i++) {
+		if (_contacts[i].state == TOUCH_FREE) {
+			contact = &_contacts[i];
+		}
+	}
+	if (!contact) {
+		return false;
+	}
+	contact->state = TOUCH_PRESSED;
+	contact->id = id;
+	contact->xAxis = min(x, (uint16_t)TOUCH_MAXIMUM);
+	contact->yAxis = min(y, (uint16_t)TOUCH_MAXIMUM);
+	return true;
+}
+
+template<class Transport>
+bool StaticTouchscreenAPI<Transport>::move(uint8_t id, uint16_t x, uint16_t y)
+{
+	if (!isPressed(id)) {
+		return false;
+	}
+	return press(id, x, y);
+}
+
+template<class Transport>
+void StaticTouchscreenAPI<Transport>::release(uint8_t id)
+{
+	Contact* contact = find(id);
+
+	// Lifted at the last position with the next scan
+	if (contact) {
+		contact->state = TOUCH_RELEASED;
+	}
+}
+
+template<class Transport>
+void StaticTouchscreenAPI<Transport>::releaseAll(void)
+{
+	for (uint8_t i = 0; i < HID_TOUCH_CONTACTS; i++) {
+		if (_contacts[i].state != TOUCH_FREE) {
+			_contacts[i].state = TOUCH_RELEASED;
+		}
+	}
+}
+
+template<class Transport>
+bool StaticTouchscreenAPI<Transport>::isPressed(uint8_t id)
+{
+	Contact* contact = find(id);
+	return contact && contact->state == TOUCH_PRESSED;
+}
+
+template<class Transport>
+uint8_t StaticTouchscreenAPI<Transport>::contacts(void)
+{
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < HID_TOUCH_CONTACTS; i++) {
+		if (_contacts[i].state != TOUCH_FREE) {
+			count++;
+		}
+	}
+	return count;
+}
+
+template<class Transport>
+void StaticTouchscreenAPI<Transport>::send(void)
+{
+	uint8_t count = contacts();
+	if (!count) {
+		return;
+	}
+
+	// All reports of one scan have the same scan time
+	HID_TouchscreenReport_Data_t report;
+	memset(&report, 0, sizeof(report));
+	report.scanTime = micros() / 100;
+	report.contactCount = count;
+
+	uint8_t n = 0;
+	for (uint8_t i = 0; i < HID_TOUCH_CONTACTS; i++) {
+		Contact& contact = _contacts[i];
+		if (contact.state == TOUCH_FREE) {
+			continue;
+		}
+		HID_TouchContact_Data_t& data = report.contacts[n++];
+		data.tip = (contact.state == TOUCH_PRESSED);
+		data.id = contact.id;
+		data.xAxis = contact.xAxis;
+		data.yAxis = contact.yAxis;
+
+		// A released contact is reported once
+		if (contact.state == TOUCH_RELEASED) {
+			contact.state = TOUCH_FREE;
+		}
+
+		// Following reports of the scan have a contact count of 0
+		count--;
+		if (n == HID_TOUCH_CONTACTS_PER_REPORT || !count) {
+			transport().SendReport(&report, sizeof(report));
+			memset(report.contacts, 0, sizeof(report.contacts));
+			report.contactCount = 0;
+			n = 0;
+		}
+	}
+}
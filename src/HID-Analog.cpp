@@ -0,0 +1,304 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Analog.h"
+
+HIDAnalog* HIDAnalog::active = NULL;
+
+HIDAnalog::HIDAnalog(const uint8_t* pins, const uint8_t* axes, uint8_t count, HIDAnalogChannel* buffer) :
+	channels(buffer), count(count), current(0), filter(2), threshold(2 << (16 - HID_ANALOG_BITS))
+{
+	for (uint8_t i = 0; i < count; i++) {
+		HIDAnalogChannel& c = channels[i];
+		c.pin = pins[i];
+		c.axis = axes[i];
+		c.filtered = (HID_ANALOG_MAX / 2) << HID_ANALOG_FRACTION;
+		c.value = 0;
+		setCalibration(i, 0, HID_ANALOG_MAX / 2, HID_ANALOG_MAX);
+	}
+}
+
+void HIDAnalog::setCalibration(uint8_t channel, uint16_t minimum, uint16_t center, uint16_t maximum, uint16_t deadZone)
+{
+	HIDAnalogChannel& c = channels[channel];
+	c.center = center << HID_ANALOG_FRACTION;
+	c.deadZone = deadZone << HID_ANALOG_FRACTION;
+
+	// Ranges outside of the dead zone and their scale to the axis (Q8).
+	// The offset is limited to the range, so the product fits 32 bit.
+	int32_t low = (int32_t)center - minimum - deadZone;
+	int32_t high = (int32_t)maximum - center - deadZone;
+	c.rangeLow = (low > 0 ? low : 1) << HID_ANALOG_FRACTION;
+	c.rangeHigh = (high > 0 ? high : 1) << HID_ANALOG_FRACTION;
+	c.scaleLow = (32768UL << 8) / c.rangeLow;
+	c.scaleHigh = (32767UL << 8) / c.rangeHigh;
+}
+
+uint16_t HIDAnalog::read(uint8_t channel)
+{
+	// The interrupt writes the sample, 16 bit are not atomic on AVR
+	noInterrupts();
+	uint16_t f = channels[channel].filtered;
+	interrupts();
+	return f >> HID_ANALOG_FRACTION;
+}
+
+int16_t HIDAnalog::value(uint8_t channel)
+{
+	HIDAnalogChannel& c = channels[channel];
+	noInterrupts();
+	uint16_t f = c.filtered;
+	interrupts();
+
+	if (f > c.center + c.deadZone) {
+		uint32_t offset = f - c.center - c.deadZone;
+		if (offset >= c.rangeHigh) {
+			return 32767;
+		}
+		return (offset * c.scaleHigh) >> 8;
+	}
+	if (f + c.deadZone < c.center) {
+		uint32_t offset = c.center - c.deadZone - f;
+		if (offset >= c.rangeLow) {
+			return -32768;
+		}
+		return -(int16_t)((offset * c.scaleLow) >> 8);
+	}
+	return 0;
+}
+
+void HIDAnalog::sample(HIDAnalogChannel& c, uint16_t raw)
+{
+	// Exponential moving average with fraction bits, so small steps still move it
+	uint16_t x = raw << HID_ANALOG_FRACTION;
+	uint16_t f = c.filtered;
+	if (x > f) {
+		f += (x - f) >> filter;
+	}
+	else {
+		f -= (f - x) >> filter;
+	}
+	c.filtered = f;
+}
+
+#if defined(ARDUINO_ARCH_AVR) && defined(HID_ANALOG_INTERRUPT)
+
+static inline void convert(uint8_t mux)
+{
+#ifdef MUX5
+	ADCSRB = (ADCSRB & ~(1 << MUX5)) | (((mux >> 3) & 0x01) << MUX5);
+#endif
+	ADMUX = (1 << REFS0) | (mux & 0x07);
+	ADCSRA |= (1 << ADSC);
+}
+
+void HIDAnalog::begin(void)
+{
+	if (!count) {
+		return;
+	}
+
+	// Channel of the pin like analogRead(), with AVcc as reference
+	for (uint8_t i = 0; i < count; i++) {
+		uint8_t pin = channels[i].pin;
+		if (pin >= A0) {
+			pin -= A0;
+		}
+#ifdef analogPinToChannel
+		pin = analogPinToChannel(pin);
+#endif
+		channels[i].mux = pin;
+	}
+	current = 0;
+	active = this;
+
+	// Every conversion (13 ADC clocks) raises the interrupt, which starts
+	// the next channel. The free running mode cannot switch the channel
+	// without losing the following sample, so each conversion is started.
+	ADCSRA |= (1 << ADEN) | (1 << ADIF) | (1 << ADIE);
+	convert(channels[0].mux);
+}
+
+void HIDAnalog::end(void)
+{
+	active = NULL;
+	ADCSRA &= ~(1 << ADIE);
+
+	// analogRead() would get the result of the running conversion
+	while (ADCSRA & (1 << ADSC));
+}
+
+void HIDAnalog::next(void)
+{
+	sample(channels[current], ADC);
+	if (++current >= count) {
+		current = 0;
+	}
+	convert(channels[current].mux);
+}
+
+ISR(ADC_vect)
+{
+	if (HIDAnalog::active) {
+		HIDAnalog::active->next();
+	}
+}
+
+#elif defined(ARDUINO_ARCH_SAMD) && defined(HID_ANALOG_INTERRUPT)
+
+static inline void convert(uint8_t mux)
+{
+	ADC->INPUTCTRL.bit.MUXPOS = mux;
+	while (ADC->STATUS.bit.SYNCBUSY);
+	ADC->SWTRIG.bit.START = 1;
+}
+
+void HIDAnalog::begin(void)
+{
+	if (!count) {
+		return;
+	}
+
+	// analogRead() sets up the pin multiplexer, the reference and the gain
+	for (uint8_t i = 0; i < count; i++) {
+		uint8_t pin = channels[i].pin;
+		if (pin < A0) {
+			pin += A0;
+		}
+		analogRead(pin);
+		channels[i].mux = g_APinDescription[pin].ulADCChannelNumber;
+	}
+	current = 0;
+	active = this;
+
+	ADC->CTRLA.bit.ENABLE = 1;
+	while (ADC->STATUS.bit.SYNCBUSY);
+	ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+	ADC->INTENSET.reg = ADC_INTFLAG_RESRDY;
+	NVIC_EnableIRQ(ADC_IRQn);
+	convert(channels[0].mux);
+}
+
+void HIDAnalog::end(void)
+{
+	active = NULL;
+	ADC->INTENCLR.reg = ADC_INTFLAG_RESRDY;
+	NVIC_DisableIRQ(ADC_IRQn);
+
+	// analogRead() enables it again
+	ADC->CTRLA.bit.ENABLE = 0;
+	while (ADC->STATUS.bit.SYNCBUSY);
+}
+
+void HIDAnalog::next(void)
+{
+	sample(channels[current], ADC->RESULT.reg);
+	if (++current >= count) {
+		current = 0;
+	}
+	convert(channels[current].mux);
+}
+
+extern "C" void ADC_Handler(void)
+{
+	ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+	if (HIDAnalog::active) {
+		HIDAnalog::active->next();
+	}
+}
+
+#elif defined(HID_ANALOG_FREERUN)
+
+void HIDAnalog::begin(void)
+{
+	// analogRead() sets up the ADC, then all channels are converted
+	// continuously and each has its own data register
+	uint32_t mask = 0;
+	for (uint8_t i = 0; i < count; i++) {
+		uint8_t pin = channels[i].pin;
+		if (pin < A0) {
+			pin += A0;
+		}
+		analogRead(pin);
+		channels[i].mux = g_APinDescription[pin].ulADCChannelNumber;
+		mask |= 1UL << channels[i].mux;
+	}
+	if (!mask) {
+		return;
+	}
+	active = this;
+
+	ADC->ADC_CHER = mask;
+	ADC->ADC_MR |= ADC_MR_FREERUN_ON;
+	ADC->ADC_CR = ADC_CR_START;
+}
+
+void HIDAnalog::end(void)
+{
+	active = NULL;
+	ADC->ADC_MR &= ~ADC_MR_FREERUN_ON;
+	for (uint8_t i = 0; i < count; i++) {
+		ADC->ADC_CHDR = 1UL << channels[i].mux;
+	}
+}
+
+void HIDAnalog::next(void)
+{
+	if (active != this) {
+		return;
+	}
+	for (uint8_t i = 0; i < count; i++) {
+		sample(channels[i], ADC->ADC_CDR[channels[i].mux] & HID_ANALOG_MAX);
+	}
+}
+
+#else
+
+void HIDAnalog::begin(void)
+{
+#if !defined(ARDUINO_ARCH_AVR)
+	analogReadResolution(HID_ANALOG_BITS);
+#endif
+	current = 0;
+	active = this;
+}
+
+void HIDAnalog::end(void)
+{
+	active = NULL;
+}
+
+void HIDAnalog::next(void)
+{
+	if (active != this || !count) {
+		return;
+	}
+
+	// One conversion per call, so poll() does not block for all channels
+	sample(channels[current], analogRead(channels[current].pin));
+	if (++current >= count) {
+		current = 0;
+	}
+}
+
+#endif
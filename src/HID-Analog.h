@@ -0,0 +1,206 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Resolution of the samples and the calibration values.
+// AVR and SAMD21: the next channel is converted from the ADC interrupt.
+// SAM: the ADC converts all channels in free running mode.
+// Other cores: poll() converts one channel per call with analogRead().
+#if defined(ARDUINO_ARCH_AVR) && defined(ADCSRA)
+#define HID_ANALOG_INTERRUPT
+#define HID_ANALOG_BITS 10
+#elif defined(ARDUINO_ARCH_SAMD) && !defined(__SAMD51__)
+#define HID_ANALOG_INTERRUPT
+#define HID_ANALOG_BITS 10
+#elif defined(ARDUINO_ARCH_SAM)
+#define HID_ANALOG_FREERUN
+#define HID_ANALOG_BITS 12
+#else
+#define HID_ANALOG_BITS 10
+#endif
+
+#define HID_ANALOG_MAX ((1 << HID_ANALOG_BITS) - 1)
+
+// Fraction bits of the filtered samples
+#define HID_ANALOG_FRACTION 4
+
+// Gamepad axes a channel is pushed into
+enum HIDAnalogAxis : uint8_t
+{
+	HID_ANALOG_X,
+	HID_ANALOG_Y,
+	HID_ANALOG_Z,
+	HID_ANALOG_RX,
+	HID_ANALOG_RY,
+	HID_ANALOG_RZ,
+	HID_ANALOG_NONE,
+};
+
+// State of one channel, the sample is written by the ADC interrupt
+struct HIDAnalogChannel
+{
+	uint8_t pin;
+	uint8_t mux;
+	uint8_t axis;
+	volatile uint16_t filtered;
+	uint16_t center;
+	uint16_t deadZone;
+	uint16_t rangeLow;
+	uint16_t rangeHigh;
+	uint32_t scaleLow;
+	uint32_t scaleHigh;
+	int16_t value;
+};
+
+// Samples analog inputs in the background and feeds them into gamepad axes.
+// The samples are filtered with an exponential moving average, then mapped
+// from the calibration (minimum, center, maximum) to -32768..32767 with a
+// dead zone around the center. All of it is fixed point math.
+// An axis is only pushed if it moved at least the threshold, so noise does
+// not send reports. The ADC is owned by the pipeline between begin() and
+// end(), analogRead() must not be used meanwhile.
+class HIDAnalog
+{
+public:
+	// The pins are the analog pins (A0...), the axes one HIDAnalogAxis per pin
+	HIDAnalog(const uint8_t* pins, const uint8_t* axes, uint8_t count, HIDAnalogChannel* buffer);
+
+	// Set up the channels and start the conversions
+	void begin(void);
+	void end(void);
+
+	// Calibration of a channel in ADC counts (0-HID_ANALOG_MAX).
+	// Values within deadZone around the center read as 0.
+	void setCalibration(uint8_t channel, uint16_t minimum, uint16_t center, uint16_t maximum, uint16_t deadZone = 0);
+
+	// Filter strength, each sample moves the value by 1/2^shift (0-4, 0 is off)
+	void setFilter(uint8_t shift){
+		filter = shift > HID_ANALOG_FRACTION ? HID_ANALOG_FRACTION : shift;
+	}
+
+	// Minimum change of an axis (in 16 bit axis units) that is pushed,
+	// 2 ADC counts of the full scale by default
+	void setThreshold(uint16_t units){
+		threshold = units;
+	}
+
+	// Filtered sample in ADC counts
+	uint16_t read(uint8_t channel);
+
+	// Calibrated value, -32768 to 32767
+	int16_t value(uint8_t channel);
+
+	// Push the axes which changed beyond the threshold and send the report.
+	// Works with the Gamepad of both the virtual and the static API.
+	// Returns true if an axis was pushed.
+	template<class Gamepad>
+	bool poll(Gamepad& gamepad);
+
+	// Take the sample of the current channel and start the next one.
+	// Called from the ADC interrupt, or by poll() without interrupt.
+	void next(void);
+
+	static HIDAnalog* active;
+
+protected:
+	// Filter a new sample into a channel
+	void sample(HIDAnalogChannel& c, uint16_t raw);
+
+	HIDAnalogChannel* channels;
+	uint8_t count;
+	volatile uint8_t current;
+	uint8_t filter;
+	uint16_t threshold;
+};
+
+template<class Gamepad>
+bool HIDAnalog::poll(Gamepad& gamepad)
+{
+#if !defined(HID_ANALOG_INTERRUPT)
+	next();
+#endif
+
+	bool pushed = false;
+	for (uint8_t i = 0; i < count; i++) {
+		HIDAnalogChannel& c = channels[i];
+		int16_t v = value(i);
+
+		// Always push the center and the end positions, they might be
+		// closer than the threshold to the last value
+		int32_t diff = (int32_t)v - c.value;
+		if (diff < 0) {
+			diff = -diff;
+		}
+		if (!diff || (diff < threshold && v != 0 && v != 32767 && v != -32768)) {
+			continue;
+		}
+		c.value = v;
+		pushed = true;
+
+		switch (c.axis) {
+		case HID_ANALOG_X:
+			gamepad.xAxis(v);
+			break;
+		case HID_ANALOG_Y:
+			gamepad.yAxis(v);
+			break;
+		case HID_ANALOG_Z:
+			gamepad.zAxis(v >> 8);
+			break;
+		case HID_ANALOG_RX:
+			gamepad.rxAxis(v);
+			break;
+		case HID_ANALOG_RY:
+			gamepad.ryAxis(v);
+			break;
+		case HID_ANALOG_RZ:
+			gamepad.rzAxis(v >> 8);
+			break;
+		}
+	}
+
+	if (pushed) {
+		gamepad.update();
+	}
+	return pushed;
+}
+
+// Pipeline with the buffer for the given number of channels
+template<uint8_t Channels>
+class HIDAnalogBuffer : public HIDAnalog
+{
+public:
+	HIDAnalogBuffer(const uint8_t* pins, const uint8_t* axes) :
+		HIDAnalog(pins, axes, Channels, buffer)
+	{
+		// Empty
+	}
+
+protected:
+	HIDAnalogChannel buffer[Channels];
+};
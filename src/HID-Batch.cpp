@@ -0,0 +1,90 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Batch.h"
+
+#define HID_BATCH_HEADER 3
+
+uint8_t HIDReportBatch::depth = 0;
+
+#if HID_REPORT_BATCH
+uint8_t HIDReportBatch::buffer[HID_REPORT_BATCH];
+uint8_t HIDReportBatch::used = 0;
+#endif
+
+void HIDReportBatch::begin(void)
+{
+	depth++;
+}
+
+int HIDReportBatch::end(void)
+{
+	if (!depth) {
+		return 0;
+	}
+	depth--;
+#if HID_REPORT_BATCH
+	if (!depth) {
+		return flush();
+	}
+#endif
+	return 0;
+}
+
+#if HID_REPORT_BATCH
+int HIDReportBatch::collect(uint8_t id, uint8_t priority, const void* data, int length)
+{
+	// Reports which do not fit are sent right away, after the older ones
+	if (used + HID_BATCH_HEADER + length > HID_REPORT_BATCH) {
+		flush();
+		if (HID_BATCH_HEADER + length > HID_REPORT_BATCH) {
+			return sendNow(id, data, length);
+		}
+	}
+
+	uint8_t* entry = buffer + used;
+	entry[0] = id;
+	entry[1] = min(priority, (uint8_t)(HID_BATCH_PRIORITIES - 1));
+	entry[2] = length;
+	memcpy(entry + HID_BATCH_HEADER, data, length);
+	used += HID_BATCH_HEADER + length;
+	return length + 1;
+}
+
+int HIDReportBatch::flush(void)
+{
+	// Reports of the same device keep their order
+	int sent = 0;
+	for (uint8_t priority = 0; priority < HID_BATCH_PRIORITIES; priority++) {
+		for (uint8_t i = 0; i < used; i += HID_BATCH_HEADER + buffer[i + 2]) {
+			uint8_t* entry = buffer + i;
+			if (entry[1] == priority) {
+				sendNow(entry[0], entry + HID_BATCH_HEADER, entry[2]);
+				sent++;
+			}
+		}
+	}
+	used = 0;
+	return sent;
+}
+#endif
@@ -0,0 +1,80 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "HID-Stats.h"
+#include "HID-Suspend.h"
+
+#if HID_REPORT_BATCH > 0xFF
+#error HID_REPORT_BATCH needs to be 255 or less.
+#endif
+
+// Send order inside a batch, lower first
+#define HID_BATCH_PRIORITY_KEYBOARD 0
+#define HID_BATCH_PRIORITY_CONTROL  1
+#define HID_BATCH_PRIORITY_POINTER  2
+#define HID_BATCH_PRIORITY_GAMEPAD  3
+#define HID_BATCH_PRIORITIES        4
+
+class HIDReportBatch
+{
+public:
+	// Batches can be nested, the outer end() sends the reports
+	static void begin(void);
+
+	// Send the collected reports, returns the number of reports sent
+	static int end(void);
+
+	// Send a multi report, or collect it while a batch is running.
+	// Returns the sent length including the report ID, like HID().SendReport().
+	static int send(uint8_t id, uint8_t priority, const void* data, int length){
+#if HID_REPORT_BATCH
+		if (depth) {
+			return collect(id, priority, data, length);
+		}
+#else
+		(void)priority;
+#endif
+		return sendNow(id, data, length);
+	}
+
+protected:
+	static int sendNow(uint8_t id, const void* data, int length){
+		HID_STATS_START();
+		return HID_STATS_RECORD(HIDStats::multiReport, length + 1, HIDSuspend::sendMulti(id, data, length));
+	}
+
+#if HID_REPORT_BATCH
+	static int collect(uint8_t id, uint8_t priority, const void* data, int length);
+	static int flush(void);
+
+	// Every entry is the ID, the priority, the length and the report
+	static uint8_t buffer[HID_REPORT_BATCH];
+	static uint8_t used;
+#endif
+	static uint8_t depth;
+};
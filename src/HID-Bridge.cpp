@@ -0,0 +1,288 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Bridge.h"
+
+#ifdef __AVR__
+#include <util/crc16.h>
+#endif
+
+#if defined(USBCON) || defined(HID_TINYUSB)
+#include "HID-APIs/DefaultKeyboardAPI.h"
+#include "HID-APIs/MouseAPI.h"
+#include "HID-APIs/ConsumerAPI.h"
+#include "HID-APIs/GamepadAPI.h"
+#include "SingleReport/RawHID.h"
+#endif
+
+static uint16_t bridgeCRC(uint16_t crc, const uint8_t* data, uint16_t length)
+{
+	while (length--) {
+#ifdef __AVR__
+		crc = _crc_ccitt_update(crc, *data++);
+#else
+		uint8_t b = *data++ ^ (crc & 0xFF);
+		b ^= b << 4;
+		crc = ((uint16_t(b) << 8) | (crc >> 8)) ^ uint8_t(b >> 4) ^ (uint16_t(b) << 3);
+#endif
+	}
+	return crc;
+}
+
+static void bridgeWrite(Stream* serial, uint8_t type, uint8_t seq, const uint8_t* data, uint8_t length)
+{
+	uint8_t header[4] = { HID_BRIDGE_SYNC, type, seq, length };
+	uint16_t crc = bridgeCRC(0xFFFF, header + 1, 3);
+	crc = bridgeCRC(crc, data, length);
+	uint8_t trailer[2] = { uint8_t(crc), uint8_t(crc >> 8) };
+	serial->write(header, sizeof(header));
+	if (length) {
+		serial->write(data, length);
+	}
+	serial->write(trailer, sizeof(trailer));
+}
+
+// Drops the first byte and everything up to the next SYNC
+static void bridgeDrop(uint8_t* frame, uint16_t& count)
+{
+	uint16_t i = 1;
+	while (i < count && frame[i] != HID_BRIDGE_SYNC) {
+		i++;
+	}
+	count -= i;
+	memmove(frame, frame + i, count);
+}
+
+// Reads into the frame until it holds a complete record that passed the
+// CRC, the caller handles the record and empties the frame. Only the bytes
+// of the current record are read, so the record always ends at count.
+static bool bridgeRead(Stream* serial, uint8_t* frame, uint16_t size, uint16_t& count, uint16_t& errors)
+{
+	for (;;) {
+		if (count && frame[0] != HID_BRIDGE_SYNC) {
+			bridgeDrop(frame, count);
+			continue;
+		}
+
+		uint16_t need = 4;
+		if (count >= need) {
+			need = frame[3] + HID_BRIDGE_OVERHEAD;
+			if (need > size) {
+				errors++;
+				bridgeDrop(frame, count);
+				continue;
+			}
+		}
+
+		if (count < need) {
+			if (serial->available() <= 0) {
+				return false;
+			}
+			while (count < need && serial->available() > 0) {
+				frame[count++] = serial->read();
+			}
+			continue;
+		}
+
+		uint16_t crc = bridgeCRC(0xFFFF, frame + 1, need - 3);
+		if (frame[need - 2] == uint8_t(crc) && frame[need - 1] == uint8_t(crc >> 8)) {
+			return true;
+		}
+		errors++;
+		bridgeDrop(frame, count);
+	}
+}
+
+
+HIDBridge::HIDBridge(void) :
+	serial(NULL), rxCount(0), rxErrors(0), rxSeq(0), synced(false)
+{
+	// Empty
+}
+
+int HIDBridge::poll(void)
+{
+	if (!serial) {
+		return 0;
+	}
+
+	int sent = 0;
+	uint8_t answer = 0xFF;
+	while (bridgeRead(serial, rxFrame, sizeof(rxFrame), rxCount, rxErrors)) {
+		uint8_t type = rxFrame[1];
+		uint8_t seq = rxFrame[2];
+		rxCount = 0;
+
+		// The sender sends nothing else until the reset is acknowledged,
+		// so the reset can be repeated without losing any records
+		if (type == HID_BRIDGE_RESET || !synced || seq == rxSeq) {
+			synced = true;
+			rxSeq = seq + 1;
+			if (type != HID_BRIDGE_RESET) {
+				if (dispatch(type, rxFrame + 4, rxFrame[3])) {
+					sent++;
+				}
+				else {
+					rxErrors++;
+				}
+			}
+			if (answer != HID_BRIDGE_NAK) {
+				answer = HID_BRIDGE_ACK;
+			}
+		}
+		// Sent again after a lost ack, ack it again
+		else if (uint8_t(rxSeq - 1 - seq) < HID_BRIDGE_WINDOW) {
+			if (answer != HID_BRIDGE_NAK) {
+				answer = HID_BRIDGE_ACK;
+			}
+		}
+		// A record before it was lost
+		else {
+			rxErrors++;
+			answer = HID_BRIDGE_NAK;
+		}
+	}
+
+	// One answer acknowledges all records of this poll
+	if (answer != 0xFF) {
+		bridgeWrite(serial, answer, rxSeq, NULL, 0);
+	}
+	return sent;
+}
+
+bool HIDBridgeDevices::dispatch(uint8_t type, uint8_t* data, uint8_t length)
+{
+#if defined(USBCON) || defined(HID_TINYUSB)
+	switch (type) {
+	case HID_BRIDGE_KEYBOARD:
+		if (keyboard && length == sizeof(HID_KeyboardReport_Data_t)) {
+			HID_KeyboardReport_Data_t report;
+			memcpy(&report, data, sizeof(report));
+			keyboard->setReport(report);
+			keyboard->send();
+			return true;
+		}
+		break;
+	case HID_BRIDGE_MOUSE:
+		if (mouse && length == sizeof(HID_MouseReport_Data_t)) {
+			mouse->SendReport(data, length);
+			return true;
+		}
+		break;
+	case HID_BRIDGE_CONSUMER:
+		if (consumer && length == sizeof(HID_ConsumerControlReport_Data_t)) {
+			consumer->SendReport(data, length);
+			return true;
+		}
+		break;
+	case HID_BRIDGE_GAMEPAD:
+		if (gamepad && length == sizeof(HID_GamepadReport_Data_t)) {
+			gamepad->SendReport(data, length);
+			return true;
+		}
+		break;
+	case HID_BRIDGE_RAWHID:
+		if (rawhid && length && length <= RAWHID_TX_SIZE) {
+			rawhid->write(data, length);
+			return true;
+		}
+		break;
+	}
+#endif
+	return false;
+}
+
+
+HIDBridgeSender::HIDBridgeSender(void) :
+	serial(NULL), rxCount(0), rxErrors(0), txSeq(0), txAcked(0), txReset(false), txTime(0)
+{
+	// Empty
+}
+
+void HIDBridgeSender::begin(Stream& serial)
+{
+	this->serial = &serial;
+	rxCount = 0;
+	txAcked = txSeq;
+	txRecords[txSeq % HID_BRIDGE_WINDOW].type = HID_BRIDGE_RESET;
+	txRecords[txSeq % HID_BRIDGE_WINDOW].length = 0;
+	txReset = true;
+	txTime = millis();
+	transmit(txSeq++);
+}
+
+bool HIDBridgeSender::send(uint8_t type, const void* data, uint8_t length)
+{
+	if (!ready() || length > HID_BRIDGE_MAX_LENGTH) {
+		return false;
+	}
+	if (!pending()) {
+		txTime = millis();
+	}
+	txRecords[txSeq % HID_BRIDGE_WINDOW].type = type;
+	txRecords[txSeq % HID_BRIDGE_WINDOW].length = length;
+	memcpy(txRecords[txSeq % HID_BRIDGE_WINDOW].data, data, length);
+	transmit(txSeq++);
+	return true;
+}
+
+void HIDBridgeSender::poll(void)
+{
+	if (!serial) {
+		return;
+	}
+
+	bool back = false;
+	while (bridgeRead(serial, rxReply, sizeof(rxReply), rxCount, rxErrors)) {
+		rxCount = 0;
+		if (rxReply[1] == HID_BRIDGE_ACK || rxReply[1] == HID_BRIDGE_NAK) {
+			acked(rxReply[2]);
+			back |= rxReply[1] == HID_BRIDGE_NAK;
+		}
+	}
+
+	// Go back to the first unacknowledged record
+	if (pending() && (back || (millis() - txTime) >= HID_BRIDGE_TIMEOUT)) {
+		txTime = millis();
+		for (uint8_t seq = txAcked; seq != txSeq; seq++) {
+			transmit(seq);
+		}
+	}
+}
+
+void HIDBridgeSender::transmit(uint8_t seq)
+{
+	bridgeWrite(serial, txRecords[seq % HID_BRIDGE_WINDOW].type, seq,
+		txRecords[seq % HID_BRIDGE_WINDOW].data, txRecords[seq % HID_BRIDGE_WINDOW].length);
+}
+
+void HIDBridgeSender::acked(uint8_t seq)
+{
+	// Acks of records that were never sent are stale
+	uint8_t count = seq - txAcked;
+	if (count && count <= pending()) {
+		txAcked = seq;
+		txReset = false;
+		txTime = millis();
+	}
+}
@@ -0,0 +1,199 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+
+// Bridge of HID reports over a serial link, for a USB companion chip
+// (16u2 or 32u4) that forwards the reports of a main MCU without USB.
+//
+// Every record is one complete report:
+//	SYNC (0xA5), type, seq, length, payload, CRC-16 (low byte first)
+// The CRC covers type, seq, length and payload (CCITT polynomial,
+// init 0xFFFF, reflected, the same as RawHIDMessage).
+//
+// The receiver accepts records in sequence order only and answers with an
+// ACK of the next expected seq after every poll() that took records. Records
+// out of order are dropped and answered with a NAK, the sender goes back to
+// that record. The sender keeps up to HID_BRIDGE_WINDOW records unacknowledged
+// and sends them again after HID_BRIDGE_TIMEOUT. A RESET record starts the
+// sequence over, the sender sends it from begin().
+
+#define HID_BRIDGE_SYNC 0xA5
+
+// Record types
+#define HID_BRIDGE_ACK 0
+#define HID_BRIDGE_NAK 1
+#define HID_BRIDGE_RESET 2
+#define HID_BRIDGE_KEYBOARD 3
+#define HID_BRIDGE_MOUSE 4
+#define HID_BRIDGE_CONSUMER 5
+#define HID_BRIDGE_GAMEPAD 6
+#define HID_BRIDGE_RAWHID 7
+
+// Largest payload of a record.
+#ifndef HID_BRIDGE_MAX_LENGTH
+#define HID_BRIDGE_MAX_LENGTH 64
+#endif
+
+#if HID_BRIDGE_MAX_LENGTH > 255
+#error HID_BRIDGE_MAX_LENGTH has to fit into the length byte.
+#endif
+
+// Records the sender may send ahead of the acks.
+#ifndef HID_BRIDGE_WINDOW
+#define HID_BRIDGE_WINDOW 4
+#endif
+
+#if HID_BRIDGE_WINDOW < 1 || HID_BRIDGE_WINDOW > 64 || (HID_BRIDGE_WINDOW & (HID_BRIDGE_WINDOW - 1))
+#error HID_BRIDGE_WINDOW has to be a power of two up to 64.
+#endif
+
+// Time in ms until unacknowledged records are sent again.
+#ifndef HID_BRIDGE_TIMEOUT
+#define HID_BRIDGE_TIMEOUT 20
+#endif
+
+// SYNC, type, seq, length and the CRC
+#define HID_BRIDGE_OVERHEAD 6
+
+class DefaultKeyboardAPI;
+class MouseAPI;
+class ConsumerAPI;
+class GamepadAPI;
+class RawHID_;
+
+// Devices the reports of records are sent to, also used by HIDReplay.
+// Mouse, consumer and gamepad reports go straight to SendReport(), the state
+// of these devices is not changed. Devices have to be set up with begin()
+// by the sketch as usual.
+class HIDBridgeDevices
+{
+public:
+	HIDBridgeDevices(void) :
+		keyboard(NULL), mouse(NULL), consumer(NULL), gamepad(NULL), rawhid(NULL) {}
+
+	// Records of unset devices are dropped
+	void attach(DefaultKeyboardAPI* keyboard, MouseAPI* mouse = NULL, ConsumerAPI* consumer = NULL,
+		GamepadAPI* gamepad = NULL, RawHID_* rawhid = NULL){
+		this->keyboard = keyboard;
+		this->mouse = mouse;
+		this->consumer = consumer;
+		this->gamepad = gamepad;
+		this->rawhid = rawhid;
+	}
+
+	// Sends the report of a record, false if it was dropped.
+	// The data may be changed, like by the boot protocol of BootMouse.
+	bool dispatch(uint8_t type, uint8_t* data, uint8_t length);
+
+protected:
+	DefaultKeyboardAPI* keyboard;
+	MouseAPI* mouse;
+	ConsumerAPI* consumer;
+	GamepadAPI* gamepad;
+	RawHID_* rawhid;
+};
+
+// Receives records on the USB chip and passes every report as a whole to its
+// device, call poll() regularly from loop().
+class HIDBridge : public HIDBridgeDevices
+{
+public:
+	HIDBridge(void);
+
+	void begin(Stream& serial){
+		this->serial = &serial;
+		rxCount = 0;
+		synced = false;
+	}
+
+	// Reads the available bytes and sends all complete reports,
+	// returns the number of reports that were sent
+	int poll(void);
+
+	// Records dropped because of a CRC error, a bad length or the sequence
+	uint16_t errors(void){
+		return rxErrors;
+	}
+
+protected:
+	Stream* serial;
+	uint8_t rxFrame[HID_BRIDGE_MAX_LENGTH + HID_BRIDGE_OVERHEAD];
+	uint16_t rxCount;
+	uint16_t rxErrors;
+	uint8_t rxSeq;
+	bool synced;
+};
+
+// Sends records from the main MCU, call poll() regularly from loop() to
+// read the acks and to send lost records again.
+class HIDBridgeSender
+{
+public:
+	HIDBridgeSender(void);
+
+	// Starts the sequence over with a RESET record, no reports are
+	// sent until it is acknowledged
+	void begin(Stream& serial);
+
+	// Queues a report and sends it, returns false while the window is full
+	bool send(uint8_t type, const void* data, uint8_t length);
+
+	// Records that are not acknowledged yet
+	uint8_t pending(void){
+		return txSeq - txAcked;
+	}
+
+	bool ready(void){
+		return serial && !txReset && pending() < HID_BRIDGE_WINDOW;
+	}
+
+	// Reads the acks and sends records again after a NAK or the timeout
+	void poll(void);
+
+	// Acks dropped because of a CRC error
+	uint16_t errors(void){
+		return rxErrors;
+	}
+
+protected:
+	void transmit(uint8_t seq);
+	void acked(uint8_t seq);
+
+	Stream* serial;
+	struct {
+		uint8_t type;
+		uint8_t length;
+		uint8_t data[HID_BRIDGE_MAX_LENGTH];
+	} txRecords[HID_BRIDGE_WINDOW];
+	uint8_t rxReply[HID_BRIDGE_OVERHEAD];
+	uint16_t rxCount;
+	uint16_t rxErrors;
+	uint8_t txSeq;
+	uint8_t txAcked;
+	bool txReset;
+	uint32_t txTime;
+};
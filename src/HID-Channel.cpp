@@ -0,0 +1,215 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+#include "HID-Channel.h"
+
+RawHIDChannels::RawHIDChannels(void) : txLast(RAWHID_CHANNELS - 1), rxErrors(0)
+{
+	memset(channels, 0x00, sizeof(channels));
+	for (uint8_t i = 0; i < RAWHID_CHANNELS; i++) {
+		channels[i].priority = i;
+	}
+}
+
+void RawHIDChannels::begin(uint8_t channel, uint8_t* buffer, uint16_t size)
+{
+	if (channel >= RAWHID_CHANNELS) {
+		return;
+	}
+	Channel& ch = channels[channel];
+	ch.rxBuffer = buffer;
+	ch.rxSize = size;
+	ch.rxActive = false;
+	ch.rxComplete = false;
+}
+
+void RawHIDChannels::end(void)
+{
+	for (uint8_t i = 0; i < RAWHID_CHANNELS; i++) {
+		Channel& ch = channels[i];
+		ch.rxBuffer = NULL;
+		ch.rxSize = 0;
+		ch.rxActive = false;
+		ch.rxComplete = false;
+		ch.txCount = 0;
+		ch.txOffset = 0;
+	}
+}
+
+void RawHIDChannels::setPriority(uint8_t channel, uint8_t priority)
+{
+	if (channel < RAWHID_CHANNELS) {
+		channels[channel].priority = priority;
+	}
+}
+
+bool RawHIDChannels::send(uint8_t channel, const void* data, uint16_t length)
+{
+	if (channel >= RAWHID_CHANNELS) {
+		return false;
+	}
+	Channel& ch = channels[channel];
+	if (ch.txCount >= RAWHID_CH_QUEUE) {
+		return false;
+	}
+	uint8_t index = (ch.txHead + ch.txCount) % RAWHID_CH_QUEUE;
+	ch.txData[index] = (const uint8_t*)data;
+	ch.txLength[index] = length;
+	ch.txCount++;
+	return true;
+}
+
+void RawHIDChannels::release(uint8_t channel)
+{
+	if (channel < RAWHID_CHANNELS) {
+		channels[channel].rxComplete = false;
+	}
+}
+
+bool RawHIDChannels::receive(const uint8_t* report, int length)
+{
+	if (length < 2) {
+		return true;
+	}
+
+	uint8_t flags = report[0];
+	uint8_t channel = flags & RAWHID_CH_CHANNEL_MASK;
+	uint16_t payload = report[1] | (uint16_t(flags & RAWHID_CH_LENGTH_MASK) << 2);
+	if (payload > length - 2) {
+		return true;
+	}
+	if (channel >= RAWHID_CHANNELS || !channels[channel].rxBuffer) {
+		if (flags & RAWHID_CH_END) {
+			rxErrors++;
+		}
+		return true;
+	}
+
+	Channel& ch = channels[channel];
+	if (ch.rxComplete) {
+		return false;
+	}
+	if (flags & RAWHID_CH_START) {
+		ch.rxLength = 0;
+		ch.rxActive = true;
+		ch.rxDrop = false;
+	}
+	else if (!ch.rxActive) {
+		// Middle of a message we never saw the start of
+		return true;
+	}
+
+	if (ch.rxLength + uint32_t(payload) > ch.rxSize) {
+		ch.rxDrop = true;
+	}
+	if (!ch.rxDrop) {
+		memcpy(ch.rxBuffer + ch.rxLength, report + 2, payload);
+		ch.rxLength += payload;
+	}
+
+	if (flags & RAWHID_CH_END) {
+		ch.rxActive = false;
+		if (ch.rxDrop) {
+			rxErrors++;
+		}
+		else {
+			ch.rxComplete = true;
+		}
+	}
+	return true;
+}
+
+int8_t RawHIDChannels::schedule(void)
+{
+	// Highest priority first, equal ones start after the last sent channel
+	int8_t best = -1;
+	for (uint8_t i = 1; i <= RAWHID_CHANNELS; i++) {
+		uint8_t channel = (txLast + i) % RAWHID_CHANNELS;
+		if (channels[channel].txCount && (best < 0 || channels[channel].priority < channels[best].priority)) {
+			best = channel;
+		}
+	}
+	return best;
+}
+
+void RawHIDChannels::transmit(void)
+{
+	int8_t channel = schedule();
+	if (channel < 0 || !RawHID.availableForWrite()) {
+		return;
+	}
+
+	Channel& ch = channels[channel];
+	const uint8_t* data = ch.txData[ch.txHead];
+	uint16_t length = ch.txLength[ch.txHead];
+	uint16_t payload = min(uint16_t(length - ch.txOffset), uint16_t(RAWHID_SIZE - 2));
+
+	// Full reports, some hosts drop short ones
+	uint8_t* report = RawHID.acquirePacket();
+	memset(report, 0x00, RAWHID_SIZE);
+	report[0] = channel | ((payload >> 2) & RAWHID_CH_LENGTH_MASK);
+	if (!ch.txOffset) {
+		report[0] |= RAWHID_CH_START;
+	}
+	if (ch.txOffset + payload == length) {
+		report[0] |= RAWHID_CH_END;
+	}
+	report[1] = payload;
+	memcpy(report + 2, data + ch.txOffset, payload);
+	if (RawHID.commitPacket(RAWHID_SIZE) <= 0) {
+		return;
+	}
+
+	txLast = channel;
+	ch.txOffset += payload;
+	if (ch.txOffset == length) {
+		ch.txOffset = 0;
+		ch.txHead = (ch.txHead + 1) % RAWHID_CH_QUEUE;
+		ch.txCount--;
+	}
+}
+
+bool RawHIDChannels::poll(void)
+{
+	const uint8_t* report;
+	int length;
+	while ((length = RawHID.readPacket(&report)) > 0) {
+		if (!receive(report, length)) {
+			break;
+		}
+		RawHID.releasePacket();
+	}
+
+	// One report per call, a message queued meanwhile on a channel with
+	// a higher priority goes out with the next one
+	transmit();
+
+	for (uint8_t i = 0; i < RAWHID_CHANNELS; i++) {
+		if (channels[i].txCount) {
+			return true;
+		}
+	}
+	return false;
+}
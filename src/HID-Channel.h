@@ -0,0 +1,133 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "SingleReport/RawHID.h"
+
+// Logical channels multiplexed over one RawHID interface, see
+// extras/rawhid/rawhid_channel.h for the host side.
+//
+// Every report carries a part of one message of one channel:
+//	flags, length, payload
+// The low 4 bits of the flags are the channel, RAWHID_CH_START marks the
+// first and RAWHID_CH_END the last report of a message. The length is the
+// number of payload bytes in this report, its bits 8 and 9 are the top two
+// bits of the flags. Messages may be empty, they are a single report with
+// both flags set.
+//
+// Messages of different channels are interleaved report by report, so a
+// short message of a high priority channel is sent between two reports of
+// a long one and does not wait for its end. Each channel reassembles its
+// messages on its own.
+//
+// There are no acks, the channels rely on the USB transfers. A report for
+// a channel whose message was not released yet stays in the RawHID slots,
+// so the host is held back until the sketch calls release().
+
+#define RAWHID_CH_START 0x10
+#define RAWHID_CH_END 0x20
+#define RAWHID_CH_CHANNEL_MASK 0x0F
+#define RAWHID_CH_LENGTH_MASK 0xC0
+
+#if (RAWHID_CHANNELS < 1) || (RAWHID_CHANNELS > 16)
+#error RAWHID_CHANNELS needs to be 1 - 16.
+#endif
+
+// Sends and receives messages on several channels without blocking, call
+// poll() regularly from loop(). RawHID.begin() is called by the sketch as usual.
+class RawHIDChannels
+{
+public:
+	RawHIDChannels(void);
+
+	// Buffer for the received messages of a channel, longer messages are dropped.
+	// Reports of channels without a buffer are dropped as well.
+	void begin(uint8_t channel, uint8_t* buffer, uint16_t size);
+	void end(void);
+
+	// Channels with a lower priority value are sent first, equal ones take
+	// turns. The default priority is the channel number.
+	void setPriority(uint8_t channel, uint8_t priority);
+
+	// Queue a message, the data has to stay valid until queued() drops
+	// below its place. Returns false if the queue of the channel is full.
+	bool send(uint8_t channel, const void* data, uint16_t length);
+	uint8_t queued(uint8_t channel){
+		return (channel < RAWHID_CHANNELS) ? channels[channel].txCount : 0;
+	}
+
+	// A received message of a channel, complete() is true until it is released
+	bool complete(uint8_t channel){
+		return (channel < RAWHID_CHANNELS) && channels[channel].rxComplete;
+	}
+	uint16_t available(uint8_t channel){
+		return complete(channel) ? channels[channel].rxLength : 0;
+	}
+	const uint8_t* message(uint8_t channel){
+		return (channel < RAWHID_CHANNELS) ? channels[channel].rxBuffer : NULL;
+	}
+	void release(uint8_t channel);
+
+	// Receive reports and send one report of the channel with the highest
+	// priority, returns true while messages are queued
+	bool poll(void);
+
+	// Messages which were too long or for a channel without buffer
+	uint16_t errors(void){
+		return rxErrors;
+	}
+
+protected:
+	struct Channel {
+		// Receiving
+		uint8_t* rxBuffer;
+		uint16_t rxSize;
+		uint16_t rxLength;
+		bool rxActive;
+		bool rxDrop;
+		bool rxComplete;
+
+		// Sending, a ring of queued messages
+		const uint8_t* txData[RAWHID_CH_QUEUE];
+		uint16_t txLength[RAWHID_CH_QUEUE];
+		uint16_t txOffset;
+		uint8_t txHead;
+		uint8_t txCount;
+		uint8_t priority;
+	};
+
+	// Returns false if the report has to wait for a release()
+	bool receive(const uint8_t* report, int length);
+	int8_t schedule(void);
+	void transmit(void);
+
+	Channel channels[RAWHID_CHANNELS];
+	uint8_t txLast;
+	uint16_t rxErrors;
+};
@@ -0,0 +1,74 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Control.h"
+
+bool HIDControlStream::write_P(const void* data, uint16_t length)
+{
+	if (failed) {
+		return false;
+	}
+
+	// The host does not read more
+	uint16_t sent = total;
+	total += length;
+	if (sent >= limit) {
+		return true;
+	}
+	length = min(length, (uint16_t)(limit - sent));
+
+#if defined(ARDUINO_ARCH_AVR)
+	if (USB_SendControl(TRANSFER_PGM, data, length) == -1) {
+		failed = true;
+	}
+#else
+	// Flash is mapped into the address space
+	const uint8_t* bytes = (const uint8_t*)data;
+	while (length) {
+		uint8_t n = min(length, (uint16_t)(sizeof(buffer) - used));
+		memcpy(buffer + used, bytes, n);
+		used += n;
+		bytes += n;
+		length -= n;
+		if (used == sizeof(buffer)) {
+			if (USB_SendControl(0, buffer, used) == -1) {
+				failed = true;
+				break;
+			}
+			used = 0;
+		}
+	}
+#endif
+	return !failed;
+}
+
+int HIDControlStream::end(void)
+{
+#if !defined(ARDUINO_ARCH_AVR)
+	if (used && !failed && USB_SendControl(0, buffer, used) == -1) {
+		failed = true;
+	}
+	used = 0;
+#endif
+	return failed ? -1 : total;
+}
@@ -0,0 +1,58 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Sends a descriptor made of several pieces as one control transfer.
+// SAMD and SAM send every USB_SendControl() call as packets of its own, so
+// each piece ended in a short packet. The pieces are collected into full
+// EP0 packets here and cut at wLength, later pieces are not even read once
+// the host has enough. The AVR core already fills the EP0 bank itself.
+class HIDControlStream
+{
+public:
+	HIDControlStream(uint16_t limit) : total(0), limit(limit), failed(false)
+#if !defined(ARDUINO_ARCH_AVR)
+		, used(0)
+#endif
+	{ }
+
+	// Data in PROGMEM, the descriptors of the devices
+	bool write_P(const void* data, uint16_t length);
+
+	// Sends the rest, returns the length of the whole descriptor or -1
+	int end(void);
+
+protected:
+	uint16_t total;
+	uint16_t limit;
+	bool failed;
+#if !defined(ARDUINO_ARCH_AVR)
+	uint8_t used;
+	uint8_t buffer[USB_EP_SIZE];
+#endif
+};
@@ -0,0 +1,200 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Report descriptors composed at compile time. Every item is a HIDReportDescriptor
+// type holding its bytes as template arguments, HIDItems<> joins them and
+// only the final descriptor is stored in flash:
+//
+//	typedef HIDItems<HIDUsagePage<0x0C>, HIDUsage<0x01>,
+//		HIDCollection<HID_COLLECTION_APPLICATION, ...>> Descriptor;
+//	static HIDSubDescriptor node(Descriptor::data, Descriptor::size);
+//
+// Counts and sizes can be computed from the report types, see HID_COUNT_OF().
+
+// Collection types
+#define HID_COLLECTION_PHYSICAL    0x00
+#define HID_COLLECTION_APPLICATION 0x01
+#define HID_COLLECTION_LOGICAL     0x02
+
+// Input, Output and Feature flags, TinyUSB already has the same ones
+#ifndef HID_DATA
+#define HID_DATA     0x00
+#define HID_CONSTANT 0x01
+#define HID_ARRAY    0x00
+#define HID_VARIABLE 0x02
+#define HID_ABSOLUTE 0x00
+#define HID_RELATIVE 0x04
+#endif
+
+// Number of elements of an array member of a report
+#define HID_COUNT_OF(report, member) (sizeof(report::member) / sizeof(report::member[0]))
+
+template<uint8_t... Bytes>
+struct HIDReportDescriptor
+{
+	static const uint8_t data[sizeof...(Bytes)];
+	static constexpr uint16_t size = sizeof...(Bytes);
+};
+
+// Only instantiated for the descriptors which are sent
+template<uint8_t... Bytes>
+const uint8_t HIDReportDescriptor<Bytes...>::data[sizeof...(Bytes)] PROGMEM = { Bytes... };
+
+template<uint8_t... Bytes>
+constexpr uint16_t HIDReportDescriptor<Bytes...>::size;
+
+template<class... Items>
+struct HIDJoin;
+
+template<>
+struct HIDJoin<>
+{
+	typedef HIDReportDescriptor<> type;
+};
+
+template<uint8_t... A>
+struct HIDJoin<HIDReportDescriptor<A...>>
+{
+	typedef HIDReportDescriptor<A...> type;
+};
+
+template<uint8_t... A, uint8_t... B, class... Items>
+struct HIDJoin<HIDReportDescriptor<A...>, HIDReportDescriptor<B...>, Items...>
+{
+	typedef typename HIDJoin<HIDReportDescriptor<A..., B...>, Items...>::type type;
+};
+
+template<class... Items>
+using HIDItems = typename HIDJoin<Items...>::type;
+
+// Leave out parts, for example depending on a setting
+template<bool Enable, class Item>
+struct HIDSelect
+{
+	typedef Item type;
+};
+
+template<class Item>
+struct HIDSelect<false, Item>
+{
+	typedef HIDReportDescriptor<> type;
+};
+
+template<bool Enable, class... Items>
+using HIDOptional = typename HIDSelect<Enable, HIDItems<Items...>>::type;
+
+// Repeat parts, for example one collection per contact
+template<uint8_t Count, class Item>
+struct HIDRepeatItem
+{
+	typedef HIDItems<Item, typename HIDRepeatItem<Count - 1, Item>::type> type;
+};
+
+template<class Item>
+struct HIDRepeatItem<0, Item>
+{
+	typedef HIDReportDescriptor<> type;
+};
+
+template<uint8_t Count, class... Items>
+using HIDRepeat = typename HIDRepeatItem<Count, HIDItems<Items...>>::type;
+
+// Short item with the smallest data size for an unsigned value
+template<uint8_t Tag, uint32_t Value, uint8_t Size = (Value <= 0xFF) ? 1 : (Value <= 0xFFFF) ? 2 : 4>
+struct HIDUnsignedItem
+{
+	typedef HIDReportDescriptor<Tag | 0x03, uint8_t(Value), uint8_t(Value >> 8), uint8_t(Value >> 16), uint8_t(Value >> 24)> type;
+};
+
+template<uint8_t Tag, uint32_t Value>
+struct HIDUnsignedItem<Tag, Value, 1>
+{
+	typedef HIDReportDescriptor<Tag | 0x01, uint8_t(Value)> type;
+};
+
+template<uint8_t Tag, uint32_t Value>
+struct HIDUnsignedItem<Tag, Value, 2>
+{
+	typedef HIDReportDescriptor<Tag | 0x02, uint8_t(Value), uint8_t(Value >> 8)> type;
+};
+
+// Logical and physical limits are signed, 255 needs two bytes
+template<uint8_t Tag, int32_t Value>
+using HIDSignedItem = typename HIDUnsignedItem<Tag, uint32_t(Value),
+	(Value >= -0x80 && Value <= 0x7F) ? 1 : (Value >= -0x8000 && Value <= 0x7FFF) ? 2 : 4>::type;
+
+// Main items
+template<uint8_t Flags>
+using HIDInput = HIDReportDescriptor<0x81, Flags>;
+
+template<uint8_t Flags>
+using HIDOutput = HIDReportDescriptor<0x91, Flags>;
+
+template<uint8_t Flags>
+using HIDFeature = HIDReportDescriptor<0xB1, Flags>;
+
+template<uint8_t Type, class... Items>
+using HIDCollection = HIDItems<HIDReportDescriptor<0xA1, Type>, Items..., HIDReportDescriptor<0xC0>>;
+
+// Global items
+template<uint16_t Page>
+using HIDUsagePage = typename HIDUnsignedItem<0x04, Page>::type;
+
+template<int32_t Value>
+using HIDLogicalMinimum = HIDSignedItem<0x14, Value>;
+
+template<int32_t Value>
+using HIDLogicalMaximum = HIDSignedItem<0x24, Value>;
+
+// Exponent -4 is a nibble (0x0C)
+template<int8_t Exponent>
+using HIDUnitExponent = HIDReportDescriptor<0x55, uint8_t(Exponent & 0x0F)>;
+
+template<uint32_t Unit>
+using HIDUnit = typename HIDUnsignedItem<0x64, Unit>::type;
+
+template<uint8_t Bits>
+using HIDReportSize = HIDReportDescriptor<0x75, Bits>;
+
+template<uint16_t Count>
+using HIDReportCount = typename HIDUnsignedItem<0x94, Count>::type;
+
+// Report ID 0 means no ID, for single report devices
+template<uint8_t ID>
+using HIDReportID = HIDOptional<(ID != 0), HIDReportDescriptor<0x85, ID>>;
+
+// Local items
+template<uint16_t Usage>
+using HIDUsage = typename HIDUnsignedItem<0x08, Usage>::type;
+
+template<uint16_t Usage>
+using HIDUsageMinimum = typename HIDUnsignedItem<0x18, Usage>::type;
+
+template<uint16_t Usage>
+using HIDUsageMaximum = typename HIDUnsignedItem<0x28, Usage>::type;
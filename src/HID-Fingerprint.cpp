@@ -0,0 +1,115 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Fingerprint.h"
+
+#define HID_FINGERPRINT_STRING_FF   0x01
+#define HID_FINGERPRINT_STRING      0x02
+#define HID_FINGERPRINT_STRING_2    0x04
+#define HID_FINGERPRINT_WINDOWS     0x08
+#define HID_FINGERPRINT_CONFIGURED  0x10
+
+HIDFingerprint_::HIDFingerprint_(void) : PluggableUSBModule(0, 0, epType), flags(0)
+{
+	PluggableUSB().plug(this);
+}
+
+HIDHostOS HIDFingerprint_::os(void)
+{
+	uint8_t seen = flags;
+	if (seen & HID_FINGERPRINT_WINDOWS) {
+		return HID_OS_WINDOWS;
+	}
+	if (seen & HID_FINGERPRINT_STRING) {
+		return (seen & HID_FINGERPRINT_STRING_2) ? HID_OS_MACOS : HID_OS_UNKNOWN;
+	}
+	if (seen & HID_FINGERPRINT_STRING_FF) {
+		return HID_OS_LINUX;
+	}
+	return HID_OS_UNKNOWN;
+}
+
+int HIDFingerprint_::getInterface(uint8_t* interfaceCount)
+{
+	(void)interfaceCount;
+	return 0;
+}
+
+int HIDFingerprint_::getDescriptor(USBSetup& setup)
+{
+	// Only watch the requests, the core or the other modules answer them
+	uint8_t seen = flags;
+#if defined(HID_TINYUSB)
+	bool configured = USB_Configured();
+#else
+	bool configured = USBDevice.configured();
+#endif
+	switch (setup.wValueH) {
+	case USB_DEVICE_DESCRIPTOR_TYPE:
+		// The bus reset of a new enumeration cleared the configuration,
+		// e.g. after a KVM switched the host
+		if (!configured && (seen & HID_FINGERPRINT_CONFIGURED)) {
+			seen = 0;
+		}
+		break;
+	case USB_CONFIGURATION_DESCRIPTOR_TYPE:
+		if (setup.wLength == 0xFF) {
+			seen |= HID_FINGERPRINT_WINDOWS;
+		}
+		break;
+	case USB_STRING_DESCRIPTOR_TYPE:
+		if (setup.wValueL == 0xEE) {
+			seen |= HID_FINGERPRINT_WINDOWS;
+		}
+		else if (setup.wLength == 0xFF) {
+			seen |= HID_FINGERPRINT_STRING_FF;
+		}
+		else {
+			seen |= HID_FINGERPRINT_STRING;
+			if (setup.wLength == 2) {
+				seen |= HID_FINGERPRINT_STRING_2;
+			}
+		}
+		break;
+	}
+	if (configured) {
+		seen |= HID_FINGERPRINT_CONFIGURED;
+	}
+	flags = seen;
+	return 0;
+}
+
+bool HIDFingerprint_::setup(USBSetup& setup)
+{
+	(void)setup;
+	return false;
+}
+
+uint8_t HIDFingerprint_::getShortName(char* name)
+{
+	// Keep the serial number of the device
+	(void)name;
+	return 0;
+}
+
+HIDFingerprint_ HIDFingerprint;
@@ -0,0 +1,79 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Guess of the host OS from the descriptor requests during enumeration.
+// The core passes every GET_DESCRIPTOR request to the plugged modules first,
+// the requested lengths differ between the hosts:
+// - Windows reads the configuration with wLength 255 and asks for the
+//   Microsoft OS string (index 0xEE) when it sees the device the first time
+// - Linux reads all strings with wLength 255
+// - macOS reads the strings with other lengths, the header (2 bytes) first
+// BIOS, KVM switches and consoles often read no strings at all, they stay
+// unknown. The guess is ready once the host read the strings, shortly after
+// USBDevice.configured(). It is only a heuristic, the sketch decides what to
+// do with it. The module uses no interface or endpoint.
+// On TinyUSB the port answers the standard requests, the OS stays unknown.
+
+enum HIDHostOS : uint8_t {
+	HID_OS_UNKNOWN,
+	HID_OS_WINDOWS,
+	HID_OS_LINUX,
+	HID_OS_MACOS,
+};
+
+class HIDFingerprint_ : public PluggableUSBModule
+{
+public:
+	HIDFingerprint_(void);
+
+	HIDHostOS os(void);
+
+	// Desktop hosts handle the NKRO bitmap and report IDs on any interface,
+	// unknown hosts may only understand the 6KRO boot reports.
+	bool nkro(void){
+		return os() != HID_OS_UNKNOWN;
+	}
+
+	bool reportIds(void){
+		return os() != HID_OS_UNKNOWN;
+	}
+
+protected:
+	// Implementation of the PUSBListNode
+	int getInterface(uint8_t* interfaceCount);
+	int getDescriptor(USBSetup& setup);
+	bool setup(USBSetup& setup);
+	uint8_t getShortName(char* name);
+
+	EPTYPE_DESCRIPTOR_SIZE epType[1];
+
+	// Seen requests, cleared when the host starts over
+	volatile uint8_t flags;
+};
+extern HIDFingerprint_ HIDFingerprint;
@@ -0,0 +1,49 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Frame.h"
+
+HIDFrame::Callback HIDFrame::callback = NULL;
+uint16_t HIDFrame::offset = 0;
+uint16_t HIDFrame::last = 0;
+uint32_t HIDFrame::start = 0;
+bool HIDFrame::pending = false;
+
+bool HIDFrame::poll(void)
+{
+	uint16_t frame = number();
+	if (frame != last) {
+		// The frame started somewhere since the last poll, a missed frame
+		// is skipped instead of calling the callback twice.
+		last = frame;
+		start = micros();
+		pending = true;
+	}
+
+	if (!pending || !callback || (micros() - start) < offset) {
+		return false;
+	}
+	pending = false;
+	callback();
+	return true;
+}
@@ -0,0 +1,79 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Start-of-frame synchronization. The host polls every endpoint at a fixed
+// point of its 1ms frames, reports sent at a fixed time after the frame
+// started therefore have a constant latency instead of 0 - 1ms jitter.
+// The core handles the SOF interrupt itself, so new frames are detected by
+// polling the frame number of the USB controller from loop().
+class HIDFrame
+{
+public:
+	typedef void (*Callback)(void);
+
+	// Current 11 bit frame number of the USB controller
+	static uint16_t number(void){
+#if defined(ARDUINO_ARCH_AVR)
+		uint8_t low, high;
+		do {
+			low = UDFNUML;
+			high = UDFNUMH;
+		} while (low != UDFNUML);
+		return ((uint16_t)(high & 0x07) << 8) | low;
+#elif defined(ARDUINO_ARCH_SAMD)
+		return USB->DEVICE.FNUM.bit.FNUM;
+#elif defined(ARDUINO_ARCH_SAM)
+		return (UOTGHS->UOTGHS_DEVFNUM & UOTGHS_DEVFNUM_FNUM_Msk) >> UOTGHS_DEVFNUM_FNUM_Pos;
+#else
+		// Full speed frames are 1ms long
+		return millis() & 0x7FF;
+#endif
+	}
+
+	// Call the function once per frame, offset us after the frame started.
+	// Build the report there, a later offset samples the inputs closer to
+	// the next poll of the host. NULL stops the callback.
+	static void onFrame(Callback callback, uint16_t offset = 0){
+		HIDFrame::callback = callback;
+		HIDFrame::offset = offset;
+		pending = false;
+	}
+
+	// Detect new frames and run the callback when it is due,
+	// call this as often as possible from loop().
+	// Returns true if the callback was called.
+	static bool poll(void);
+
+protected:
+	static Callback callback;
+	static uint16_t offset;
+	static uint16_t last;
+	static uint32_t start;
+	static bool pending;
+};
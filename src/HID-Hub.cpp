@@ -0,0 +1,226 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Hub.h"
+#include "HID-Control.h"
+
+HIDHubReport::HIDHubReport(const uint8_t* descriptor, uint16_t descriptorLength, uint8_t id,
+	uint8_t priority, uint8_t* buffer, uint8_t size, bool replace) :
+	descriptor(descriptor), descriptorLength(descriptorLength), buffer(buffer), size(size),
+	id(id), priority(min(priority, (uint8_t)(HID_BATCH_PRIORITIES - 1))), replace(replace),
+	length(0), front(0), next(NULL)
+{
+	memset(buffer, 0, 3 * (size + 1));
+	buffer[0] = id;
+	sent(0)[0] = id;
+	sent(1)[0] = id;
+}
+
+void HIDHubReport::queue(const void* data, int length)
+{
+	// Keep the order of state changes, only absolute state can be replaced
+	while (this->length && !replace) {
+		HIDHub().sendNext();
+	}
+
+	length = min(length, (int)size);
+	memcpy(buffer + 1, data, length);
+	this->length = length + 1;
+	HIDHub().poll();
+}
+
+HIDHub_& HIDHub(void)
+{
+	static HIDHub_ obj;
+	return obj;
+}
+
+HIDHub_::HIDHub_(void) : PluggableUSBModule(1, 1, epType),
+	rootNode(NULL), lastNode(NULL), descriptorSize(0), protocol(HID_REPORT_PROTOCOL), idle(0)
+{
+	epType[0] = EP_TYPE_INTERRUPT_IN;
+	PluggableUSB().plug(this);
+#if HID_STATS
+	stats.interface = pluggedInterface;
+#endif
+}
+
+void HIDHub_::append(HIDHubReport* node)
+{
+	if (!rootNode) {
+		rootNode = node;
+	} else {
+		HIDHubReport* current = rootNode;
+		while (current->next) {
+			current = current->next;
+		}
+		current->next = node;
+	}
+	descriptorSize += node->descriptorLength;
+}
+
+int HIDHub_::getInterface(uint8_t* interfaceCount)
+{
+	*interfaceCount += 1; // uses 1
+	HIDDescriptor hidInterface = {
+		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_NONE, HID_PROTOCOL_NONE),
+		D_HIDREPORT(descriptorSize),
+		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, HID_INTERVAL_HUB)
+	};
+	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
+}
+
+int HIDHub_::getDescriptor(USBSetup& setup)
+{
+	// In a HID Class Descriptor wIndex cointains the interface number
+	if (setup.wIndex != pluggedInterface) { return 0; }
+
+	// Check if this is a HID Class Descriptor request
+	if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE) { return 0; }
+
+	if (setup.wValueH == HID_HID_DESCRIPTOR_TYPE) {
+		// Apple UEFI and USBCV wants it
+		HIDDescDescriptor desc = D_HIDREPORT(descriptorSize);
+		return USB_SendControl(0, &desc, sizeof(desc));
+	} else if (setup.wValueH == HID_REPORT_DESCRIPTOR_TYPE) {
+		// Reset the protocol on reenumeration. Normally the host should not assume the state of the protocol
+		// due to the USB specs, but Windows and Linux just assumes its in report mode.
+		protocol = HID_REPORT_PROTOCOL;
+
+		// The descriptors of all devices, in the order they were added
+		HIDControlStream stream(setup.wLength);
+		for (HIDHubReport* node = rootNode; node; node = node->next) {
+			if (!stream.write_P(node->descriptor, node->descriptorLength)) {
+				break;
+			}
+		}
+		return stream.end();
+	}
+
+	return 0;
+}
+
+bool HIDHub_::setup(USBSetup& setup)
+{
+	if (pluggedInterface != setup.wIndex) {
+		return false;
+	}
+
+	uint8_t request = setup.bRequest;
+	uint8_t requestType = setup.bmRequestType;
+
+	if (requestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE)
+	{
+		if (request == HID_GET_REPORT) {
+			// Last sent report of the device with this ID
+			if (setup.wValueH == HID_REPORT_TYPE_INPUT) {
+				for (HIDHubReport* node = rootNode; node; node = node->next) {
+					if (node->id == setup.wValueL) {
+						return USB_SendControl(0, node->sent(node->front), min((int)node->size + 1, (int)setup.wLength)) >= 0;
+					}
+				}
+			}
+			return false;
+		}
+		if (request == HID_GET_PROTOCOL) {
+			USB_SendControl(0, &protocol, 1);
+			return true;
+		}
+		if (request == HID_GET_IDLE) {
+			USB_SendControl(0, &idle, 1);
+			return true;
+		}
+	}
+
+	if (requestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE)
+	{
+		if (request == HID_SET_PROTOCOL) {
+			protocol = setup.wValueL;
+			return true;
+		}
+		if (request == HID_SET_IDLE) {
+			// Reports are never repeated
+			idle = setup.wValueH;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+HIDHubReport* HIDHub_::schedule(void)
+{
+	// Start after the last sent report, so equal priorities take turns
+	HIDHubReport* start = (lastNode && lastNode->next) ? lastNode->next : rootNode;
+	HIDHubReport* best = NULL;
+	HIDHubReport* node = start;
+	while (node) {
+		if (node->length && (!best || node->priority < best->priority)) {
+			best = node;
+		}
+		node = node->next ? node->next : rootNode;
+		if (node == start) {
+			break;
+		}
+	}
+	return best;
+}
+
+bool HIDHub_::sendNext(void)
+{
+	HIDHubReport* node = schedule();
+	if (!node) {
+		return false;
+	}
+
+	uint8_t length = node->length;
+	node->length = 0;
+	lastNode = node;
+
+	HID_STATS_START();
+	if (HID_STATS_RECORD(stats, length, USB_Send(pluggedEndpoint | TRANSFER_RELEASE, node->buffer, length)) > 0) {
+		// Publish the back copy after it was written
+		uint8_t back = node->front ^ 1;
+		memcpy(node->sent(back), node->buffer, length);
+		memset(node->sent(back) + length, 0, node->size + 1 - length);
+		HID_BARRIER();
+		node->front = back;
+	}
+	return true;
+}
+
+uint8_t HIDHub_::poll(void)
+{
+	HIDHubReport* node;
+	while ((node = schedule()) && HIDReportQueue::sendSpace(pluggedEndpoint, node->length)) {
+		sendNext();
+	}
+
+	uint8_t pending = 0;
+	for (node = rootNode; node; node = node->next) {
+		if (node->length) {
+			pending++;
+		}
+	}
+	return pending;
+}
@@ -0,0 +1,207 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "HID-Batch.h"
+#include "HID-Queue.h"
+#include "HID-Stats.h"
+#include "HID-Shared.h"
+#include "HID-APIs/DefaultKeyboardAPI.h"
+#include "HID-APIs/MouseAPI.h"
+#include "HID-APIs/AbsoluteMouseAPI.h"
+#include "HID-APIs/ConsumerAPI.h"
+#include "HID-APIs/SystemAPI.h"
+#include "HID-APIs/GamepadAPI.h"
+
+// The hub is one HID interface with a single IN endpoint, shared by any
+// number of devices with their own report ID. Every device keeps one
+// pending report. The hub sends them when the endpoint has room: keyboards
+// first (HID_BATCH_PRIORITY_*), devices of the same priority in turns.
+
+class HIDHubReport
+{
+public:
+	// The buffer holds three reports of the report ID and size bytes: the
+	// pending one and the double buffered last sent one for GET_REPORT.
+	// With replace a new report overwrites a pending one (absolute state like
+	// gamepads), otherwise the pending one is sent first.
+	HIDHubReport(const uint8_t* descriptor, uint16_t descriptorLength, uint8_t id,
+		uint8_t priority, uint8_t* buffer, uint8_t size, bool replace);
+
+	// Copy the report and send it as soon as possible
+	void queue(const void* data, int length);
+
+	bool pending(void){
+		return length;
+	}
+
+protected:
+	friend class HIDHub_;
+
+	// Copies of the last sent report, the pending one may not have reached
+	// the host. GET_REPORT reads the front copy in the USB interrupt.
+	uint8_t* sent(uint8_t index){
+		return buffer + (index + 1) * (size + 1);
+	}
+
+	const uint8_t* descriptor;
+	uint16_t descriptorLength;
+	uint8_t* buffer;
+	uint8_t size;
+	uint8_t id;
+	uint8_t priority;
+	bool replace;
+
+	// Length of the pending report including the ID, 0 if none
+	uint8_t length;
+
+	// Published copy of the last sent report
+	volatile uint8_t front;
+
+	HIDHubReport* next;
+};
+
+template<int ReportSize>
+class HIDHubReportBuffer : public HIDHubReport
+{
+public:
+	HIDHubReportBuffer(const uint8_t* descriptor, uint16_t descriptorLength, uint8_t id,
+		uint8_t priority, bool replace) :
+		HIDHubReport(descriptor, descriptorLength, id, priority, storage, ReportSize, replace) {}
+
+private:
+	uint8_t storage[3 * (ReportSize + 1)];
+};
+
+class HIDHub_ : public PluggableUSBModule
+{
+public:
+	HIDHub_(void);
+
+	void append(HIDHubReport* node);
+
+	// Send pending reports while the endpoint has room, call this regularly
+	// from loop(). Returns the number of reports still pending.
+	uint8_t poll(void);
+
+	// Send the next pending report, waits for the endpoint if required
+	bool sendNext(void);
+
+	uint8_t getProtocol(void){
+		return protocol;
+	}
+
+protected:
+	// Implementation of the PUSBListNode
+	int getInterface(uint8_t* interfaceCount);
+	int getDescriptor(USBSetup& setup);
+	bool setup(USBSetup& setup);
+
+	// Lowest priority first, round-robin after the last sent report
+	HIDHubReport* schedule(void);
+
+	EPTYPE_DESCRIPTOR_SIZE epType[1];
+
+	HIDHubReport* rootNode;
+	HIDHubReport* lastNode;
+	uint16_t descriptorSize;
+	uint8_t protocol;
+	uint8_t idle;
+
+#if HID_STATS
+public:
+	// Send counters of this interface
+	HIDStats stats;
+#endif
+};
+
+// Created with the first hub device, like HID()
+HIDHub_& HIDHub(void);
+
+// Any Static*API device on the hub
+template<template<class> class API, class Descriptor, int ReportSize, uint8_t ReportID,
+	uint8_t Priority, bool Replace = false>
+class HIDHubDevice : public API<HIDHubDevice<API, Descriptor, ReportSize, ReportID, Priority, Replace>>
+{
+public:
+	HIDHubDevice(void) : report(Descriptor::data, Descriptor::size, ReportID, Priority, Replace)
+	{
+		HIDHub().append(&report);
+	}
+
+	void SendReport(void* data, int length){
+		report.queue(data, length);
+	}
+
+	// Coalescing APIs wait until the last report was sent
+	bool ReadyToSend(void){
+		return !report.pending();
+	}
+
+protected:
+	HIDHubReportBuffer<ReportSize> report;
+};
+
+template<uint8_t ReportID = HID_REPORTID_MOUSE>
+using HubMouse = HIDHubDevice<StaticMouseAPI, HIDMouseDescriptor<ReportID>,
+	sizeof(HID_MouseReport_Data_t), ReportID, HID_BATCH_PRIORITY_POINTER>;
+
+template<uint8_t ReportID = HID_REPORTID_MOUSE_ABSOLUTE>
+using HubAbsoluteMouse = HIDHubDevice<StaticAbsoluteMouseAPI, HIDAbsoluteMouseDescriptor<ReportID>,
+	sizeof(HID_MouseAbsoluteReport_Data_t), ReportID, HID_BATCH_PRIORITY_POINTER>;
+
+template<uint8_t ReportID = HID_REPORTID_CONSUMERCONTROL>
+using HubConsumer = HIDHubDevice<StaticConsumerAPI, HIDConsumerDescriptor<ReportID>,
+	sizeof(HID_ConsumerControlReport_Data_t), ReportID, HID_BATCH_PRIORITY_CONTROL>;
+
+template<uint8_t ReportID = HID_REPORTID_SYSTEMCONTROL>
+using HubSystem = HIDHubDevice<StaticSystemAPI, HIDSystemDescriptor<ReportID>,
+	sizeof(HID_SystemControlReport_Data_t), ReportID, HID_BATCH_PRIORITY_CONTROL>;
+
+template<uint8_t ReportID = HID_REPORTID_GAMEPAD>
+using HubGamepad = HIDHubDevice<StaticGamepadAPI, HIDGamepadDescriptor<ReportID>,
+	sizeof(HID_GamepadReport_Data_t), ReportID, HID_BATCH_PRIORITY_GAMEPAD, true>;
+
+// The keyboard API is virtual, it has no Static*API
+template<uint8_t ReportID = HID_REPORTID_KEYBOARD>
+class HubKeyboard : public DefaultKeyboardAPI
+{
+public:
+	HubKeyboard(void) : report(Descriptor::data, Descriptor::size, ReportID, HID_BATCH_PRIORITY_KEYBOARD, false)
+	{
+		HIDHub().append(&report);
+	}
+
+	virtual int send(void) final {
+		report.queue(&_keyReport, sizeof(_keyReport));
+		return sizeof(_keyReport) + 1;
+	}
+
+protected:
+	typedef HIDKeyboardDescriptor<ReportID> Descriptor;
+	HIDHubReportBuffer<sizeof(HID_KeyboardReport_Data_t)> report;
+};
@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Idle.h"
+
+HIDIdleReport* HIDIdleReport::rootReport = NULL;
+bool HIDIdleReport::enabled = false;
+
+HIDIdleReport::HIDIdleReport(uint8_t* buffer, uint8_t size, uint8_t idle, bool relative) :
+	idle(idle), endpoint(0), queue(NULL), buffer(buffer), size(size), front(0), relative(relative)
+{
+	memset(buffer, 0, 2 * size);
+	last[0] = size;
+	last[1] = size;
+
+	lastSend = 0;
+	next = NULL;
+
+	// Append to the list of reports
+	if (!rootReport) {
+		rootReport = this;
+	}
+	else {
+		HIDIdleReport* current = rootReport;
+		while (current->next) {
+			current = current->next;
+		}
+		current->next = this;
+	}
+}
+
+int HIDIdleReport::sent(const void* data, int length, int result)
+{
+	if (result > 0 && length <= size) {
+		// Publish the back buffer after it was written
+		uint8_t back = front ^ 1;
+		memcpy(buffer + back * size, data, length);
+		last[back] = length;
+		HID_BARRIER();
+		front = back;
+		lastSend = millis();
+	}
+	return result;
+}
+
+void HIDIdleReport::poll(void)
+{
+	if (!enabled || relative || !endpoint || !expired()) {
+		return;
+	}
+
+	// Newer reports are still waiting
+	if (queue && queue->pending()) {
+		return;
+	}
+
+	if (HIDReportQueue::sendSpace(endpoint, last[front]) && USB_Send(endpoint | TRANSFER_RELEASE, current(), last[front]) > 0) {
+		lastSend = millis();
+	}
+}
+
+void HIDIdleReport::pollAll(void)
+{
+	for (HIDIdleReport* current = rootReport; current; current = current->next) {
+		current->poll();
+	}
+}
@@ -0,0 +1,112 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "HID-Queue.h"
+#include "HID-Shared.h"
+
+// Idle rate unit of SET_IDLE in ms
+#define HID_IDLE_UNIT 4
+
+// Default idle rate of keyboards (500ms) as recommended by the HID spec
+#define HID_IDLE_KEYBOARD 125
+
+// The last report is double buffered, GET_REPORT is answered from the front
+// buffer in the USB interrupt while sent() fills the back buffer.
+class HIDIdleReport
+{
+public:
+	// The buffer holds two reports of size bytes
+	HIDIdleReport(uint8_t* buffer, uint8_t size, uint8_t idle, bool relative);
+
+	// True if the report can be skipped, because it equals the last one
+	// and the idle period did not expire yet
+	bool skip(const void* data, int length){
+		return enabled && !relative && length == last[front] && !expired() && !memcmp(current(), data, length);
+	}
+
+	// Keep the report if it was sent, returns the result
+	int sent(const void* data, int length, int result);
+
+	// Answer GET_REPORT with the last sent report (all zero before)
+	bool sendReport(uint16_t maxLength){
+		return USB_SendControl(0, current(), min((int)last[front], (int)maxLength)) >= 0;
+	}
+
+	// Honor the idle rate the host sets with SET_IDLE: a report equal to the
+	// last one is only sent again after the idle period expired (0 = never),
+	// and pollAll() repeats it then. Relative mice always send. Off by default.
+	static void setEnabled(bool enable){
+		enabled = enable;
+	}
+
+	// Repeat the last report of every device whose idle period expired,
+	// call this regularly from loop()
+	static void pollAll(void);
+
+	// Idle rate in HID_IDLE_UNIT
+	uint8_t idle;
+
+	// Set by the device after it was plugged
+	uint8_t endpoint;
+	HIDReportQueue* queue;
+
+protected:
+	void poll(void);
+
+	uint8_t* current(void){
+		return buffer + front * size;
+	}
+
+	uint8_t* buffer;
+	uint8_t size;
+	uint8_t last[2];
+	volatile uint8_t front;
+	bool relative;
+
+	bool expired(void){
+		return idle && (millis() - lastSend) >= (uint32_t)idle * HID_IDLE_UNIT;
+	}
+
+	uint32_t lastSend;
+
+	HIDIdleReport* next;
+	static HIDIdleReport* rootReport;
+	static bool enabled;
+};
+
+// Idle report with its own storage
+template<int ReportSize>
+class HIDIdleReportBuffer : public HIDIdleReport
+{
+public:
+	HIDIdleReportBuffer(uint8_t idle = 0, bool relative = false) :
+		HIDIdleReport(storage, ReportSize, idle, relative) {}
+
+private:
+	uint8_t storage[2 * ReportSize];
+};
@@ -0,0 +1,67 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// LED output report of a keyboard. The host sends it with SET_REPORT on every
+// LED change and usually also after enumeration, the callback is called for
+// every report from the USB interrupt. Keep it short and do not send reports
+// from it. Sketches without a callback can compare sequence() instead.
+class HIDLedReport
+{
+public:
+	typedef void (*Callback)(uint8_t leds);
+
+	HIDLedReport(void) : leds(0), reports(0), valid(false), callback(NULL) {}
+
+	// Receive the report of a SET_REPORT output request
+	bool receive(uint16_t length);
+
+	uint8_t get(void){
+		return leds;
+	}
+
+	// Counts every received report, wraps around at 256
+	uint8_t sequence(void){
+		return reports;
+	}
+
+	// The host sent at least one report, get() is its LED state
+	bool received(void){
+		return valid;
+	}
+
+	void onReport(Callback function){
+		callback = function;
+	}
+
+protected:
+	volatile uint8_t leds;
+	volatile uint8_t reports;
+	volatile bool valid;
+	Callback callback;
+};
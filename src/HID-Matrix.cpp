@@ -0,0 +1,139 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "HID-Matrix.h"
+#include "HID-APIs/KeyboardAPI.h"
+
+HIDMatrix::HIDMatrix(const uint8_t* rowPins, uint8_t rows, const uint8_t* columnPins, uint8_t columns,
+	const uint8_t* keymap, uint8_t* buffer) :
+	rowPins(rowPins), columnPins(columnPins), keymap(keymap),
+	rows(rows), columns(columns), rowBytes(HID_MATRIX_ROW_BYTES(columns)),
+	length(uint16_t(rows) * rowBytes), state(buffer), count0(buffer + length),
+	count1(buffer + 2 * length), raw(buffer + 3 * length),
+	interval(5000 / HID_MATRIX_SAMPLES), due(0), keyboard(NULL)
+{
+	// Empty
+}
+
+void HIDMatrix::begin(KeyboardAPI* keyboard)
+{
+	// Rows are only driven while they are scanned
+	for (uint8_t r = 0; r < rows; r++) {
+		pinMode(rowPins[r], INPUT);
+	}
+	for (uint8_t c = 0; c < columns; c++) {
+		pinMode(columnPins[c], INPUT_PULLUP);
+	}
+
+	// Released keys with reset counters
+	memset(state, 0x00, length);
+	memset(count0, 0xFF, length);
+	memset(count1, 0xFF, length);
+
+	this->keyboard = keyboard;
+	due = micros();
+}
+
+void HIDMatrix::end(void)
+{
+	for (uint8_t r = 0; r < rows; r++) {
+		pinMode(rowPins[r], INPUT);
+	}
+	keyboard = NULL;
+}
+
+void HIDMatrix::sample(void)
+{
+	for (uint8_t r = 0; r < rows; r++) {
+		pinMode(rowPins[r], OUTPUT);
+		digitalWrite(rowPins[r], LOW);
+
+		uint8_t* bits = raw + uint16_t(r) * rowBytes;
+		memset(bits, 0x00, rowBytes);
+		for (uint8_t c = 0; c < columns; c++) {
+			if (!digitalRead(columnPins[c])) {
+				bits[c / 8] |= 1 << (c % 8);
+			}
+		}
+
+		// Release the row, the pullups charge the columns again
+		pinMode(rowPins[r], INPUT);
+	}
+}
+
+bool HIDMatrix::scan(void)
+{
+	uint32_t now = micros();
+	if ((now - due) < interval) {
+		return false;
+	}
+	due = now;
+
+	// Sample the whole matrix first, the rows read while the keys are added
+	// would be delayed otherwise
+	sample();
+
+	bool changed = false;
+	for (uint16_t i = 0; i < length; i++) {
+		// Vertical counter: keys that differ from their state count down,
+		// the others are reset. The state toggles when the counter wraps.
+		uint8_t delta = state[i] ^ raw[i];
+		count0[i] = ~(count0[i] & delta);
+		count1[i] = count0[i] ^ (count1[i] & delta);
+		delta &= count0[i] & count1[i];
+		if (!delta) {
+			continue;
+		}
+		state[i] ^= delta;
+		changed = true;
+
+		if (!keyboard) {
+			continue;
+		}
+		uint8_t row = i / rowBytes;
+		uint8_t column = (i % rowBytes) * 8;
+		for (; delta; delta >>= 1, column++) {
+			if (!(delta & 0x01)) {
+				continue;
+			}
+			uint8_t k = pgm_read_byte(keymap + uint16_t(row) * columns + column);
+			if (k == KEY_RESERVED) {
+				continue;
+			}
+			if (state[i] & (1 << (column % 8))) {
+				keyboard->add(KeyboardKeycode(k));
+			}
+			else {
+				keyboard->remove(KeyboardKeycode(k));
+			}
+		}
+	}
+
+	// One report for all keys of this pass
+	if (changed && keyboard) {
+		keyboard->send();
+		return true;
+	}
+	return false;
+}
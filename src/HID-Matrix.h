@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Bytes of the bit arrays per matrix row
+#define HID_MATRIX_ROW_BYTES(columns) (((columns) + 7) / 8)
+
+// A key changes its debounced state after this many equal samples in a row.
+// The 2 bit vertical counters count all keys of a byte at once.
+#define HID_MATRIX_SAMPLES 4
+
+class KeyboardAPI;
+
+// Scans a key matrix and feeds the debounced keys into a keyboard.
+// Each row is pulled low in turn, the columns are read with pullups,
+// so the diodes (if any) point from the columns to the rows.
+// The state of the keys is stored in bit arrays, one bit per key for the
+// debounced state, two for the debounce counter and
+// one for the raw sample. A scan pass with
+// changes sends a single report, passes without changes send nothing.
+class HIDMatrix
+{
+public:
+	// The keymap (rows * columns keycodes, KEY_RESERVED for no key) is
+	// stored in PROGMEM. The buffer needs 4 * rows * HID_MATRIX_ROW_BYTES(columns) bytes.
+	HIDMatrix(const uint8_t* rowPins, uint8_t rows, const uint8_t* columnPins, uint8_t columns,
+		const uint8_t* keymap, uint8_t* buffer);
+
+	// Set up the pins and start with all keys released
+	void begin(KeyboardAPI* keyboard);
+	void end(void);
+
+	// Debounce time in us, split into HID_MATRIX_SAMPLES samples
+	void setDebounce(uint16_t us){
+		interval = us / HID_MATRIX_SAMPLES;
+	}
+
+	// Take a sample if it is due, returns true if a report was sent
+	bool scan(void);
+
+	// Debounced state of a key
+	bool isPressed(uint8_t row, uint8_t column){
+		return state[uint16_t(row) * rowBytes + column / 8] & (1 << (column % 8));
+	}
+
+protected:
+	// Read the raw state of all keys
+	void sample(void);
+
+	const uint8_t* rowPins;
+	const uint8_t* columnPins;
+	const uint8_t* keymap;
+	uint8_t rows;
+	uint8_t columns;
+	uint8_t rowBytes;
+
+	// Debounced state, vertical counters and the last sample, one bit per key
+	uint16_t length;
+	uint8_t* state;
+	uint8_t* count0;
+	uint8_t* count1;
+	uint8_t* raw;
+
+	uint16_t interval;
+	uint32_t due;
+
+	KeyboardAPI* keyboard;
+};
+
+// Matrix with the buffer for the given size
+template<uint8_t Rows, uint8_t Columns>
+class HIDMatrixBuffer : public HIDMatrix
+{
+public:
+	HIDMatrixBuffer(const uint8_t* rowPins, const uint8_t* columnPins, const uint8_t* keymap) :
+		HIDMatrix(rowPins, Rows, columnPins, Columns, keymap, buffer)
+	{
+		// Empty
+	}
+
+protected:
+	uint8_t buffer[4 * Rows * HID_MATRIX_ROW_BYTES(Columns)];
+};
@@ -0,0 +1,409 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "HID-Message.h"
+#ifdef __AVR__
+#include <util/crc16.h>
+#endif
+
+RawHIDMessage::RawHIDMessage(void) :
+	rxBuffer(NULL), rxSize(0), rxLength(0), rxOffset(0), rxCRC(0), rxSeq(0), rxUnacked(0), rxErrors(0),
+	rxActive(false), rxHasCRC(false), rxPacked(false), rxComplete(false), rxDrop(false), rxSynced(false), rxNak(false), rxAck(0),
+	txData(NULL), txLength(0), txCRC(0), txHasCRC(false), txPacked(false), txStream(0), txPackPacket(0), txPackOffset(0),
+	txPackets(0), txNext(0), txAcked(0), txStart(0), txSeq(0), txWindow(1), txLastAck(0), crc(false), compression(false)
+{
+	// Empty
+}
+
+void RawHIDMessage::begin(uint8_t* buffer, uint16_t size)
+{
+	rxBuffer = buffer;
+	rxSize = size;
+	rxActive = false;
+	rxComplete = false;
+	rxSynced = false;
+	rxAck = 0;
+}
+
+void RawHIDMessage::end(void)
+{
+	rxBuffer = NULL;
+	rxSize = 0;
+	rxActive = false;
+	rxComplete = false;
+	txData = NULL;
+}
+
+uint16_t RawHIDMessage::crc16(uint16_t crc, uint8_t data)
+{
+#ifdef __AVR__
+	return _crc_ccitt_update(crc, data);
+#else
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	return ((uint16_t(data) << 8) | (crc >> 8)) ^ uint8_t(data >> 4) ^ (uint16_t(data) << 3);
+#endif
+}
+
+bool RawHIDMessage::send(const void* data, uint16_t length)
+{
+	if (txData || !length) {
+		return false;
+	}
+
+	// The CRC is calculated once, reports that are sent again only copy data
+	txHasCRC = crc;
+	txCRC = 0xFFFF;
+	if (txHasCRC) {
+		for (uint16_t i = 0; i < length; i++) {
+			txCRC = crc16(txCRC, ((const uint8_t*)data)[i]);
+		}
+	}
+
+	txStream = uint32_t(length) + (txHasCRC ? 2 : 0);
+	txPackets = 1;
+	if (txStream > RAWHID_SIZE - 4) {
+		txPackets += (txStream - (RAWHID_SIZE - 4) + (RAWHID_SIZE - 3)) / (RAWHID_SIZE - 2);
+	}
+
+	txLength = length;
+	txData = (const uint8_t*)data;
+
+	// Packing costs one pass over the message, it is only used if it saves reports
+	txPacked = false;
+	if (compression) {
+		uint16_t packets = 0;
+		for (uint32_t start = 0; start < txStream && packets < txPackets; packets++) {
+			start += pack(NULL, payload(packets), start);
+		}
+		if (packets < txPackets) {
+			txPacked = true;
+			txPackets = packets;
+		}
+	}
+	txPackPacket = 0;
+	txPackOffset = 0;
+
+	txNext = 0;
+	txAcked = 0;
+	txStart = txSeq;
+	txSeq += txPackets;
+	txLastAck = millis();
+	return true;
+}
+
+uint16_t RawHIDMessage::pack(uint8_t* out, uint8_t space, uint32_t start)
+{
+	uint32_t pos = start;
+	uint8_t used = 0;
+	while (pos < txStream && used + 2 <= space) {
+		// Runs of three and more bytes are repeated
+		uint8_t b = streamByte(pos);
+		uint8_t run = 1;
+		while (run < 128 && pos + run < txStream && streamByte(pos + run) == b) {
+			run++;
+		}
+		if (run >= 3) {
+			if (out) {
+				out[used] = 257 - run;
+				out[used + 1] = b;
+			}
+			used += 2;
+			pos += run;
+			continue;
+		}
+
+		// Literals up to the next run
+		uint8_t limit = min(128, space - used - 1);
+		uint8_t n = 0;
+		while (n < limit && pos + n < txStream) {
+			if (pos + n + 2 < txStream && streamByte(pos + n) == streamByte(pos + n + 1)
+				&& streamByte(pos + n) == streamByte(pos + n + 2)) {
+				break;
+			}
+			n++;
+		}
+		if (out) {
+			out[used] = n - 1;
+			for (uint8_t i = 0; i < n; i++) {
+				out[used + 1 + i] = streamByte(pos + i);
+			}
+		}
+		used += n + 1;
+		pos += n;
+	}
+	return pos - start;
+}
+
+uint32_t RawHIDMessage::packedOffset(uint16_t packet)
+{
+	// Reports are sent in order, only going back needs to pack from the start
+	if (packet != txPackPacket) {
+		txPackPacket = 0;
+		txPackOffset = 0;
+		while (txPackPacket < packet) {
+			txPackOffset += pack(NULL, payload(txPackPacket), txPackOffset);
+			txPackPacket++;
+		}
+	}
+	return txPackOffset;
+}
+
+void RawHIDMessage::fill(uint8_t* report, uint16_t packet)
+{
+	memset(report, 0x00, RAWHID_SIZE);
+	report[0] = RAWHID_MSG_DATA;
+	report[1] = txStart + packet;
+
+	uint8_t header = 2;
+	if (!packet) {
+		report[0] |= RAWHID_MSG_START | (txHasCRC ? RAWHID_MSG_CRC : 0) | (txPacked ? RAWHID_MSG_PACKED : 0);
+		report[2] = txLength;
+		report[3] = txLength >> 8;
+		header = 4;
+	}
+	if (packet == txPackets - 1) {
+		report[0] |= RAWHID_MSG_END;
+	}
+
+	if (txPacked) {
+		uint32_t start = packedOffset(packet);
+		uint8_t* out = report + header;
+		memset(out, 0x80, payload(packet));
+		txPackOffset = start + pack(out, payload(packet), start);
+		txPackPacket = packet + 1;
+		return;
+	}
+
+	// Payload of the message, followed by the CRC
+	uint32_t start = offset(packet);
+	for (uint16_t i = header; i < RAWHID_SIZE && start < txStream; i++, start++) {
+		report[i] = streamByte(start);
+	}
+}
+
+void RawHIDMessage::transmit(void)
+{
+	if (!txData) {
+		return;
+	}
+
+	// Go back to the oldest unacknowledged report after a timeout
+	uint16_t now = millis();
+	if (txAcked != txNext && uint16_t(now - txLastAck) >= RAWHID_MSG_TIMEOUT) {
+		txNext = txAcked;
+		txLastAck = now;
+	}
+
+	while (txNext < txPackets && uint16_t(txNext - txAcked) < txWindow && RawHID.availableForWrite()) {
+		uint8_t* report = RawHID.acquirePacket();
+		fill(report, txNext);
+		if (RawHID.commitPacket(RAWHID_SIZE) <= 0) {
+			break;
+		}
+		txNext++;
+	}
+}
+
+void RawHIDMessage::acknowledge(void)
+{
+	if (!rxAck || !RawHID.availableForWrite()) {
+		return;
+	}
+
+	// Full reports, some hosts drop short ones
+	uint8_t* report = RawHID.acquirePacket();
+	memset(report, 0x00, RAWHID_SIZE);
+	report[0] = rxAck;
+	report[1] = rxSeq;
+	report[2] = RAWHID_MSG_WINDOW;
+	if (RawHID.commitPacket(RAWHID_SIZE) > 0) {
+		rxAck = 0;
+		rxUnacked = 0;
+	}
+}
+
+void RawHIDMessage::receive(const uint8_t* report, int length)
+{
+	if (length < 3) {
+		return;
+	}
+
+	uint8_t type = report[0] & RAWHID_MSG_TYPE_MASK;
+	if (type == RAWHID_MSG_DATA) {
+		receiveData(report, length);
+		return;
+	}
+	if (!txData || (type != RAWHID_MSG_ACK && type != RAWHID_MSG_NAK)) {
+		return;
+	}
+
+	// Acks outside of the reports in flight are stale
+	uint16_t acked = txAcked + uint8_t(report[1] - uint8_t(txStart + txAcked));
+	if (acked > txNext) {
+		return;
+	}
+	txAcked = acked;
+	txWindow = report[2] ? report[2] : 1;
+	txLastAck = millis();
+	if (type == RAWHID_MSG_NAK) {
+		txNext = txAcked;
+	}
+	if (txAcked == txPackets) {
+		txData = NULL;
+	}
+}
+
+void RawHIDMessage::receiveData(const uint8_t* report, int length)
+{
+	uint8_t flags = report[0];
+	uint8_t seq = report[1];
+
+	// Reports sent again after a lost ack, ack them again
+	if (duplicate(seq)) {
+		setAck(RAWHID_MSG_ACK);
+		return;
+	}
+	if (rxSynced && seq != rxSeq) {
+		// A report is missing, a new start means the host started over
+		if (!(flags & RAWHID_MSG_START)) {
+			if (!rxNak) {
+				rxNak = true;
+				setAck(RAWHID_MSG_NAK);
+			}
+			return;
+		}
+	}
+
+	uint8_t header = 2;
+	if (flags & RAWHID_MSG_START) {
+		if (length < 4) {
+			return;
+		}
+		rxLength = report[2] | (report[3] << 8);
+		rxHasCRC = flags & RAWHID_MSG_CRC;
+		rxPacked = flags & RAWHID_MSG_PACKED;
+		rxCRC = 0xFFFF;
+		rxOffset = 0;
+		rxActive = true;
+		rxDrop = (rxLength > rxSize);
+		header = 4;
+	}
+	else if (!rxActive) {
+		// Middle of a message we never saw the start of
+		return;
+	}
+
+	rxSynced = true;
+	rxNak = false;
+	rxSeq = seq + 1;
+
+	// Copy or unpack the payload
+	if (rxPacked) {
+		for (int i = header; i < length;) {
+			uint8_t n = report[i++];
+			if (n < 128) {
+				for (n++; n && i < length; n--) {
+					receiveByte(report[i++]);
+				}
+			}
+			else if (n > 128 && i < length) {
+				uint8_t b = report[i++];
+				for (uint16_t run = 257 - n; run; run--) {
+					receiveByte(b);
+				}
+			}
+		}
+	}
+	else {
+		for (int i = header; i < length; i++) {
+			receiveByte(report[i]);
+		}
+	}
+
+	uint32_t stream = uint32_t(rxLength) + (rxHasCRC ? 2 : 0);
+	if (flags & RAWHID_MSG_END) {
+		rxActive = false;
+		if (rxOffset < stream || rxDrop || (rxHasCRC && rxCRC)) {
+			rxErrors++;
+		}
+		else {
+			rxComplete = true;
+		}
+		setAck(RAWHID_MSG_ACK);
+	}
+	else if (++rxUnacked >= (RAWHID_MSG_WINDOW + 1) / 2) {
+		setAck(RAWHID_MSG_ACK);
+	}
+}
+
+void RawHIDMessage::receiveByte(uint8_t b)
+{
+	// Store the message and check the trailing CRC, padding is ignored
+	uint32_t stream = uint32_t(rxLength) + (rxHasCRC ? 2 : 0);
+	if (rxOffset >= stream) {
+		return;
+	}
+	if (rxOffset < rxLength) {
+		if (!rxDrop) {
+			rxBuffer[rxOffset] = b;
+		}
+		rxCRC = crc16(rxCRC, b);
+	}
+	else if (rxOffset == rxLength) {
+		rxCRC ^= b;
+	}
+	else {
+		rxCRC ^= uint16_t(b) << 8;
+	}
+	rxOffset++;
+}
+
+void RawHIDMessage::release(void)
+{
+	rxComplete = false;
+}
+
+bool RawHIDMessage::poll(void)
+{
+	// Acks first, they open the window of the other side
+	acknowledge();
+
+	const uint8_t* report;
+	int length;
+	while ((length = RawHID.readPacket(&report)) > 0) {
+		// New data is dropped until the message is released, without an ack
+		// the host sends it again. Waiting in the RawHID slots instead would
+		// also hold back the acks behind it.
+		bool drop = rxComplete && (report[0] & RAWHID_MSG_TYPE_MASK) == RAWHID_MSG_DATA && !duplicate(report[1]);
+		if (!drop) {
+			receive(report, length);
+		}
+		RawHID.releasePacket();
+	}
+
+	acknowledge();
+	transmit();
+	return sending();
+}
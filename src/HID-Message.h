@@ -0,0 +1,203 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "SingleReport/RawHID.h"
+
+// Framing of messages larger than one RawHID report, see
+// extras/rawhid/rawhid_message.h for the host side.
+//
+// Every report starts with a type byte and a sequence number that counts
+// the data reports and wraps at 256:
+//	DATA	type, seq, [length (2 bytes, first report only)], payload
+//	ACK	type, next expected seq, window
+//	NAK	type, next expected seq, window
+// The first data report has RAWHID_MSG_START set and carries the length of
+// the message (1 - 65535 bytes), the last one has RAWHID_MSG_END set. With
+// RAWHID_MSG_CRC in the first report the message is followed by its CRC-16
+// (CCITT polynomial, init 0xFFFF, reflected, low byte first).
+//
+// With RAWHID_MSG_PACKED in the first report the payload of every data
+// report is PackBits coded on its own, so a lost report does not affect
+// the others. A control byte n of 0 - 127 is followed by n + 1 literal bytes,
+// 129 - 255 repeat the next byte 257 - n times and 128 pads the report.
+// The length is the unpacked length, the CRC is packed with the message.
+//
+// The sender keeps up to window reports unacknowledged. The receiver acks
+// after half of its window and at the end of every message, a gap in the
+// sequence is answered with a NAK and the sender goes back to that report.
+// Unacknowledged reports are sent again after RAWHID_MSG_TIMEOUT.
+
+#define RAWHID_MSG_DATA 0x10
+#define RAWHID_MSG_ACK 0x20
+#define RAWHID_MSG_NAK 0x30
+#define RAWHID_MSG_TYPE_MASK 0xF0
+
+#define RAWHID_MSG_START 0x01
+#define RAWHID_MSG_END 0x02
+#define RAWHID_MSG_CRC 0x04
+#define RAWHID_MSG_PACKED 0x08
+
+// Reports the host may send ahead of the acks. Received reports are moved
+// into the message buffer from the RawHID slots, so this is the number of slots.
+#define RAWHID_MSG_WINDOW RAWHID_RX_SLOTS
+
+// Sends and receives messages over RawHID without blocking, call poll()
+// regularly from loop(). RawHID.begin() is called by the sketch as usual,
+// with one slot per report (see RAWHID_RX_SLOTS).
+class RawHIDMessage
+{
+public:
+	RawHIDMessage(void);
+
+	// Buffer for a received message, longer messages are dropped
+	void begin(uint8_t* buffer, uint16_t size);
+	void end(void);
+
+	// Append a CRC to sent messages, received messages are checked
+	// if the host sent a CRC.
+	void setCRC(bool enable){
+		crc = enable;
+	}
+
+	// Pack sent messages with run-length coding if that saves reports,
+	// received messages are unpacked if the host packed them.
+	void setCompression(bool enable){
+		compression = enable;
+	}
+
+	// Start sending a message, the data has to stay valid until sending()
+	// returns false. Returns false if a message is still being sent.
+	bool send(const void* data, uint16_t length);
+	bool sending(void){
+		return txData != NULL;
+	}
+
+	// Length of the received message, 0 until a message is complete.
+	// The next message is not received until this one is released.
+	uint16_t available(void){
+		return rxComplete ? rxLength : 0;
+	}
+	const uint8_t* message(void){
+		return rxBuffer;
+	}
+	void release(void);
+
+	// Receive and send reports, returns true while a message is being sent
+	bool poll(void);
+
+	// Messages which were too long or had a wrong CRC
+	uint16_t errors(void){
+		return rxErrors;
+	}
+
+protected:
+	void receive(const uint8_t* report, int length);
+	void receiveData(const uint8_t* report, int length);
+	void receiveByte(uint8_t b);
+	void acknowledge(void);
+
+	// Reports that were already received
+	bool duplicate(uint8_t seq){
+		return rxSynced && uint8_t(rxSeq - seq - 1) < RAWHID_MSG_WINDOW;
+	}
+
+	// Acks carry the next expected report, a pending NAK stays one
+	void setAck(uint8_t type){
+		if (rxAck != RAWHID_MSG_NAK) {
+			rxAck = type;
+		}
+	}
+	void transmit(void);
+	void fill(uint8_t* report, uint16_t packet);
+
+	// Message followed by its CRC
+	uint8_t streamByte(uint32_t index){
+		if (index < txLength) {
+			return txData[index];
+		}
+		return (index == txLength) ? txCRC : (txCRC >> 8);
+	}
+
+	// Packs as much of the stream from start as fits into space bytes,
+	// returns the number of stream bytes. Only counts if out is NULL.
+	uint16_t pack(uint8_t* out, uint8_t space, uint32_t start);
+	uint32_t packedOffset(uint16_t packet);
+
+	// Payload bytes of a data report
+	static uint8_t payload(uint16_t packet){
+		return packet ? (RAWHID_SIZE - 2) : (RAWHID_SIZE - 4);
+	}
+
+	// Payload offset of a data report
+	static uint32_t offset(uint16_t packet){
+		return packet ? (RAWHID_SIZE - 4) + uint32_t(packet - 1) * (RAWHID_SIZE - 2) : 0;
+	}
+
+	static uint16_t crc16(uint16_t crc, uint8_t data);
+
+	// Receiving
+	uint8_t* rxBuffer;
+	uint16_t rxSize;
+	uint16_t rxLength;
+	uint32_t rxOffset;
+	uint16_t rxCRC;
+	uint8_t rxSeq;
+	uint8_t rxUnacked;
+	uint16_t rxErrors;
+	bool rxActive;
+	bool rxHasCRC;
+	bool rxPacked;
+	bool rxComplete;
+	bool rxDrop;
+	bool rxSynced;
+	bool rxNak;
+	// ACK or NAK waiting for a free endpoint
+	uint8_t rxAck;
+
+	// Sending, reports are counted from the start of the message
+	const uint8_t* txData;
+	uint16_t txLength;
+	uint16_t txCRC;
+	bool txHasCRC;
+	bool txPacked;
+	uint32_t txStream;
+	// Stream offset of the next packed report, to not pack from the start again
+	uint16_t txPackPacket;
+	uint32_t txPackOffset;
+	uint16_t txPackets;
+	uint16_t txNext;
+	uint16_t txAcked;
+	uint8_t txStart;
+	uint8_t txSeq;
+	uint8_t txWindow;
+	uint16_t txLastAck;
+
+	bool crc;
+	bool compression;
+};
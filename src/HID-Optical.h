@@ -0,0 +1,127 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "HID-Frame.h"
+#include "HID-APIs/MouseAPI.h"
+#include <SPI.h>
+
+// Bytes of a motion burst: motion, observation, delta X and Y (16 bit each),
+// surface quality, raw data sum, raw maximum, raw minimum and the shutter
+#define HID_OPTICAL_BURST 12
+
+// PixArt PMW3360 sensor on SPI, read with motion bursts.
+// HID-Project.h does not include this file, so only sketches which include
+// it themselves depend on the SPI library.
+// The sensor counts at up to 12000 frames per second, every read() moves its
+// counts into 32 bit accumulators. poll() hands them to the mouse when it can
+// send the next report, once per host poll, so the sensor is read far faster
+// than the host polls without losing or clipping counts. Enable
+// HID_MOUSE_HIGH_RESOLUTION for the 16 bit movement of high CPI settings,
+// otherwise a fast movement is spread over several 8 bit reports.
+class HIDOpticalSensor
+{
+public:
+	// The chip select pin, the sensor shares the SPI bus
+	inline HIDOpticalSensor(uint8_t csPin);
+
+	// Reset the sensor and upload its firmware, the SROM image of the vendor
+	// in PROGMEM. The sensor does not track reliably without it.
+	// Returns false if no PMW3360 answered or the upload failed.
+	inline bool begin(const uint8_t* srom = NULL, uint16_t length = 0);
+	inline void end(void);
+
+	// Resolution in counts per inch, 100 - 12000 in steps of 100
+	inline void setCPI(uint16_t cpi);
+
+	// Mirror the axes for the mounting of the sensor
+	void setInvert(bool x, bool y){
+		invertX = x;
+		invertY = y;
+	}
+
+	// Burst read the counts since the last read, returns true on movement
+	inline bool read(void);
+
+	// Read the sensor and move the mouse by the accumulated counts if its
+	// endpoint is free or a new frame started. Returns true if it moved.
+	template<class Mouse>
+	bool poll(Mouse& mouse);
+
+	// Surface quality of the last burst, about half the number of features
+	uint8_t quality(void){
+		return burstData[6];
+	}
+
+	// The sensor is lifted off the surface and stopped counting
+	bool lifted(void){
+		return burstData[0] & 0x08;
+	}
+
+protected:
+	inline uint8_t readRegister(uint8_t reg);
+	inline void writeRegister(uint8_t reg, uint8_t value);
+
+	uint8_t csPin;
+	bool bursting;
+	bool invertX;
+	bool invertY;
+	uint16_t frame;
+	int32_t deltaX;
+	int32_t deltaY;
+	uint8_t burstData[HID_OPTICAL_BURST];
+};
+
+template<class Mouse>
+bool HIDOpticalSensor::poll(Mouse& mouse)
+{
+	read();
+	if (!deltaX && !deltaY) {
+		return false;
+	}
+
+	// Mice which cannot tell if the endpoint is free send once per frame.
+	// Waiting for the endpoint loses no counts, the sensor keeps them.
+	if (!mouse.ReadyToSend()) {
+		uint16_t f = HIDFrame::number();
+		if (f == frame) {
+			return false;
+		}
+		frame = f;
+	}
+
+	// The rest of a fast movement is sent with the next report
+	int16_t x = constrain(deltaX, -HID_MOUSE_AXIS_LIMIT, HID_MOUSE_AXIS_LIMIT);
+	int16_t y = constrain(deltaY, -HID_MOUSE_AXIS_LIMIT, HID_MOUSE_AXIS_LIMIT);
+	deltaX -= x;
+	deltaY -= y;
+	mouse.move(x, y);
+	return true;
+}
+
+// Implementation is inline
+#include "HID-Optical.hpp"
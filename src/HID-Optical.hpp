@@ -0,0 +1,175 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+// PMW3360 registers
+#define PMW3360_PRODUCT_ID        0x00
+#define PMW3360_MOTION            0x02
+#define PMW3360_DELTA_Y_H         0x06
+#define PMW3360_CONFIG1           0x0F
+#define PMW3360_CONFIG2           0x10
+#define PMW3360_SROM_ENABLE       0x13
+#define PMW3360_SROM_ID           0x2A
+#define PMW3360_POWER_UP_RESET    0x3A
+#define PMW3360_MOTION_BURST      0x50
+#define PMW3360_SROM_LOAD_BURST   0x62
+
+#define PMW3360_PRODUCT           0x42
+
+// Mode 3 with at most 2MHz
+#define PMW3360_SPI_SETTINGS      SPISettings(2000000, MSBFIRST, SPI_MODE3)
+
+HIDOpticalSensor::HIDOpticalSensor(uint8_t csPin) :
+	csPin(csPin), bursting(false), invertX(false), invertY(false),
+	frame(0), deltaX(0), deltaY(0)
+{
+	memset(burstData, 0x00, sizeof(burstData));
+}
+
+uint8_t HIDOpticalSensor::readRegister(uint8_t reg)
+{
+	// Every other access ends the motion burst mode
+	bursting = false;
+
+	SPI.beginTransaction(PMW3360_SPI_SETTINGS);
+	digitalWrite(csPin, LOW);
+	SPI.transfer(reg & 0x7F);
+	delayMicroseconds(160);
+	uint8_t value = SPI.transfer(0);
+	delayMicroseconds(1);
+	digitalWrite(csPin, HIGH);
+	SPI.endTransaction();
+	delayMicroseconds(20);
+	return value;
+}
+
+void HIDOpticalSensor::writeRegister(uint8_t reg, uint8_t value)
+{
+	bursting = false;
+
+	SPI.beginTransaction(PMW3360_SPI_SETTINGS);
+	digitalWrite(csPin, LOW);
+	SPI.transfer(reg | 0x80);
+	SPI.transfer(value);
+	delayMicroseconds(35);
+	digitalWrite(csPin, HIGH);
+	SPI.endTransaction();
+	delayMicroseconds(180);
+}
+
+bool HIDOpticalSensor::begin(const uint8_t* srom, uint16_t length)
+{
+	pinMode(csPin, OUTPUT);
+	digitalWrite(csPin, HIGH);
+	SPI.begin();
+
+	// A pulse of the chip select resets the serial port of the sensor
+	digitalWrite(csPin, LOW);
+	digitalWrite(csPin, HIGH);
+	writeRegister(PMW3360_POWER_UP_RESET, 0x5A);
+	delay(50);
+	for (uint8_t reg = PMW3360_MOTION; reg <= PMW3360_DELTA_Y_H; reg++) {
+		readRegister(reg);
+	}
+	if (readRegister(PMW3360_PRODUCT_ID) != PMW3360_PRODUCT) {
+		return false;
+	}
+
+	// The firmware is uploaded in one burst with the rest mode disabled
+	if (srom && length) {
+		writeRegister(PMW3360_CONFIG2, 0x20);
+		writeRegister(PMW3360_SROM_ENABLE, 0x1D);
+		delay(10);
+		writeRegister(PMW3360_SROM_ENABLE, 0x18);
+
+		SPI.beginTransaction(PMW3360_SPI_SETTINGS);
+		digitalWrite(csPin, LOW);
+		SPI.transfer(PMW3360_SROM_LOAD_BURST | 0x80);
+		delayMicroseconds(15);
+		for (uint16_t i = 0; i < length; i++) {
+			SPI.transfer(pgm_read_byte(srom + i));
+			delayMicroseconds(15);
+		}
+		digitalWrite(csPin, HIGH);
+		SPI.endTransaction();
+		delayMicroseconds(200);
+
+		// The ID of the running firmware is 0 if the upload failed
+		if (!readRegister(PMW3360_SROM_ID)) {
+			return false;
+		}
+		writeRegister(PMW3360_CONFIG2, 0x00);
+	}
+
+	deltaX = 0;
+	deltaY = 0;
+	frame = HIDFrame::number();
+	return true;
+}
+
+void HIDOpticalSensor::end(void)
+{
+	bursting = false;
+	deltaX = 0;
+	deltaY = 0;
+}
+
+void HIDOpticalSensor::setCPI(uint16_t cpi)
+{
+	cpi = constrain(cpi, 100, 12000);
+	writeRegister(PMW3360_CONFIG1, cpi / 100 - 1);
+}
+
+bool HIDOpticalSensor::read(void)
+{
+	// Any write to the burst register starts the burst mode, then each
+	// burst only needs the address
+	if (!bursting) {
+		writeRegister(PMW3360_MOTION_BURST, 0x00);
+		bursting = true;
+	}
+
+	SPI.beginTransaction(PMW3360_SPI_SETTINGS);
+	digitalWrite(csPin, LOW);
+	SPI.transfer(PMW3360_MOTION_BURST);
+	delayMicroseconds(35);
+	for (uint8_t i = 0; i < HID_OPTICAL_BURST; i++) {
+		burstData[i] = SPI.transfer(0);
+	}
+	digitalWrite(csPin, HIGH);
+	SPI.endTransaction();
+	delayMicroseconds(1);
+
+	// No motion since the last read
+	if (!(burstData[0] & 0x80)) {
+		return false;
+	}
+
+	int16_t x = (int16_t)((uint16_t)burstData[3] << 8 | burstData[2]);
+	int16_t y = (int16_t)((uint16_t)burstData[5] << 8 | burstData[4]);
+	deltaX += invertX ? -x : x;
+	deltaY += invertY ? -y : y;
+	return x || y;
+}
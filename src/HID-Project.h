@@ -31,7 +31,9 @@ THE SOFTWARE.
 #error HID Project requires Arduino IDE 1.6.7 or greater. Please update your IDE.
 #endif
 
-#if !defined(USBCON)
+#include "HID-Settings.h"
+
+#if !defined(USBCON) && !defined(HID_TINYUSB)
 #error HID Project can only be used with an USB MCU.
 #endif
 
@@ -40,6 +42,7 @@ THE SOFTWARE.
 #include "MultiReport/AbsoluteMouse.h"
 #include "SingleReport/BootMouse.h"
 #include "MultiReport/ImprovedMouse.h"
+#include "HID-APIs/MouseAcceleration.h"
 #include "SingleReport/SingleConsumer.h"
 #include "MultiReport/Consumer.h"
 #include "SingleReport/SingleGamepad.h"
@@ -47,10 +50,26 @@ THE SOFTWARE.
 #include "SingleReport/SingleSystem.h"
 #include "MultiReport/System.h"
 #include "SingleReport/RawHID.h"
+#include "HID-Message.h"
+#include "HID-Channel.h"
 #include "SingleReport/BootKeyboard.h"
 #include "MultiReport/ImprovedKeyboard.h"
 #include "SingleReport/SingleNKROKeyboard.h"
 #include "MultiReport/NKROKeyboard.h"
+#include "MultiReport/HybridKeyboard.h"
 #include "MultiReport/SurfaceDial.h"
+#include "SingleReport/SingleTouchscreen.h"
+#include "MultiReport/Touchscreen.h"
+#include "HID-Hub.h"
+#include "HID-Sequencer.h"
+#include "HID-Trajectory.h"
+#include "HID-Bridge.h"
+#include "HID-Replay.h"
+#include "HID-Suspend.h"
+#include "HID-Matrix.h"
+#include "HID-Frame.h"
+#include "HID-Fingerprint.h"
+#include "HID-Analog.h"
+#include "HID-Task.h"
 
 // Include Teensy HID afterwards to overwrite key definitions if used
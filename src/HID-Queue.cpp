@@ -0,0 +1,110 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Queue.h"
+
+HIDReportQueue* HIDReportQueue::rootQueue = NULL;
+
+HIDReportQueue::HIDReportQueue(uint8_t* buffer, uint8_t slotSize, uint8_t slots) :
+	buffer(buffer), slotSize(slotSize), slots(slots), ep(0), head(0), count(0), next(NULL)
+{
+	// Append to the list of queues
+	if (!rootQueue) {
+		rootQueue = this;
+	}
+	else {
+		HIDReportQueue* current = rootQueue;
+		while (current->next) {
+			current = current->next;
+		}
+		current->next = this;
+	}
+}
+
+bool HIDReportQueue::sendSpace(uint8_t endpoint, int length)
+{
+#if HID_SUSPEND_QUEUE
+	// Queued until the host resumes
+	if (HIDSuspend::suspended()) {
+		return false;
+	}
+#endif
+#ifdef ARDUINO_ARCH_AVR
+	// USB_Send() returns right away if not connected
+	if (!USBDevice.configured()) {
+		return true;
+	}
+	return USB_SendSpace(endpoint) >= length;
+#elif defined(HID_TINYUSB)
+	if (!USB_Configured()) {
+		return true;
+	}
+	return USB_SendSpace(endpoint) >= length;
+#else
+	// No way to check the endpoint, USB_Send() blocks like before
+	(void)endpoint;
+	(void)length;
+	return true;
+#endif
+}
+
+int HIDReportQueue::send(uint8_t endpoint, const void* data, int length)
+{
+	ep = endpoint;
+
+	// Older reports have to be sent first
+	if (!flush() && sendSpace(ep, length)) {
+		return USB_Send(ep | TRANSFER_RELEASE, data, length);
+	}
+
+	if (count >= slots || length >= slotSize) {
+		return 0;
+	}
+
+	uint8_t* slot = buffer + ((head + count) % slots) * slotSize;
+	slot[0] = length;
+	memcpy(slot + 1, data, length);
+	count++;
+	return length;
+}
+
+uint8_t HIDReportQueue::flush(void)
+{
+	while (count) {
+		uint8_t* slot = buffer + head * slotSize;
+		if (!sendSpace(ep, slot[0])) {
+			break;
+		}
+		USB_Send(ep | TRANSFER_RELEASE, slot + 1, slot[0]);
+		head = (head + 1) % slots;
+		count--;
+	}
+	return count;
+}
+
+void HIDReportQueue::flushAll(void)
+{
+	for (HIDReportQueue* current = rootQueue; current; current = current->next) {
+		current->flush();
+	}
+}
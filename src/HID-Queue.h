@@ -0,0 +1,78 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "HID-Suspend.h"
+
+class HIDReportQueue
+{
+public:
+	HIDReportQueue(uint8_t* buffer, uint8_t slotSize, uint8_t slots);
+
+	// Send the report if the endpoint has room, otherwise queue it.
+	// Returns the report length or 0 if the queue is full (report dropped).
+	int send(uint8_t endpoint, const void* data, int length);
+
+	// Send queued reports while the endpoint has room.
+	// Returns the number of reports still queued.
+	uint8_t flush(void);
+
+	uint8_t pending(void){
+		return count;
+	}
+
+	// Flush the queues of all devices, call this regularly from loop()
+	static void flushAll(void);
+
+	// Returns true if the endpoint has room for the report.
+	// Always true on cores which cannot check the endpoint, false while
+	// suspended if reports are held (HID_SUSPEND_QUEUE).
+	static bool sendSpace(uint8_t endpoint, int length);
+
+protected:
+
+	uint8_t* buffer;
+	uint8_t slotSize;
+	uint8_t slots;
+	uint8_t ep;
+	uint8_t head;
+	uint8_t count;
+
+	HIDReportQueue* next;
+	static HIDReportQueue* rootQueue;
+};
+
+// Queue with its own storage, every slot keeps the length in front of the report
+template<int ReportSize, int Slots = HID_SEND_QUEUE>
+class HIDReportQueueBuffer : public HIDReportQueue
+{
+public:
+	HIDReportQueueBuffer(void) : HIDReportQueue(&storage[0][0], ReportSize + 1, Slots) {}
+
+private:
+	uint8_t storage[Slots][ReportSize + 1];
+};
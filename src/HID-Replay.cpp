@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Replay.h"
+
+HIDReplay::HIDReplay(void) :
+	source(SOURCE_NONE), stream(NULL), trace(NULL), remaining(0), header(false), started(false),
+	due(0), count(0), lateCount(0), skipCount(0)
+{
+	// Empty
+}
+
+void HIDReplay::begin(Stream& stream)
+{
+	this->stream = &stream;
+	start(SOURCE_STREAM);
+}
+
+void HIDReplay::begin_P(const uint8_t* trace, uint32_t length)
+{
+	this->trace = trace;
+	remaining = length;
+	start(SOURCE_PROGMEM);
+}
+
+void HIDReplay::start(uint8_t source)
+{
+	this->source = source;
+	header = false;
+	started = false;
+	count = 0;
+	lateCount = 0;
+	skipCount = 0;
+}
+
+void HIDReplay::stop(void)
+{
+	source = SOURCE_NONE;
+}
+
+int HIDReplay::read(void)
+{
+	if (source == SOURCE_STREAM) {
+		return stream->read();
+	}
+	if (remaining) {
+		remaining--;
+		return pgm_read_byte(trace++);
+	}
+	// End of the PROGMEM trace
+	stop();
+	return -1;
+}
+
+bool HIDReplay::fill(void)
+{
+	// The header is checked before the first record
+	while (!header) {
+		int b = read();
+		if (b < 0) {
+			return false;
+		}
+		record[count++] = b;
+		if (count == HID_TRACE_HEADER) {
+			count = 0;
+			if (record[0] != 'H' || record[1] != 'I' || record[2] != 'D' || record[3] != 'T'
+				|| record[4] != HID_TRACE_VERSION) {
+				stop();
+				return false;
+			}
+			header = true;
+		}
+	}
+
+	// Delay, type, length and then the data
+	while (count < HID_TRACE_RECORD || count < HID_TRACE_RECORD + record[5]) {
+		int b = read();
+		if (b < 0) {
+			return false;
+		}
+		record[count++] = b;
+		if (count == HID_TRACE_RECORD && record[5] > HID_BRIDGE_MAX_LENGTH) {
+			stop();
+			return false;
+		}
+	}
+	return true;
+}
+
+int HIDReplay::poll(void)
+{
+	int sent = 0;
+	while (playing() && fill()) {
+		// The delays add up to the original time of the record, so late
+		// reports do not shift the rest of the trace
+		uint32_t delay = record[0] | (uint32_t(record[1]) << 8) | (uint32_t(record[2]) << 16) | (uint32_t(record[3]) << 24);
+		uint32_t now = micros();
+		if (!started) {
+			due = now;
+			started = true;
+		}
+		int32_t wait = int32_t(due + delay - now);
+		if (wait > 0) {
+			break;
+		}
+		due += delay;
+		if (wait < -1000) {
+			lateCount++;
+		}
+
+		if (dispatch(record[4], record + HID_TRACE_RECORD, record[5])) {
+			sent++;
+		}
+		else {
+			skipCount++;
+		}
+		count = 0;
+	}
+	return sent;
+}
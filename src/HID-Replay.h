@@ -0,0 +1,106 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Bridge.h"
+
+// Replays a trace of reports at their original timing, for load tests.
+// Traces are captured on the host with extras/rawhid/rawhid_capture.
+//
+// The trace is a header followed by records, all numbers little endian:
+//	header: 'H', 'I', 'D', 'T', version, 3 reserved bytes (0)
+//	record: delay (uint32, us after the previous record), type, length, data
+// The types are those of HIDBridge (HID_BRIDGE_KEYBOARD etc.) and the data
+// is the report without the report ID. Records are only appended, so a
+// capture that was cut off still is a valid trace up to its last record.
+
+#define HID_TRACE_VERSION 1
+#define HID_TRACE_HEADER 8
+#define HID_TRACE_RECORD 6
+
+// Set the devices with attach()
+class HIDReplay : public HIDBridgeDevices
+{
+public:
+	HIDReplay(void);
+
+	// Trace from a stream, like a File of an SD card. Serial works as well
+	// if the host writes the trace faster than it is replayed.
+	void begin(Stream& stream);
+
+	// Trace in PROGMEM
+	void begin_P(const uint8_t* trace, uint32_t length);
+
+	void stop(void);
+
+	// Sends the reports that are due, call this as often as possible from
+	// loop(). Returns the number of reports that were sent.
+	int poll(void);
+
+	// False after the end of a PROGMEM trace or an invalid record,
+	// stream traces play until stop()
+	bool playing(void){
+		return source != SOURCE_NONE;
+	}
+
+	// Reports that were sent more than 1ms after their time, because poll()
+	// was not called often enough or the stream was too slow
+	uint16_t late(void){
+		return lateCount;
+	}
+
+	// Records that could not be sent: unknown type, wrong length or device
+	uint16_t skipped(void){
+		return skipCount;
+	}
+
+protected:
+	enum {
+		SOURCE_NONE,
+		SOURCE_STREAM,
+		SOURCE_PROGMEM,
+	};
+
+	void start(uint8_t source);
+	// Next byte of the trace, -1 if none is available
+	int read(void);
+	// True once the next record is complete in the buffer
+	bool fill(void);
+
+	uint8_t source;
+	Stream* stream;
+	const uint8_t* trace;
+	uint32_t remaining;
+
+	bool header;
+	bool started;
+	uint32_t due;
+	uint16_t count;
+	uint8_t record[HID_TRACE_RECORD + HID_BRIDGE_MAX_LENGTH];
+
+	uint16_t lateCount;
+	uint16_t skipCount;
+};
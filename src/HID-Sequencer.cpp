@@ -0,0 +1,133 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Sequencer.h"
+#include "HID-APIs/KeyboardAPI.h"
+#include "HID-APIs/ConsumerAPI.h"
+#include "HID-APIs/MouseAPI.h"
+#include "HID-APIs/GamepadAPI.h"
+
+HIDSequencer::HIDSequencer(void) :
+	sequence(NULL), step(NULL), due(0), wait(0), repeats(0),
+	keyboard(NULL), consumer(NULL), mouse(NULL), gamepad(NULL)
+{
+	// Empty
+}
+
+void HIDSequencer::play(const HIDSequenceStep* sequence)
+{
+	this->sequence = sequence;
+	step = sequence;
+	due = micros();
+	wait = 0;
+	repeats = 0;
+}
+
+bool HIDSequencer::poll(void)
+{
+	uint32_t now = micros();
+	while (sequence && (now - due) >= wait) {
+		due += wait;
+		wait = 0;
+
+		HIDSequenceStep current;
+		memcpy_P(&current, step++, sizeof(current));
+
+		if (current.action == HID_SEQ_ACTION_END) {
+			sequence = NULL;
+		}
+		else if (current.action == HID_SEQ_ACTION_REPEAT) {
+			if (current.value && ++repeats >= current.value) {
+				sequence = NULL;
+			}
+			else {
+				// Continue with the next poll, a sequence without delays
+				// would never return otherwise
+				step = sequence;
+				break;
+			}
+		}
+		else {
+			run(current.action, current.arg, current.value);
+			wait = (uint32_t)current.delay * HID_SEQUENCE_TICK;
+		}
+	}
+	return sequence != NULL;
+}
+
+void HIDSequencer::run(uint8_t action, uint8_t arg, uint16_t value)
+{
+	switch (action) {
+	case HID_SEQ_ACTION_KEYBOARD_PRESS:
+		if (keyboard) keyboard->press(KeyboardKeycode(value));
+		break;
+	case HID_SEQ_ACTION_KEYBOARD_RELEASE:
+		if (keyboard) keyboard->release(KeyboardKeycode(value));
+		break;
+	case HID_SEQ_ACTION_KEYBOARD_WRITE:
+		if (keyboard) keyboard->write(KeyboardKeycode(value));
+		break;
+	case HID_SEQ_ACTION_KEYBOARD_RELEASE_ALL:
+		if (keyboard) keyboard->releaseAll();
+		break;
+	case HID_SEQ_ACTION_CONSUMER_PRESS:
+		if (consumer) consumer->press(ConsumerKeycode(value));
+		break;
+	case HID_SEQ_ACTION_CONSUMER_RELEASE:
+		if (consumer) consumer->release(ConsumerKeycode(value));
+		break;
+	case HID_SEQ_ACTION_CONSUMER_WRITE:
+		if (consumer) consumer->write(ConsumerKeycode(value));
+		break;
+	case HID_SEQ_ACTION_MOUSE_PRESS:
+		if (mouse) mouse->press(arg);
+		break;
+	case HID_SEQ_ACTION_MOUSE_RELEASE:
+		if (mouse) mouse->release(arg);
+		break;
+	case HID_SEQ_ACTION_MOUSE_MOVE:
+		if (mouse) mouse->move(int8_t(arg), int8_t(value), int8_t(value >> 8));
+		break;
+	case HID_SEQ_ACTION_GAMEPAD_PRESS:
+		if (gamepad) {
+			gamepad->press(arg);
+			gamepad->write();
+		}
+		break;
+	case HID_SEQ_ACTION_GAMEPAD_RELEASE:
+		if (gamepad) {
+			gamepad->release(arg);
+			gamepad->write();
+		}
+		break;
+	case HID_SEQ_ACTION_GAMEPAD_RELEASE_ALL:
+		if (gamepad) {
+			gamepad->releaseAll();
+			gamepad->write();
+		}
+		break;
+	default:
+		// HID_SEQ_ACTION_WAIT
+		break;
+	}
+}
@@ -0,0 +1,128 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Convert a delay to ticks
+#define HID_SEQ_US(us) ((uint16_t)(((uint32_t)(us) + HID_SEQUENCE_TICK / 2) / HID_SEQUENCE_TICK))
+#define HID_SEQ_MS(ms) HID_SEQ_US((uint32_t)(ms) * 1000)
+
+// Step actions
+#define HID_SEQ_ACTION_END                  0
+#define HID_SEQ_ACTION_WAIT                 1
+#define HID_SEQ_ACTION_REPEAT               2
+#define HID_SEQ_ACTION_KEYBOARD_PRESS       3
+#define HID_SEQ_ACTION_KEYBOARD_RELEASE     4
+#define HID_SEQ_ACTION_KEYBOARD_WRITE       5
+#define HID_SEQ_ACTION_KEYBOARD_RELEASE_ALL 6
+#define HID_SEQ_ACTION_CONSUMER_PRESS       7
+#define HID_SEQ_ACTION_CONSUMER_RELEASE     8
+#define HID_SEQ_ACTION_CONSUMER_WRITE       9
+#define HID_SEQ_ACTION_MOUSE_PRESS          10
+#define HID_SEQ_ACTION_MOUSE_RELEASE        11
+#define HID_SEQ_ACTION_MOUSE_MOVE           12
+#define HID_SEQ_ACTION_GAMEPAD_PRESS        13
+#define HID_SEQ_ACTION_GAMEPAD_RELEASE      14
+#define HID_SEQ_ACTION_GAMEPAD_RELEASE_ALL  15
+
+// Sequence steps, the delay (in ticks) is waited after the action.
+// Sequences are stored in PROGMEM and end with HID_SEQ_END.
+#define HID_SEQ_END() { HID_SEQ_ACTION_END, 0, 0, 0 }
+#define HID_SEQ_WAIT(delay) { HID_SEQ_ACTION_WAIT, 0, 0, (delay) }
+// Start over, count times in total (0 = forever)
+#define HID_SEQ_REPEAT(count) { HID_SEQ_ACTION_REPEAT, 0, (count), 0 }
+#define HID_SEQ_KEYBOARD_PRESS(key, delay) { HID_SEQ_ACTION_KEYBOARD_PRESS, 0, (uint16_t)(key), (delay) }
+#define HID_SEQ_KEYBOARD_RELEASE(key, delay) { HID_SEQ_ACTION_KEYBOARD_RELEASE, 0, (uint16_t)(key), (delay) }
+#define HID_SEQ_KEYBOARD_WRITE(key, delay) { HID_SEQ_ACTION_KEYBOARD_WRITE, 0, (uint16_t)(key), (delay) }
+#define HID_SEQ_KEYBOARD_RELEASE_ALL(delay) { HID_SEQ_ACTION_KEYBOARD_RELEASE_ALL, 0, 0, (delay) }
+#define HID_SEQ_CONSUMER_PRESS(key, delay) { HID_SEQ_ACTION_CONSUMER_PRESS, 0, (uint16_t)(key), (delay) }
+#define HID_SEQ_CONSUMER_RELEASE(key, delay) { HID_SEQ_ACTION_CONSUMER_RELEASE, 0, (uint16_t)(key), (delay) }
+#define HID_SEQ_CONSUMER_WRITE(key, delay) { HID_SEQ_ACTION_CONSUMER_WRITE, 0, (uint16_t)(key), (delay) }
+#define HID_SEQ_MOUSE_PRESS(b, delay) { HID_SEQ_ACTION_MOUSE_PRESS, (uint8_t)(b), 0, (delay) }
+#define HID_SEQ_MOUSE_RELEASE(b, delay) { HID_SEQ_ACTION_MOUSE_RELEASE, (uint8_t)(b), 0, (delay) }
+#define HID_SEQ_MOUSE_MOVE(x, y, wheel, delay) { HID_SEQ_ACTION_MOUSE_MOVE, (uint8_t)(x), (uint16_t)(((uint8_t)(wheel) << 8) | (uint8_t)(y)), (delay) }
+#define HID_SEQ_GAMEPAD_PRESS(b, delay) { HID_SEQ_ACTION_GAMEPAD_PRESS, (uint8_t)(b), 0, (delay) }
+#define HID_SEQ_GAMEPAD_RELEASE(b, delay) { HID_SEQ_ACTION_GAMEPAD_RELEASE, (uint8_t)(b), 0, (delay) }
+#define HID_SEQ_GAMEPAD_RELEASE_ALL(delay) { HID_SEQ_ACTION_GAMEPAD_RELEASE_ALL, 0, 0, (delay) }
+
+typedef struct ATTRIBUTE_PACKED {
+	uint8_t action;
+	uint8_t arg;
+	uint16_t value;
+	uint16_t delay;
+} HIDSequenceStep;
+
+class KeyboardAPI;
+class ConsumerAPI;
+class MouseAPI;
+class GamepadAPI;
+
+// Plays back a sequence without blocking, call poll() regularly from loop().
+// Every step is due a fixed time after the previous one was due, so delays
+// of loop() do not add up over a long sequence.
+class HIDSequencer
+{
+public:
+	HIDSequencer(void);
+
+	// Devices the actions are sent to, unset devices ignore their actions
+	void begin(KeyboardAPI* keyboard, ConsumerAPI* consumer = NULL, MouseAPI* mouse = NULL, GamepadAPI* gamepad = NULL){
+		this->keyboard = keyboard;
+		this->consumer = consumer;
+		this->mouse = mouse;
+		this->gamepad = gamepad;
+	}
+
+	// Start a sequence stored in PROGMEM, the first step runs with the next poll()
+	void play(const HIDSequenceStep* sequence);
+
+	// Stop without releasing the pressed keys
+	void stop(void){
+		sequence = NULL;
+	}
+
+	bool playing(void){
+		return sequence != NULL;
+	}
+
+	// Run all steps that are due, returns true while the sequence is playing
+	bool poll(void);
+
+protected:
+	void run(uint8_t action, uint8_t arg, uint16_t value);
+
+	const HIDSequenceStep* sequence;
+	const HIDSequenceStep* step;
+	uint32_t due;
+	uint32_t wait;
+	uint16_t repeats;
+
+	KeyboardAPI* keyboard;
+	ConsumerAPI* consumer;
+	MouseAPI* mouse;
+	GamepadAPI* gamepad;
+};
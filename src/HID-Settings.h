@@ -24,6 +24,15 @@ THE SOFTWARE.
 // Include guard
 #pragma once
 
+// USB stack of the core. On RP2040, nRF52840 and ESP32-S2/S3 the Adafruit
+// TinyUSB stack has to be selected, the port provides the same USB API.
+#if defined(USE_TINYUSB) || (defined(ARDUINO_ARCH_ESP32) && defined(ARDUINO_USB_MODE) && ARDUINO_USB_MODE == 0)
+#define HID_TINYUSB
+#include "port/tinyusb.h"
+#elif defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_SAM) || defined(ARDUINO_ARCH_SAMD) || defined(HID_HOST)
+#include "HID.h"
+#endif
+
 //================================================================================
 // Settings
 //================================================================================
@@ -73,7 +82,283 @@ THE SOFTWARE.
 #define HID_REPORTID_SURFACEDIAL 10
 #endif
 
-#if defined(ARDUINO_ARCH_AVR)
+#ifndef HID_REPORTID_TOUCHSCREEN
+#define HID_REPORTID_TOUCHSCREEN 11
+#endif
+
+#ifndef HID_REPORTID_HYBRID_KEYBOARD
+#define HID_REPORTID_HYBRID_KEYBOARD 12
+#endif
+
+#ifndef HID_REPORTID_HYBRID_OVERFLOW
+#define HID_REPORTID_HYBRID_OVERFLOW 13
+#endif
+
+// Polling interval (bInterval) of the SingleReport endpoints in ms (1-255).
+// Devices which rarely change can poll slower and leave bus time to others.
+#ifndef HID_INTERVAL_BOOTKEYBOARD
+#define HID_INTERVAL_BOOTKEYBOARD 1
+#endif
+
+#ifndef HID_INTERVAL_BOOTMOUSE
+#define HID_INTERVAL_BOOTMOUSE 1
+#endif
+
+#ifndef HID_INTERVAL_RAWHID
+#define HID_INTERVAL_RAWHID 1
+#endif
+
+#ifndef HID_INTERVAL_CONSUMERCONTROL
+#define HID_INTERVAL_CONSUMERCONTROL 1
+#endif
+
+#ifndef HID_INTERVAL_SYSTEMCONTROL
+#define HID_INTERVAL_SYSTEMCONTROL 1
+#endif
+
+#ifndef HID_INTERVAL_GAMEPAD
+#define HID_INTERVAL_GAMEPAD 1
+#endif
+
+#ifndef HID_INTERVAL_MOUSE_ABSOLUTE
+#define HID_INTERVAL_MOUSE_ABSOLUTE 1
+#endif
+
+#ifndef HID_INTERVAL_NKRO_KEYBOARD
+#define HID_INTERVAL_NKRO_KEYBOARD 1
+#endif
+
+#ifndef HID_INTERVAL_TOUCHSCREEN
+#define HID_INTERVAL_TOUCHSCREEN 1
+#endif
+
+#ifndef HID_INTERVAL_HUB
+#define HID_INTERVAL_HUB 1
+#endif
+
+// Use two banks for the SingleReport IN endpoints, so the next report can be
+// written while the previous one still waits for the host.
+// SAM: the banks are configured here. It costs twice the endpoint memory,
+// check that all endpoints still fit into the 4kb DPRAM.
+// AVR: the core always uses two banks for 64 byte endpoints.
+// SAMD: the core only uses a single bank.
+#ifndef HID_ENDPOINT_DOUBLE_BANK
+#define HID_ENDPOINT_DOUBLE_BANK 0
+#endif
+
+//================================================================================
+// Features
+//================================================================================
+
+// The switches below change the size of classes and reports or which code
+// is compiled. The Arduino IDE builds the library sources without the defines
+// of the sketch, so a #define in the sketch only reaches the sketch and the
+// header-only parts of the library. The classes then have a different layout
+// in the sketch than in the library, which compiles and links without any
+// warning and fails at runtime. Change them here or pass them to every file
+// with the build flags of the board (build.extra_flags, build_flags).
+// The settings of HID-Bridge.h stay in that file, it is also compiled on
+// MCUs without USB which cannot include this file.
+
+// Bind the MultiReport Mouse, AbsoluteMouse, Gamepad, Consumer, System and
+// SurfaceDial, Touchscreen to their API at compile time (Static*API) instead of deriving
+// from the virtual API classes. This saves their vtables in RAM and the
+// indirect call per report, but they cannot be used as MouseAPI& etc. anymore.
+#ifndef HID_STATIC_API
+#define HID_STATIC_API 0
+#endif
+
+// Number of reports each SingleReport device queues while its endpoint is busy.
+// With 0 reports are sent synchronously, blocking until the endpoint is free.
+// Only AVR can check for a free endpoint bank, other cores keep blocking.
+#ifndef HID_SEND_QUEUE
+#define HID_SEND_QUEUE 0
+#endif
+
+// Bytes to hold reports while the host suspended the bus. Every device keeps
+// its first and its latest report, they are sent in order on resume, so a key
+// that was tapped while the host slept is not lost. Reports of the RawHID
+// endpoint are not held. With 0 reports are sent as before.
+#ifndef HID_SUSPEND_QUEUE
+#define HID_SUSPEND_QUEUE 0
+#endif
+
+// Bytes to collect multi report (HID()) reports between HIDReportBatch::begin()
+// and end(). The reports are then sent back-to-back, keyboards first, so a
+// combined update of several devices reaches the host as fast as possible.
+// 0 sends every report right away.
+#ifndef HID_REPORT_BATCH
+#define HID_REPORT_BATCH 0
+#endif
+
+// Count sent reports, failures and blocking time of every HID interface.
+// The counters can be read from the sketch or as RawHID feature report,
+// a RawHID snapshot (setSnapshot()) is then only answered as Input report.
+#ifndef HID_STATS
+#define HID_STATS 0
+#endif
+
+// Number of interfaces in the RawHID feature report
+#ifndef HID_STATS_MAX_ENTRIES
+#define HID_STATS_MAX_ENTRIES 4
+#endif
+
+// 16 bit movement, horizontal pan and a high resolution wheel.
+// The wheel and pan are then counted in 1/HID_MOUSE_WHEEL_MULTIPLIER detents.
+// The BootMouse lets the host enable the resolution multiplier, other mice
+// and hosts which do not enable it get whole detents.
+#ifndef HID_MOUSE_HIGH_RESOLUTION
+#define HID_MOUSE_HIGH_RESOLUTION 0
+#endif
+
+// Number of contacts which can touch at the same time.
+#ifndef HID_TOUCH_CONTACTS
+#define HID_TOUCH_CONTACTS 10
+#endif
+
+// Contacts per report. More contacts are sent in several reports of the same
+// scan (hybrid mode), only the first one carries the contact count.
+#ifndef HID_TOUCH_CONTACTS_PER_REPORT
+#define HID_TOUCH_CONTACTS_PER_REPORT 5
+#endif
+
+// Keep a 256 bit shadow bitmap of the pressed keys for a single bit lookup.
+// This costs 32 bytes of RAM per keyboard.
+#ifndef KEYBOARD_PRESENCE_BITMAP
+#define KEYBOARD_PRESENCE_BITMAP 0
+#endif
+
+// Characters of a flash string that are looked up before they are typed
+// with write(buffer, size), costs this many bytes of stack
+#ifndef KEYBOARD_FLASH_BLOCK
+#define KEYBOARD_FLASH_BLOCK 32
+#endif
+
+// Shortest time between two reports in ms, the polling interval of the host.
+#ifndef HID_TRAJECTORY_INTERVAL
+#define HID_TRAJECTORY_INTERVAL 1
+#endif
+
+// Length of a delay tick of the sequence steps in us (1/8 ms by default).
+// A step can wait up to 65535 ticks.
+#ifndef HID_SEQUENCE_TICK
+#define HID_SEQUENCE_TICK 125
+#endif
+
+// Wake the HID task with a FreeRTOS task notification when a report intent is
+// posted, instead of polling HIDTask::process() (SAMD only).
+#ifndef HID_RTOS
+#define HID_RTOS 0
+#endif
+
+// Payload bytes per intent, RawHID writes are split into this many bytes
+#ifndef HID_INTENT_DATA
+#define HID_INTENT_DATA 14
+#endif
+
+// Longest RawHID write the HID task collects before it sends it
+#ifndef HID_TASK_RAW_SIZE
+#define HID_TASK_RAW_SIZE 64
+#endif
+
+// Receive OUT reports via a dedicated interrupt endpoint instead of
+// SET_REPORT control transfers on EP0. This costs one extra endpoint.
+#ifndef RAWHID_USE_OUT_ENDPOINT
+#define RAWHID_USE_OUT_ENDPOINT 0
+#endif
+
+// Number of OUT reports that can be buffered until the sketch reads them.
+// The buffer passed to begin() is split into this many equal slots.
+// Must be a power of two.
+#ifndef RAWHID_RX_SLOTS
+#define RAWHID_RX_SLOTS 1
+#endif
+
+// High speed profile for the Due: 512 byte reports on double banked endpoints.
+// At high speed HID_INTERVAL_RAWHID counts 125us microframes (2^(n-1)).
+// The core has to attach the device in high speed mode.
+#ifndef RAWHID_HIGH_SPEED
+#define RAWHID_HIGH_SPEED 0
+#endif
+
+// Send and receive with the USB controller straight from and into the sketch
+// buffers, without copying them through the endpoint buffers of the core.
+// SAMD: writeStream() is sent by the controller as one multi-packet transfer.
+// OUT reports are still copied by the core, it owns the OUT endpoint banks.
+// SAM: writeStream() and write() use the DMA channel of the IN endpoint.
+// With RAWHID_USE_OUT_ENDPOINT the OUT reports are also moved into the slots
+// of begin() by DMA. All buffers have to be in RAM.
+#ifndef RAWHID_STREAMING
+#define RAWHID_STREAMING 0
+#endif
+
+// Append a trailer to every IN report for latency measurements on the host:
+// micros() when the report is handed to the USB core (4 bytes), the time in
+// us it waited since write() (2 bytes, saturated) and a sequence number
+// (2 bytes), all little endian. The sketch payload shrinks by the trailer,
+// short writes are padded with zeros. The host reads the device clock with
+// a GET_REPORT Feature request for report RAWHID_CLOCK_ID, see
+// extras/rawhid/rawhid_clock.h. RawHIDMessage and RawHIDChannels frame
+// whole reports and can not be used together with the trailer.
+#ifndef RAWHID_TIMESTAMP
+#define RAWHID_TIMESTAMP 0
+#endif
+
+// Collect the bytes of write(uint8_t), and so of print(), into whole reports
+// instead of sending a report per byte. A report is sent once it is full, at
+// a newline, on RawHID.flush() or RAWHID_TX_TIMEOUT ms after its first byte.
+// The timeout is only checked by poll(), available() and the next write(),
+// call RawHID.poll() from loop() so the end of a print() without newline is
+// sent. The bytes are collected in the buffer of acquirePacket(), which sends
+// them first; write(uint8_t) returns 0 until the packet is committed.
+#ifndef RAWHID_TX_BUFFER
+#define RAWHID_TX_BUFFER 0
+#endif
+
+#ifndef RAWHID_TX_TIMEOUT
+#define RAWHID_TX_TIMEOUT 2
+#endif
+
+// Size of the feature report the host reads with GET_REPORT, see setSnapshot().
+// With HID_STATS the statistics are sent while no snapshot is set.
+// 0 does not declare a feature report.
+#ifndef RAWHID_FEATURE_SIZE
+#if HID_STATS
+#define RAWHID_FEATURE_SIZE HID_STATS_REPORT_SIZE
+#else
+#define RAWHID_FEATURE_SIZE 0
+#endif
+#endif
+
+// Time in ms until unacknowledged RawHIDMessage reports are sent again.
+#ifndef RAWHID_MSG_TIMEOUT
+#define RAWHID_MSG_TIMEOUT 50
+#endif
+
+// Number of RawHIDChannels, up to 16.
+#ifndef RAWHID_CHANNELS
+#define RAWHID_CHANNELS 4
+#endif
+
+// Messages each channel can queue for sending.
+#ifndef RAWHID_CH_QUEUE
+#define RAWHID_CH_QUEUE 2
+#endif
+
+// Longest report of a HIDFeatureTransfer, it is received on the stack of the USB
+// interrupt. Larger reports need fewer control transfers, Windows only
+// sends reports of the size declared in the report descriptor.
+#ifndef HID_TRANSFER_SIZE
+#define HID_TRANSFER_SIZE 64
+#endif
+
+#if defined(HID_TINYUSB)
+
+#define ATTRIBUTE_PACKED  __attribute__((packed, aligned(1)))
+
+// The endpoint types, USB_Send() and the descriptors are defined by the port
+
+#elif defined(ARDUINO_ARCH_AVR)
 
 // Use default alignment for AVR
 #define ATTRIBUTE_PACKED
@@ -89,10 +374,15 @@ THE SOFTWARE.
 #include "USB/PluggableUSB.h"
 
 #define EPTYPE_DESCRIPTOR_SIZE      uint32_t
+#if HID_ENDPOINT_DOUBLE_BANK
+#define HID_EP_BANKS                UOTGHS_DEVEPTCFG_EPBK_2_BANK
+#else
+#define HID_EP_BANKS                UOTGHS_DEVEPTCFG_EPBK_1_BANK
+#endif
 #define EP_TYPE_INTERRUPT_IN        (UOTGHS_DEVEPTCFG_EPSIZE_512_BYTE | \
                                     UOTGHS_DEVEPTCFG_EPDIR_IN |         \
                                     UOTGHS_DEVEPTCFG_EPTYPE_BLK |       \
-                                    UOTGHS_DEVEPTCFG_EPBK_1_BANK |      \
+                                    HID_EP_BANKS |                      \
                                     UOTGHS_DEVEPTCFG_NBTRANS_1_TRANS |  \
                                     UOTGHS_DEVEPTCFG_ALLOC)
 #define EP_TYPE_INTERRUPT_OUT       (UOTGHS_DEVEPTCFG_EPSIZE_512_BYTE | \
@@ -130,7 +420,7 @@ THE SOFTWARE.
 #define USB_Flush                   USBDevice.flush
 
 int USB_SendControl(void* y, uint8_t z);
-int USB_SendControl(uint8_t x, const void* y, uint8_t z);
+int USB_SendControl(uint8_t x, const void* y, int z);
 #endif
 
 #define TRANSFER_PGM                0
@@ -140,8 +430,15 @@ int USB_SendControl(uint8_t x, const void* y, uint8_t z);
 #define HID_REPORT_TYPE_OUTPUT      2
 #define HID_REPORT_TYPE_FEATURE     3
 
+#elif defined(HID_HOST)
+
+// Host build of the APIs without USB, see extras/hostbench
+#define ATTRIBUTE_PACKED  __attribute__((packed, aligned(1)))
+
+#define EPTYPE_DESCRIPTOR_SIZE      uint8_t
+
 #else
 
-#error "Unsupported architecture"
+#error "Unsupported architecture, select the Adafruit TinyUSB stack on TinyUSB cores."
 
 #endif
@@ -0,0 +1,96 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// State shared between the USB interrupt and the sketch, without disabling
+// interrupts. The sketch never interrupts the USB interrupt, so:
+// - State the interrupt writes is read by the sketch through a HIDSeqLock,
+//   the copy is repeated if the interrupt wrote in between.
+// - State the sketch writes is double buffered, the interrupt reads the
+//   front buffer and the sketch swaps it with a single byte write.
+
+// Keeps the compiler from moving memory accesses across it. The USB interrupt
+// of the native cores runs on the same core as the sketch, so no hardware
+// barrier is needed there. With TinyUSB the USB callbacks may run on another
+// core (the USB task of the ESP32-S3, core 0 of the RP2040 while the sketch
+// sends from core 1), the barrier then also orders the memory accesses.
+#if defined(HID_TINYUSB)
+#define HID_BARRIER() __sync_synchronize()
+#else
+#define HID_BARRIER() __asm__ __volatile__("" ::: "memory")
+#endif
+
+class HIDSeqLock
+{
+public:
+	HIDSeqLock(void) : count(0) {}
+
+	// The count is odd while the writer writes
+	void writeBegin(void){
+		count++;
+		HID_BARRIER();
+	}
+
+	void writeEnd(void){
+		HID_BARRIER();
+		count++;
+	}
+
+	// The reader must not interrupt the writer, so it never has to wait
+	// for an odd count
+	uint8_t readBegin(void){
+		uint8_t start = count;
+		HID_BARRIER();
+		return start;
+	}
+
+	// Returns true if the state changed while it was read
+	bool readRetry(uint8_t start){
+		HID_BARRIER();
+		return (start & 1) || count != start;
+	}
+
+	// Changes with every write, wraps around at 256
+	uint8_t sequence(void){
+		return count;
+	}
+
+	// Copies the state, repeated until no write happened in between.
+	// Returns the sequence of the copy.
+	uint8_t read(void* copy, const void* state, size_t length){
+		uint8_t start;
+		do {
+			start = readBegin();
+			memcpy(copy, state, length);
+		} while (readRetry(start));
+		return start;
+	}
+
+protected:
+	volatile uint8_t count;
+};
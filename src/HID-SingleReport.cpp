@@ -0,0 +1,173 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-SingleReport.h"
+
+HIDSingleReport::HIDSingleReport(const uint8_t* descriptor, uint16_t descriptorSize, uint8_t interval,
+	uint8_t subclass, uint8_t bootProtocol) :
+	PluggableUSBModule(1, 1, epType), reportDescriptor(descriptor), reportDescriptorSize(descriptorSize),
+	interval(interval), subclass(subclass), bootProtocol(bootProtocol), protocol(HID_REPORT_PROTOCOL),
+	idleReport(NULL)
+#if HID_SEND_QUEUE
+	, reportQueue(NULL)
+#endif
+{
+	epType[0] = EP_TYPE_INTERRUPT_IN;
+	PluggableUSB().plug(this);
+#if HID_STATS
+	stats.interface = pluggedInterface;
+#endif
+}
+
+void HIDSingleReport::attach(HIDIdleReport* report, HIDReportQueue* queue)
+{
+	idleReport = report;
+	report->endpoint = pluggedEndpoint;
+#if HID_SEND_QUEUE
+	reportQueue = queue;
+	report->queue = queue;
+#else
+	(void)queue;
+#endif
+}
+
+int HIDSingleReport::getInterface(uint8_t* interfaceCount)
+{
+	*interfaceCount += 1; // uses 1
+	HIDDescriptor hidInterface = {
+		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, subclass, bootProtocol),
+		D_HIDREPORT(reportDescriptorSize),
+		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, interval)
+	};
+	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
+}
+
+int HIDSingleReport::getDescriptor(USBSetup& setup)
+{
+	// In a HID Class Descriptor wIndex cointains the interface number
+	if (setup.wIndex != pluggedInterface) { return 0; }
+
+	// Check if this is a HID Class Descriptor request
+	if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE) { return 0; }
+
+	if (setup.wValueH == HID_HID_DESCRIPTOR_TYPE) {
+		// Apple UEFI and USBCV wants it
+		HIDDescDescriptor desc = D_HIDREPORT(reportDescriptorSize);
+		return USB_SendControl(0, &desc, sizeof(desc));
+	} else if (setup.wValueH == HID_REPORT_DESCRIPTOR_TYPE) {
+		// Reset the protocol on reenumeration. Normally the host should not assume the state of the protocol
+		// due to the USB specs, but Windows and Linux just assumes its in report mode.
+		setProtocol(HID_REPORT_PROTOCOL);
+		return USB_SendControl(TRANSFER_PGM, reportDescriptor, reportDescriptorSize);
+	}
+
+	return 0;
+}
+
+bool HIDSingleReport::setup(USBSetup& setup)
+{
+	if (pluggedInterface != setup.wIndex) {
+		return false;
+	}
+
+	uint8_t request = setup.bRequest;
+	uint8_t requestType = setup.bmRequestType;
+
+	if (requestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE)
+	{
+		if (request == HID_GET_REPORT) {
+			// Last sent input report
+			if (setup.wValueH == HID_REPORT_TYPE_INPUT) {
+				return idleReport->sendReport(setup.wLength);
+			}
+			return onGetReport(setup);
+		}
+		if (request == HID_GET_PROTOCOL) {
+			USB_SendControl(0, &protocol, 1);
+			return true;
+		}
+		if (request == HID_GET_IDLE) {
+			USB_SendControl(0, &idleReport->idle, 1);
+			return true;
+		}
+	}
+
+	if (requestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE)
+	{
+		if (request == HID_SET_PROTOCOL) {
+			setProtocol(setup.wValueL);
+			return true;
+		}
+		if (request == HID_SET_IDLE) {
+			idleReport->idle = setup.wValueH;
+			return true;
+		}
+		if (request == HID_SET_REPORT) {
+			return onSetReport(setup);
+		}
+	}
+
+	return false;
+}
+
+void HIDSingleReport::setProtocol(uint8_t p){
+	protocol = p;
+}
+
+bool HIDSingleReport::onGetReport(USBSetup& setup){
+	(void)setup;
+	return false;
+}
+
+bool HIDSingleReport::onSetReport(USBSetup& setup){
+	(void)setup;
+	return false;
+}
+
+int HIDSingleReport::sendReport(const void* data, int length){
+	// The host already has this state
+	if(idleReport->skip(data, length)){
+		return length;
+	}
+	HID_STATS_START();
+#if HID_SEND_QUEUE
+	return idleReport->sent(data, length, HID_STATS_RECORD(stats, length, reportQueue->send(pluggedEndpoint, data, length)));
+#else
+	return idleReport->sent(data, length, HID_STATS_RECORD(stats, length, HIDSuspend::sendSingle(pluggedEndpoint, data, length)));
+#endif
+}
+
+bool HIDSingleReport::readyToSend(int length){
+#if defined(ARDUINO_ARCH_AVR) || defined(HID_TINYUSB)
+#if HID_SEND_QUEUE
+	if(reportQueue->pending()){
+		return false;
+	}
+#endif
+	return HIDReportQueue::sendSpace(pluggedEndpoint, length);
+#else
+	// The endpoint cannot be checked, flush() has to be called instead
+	(void)length;
+	return false;
+#endif
+}
@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "HID-Queue.h"
+#include "HID-Idle.h"
+#include "HID-Stats.h"
+
+// Interface of a SingleReport device with one interrupt IN endpoint. It
+// answers the descriptor and class requests of all SingleReport devices, so
+// this code exists only once in flash. Devices add their own requests with
+// the hooks below.
+class HIDSingleReport : public PluggableUSBModule
+{
+public:
+	uint8_t getProtocol(void){
+		return protocol;
+	}
+
+protected:
+	// The descriptor has to be in PROGMEM
+	HIDSingleReport(const uint8_t* descriptor, uint16_t descriptorSize, uint8_t interval,
+		uint8_t subclass = HID_SUBCLASS_NONE, uint8_t bootProtocol = HID_PROTOCOL_NONE);
+
+	// Connects the buffers of the device, called from its constructor
+	void attach(HIDIdleReport* report, HIDReportQueue* queue);
+
+	// Implementation of the PUSBListNode
+	virtual int getInterface(uint8_t* interfaceCount) override;
+	virtual int getDescriptor(USBSetup& setup) override;
+	virtual bool setup(USBSetup& setup) override;
+
+	// Called for SET_PROTOCOL and when the host reenumerates
+	virtual void setProtocol(uint8_t p);
+
+	// GET_REPORT of feature and output reports, the last input report is
+	// answered by the core. Return true if the request was handled.
+	virtual bool onGetReport(USBSetup& setup);
+
+	// SET_REPORT of all report types. Return true if the request was handled.
+	virtual bool onSetReport(USBSetup& setup);
+
+	// Skips reports the host already has (HIDIdleReport::setEnabled()), queues or sends it and
+	// records it for GET_REPORT. Returns the report length or 0 if dropped.
+	int sendReport(const void* data, int length);
+
+	// Returns true if a report of the length can be sent without waiting
+	bool readyToSend(int length);
+
+	EPTYPE_DESCRIPTOR_SIZE epType[1];
+
+	const uint8_t* reportDescriptor;
+	uint16_t reportDescriptorSize;
+	uint8_t interval;
+	uint8_t subclass;
+	uint8_t bootProtocol;
+
+	uint8_t protocol;
+
+	HIDIdleReport* idleReport;
+#if HID_SEND_QUEUE
+	HIDReportQueue* reportQueue;
+#endif
+
+#if HID_STATS
+public:
+	// Send counters of this interface
+	HIDStats stats;
+#endif
+};
+
+// Report buffers of a SingleReport device, sized for its report type
+template<typename Report>
+class HIDSingleReportDevice : public HIDSingleReport
+{
+protected:
+	HIDSingleReportDevice(const uint8_t* descriptor, uint16_t descriptorSize, uint8_t interval,
+		uint8_t idle = 0, bool relative = false,
+		uint8_t subclass = HID_SUBCLASS_NONE, uint8_t bootProtocol = HID_PROTOCOL_NONE) :
+		HIDSingleReport(descriptor, descriptorSize, interval, subclass, bootProtocol),
+		lastReport(idle, relative)
+	{
+#if HID_SEND_QUEUE
+		attach(&lastReport, &sendQueue);
+#else
+		attach(&lastReport, NULL);
+#endif
+	}
+
+#if HID_SEND_QUEUE
+	HIDReportQueueBuffer<sizeof(Report)> sendQueue;
+#endif
+
+	// Last report for GET_REPORT and the idle rate
+	HIDIdleReportBuffer<sizeof(Report)> lastReport;
+};
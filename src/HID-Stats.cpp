@@ -0,0 +1,97 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Stats.h"
+
+HIDStats* HIDStats::rootStats = NULL;
+
+#if HID_STATS
+HIDStats HIDStats::multiReport;
+#endif
+
+HIDStats::HIDStats(uint8_t interface) : interface(interface), next(NULL)
+{
+	reset();
+
+	// Append to the list of interfaces
+	if (!rootStats) {
+		rootStats = this;
+	}
+	else {
+		HIDStats* current = rootStats;
+		while (current->next) {
+			current = current->next;
+		}
+		current->next = this;
+	}
+}
+
+int HIDStats::record(uint32_t start, int length, int result)
+{
+	uint32_t blocked = now() - start;
+	cycles += blocked;
+	if (blocked > maxCycles) {
+		maxCycles = blocked;
+	}
+
+	reports++;
+	if (result > 0) {
+		bytes += result;
+	}
+	if (result < length) {
+		failures++;
+	}
+	return result;
+}
+
+void HIDStats::reset(void)
+{
+	reports = 0;
+	bytes = 0;
+	failures = 0;
+	dropped = 0;
+	cycles = 0;
+	maxCycles = 0;
+}
+
+int HIDStats::getReport(uint8_t* buffer)
+{
+	memset(buffer, 0, HID_STATS_REPORT_SIZE);
+
+	uint8_t* entry = buffer + 1;
+	for (HIDStats* current = rootStats; current && buffer[0] < HID_STATS_MAX_ENTRIES; current = current->next) {
+		uint32_t counters[6] = {
+			current->reports,
+			current->bytes,
+			current->failures,
+			current->dropped,
+			current->averageCycles(),
+			current->maxCycles
+		};
+		entry[0] = current->interface;
+		memcpy(entry + 1, counters, sizeof(counters));
+		entry += HID_STATS_ENTRY_SIZE;
+		buffer[0]++;
+	}
+	return HID_STATS_REPORT_SIZE;
+}
@@ -0,0 +1,95 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Interface number used for the multi report HID() interface
+#define HID_STATS_MULTIREPORT 0xFF
+
+// Feature report: entry count, then per entry the interface and 6 counters
+#define HID_STATS_ENTRY_SIZE 25
+#define HID_STATS_REPORT_SIZE (1 + HID_STATS_MAX_ENTRIES * HID_STATS_ENTRY_SIZE)
+
+#if HID_STATS_REPORT_SIZE > 0xFF
+#error HID_STATS_MAX_ENTRIES needs to be 10 or less.
+#endif
+
+#if HID_STATS
+// Take the start time, then pass the send result through HID_STATS_RECORD()
+#define HID_STATS_START() uint32_t statsStart = HIDStats::now()
+#define HID_STATS_RECORD(stats, length, result) (stats).record(statsStart, length, result)
+#else
+#define HID_STATS_START()
+#define HID_STATS_RECORD(stats, length, result) (result)
+#endif
+
+class HIDStats
+{
+public:
+	HIDStats(uint8_t interface = HID_STATS_MULTIREPORT);
+
+	// Count a send which started at start, returns the result
+	int record(uint32_t start, int length, int result);
+
+	void reset(void);
+
+	uint32_t averageCycles(void){
+		return reports ? cycles / reports : 0;
+	}
+
+	// Timestamp in CPU cycles, with the resolution of micros()
+	static uint32_t now(void){
+		return micros() * clockCyclesPerMicrosecond();
+	}
+
+	// Write the counters of the first HID_STATS_MAX_ENTRIES interfaces,
+	// returns the report length
+	static int getReport(uint8_t* buffer);
+
+	uint8_t interface;
+
+	// Reports sent (or queued) and their bytes
+	uint32_t reports;
+	uint32_t bytes;
+
+	// Failed or short sends, the report is lost
+	uint32_t failures;
+
+	// Received reports which were discarded
+	uint32_t dropped;
+
+	// Time spent in the send function
+	uint64_t cycles;
+	uint32_t maxCycles;
+
+	// Counters of the multi report HID() interface
+	static HIDStats multiReport;
+
+protected:
+	HIDStats* next;
+	static HIDStats* rootStats;
+};
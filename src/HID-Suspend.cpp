@@ -0,0 +1,176 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Suspend.h"
+#include "HID-Queue.h"
+
+#define HID_SUSPEND_HEADER 2
+
+#if HID_SUSPEND_QUEUE
+uint8_t HIDSuspend::buffer[HID_SUSPEND_QUEUE];
+uint8_t HIDSuspend::used = 0;
+uint8_t HIDSuspend::count = 0;
+bool HIDSuspend::woken = false;
+#endif
+#if !defined(ARDUINO_ARCH_AVR)
+bool HIDSuspend::asleep = false;
+#endif
+bool HIDSuspend::wakeup = false;
+
+bool HIDSuspend::suspended(void)
+{
+#if defined(HID_TINYUSB)
+	return USB_Configured() && USB_Suspended();
+#else
+	if (!USBDevice.configured()) {
+		return false;
+	}
+#if defined(ARDUINO_ARCH_AVR)
+	// The core only enables the wakeup interrupt while suspended
+	return UDIEN & (1 << WAKEUPE);
+#else
+	// The cores do not handle these flags, a resume wins if both are set
+#if defined(ARDUINO_ARCH_SAMD)
+	uint16_t flags = USB->DEVICE.INTFLAG.reg;
+	if (flags & (USB_DEVICE_INTFLAG_WAKEUP | USB_DEVICE_INTFLAG_EORSM)) {
+		USB->DEVICE.INTFLAG.reg = USB_DEVICE_INTFLAG_SUSPEND | USB_DEVICE_INTFLAG_WAKEUP |
+			USB_DEVICE_INTFLAG_EORSM | USB_DEVICE_INTFLAG_UPRSM;
+		asleep = false;
+	}
+	else if (flags & USB_DEVICE_INTFLAG_SUSPEND) {
+		USB->DEVICE.INTFLAG.reg = USB_DEVICE_INTFLAG_SUSPEND;
+		asleep = true;
+	}
+#elif defined(ARDUINO_ARCH_SAM)
+	uint32_t status = UOTGHS->UOTGHS_DEVISR;
+	if (status & (UOTGHS_DEVISR_WAKEUP | UOTGHS_DEVISR_EORSM)) {
+		UOTGHS->UOTGHS_DEVICR = UOTGHS_DEVICR_SUSPC | UOTGHS_DEVICR_WAKEUPC |
+			UOTGHS_DEVICR_EORSMC | UOTGHS_DEVICR_UPRSMC;
+		asleep = false;
+	}
+	else if (status & UOTGHS_DEVISR_SUSP) {
+		UOTGHS->UOTGHS_DEVICR = UOTGHS_DEVICR_SUSPC;
+		asleep = true;
+	}
+#endif
+	return asleep;
+#endif
+#endif
+}
+
+bool HIDSuspend::wakeupHost(void)
+{
+#if defined(ARDUINO_ARCH_AVR)
+	return USBDevice.wakeupHost();
+#elif defined(HID_TINYUSB)
+	return USB_WakeupHost();
+#elif defined(ARDUINO_ARCH_SAMD)
+	if (!suspended()) {
+		return false;
+	}
+	USB->DEVICE.CTRLB.reg |= USB_DEVICE_CTRLB_UPRSM;
+	return true;
+#elif defined(ARDUINO_ARCH_SAM)
+	if (!suspended()) {
+		return false;
+	}
+	UOTGHS->UOTGHS_DEVCTRL |= UOTGHS_DEVCTRL_RMWKUP;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void HIDSuspend::poll(void)
+{
+#if HID_SUSPEND_QUEUE
+	if (count && !suspended()) {
+		release();
+		HIDReportQueue::flushAll();
+	}
+#endif
+}
+
+#if HID_SUSPEND_QUEUE
+int HIDSuspend::hold(uint8_t key, const void* data, int length)
+{
+	if (!suspended()) {
+		// Resumed, the older reports go first
+		release();
+		return sendNow(key, data, length);
+	}
+
+	// Find the latest report of the device
+	uint8_t* latest = NULL;
+	uint8_t reports = 0;
+	for (uint8_t i = 0; i < used; i += HID_SUSPEND_HEADER + buffer[i + 1]) {
+		if (buffer[i] == key) {
+			latest = buffer + i;
+			reports++;
+		}
+	}
+
+	// Keep the first report, replace the latest one with the new state
+	if (reports >= 2 && latest[1] == length) {
+		memcpy(latest + HID_SUSPEND_HEADER, data, length);
+	}
+	else if (length <= HID_SUSPEND_QUEUE - HID_SUSPEND_HEADER - used) {
+		buffer[used] = key;
+		buffer[used + 1] = length;
+		memcpy(buffer + used + HID_SUSPEND_HEADER, data, length);
+		used += HID_SUSPEND_HEADER + length;
+		count++;
+	}
+	else if (latest && latest[1] == length) {
+		memcpy(latest + HID_SUSPEND_HEADER, data, length);
+	}
+	else {
+		return 0;
+	}
+
+	if (wakeup && !woken) {
+		woken = wakeupHost();
+	}
+
+	// Counted as sent, like a queued report
+	return (key & HID_SUSPEND_SINGLE) ? length : length + 1;
+}
+
+int HIDSuspend::sendNow(uint8_t key, const void* data, int length)
+{
+	if (key & HID_SUSPEND_SINGLE) {
+		return USB_Send((key & ~HID_SUSPEND_SINGLE) | TRANSFER_RELEASE, data, length);
+	}
+	return HID().SendReport(key, data, length);
+}
+
+void HIDSuspend::release(void)
+{
+	for (uint8_t i = 0; i < used; i += HID_SUSPEND_HEADER + buffer[i + 1]) {
+		sendNow(buffer[i], buffer + i + HID_SUSPEND_HEADER, buffer[i + 1]);
+	}
+	used = 0;
+	count = 0;
+	woken = false;
+}
+#endif
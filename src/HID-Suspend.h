@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+#if HID_SUSPEND_QUEUE > 0xFF
+#error HID_SUSPEND_QUEUE needs to be 255 or less.
+#endif
+
+// Key of SingleReport endpoints in the held reports, multi reports use their ID
+#define HID_SUSPEND_SINGLE 0x80
+
+class HIDSuspend
+{
+public:
+	// True while the host suspended the configured bus, on AVR, SAMD and SAM
+	static bool suspended(void);
+
+	// Signals remote wakeup, returns false if the bus is not suspended.
+	// The host only wakes up if it enabled remote wakeup for the device.
+	static bool wakeupHost(void);
+
+	// Wake the host up with the first report that is held
+	static void setWakeup(bool enable){
+		wakeup = enable;
+	}
+
+	// Sends the held reports and flushes the queues after a resume,
+	// call this regularly from loop()
+	static void poll(void);
+
+	static uint8_t pending(void){
+#if HID_SUSPEND_QUEUE
+		return count;
+#else
+		return 0;
+#endif
+	}
+
+	// Sends through HID() like HID().SendReport(), holds the report while suspended
+	static int sendMulti(uint8_t id, const void* data, int length){
+#if HID_SUSPEND_QUEUE
+		if (count || suspended()) {
+			return hold(id, data, length);
+		}
+#endif
+		return HID().SendReport(id, data, length);
+	}
+
+	// Sends to a SingleReport endpoint like USB_Send(), holds the report while suspended
+	static int sendSingle(uint8_t endpoint, const void* data, int length){
+#if HID_SUSPEND_QUEUE
+		if (count || suspended()) {
+			return hold(HID_SUSPEND_SINGLE | endpoint, data, length);
+		}
+#endif
+		return USB_Send(endpoint | TRANSFER_RELEASE, data, length);
+	}
+
+protected:
+#if HID_SUSPEND_QUEUE
+	static int hold(uint8_t key, const void* data, int length);
+	static int sendNow(uint8_t key, const void* data, int length);
+	static void release(void);
+
+	// Every entry is the key, the length and the report
+	static uint8_t buffer[HID_SUSPEND_QUEUE];
+	static uint8_t used;
+	static uint8_t count;
+	static bool woken;
+#endif
+#if !defined(ARDUINO_ARCH_AVR)
+	static bool asleep;
+#endif
+	static bool wakeup;
+};
@@ -0,0 +1,225 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "HID-APIs/KeyboardAPI.h"
+#include "HID-APIs/ConsumerAPI.h"
+#include "HID-APIs/SurfaceDialAPI.h"
+
+#if HID_RTOS
+#if !defined(ARDUINO_ARCH_SAMD)
+#error HID_RTOS is only supported on SAMD.
+#endif
+#if defined(__SAMD51__)
+#include <FreeRTOS_SAMD51.h>
+#else
+#include <FreeRTOS_SAMD21.h>
+#endif
+#endif
+
+// Operations of a report intent
+enum HIDIntentOp : uint8_t {
+	HID_INTENT_KEY_PRESS = 1,
+	HID_INTENT_KEY_RELEASE,
+	HID_INTENT_KEY_WRITE,
+	HID_INTENT_CHAR_WRITE,
+	HID_INTENT_KEY_RELEASE_ALL,
+	HID_INTENT_CONSUMER_PRESS,
+	HID_INTENT_CONSUMER_RELEASE,
+	HID_INTENT_CONSUMER_WRITE,
+	HID_INTENT_CONSUMER_RELEASE_ALL,
+	HID_INTENT_DIAL_PRESS,
+	HID_INTENT_DIAL_RELEASE,
+	HID_INTENT_DIAL_ROTATE,
+	HID_INTENT_RAW_DATA,
+	HID_INTENT_RAW_END,
+};
+
+struct HIDIntent
+{
+	uint8_t op;
+	uint8_t length;
+	union {
+		uint16_t value;
+		int16_t rotation;
+		uint8_t data[HID_INTENT_DATA];
+	};
+};
+
+// Report intents of one task. Only the owning task posts and only the HID task
+// reads, so the ring needs no lock: each side writes its own index and the
+// barrier publishes the slot before the head. Posting never blocks, a full
+// queue returns false.
+class HIDIntentQueue
+{
+public:
+	HIDIntentQueue(HIDIntent* buffer, uint8_t slots) :
+		buffer(buffer), slots(slots), head(0), tail(0), next(NULL)
+#if HID_RTOS
+		, consumer(NULL)
+#endif
+	{ }
+
+	// Keyboard keys and characters of the layout
+	bool press(KeyboardKeycode k){ return post(HID_INTENT_KEY_PRESS, k); }
+	bool release(KeyboardKeycode k){ return post(HID_INTENT_KEY_RELEASE, k); }
+	bool write(KeyboardKeycode k){ return post(HID_INTENT_KEY_WRITE, k); }
+	bool write(uint8_t c){ return post(HID_INTENT_CHAR_WRITE, c); }
+	bool releaseAll(void){ return post(HID_INTENT_KEY_RELEASE_ALL, 0); }
+
+	bool press(ConsumerKeycode k){ return post(HID_INTENT_CONSUMER_PRESS, k); }
+	bool release(ConsumerKeycode k){ return post(HID_INTENT_CONSUMER_RELEASE, k); }
+	bool write(ConsumerKeycode k){ return post(HID_INTENT_CONSUMER_WRITE, k); }
+	bool releaseAllConsumer(void){ return post(HID_INTENT_CONSUMER_RELEASE_ALL, 0); }
+
+	bool pressDial(void){ return post(HID_INTENT_DIAL_PRESS, 0); }
+	bool releaseDial(void){ return post(HID_INTENT_DIAL_RELEASE, 0); }
+	bool rotate(int16_t rotation){ return post(HID_INTENT_DIAL_ROTATE, (uint16_t)rotation); }
+
+	// One RawHID write of up to HID_TASK_RAW_SIZE bytes, posted as a whole or not at all
+	bool writeRaw(const void* data, size_t length);
+
+	// Free slots
+	uint8_t space(void){
+		return slots - (uint8_t)(head - tail);
+	}
+
+protected:
+	template<class ConsumerT, class DialT> friend class HIDTask;
+
+	bool post(uint8_t op, uint16_t value){
+		if(!space()){
+			return false;
+		}
+		HIDIntent& intent = buffer[head % slots];
+		intent.op = op;
+		intent.value = value;
+		publish(1);
+		return true;
+	}
+
+	void publish(uint8_t count){
+		// The slots have to be written before the HID task sees the head
+		__sync_synchronize();
+		head = head + count;
+#if HID_RTOS
+		if(consumer){
+			xTaskNotifyGive(consumer);
+		}
+#endif
+	}
+
+	HIDIntent* buffer;
+	uint8_t slots;
+	// Both count up and wrap around at 256, slots has to divide 256
+	volatile uint8_t head;
+	volatile uint8_t tail;
+	HIDIntentQueue* next;
+#if HID_RTOS
+	TaskHandle_t consumer;
+#endif
+};
+
+// Queue with its own storage, Slots has to be a power of two
+template<uint8_t Slots = 16>
+class HIDIntentQueueBuffer : public HIDIntentQueue
+{
+	static_assert(Slots && !(Slots & (Slots - 1)), "Slots has to be a power of two");
+public:
+	HIDIntentQueueBuffer(void) : HIDIntentQueue(storage, Slots) {}
+
+private:
+	HIDIntent storage[Slots];
+};
+
+// The only user of the HID devices, it applies the intents of all queues and
+// sends the merged reports. Presses of several tasks share a report, a release
+// of a pressed key is sent in a report of its own so no change gets lost. Only
+// this task blocks in USB_Send(). With HID_STATIC_API pass the device classes,
+// e.g. HIDTask<Consumer_, SurfaceDial_>.
+template<class ConsumerT = ConsumerAPI, class DialT = SurfaceDialAPI>
+class HIDTask
+{
+public:
+	inline HIDTask(void);
+
+	// The devices the intents go to, intents of devices that are not set are dropped
+	void setKeyboard(KeyboardAPI& keyboard){ this->keyboard = &keyboard; }
+	void setConsumer(ConsumerT& consumer){ this->consumer = &consumer; }
+	void setSurfaceDial(DialT& dial){ this->dial = &dial; }
+	// Any Print, normally RawHID, gets every writeRaw() in one write()
+	void setRawHID(Print& raw){ this->raw = &raw; }
+
+	// Add the queue of a task. Call it before the scheduler starts or from
+	// the HID task, the list itself is not protected.
+	inline void add(HIDIntentQueue& queue);
+
+	// Apply all posted intents and send the changed reports.
+	// Returns the number of intents applied.
+	inline int process(void);
+
+#if HID_RTOS
+	// Body of the HID task, processes the intents whenever a queue is posted to:
+	// xTaskCreate(HIDTask<>::task, "HID", 256, &hidTask, 2, NULL);
+	static void task(void* hidTask){
+		static_cast<HIDTask*>(hidTask)->run();
+	}
+	inline void run(void);
+#endif
+
+protected:
+	// Bits of the changes that were not sent yet
+	static const uint8_t PRESSED = 1;
+	static const uint8_t RELEASED = 2;
+
+	inline bool apply(HIDIntentQueue* queue, const HIDIntent& intent);
+	inline void change(uint8_t& pending, uint8_t type, bool keyboard);
+	inline void flush(void);
+
+	KeyboardAPI* keyboard;
+	ConsumerT* consumer;
+	DialT* dial;
+	Print* raw;
+	HIDIntentQueue* queues;
+
+	uint8_t keyboardPending;
+	uint8_t consumerPending;
+	int32_t rotation;
+
+	// RawHID write that is being collected, the queue keeps it until the end
+	HIDIntentQueue* rawOwner;
+	uint8_t rawLength;
+	uint8_t rawBuffer[HID_TASK_RAW_SIZE];
+
+#if HID_RTOS
+	TaskHandle_t handle;
+#endif
+};
+
+// Implementation is inline
+#include "HID-Task.hpp"
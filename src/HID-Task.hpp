@@ -0,0 +1,260 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+// Include guard
+#pragma once
+
+
+inline bool HIDIntentQueue::writeRaw(const void* data, size_t length)
+{
+	uint8_t count = (length + HID_INTENT_DATA - 1) / HID_INTENT_DATA;
+	if(!length || length > HID_TASK_RAW_SIZE || count > space()){
+		return false;
+	}
+
+	// Fill all slots first, the HID task sees them at once
+	const uint8_t* p = (const uint8_t*)data;
+	for(uint8_t i = 0; i < count; i++){
+		HIDIntent& intent = buffer[(uint8_t)(head + i) % slots];
+		uint8_t part = min(length, (size_t)HID_INTENT_DATA);
+		intent.op = (i == count - 1) ? HID_INTENT_RAW_END : HID_INTENT_RAW_DATA;
+		intent.length = part;
+		memcpy(intent.data, p, part);
+		p += part;
+		length -= part;
+	}
+	publish(count);
+	return true;
+}
+
+
+template<class ConsumerT, class DialT>
+HIDTask<ConsumerT, DialT>::HIDTask(void) :
+	keyboard(NULL), consumer(NULL), dial(NULL), raw(NULL), queues(NULL),
+	keyboardPending(0), consumerPending(0), rotation(0), rawOwner(NULL), rawLength(0)
+#if HID_RTOS
+	, handle(NULL)
+#endif
+{
+	// Empty
+}
+
+
+template<class ConsumerT, class DialT>
+void HIDTask<ConsumerT, DialT>::add(HIDIntentQueue& queue)
+{
+#if HID_RTOS
+	queue.consumer = handle;
+#endif
+	queue.next = queues;
+	queues = &queue;
+}
+
+
+template<class ConsumerT, class DialT>
+int HIDTask<ConsumerT, DialT>::process(void)
+{
+	int applied = 0;
+	for(HIDIntentQueue* queue = queues; queue; queue = queue->next){
+		uint8_t tail = queue->tail;
+		while(tail != queue->head){
+			// Read the slot only after the head was seen
+			__sync_synchronize();
+			if(!apply(queue, queue->buffer[tail % queue->slots])){
+				// Waits until the RawHID write of another queue is complete
+				break;
+			}
+			// The slot is free once the tail passed it
+			__sync_synchronize();
+			queue->tail = ++tail;
+			applied++;
+		}
+	}
+	flush();
+	return applied;
+}
+
+
+#if HID_RTOS
+template<class ConsumerT, class DialT>
+void HIDTask<ConsumerT, DialT>::run(void)
+{
+	// The queues added before the scheduler started wake this task
+	handle = xTaskGetCurrentTaskHandle();
+	for(HIDIntentQueue* queue = queues; queue; queue = queue->next){
+		queue->consumer = handle;
+	}
+
+	for(;;){
+		process();
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+}
+#endif
+
+
+template<class ConsumerT, class DialT>
+bool HIDTask<ConsumerT, DialT>::apply(HIDIntentQueue* queue, const HIDIntent& intent)
+{
+	switch(intent.op){
+	case HID_INTENT_KEY_PRESS:
+	case HID_INTENT_KEY_WRITE:
+	case HID_INTENT_CHAR_WRITE:
+		if(keyboard){
+			change(keyboardPending, PRESSED, true);
+			if(intent.op == HID_INTENT_CHAR_WRITE){
+				keyboard->add((uint8_t)intent.value);
+			}
+			else{
+				keyboard->add(KeyboardKeycode(intent.value));
+			}
+			if(intent.op == HID_INTENT_KEY_PRESS){
+				break;
+			}
+			// The release needs a report of its own
+			change(keyboardPending, RELEASED, true);
+			if(intent.op == HID_INTENT_CHAR_WRITE){
+				keyboard->remove((uint8_t)intent.value);
+			}
+			else{
+				keyboard->remove(KeyboardKeycode(intent.value));
+			}
+		}
+		break;
+	case HID_INTENT_KEY_RELEASE:
+	case HID_INTENT_KEY_RELEASE_ALL:
+		if(keyboard){
+			change(keyboardPending, RELEASED, true);
+			if(intent.op == HID_INTENT_KEY_RELEASE){
+				keyboard->remove(KeyboardKeycode(intent.value));
+			}
+			else{
+				keyboard->removeAll();
+			}
+		}
+		break;
+
+	case HID_INTENT_CONSUMER_PRESS:
+	case HID_INTENT_CONSUMER_WRITE:
+		if(consumer){
+			change(consumerPending, PRESSED, false);
+			consumer->add(ConsumerKeycode(intent.value));
+			if(intent.op == HID_INTENT_CONSUMER_WRITE){
+				change(consumerPending, RELEASED, false);
+				consumer->remove(ConsumerKeycode(intent.value));
+			}
+		}
+		break;
+	case HID_INTENT_CONSUMER_RELEASE:
+	case HID_INTENT_CONSUMER_RELEASE_ALL:
+		if(consumer){
+			change(consumerPending, RELEASED, false);
+			if(intent.op == HID_INTENT_CONSUMER_RELEASE){
+				consumer->remove(ConsumerKeycode(intent.value));
+			}
+			else{
+				consumer->removeAll();
+			}
+		}
+		break;
+
+	case HID_INTENT_DIAL_PRESS:
+	case HID_INTENT_DIAL_RELEASE:
+		if(dial){
+			// The rotation happened before the button changed
+			if(rotation){
+				dial->rotate(rotation);
+				rotation = 0;
+			}
+			if(intent.op == HID_INTENT_DIAL_PRESS){
+				dial->press();
+			}
+			else{
+				dial->release();
+			}
+		}
+		break;
+	case HID_INTENT_DIAL_ROTATE:
+		if(dial){
+			rotation = constrain(rotation + intent.rotation, (int32_t)-32768, (int32_t)32767);
+		}
+		break;
+
+	case HID_INTENT_RAW_DATA:
+	case HID_INTENT_RAW_END:
+		if(rawOwner && rawOwner != queue){
+			return false;
+		}
+		rawOwner = queue;
+		if(rawLength + intent.length <= HID_TASK_RAW_SIZE){
+			memcpy(rawBuffer + rawLength, intent.data, intent.length);
+			rawLength += intent.length;
+		}
+		if(intent.op == HID_INTENT_RAW_END){
+			if(raw){
+				raw->write(rawBuffer, rawLength);
+			}
+			rawOwner = NULL;
+			rawLength = 0;
+		}
+		break;
+	}
+	return true;
+}
+
+
+template<class ConsumerT, class DialT>
+void HIDTask<ConsumerT, DialT>::change(uint8_t& pending, uint8_t type, bool isKeyboard)
+{
+	// Presses and releases of one report are merged, a change in the other
+	// direction could undo them before the host saw them
+	if(pending & ~type){
+		if(isKeyboard){
+			keyboard->send();
+		}
+		else{
+			consumer->send();
+		}
+		pending = 0;
+	}
+	pending |= type;
+}
+
+
+template<class ConsumerT, class DialT>
+void HIDTask<ConsumerT, DialT>::flush(void)
+{
+	if(keyboardPending){
+		keyboard->send();
+		keyboardPending = 0;
+	}
+	if(consumerPending){
+		consumer->send();
+		consumerPending = 0;
+	}
+	if(rotation){
+		dial->rotate(rotation);
+		rotation = 0;
+	}
+}
@@ -0,0 +1,146 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Trajectory.h"
+#include "HID-APIs/AbsoluteMouseAPI.h"
+#include "HID-APIs/MouseAPI.h"
+
+// Progress in fixed point, 1 << 15 is the end of the move
+#define HID_TRAJECTORY_SHIFT 15
+#define HID_TRAJECTORY_END (1UL << HID_TRAJECTORY_SHIFT)
+
+// Largest relative movement of one report
+#if HID_MOUSE_HIGH_RESOLUTION
+#define HID_TRAJECTORY_STEP 32767
+#else
+#define HID_TRAJECTORY_STEP 127
+#endif
+
+HIDTrajectory::HIDTrajectory(void) :
+	absolute(NULL), mouse(NULL), state(HID_TRAJECTORY_IDLE), profile(HID_TRAJECTORY_LINEAR),
+	interval(HID_TRAJECTORY_INTERVAL), duration(0), startTime(0), lastSend(0),
+	startX(0), startY(0), distanceX(0), distanceY(0), sentX(0), sentY(0)
+{
+	// Empty
+}
+
+void HIDTrajectory::moveTo(int16_t x, int16_t y, uint16_t duration, uint8_t profile)
+{
+	if (!absolute) {
+		return;
+	}
+
+	// A running move continues from where it is
+	startX = absolute->getX();
+	startY = absolute->getY();
+	state = HID_TRAJECTORY_ABSOLUTE;
+	start((int32_t)x - startX, (int32_t)y - startY, duration, profile);
+}
+
+void HIDTrajectory::move(int16_t x, int16_t y, uint16_t duration, uint8_t profile)
+{
+	if (!mouse) {
+		return;
+	}
+
+	state = HID_TRAJECTORY_RELATIVE;
+	start(x, y, duration, profile);
+}
+
+void HIDTrajectory::start(int32_t x, int32_t y, uint16_t duration, uint8_t profile)
+{
+	distanceX = x;
+	distanceY = y;
+	sentX = 0;
+	sentY = 0;
+	this->duration = duration;
+	this->profile = profile;
+	startTime = millis();
+
+	// The first step goes out with the next poll()
+	lastSend = startTime - interval;
+}
+
+uint16_t HIDTrajectory::progress(uint32_t elapsed)
+{
+	if (elapsed >= duration) {
+		return HID_TRAJECTORY_END;
+	}
+
+	// Fits into 32 bit as elapsed is less than the 16 bit duration
+	uint32_t t = (elapsed << HID_TRAJECTORY_SHIFT) / duration;
+	if (profile == HID_TRAJECTORY_SMOOTH) {
+		// t * t * (3 - 2 * t), at most 3 << 30
+		uint32_t square = (t * t) >> HID_TRAJECTORY_SHIFT;
+		t = (square * (3 * HID_TRAJECTORY_END - 2 * t)) >> HID_TRAJECTORY_SHIFT;
+	}
+	return t;
+}
+
+bool HIDTrajectory::poll(void)
+{
+	if (state == HID_TRAJECTORY_IDLE) {
+		return false;
+	}
+
+	uint32_t now = millis();
+	if ((now - lastSend) < interval) {
+		return true;
+	}
+
+	// The distance is at most 65535, the product fits into 32 bit
+	uint16_t t = progress(now - startTime);
+	int32_t x = (distanceX * t + (int32_t)(HID_TRAJECTORY_END / 2)) >> HID_TRAJECTORY_SHIFT;
+	int32_t y = (distanceY * t + (int32_t)(HID_TRAJECTORY_END / 2)) >> HID_TRAJECTORY_SHIFT;
+
+	if (state == HID_TRAJECTORY_ABSOLUTE) {
+		if (x != sentX || y != sentY) {
+			absolute->moveTo(startX + x, startY + y);
+			sentX = x;
+			sentY = y;
+			lastSend = now;
+		}
+		if (t == HID_TRAJECTORY_END) {
+			state = HID_TRAJECTORY_IDLE;
+		}
+	}
+	else {
+		// Steps larger than one report are sent over the next intervals
+		int32_t stepX = constrain(x - sentX, -HID_TRAJECTORY_STEP, HID_TRAJECTORY_STEP);
+		int32_t stepY = constrain(y - sentY, -HID_TRAJECTORY_STEP, HID_TRAJECTORY_STEP);
+		if (stepX || stepY) {
+#if HID_MOUSE_HIGH_RESOLUTION
+			mouse->move((int16_t)stepX, (int16_t)stepY);
+#else
+			mouse->move((signed char)stepX, (signed char)stepY);
+#endif
+			sentX += stepX;
+			sentY += stepY;
+			lastSend = now;
+		}
+		if (t == HID_TRAJECTORY_END && sentX == distanceX && sentY == distanceY) {
+			state = HID_TRAJECTORY_IDLE;
+		}
+	}
+	return state != HID_TRAJECTORY_IDLE;
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Speed profiles of a move
+#define HID_TRAJECTORY_LINEAR 0
+// Accelerates and slows down again (smoothstep)
+#define HID_TRAJECTORY_SMOOTH 1
+
+class AbsoluteMouseAPI;
+class MouseAPI;
+
+// Moves the pointer smoothly without blocking, call poll() regularly from
+// loop() or a timer that may send reports. The position is interpolated in
+// fixed point from the time since the start, so a late poll() catches up
+// instead of slowing the move down. At most one report is sent per interval.
+class HIDTrajectory
+{
+public:
+	HIDTrajectory(void);
+
+	// Devices the moves are sent to
+	void begin(AbsoluteMouseAPI* absolute, MouseAPI* mouse = NULL){
+		this->absolute = absolute;
+		this->mouse = mouse;
+	}
+
+	// Time between two reports in ms, at least the polling interval of the host
+	void setInterval(uint8_t interval){
+		this->interval = interval;
+	}
+
+	// Absolute move from the current position to x, y in duration ms
+	void moveTo(int16_t x, int16_t y, uint16_t duration, uint8_t profile = HID_TRAJECTORY_SMOOTH);
+
+	// Relative move by x, y in duration ms
+	void move(int16_t x, int16_t y, uint16_t duration, uint8_t profile = HID_TRAJECTORY_SMOOTH);
+
+	// Stop at the last sent position
+	void stop(void){
+		state = HID_TRAJECTORY_IDLE;
+	}
+
+	bool moving(void){
+		return state != HID_TRAJECTORY_IDLE;
+	}
+
+	// Sends the next position if the interval passed, returns true while moving
+	bool poll(void);
+
+protected:
+	enum {
+		HID_TRAJECTORY_IDLE,
+		HID_TRAJECTORY_ABSOLUTE,
+		HID_TRAJECTORY_RELATIVE,
+	};
+
+	void start(int32_t x, int32_t y, uint16_t duration, uint8_t profile);
+	uint16_t progress(uint32_t elapsed);
+
+	AbsoluteMouseAPI* absolute;
+	MouseAPI* mouse;
+
+	uint8_t state;
+	uint8_t profile;
+	uint8_t interval;
+	uint16_t duration;
+	uint32_t startTime;
+	uint32_t lastSend;
+
+	// Start of an absolute move, distance and already sent part of the move
+	int16_t startX;
+	int16_t startY;
+	int32_t distanceX;
+	int32_t distanceY;
+	int32_t sentX;
+	int32_t sentY;
+};
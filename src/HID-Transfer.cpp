@@ -0,0 +1,164 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+
+#include "HID-Transfer.h"
+
+HIDFeatureTransfer::HIDFeatureTransfer(void) : pages(NULL), pageSize(0), readCallback(NULL),
+	rxOffset(0), fillLength(0), fillPage(0), readOffset(0), total(0), ended(false), readPage(0)
+{
+	ready[0] = ready[1] = false;
+}
+
+void HIDFeatureTransfer::begin(uint8_t* buffer, uint16_t size)
+{
+	// No pages while they change
+	pageSize = 0;
+	ready[0] = ready[1] = false;
+	fillLength = 0;
+	fillPage = 0;
+	readPage = 0;
+	rxOffset = 0;
+	ended = false;
+	pages = buffer;
+	pageSize = size;
+}
+
+void HIDFeatureTransfer::release(void)
+{
+	if (ready[readPage]) {
+		ready[readPage] = false;
+		readPage ^= 1;
+	}
+}
+
+bool HIDFeatureTransfer::write(const uint8_t* payload, uint8_t length)
+{
+	// The whole report has to fit, it spans two pages at most
+	uint16_t space = 0;
+	if (!ready[fillPage]) {
+		space = pageSize - fillLength;
+		if (!ready[fillPage ^ 1]) {
+			space += pageSize;
+		}
+	}
+	if (length > space) {
+		return false;
+	}
+
+	while (length) {
+		uint16_t n = min(uint16_t(length), uint16_t(pageSize - fillLength));
+		if (!fillLength) {
+			pageOffset[fillPage] = rxOffset;
+		}
+		memcpy(pages + fillPage * pageSize + fillLength, payload, n);
+		fillLength += n;
+		rxOffset += n;
+		payload += n;
+		length -= n;
+		if (fillLength == pageSize) {
+			pageLength[fillPage] = pageSize;
+			ready[fillPage] = true;
+			fillPage ^= 1;
+			fillLength = 0;
+		}
+	}
+	return true;
+}
+
+bool HIDFeatureTransfer::setReport(uint16_t length)
+{
+	if (!pageSize || length < HID_TRANSFER_HEADER || length > HID_TRANSFER_SIZE) {
+		return false;
+	}
+	uint8_t report[HID_TRANSFER_SIZE];
+	USB_RecvControl(report, length);
+
+	uint32_t offset = report[1] | (uint32_t(report[2]) << 8) | (uint32_t(report[3]) << 16);
+	uint8_t payload = min(report[4], uint8_t(length - HID_TRANSFER_HEADER));
+
+	switch (report[0]) {
+	case HID_TRANSFER_START:
+		// A new upload once the sketch wrote all pages of the last one
+		if (ready[0] || ready[1]) {
+			return false;
+		}
+		rxOffset = 0;
+		fillLength = 0;
+		ended = false;
+		total = 0;
+		if (payload >= 4) {
+			total = report[5] | (uint32_t(report[6]) << 8) | (uint32_t(report[7]) << 16) | (uint32_t(report[8]) << 24);
+		}
+		return true;
+
+	case HID_TRANSFER_WRITE:
+		// Sent again because the host lost the status
+		if (offset + payload <= rxOffset) {
+			return true;
+		}
+		if (offset != rxOffset || ended) {
+			return false;
+		}
+		return write(report + HID_TRANSFER_HEADER, payload);
+
+	case HID_TRANSFER_END:
+		if (!ended && fillLength) {
+			pageLength[fillPage] = fillLength;
+			ready[fillPage] = true;
+			fillPage ^= 1;
+			fillLength = 0;
+		}
+		ended = true;
+		return true;
+
+	case HID_TRANSFER_READ:
+		if (!readCallback) {
+			return false;
+		}
+		readOffset = offset;
+		return true;
+	}
+	return false;
+}
+
+bool HIDFeatureTransfer::getReport(uint16_t length)
+{
+	if (!readCallback || length <= HID_TRANSFER_HEADER) {
+		return false;
+	}
+	uint8_t report[HID_TRANSFER_SIZE];
+	length = min(length, uint16_t(HID_TRANSFER_SIZE));
+	memset(report, 0x00, length);
+
+	uint8_t n = readCallback(readOffset, report + HID_TRANSFER_HEADER, length - HID_TRANSFER_HEADER);
+	report[0] = HID_TRANSFER_READ;
+	report[1] = readOffset;
+	report[2] = readOffset >> 8;
+	report[3] = readOffset >> 16;
+	report[4] = n;
+	readOffset += n;
+	USB_SendControl(0, report, length);
+	return true;
+}
@@ -0,0 +1,126 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Uploads and downloads larger than one feature report, as a series of
+// SET_REPORT and GET_REPORT feature requests with offsets. Used by RawHID
+// and BootKeyboard, see setFeatureTransfer().
+//
+// Every report starts with a header:
+//	op, offset (3 bytes, low byte first), length, payload
+//	START	starts an upload, the payload is its size (4 bytes, optional)
+//	WRITE	length bytes at offset
+//	END	the upload is complete
+//	READ	sets the offset of the next GET_REPORT
+// GET_REPORT answers a READ header with the length and the data at the
+// offset and moves the offset on, a length of 0 is the end.
+//
+// Uploads are sequential, the data is collected into two pages which the
+// sketch writes to EEPROM or flash from loop(). While both pages are full
+// the requests are stalled and the host tries again. A WRITE that was
+// already received is acknowledged again, so the host can repeat a request
+// whose status it lost. A gap in the offsets is stalled.
+
+#define HID_TRANSFER_START 0x01
+#define HID_TRANSFER_WRITE 0x02
+#define HID_TRANSFER_END 0x03
+#define HID_TRANSFER_READ 0x04
+
+#define HID_TRANSFER_HEADER 5
+
+#if (HID_TRANSFER_SIZE <= HID_TRANSFER_HEADER) || (HID_TRANSFER_SIZE > 255 + HID_TRANSFER_HEADER)
+#error HID_TRANSFER_SIZE needs to be 6 - 260.
+#endif
+
+class HIDFeatureTransfer
+{
+public:
+	// Called from the USB interrupt for a download, returns the number of
+	// bytes at offset or 0 at the end. Reading EEPROM or flash is fast enough.
+	typedef uint8_t (*ReadCallback)(uint32_t offset, uint8_t* data, uint8_t length);
+
+	HIDFeatureTransfer(void);
+
+	// Two pages of size bytes for uploads, at least the payload of a report
+	// (HID_TRANSFER_SIZE - HID_TRANSFER_HEADER). Writing EEPROM or flash
+	// pages of the same size keeps the writes aligned.
+	void begin(uint8_t* buffer, uint16_t size);
+	void onRead(ReadCallback callback){
+		readCallback = callback;
+	}
+
+	// Length of the next received page, 0 if none is complete. The last
+	// page of an upload may be shorter.
+	uint16_t available(void){
+		return ready[readPage] ? pageLength[readPage] : 0;
+	}
+	uint32_t offset(void){
+		return pageOffset[readPage];
+	}
+	const uint8_t* data(void){
+		return pages + readPage * pageSize;
+	}
+	// The page was written, the host can send the next ones
+	void release(void);
+
+	// Size the host announced with START, 0 if it did not
+	uint32_t size(void){
+		return total;
+	}
+
+	// The upload ended and all pages were released
+	bool complete(void){
+		return ended && !ready[0] && !ready[1];
+	}
+
+	// Feature requests of the USB interrupt
+	bool setReport(uint16_t length);
+	bool getReport(uint16_t length);
+
+protected:
+	bool write(const uint8_t* payload, uint8_t length);
+
+	uint8_t* pages;
+	uint16_t pageSize;
+	ReadCallback readCallback;
+
+	// Owned by the USB interrupt
+	uint32_t rxOffset;
+	uint16_t fillLength;
+	uint8_t fillPage;
+	uint32_t readOffset;
+	volatile uint32_t total;
+	volatile bool ended;
+
+	// Set by the USB interrupt, cleared by release()
+	volatile bool ready[2];
+	uint32_t pageOffset[2];
+	uint16_t pageLength[2];
+	uint8_t readPage;
+};
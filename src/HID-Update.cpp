@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HID-Update.h"
+#include "HID-Batch.h"
+
+HIDReportUpdate* HIDReportUpdate::rootDevice = NULL;
+
+HIDReportUpdate::HIDReportUpdate(Function function) :
+	function(function), next(NULL)
+{
+	// Append to the list of devices
+	if (!rootDevice) {
+		rootDevice = this;
+	}
+	else {
+		HIDReportUpdate* current = rootDevice;
+		while (current->next) {
+			current = current->next;
+		}
+		current->next = this;
+	}
+}
+
+uint8_t HIDReportUpdate::updateAll(void)
+{
+	uint8_t sent = 0;
+	HIDReportBatch::begin();
+	for (HIDReportUpdate* current = rootDevice; current; current = current->next) {
+		if (current->function(current)) {
+			sent++;
+		}
+	}
+	HIDReportBatch::end();
+	return sent;
+}
@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+
+// Devices which only send their report when it changed, like the gamepads.
+// HIDReportUpdate::updateAll() sends all changed reports at once, so a sketch
+// with several devices needs only one call per loop().
+class HIDReportUpdate
+{
+public:
+	// Send the report of the device if it changed, returns true if it was sent
+	typedef bool (*Function)(HIDReportUpdate* device);
+
+	HIDReportUpdate(Function function);
+
+	// Function for devices with an update() function, like the gamepad APIs
+	template<class Device>
+	static bool updateDevice(HIDReportUpdate* device){
+		return static_cast<Device*>(device)->update();
+	}
+
+	// Send the changed reports of all devices, within one HIDReportBatch.
+	// Returns the number of sent reports.
+	static uint8_t updateAll(void);
+
+protected:
+	Function function;
+
+	HIDReportUpdate* next;
+	static HIDReportUpdate* rootDevice;
+};
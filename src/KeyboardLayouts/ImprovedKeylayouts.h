@@ -522,7 +522,7 @@ enum KeyboardKeycode : uint8_t {
 
 
 /*
-static const uint16_t _asciimap[] PROGMEM =
+static constexpr uint16_t _asciimapSource[] =
 {
     KEY_RESERVED,           // NUL
     KEY_RESERVED,           // SOH
@@ -709,3 +709,41 @@ static const uint16_t _asciimap[] PROGMEM =
 #else
     #error Keyboard layout not yet supported. Feel free to open a PR to add a new layout.
 #endif
+
+// The layout source above is only used at compile time. The packed tables of
+// all locales are generated once in KeyboardLayoutDatabase.cpp, the APIs read
+// the one of this layout through KeyboardLayoutDatabase<KEYBOARD_LOCALE>.
+#include "KeyboardLayoutDatabase.h"
+
+// Modifiers that fit into the modifier class of the layout database
+#define KEYBOARD_ASCII_MODIFIERS (MOD_LEFT_SHIFT | MOD_RIGHT_ALT)
+
+namespace {
+
+// Tables of the LAYOUT_* define, shared with the TeensyKeyboardAPI
+typedef KeyboardLayoutDatabase<KEYBOARD_LOCALE> KeyboardAsciiDatabase;
+
+// Characters of the layout, the table itself always has KEYBOARD_LAYOUT_SIZE entries
+constexpr uint16_t keyboardAsciiSize = sizeof(_asciimapSource) / sizeof(_asciimapSource[0]);
+
+// Keycode of a character, c has to be less than the size of the layout
+inline uint8_t keyboardAsciiKeycode(const uint8_t* keymap, uint8_t c){
+    return pgm_read_byte(keymap + c);
+}
+
+inline uint8_t keyboardAsciiKeycode(uint8_t c){
+    return keyboardAsciiKeycode(KeyboardAsciiDatabase::tables.keys, c);
+}
+
+// Modifiers of a character, bit n is KEY_LEFT_CTRL + n
+inline uint8_t keyboardAsciiModifiers(const uint8_t* modmap, uint8_t c){
+    uint8_t cls = keyboardLayoutClass(modmap, c);
+    return ((cls & KEYBOARD_LAYOUT_SHIFT) ? (MOD_LEFT_SHIFT >> 8) : 0) |
+        ((cls & KEYBOARD_LAYOUT_ALTGR) ? (MOD_RIGHT_ALT >> 8) : 0);
+}
+
+inline uint8_t keyboardAsciiModifiers(uint8_t c){
+    return keyboardAsciiModifiers(KeyboardAsciiDatabase::tables.modifiers, c);
+}
+
+}
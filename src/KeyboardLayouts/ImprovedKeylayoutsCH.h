@@ -21,8 +21,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
-// Include guard
-#pragma once
+// No include guard, see KeyboardLayoutDatabase.cpp
 
 #include "ImprovedKeylayouts.h"
 
@@ -57,7 +56,7 @@ THE SOFTWARE.
 #define KEY_CH_SECTION      KEY_TILDE
 
 
-static const uint16_t _asciimap[] PROGMEM =
+static constexpr uint16_t _asciimapSource[] =
 {
     KEY_RESERVED,           // NUL
     KEY_RESERVED,           // SOH
@@ -21,8 +21,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
-// Include guard
-#pragma once
+// No include guard, see ImprovedKeylayoutsRegistry.h
 
 #include "ImprovedKeylayouts.h"
 
@@ -39,7 +38,7 @@ THE SOFTWARE.
 #define KEY_IT_LT_GT        KEY_NON_US
 
 
-static const uint16_t _asciimap[] PROGMEM =
+static constexpr uint16_t _asciimapSource[] =
 {
     KEY_RESERVED,                               // NUL
     KEY_RESERVED,                               // SOH
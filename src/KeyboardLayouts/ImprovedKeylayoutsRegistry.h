@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include "ImprovedKeylayouts.h"
+
+// Layouts that can be selected at runtime with Keyboard.setLayout(), e.g.
+// Keyboard.setLayout(KeyboardLayoutGerman). The tables are generated in
+// KeyboardLayoutDatabase.cpp, only the layouts that are used by the sketch
+// take flash. The default layout of the LAYOUT_* define stays available as well.
+namespace {
+
+#define KEYBOARD_LAYOUT(locale) (&KeyboardLayoutDatabase<KEYBOARD_LOCALE_##locale>::layout)
+
+constexpr const KeyboardLayout* KeyboardLayoutDanish = KEYBOARD_LAYOUT(DANISH);
+constexpr const KeyboardLayout* KeyboardLayoutFinnish = KEYBOARD_LAYOUT(SWEDISH);
+constexpr const KeyboardLayout* KeyboardLayoutFrench = KEYBOARD_LAYOUT(FRENCH);
+constexpr const KeyboardLayout* KeyboardLayoutFrenchBelgian = KEYBOARD_LAYOUT(FRENCH_BELGIAN);
+constexpr const KeyboardLayout* KeyboardLayoutFrenchSwiss = KEYBOARD_LAYOUT(FRENCH_SWISS);
+constexpr const KeyboardLayout* KeyboardLayoutGerman = KEYBOARD_LAYOUT(GERMAN);
+constexpr const KeyboardLayout* KeyboardLayoutGermanSwiss = KEYBOARD_LAYOUT(GERMAN_SWISS);
+constexpr const KeyboardLayout* KeyboardLayoutIrish = KEYBOARD_LAYOUT(UNITED_KINGDOM);
+constexpr const KeyboardLayout* KeyboardLayoutItalian = KEYBOARD_LAYOUT(ITALIAN);
+constexpr const KeyboardLayout* KeyboardLayoutJapanese = KEYBOARD_LAYOUT(JAPANESE);
+constexpr const KeyboardLayout* KeyboardLayoutNorwegian = KEYBOARD_LAYOUT(NORWEGIAN);
+constexpr const KeyboardLayout* KeyboardLayoutPortuguese = KEYBOARD_LAYOUT(PORTUGUESE);
+constexpr const KeyboardLayout* KeyboardLayoutSpanish = KEYBOARD_LAYOUT(SPANISH);
+constexpr const KeyboardLayout* KeyboardLayoutSwedish = KEYBOARD_LAYOUT(SWEDISH);
+constexpr const KeyboardLayout* KeyboardLayoutUnitedKingdom = KEYBOARD_LAYOUT(UNITED_KINGDOM);
+constexpr const KeyboardLayout* KeyboardLayoutUsEnglish = KEYBOARD_LAYOUT(US_ENGLISH);
+
+#undef KEYBOARD_LAYOUT
+
+}
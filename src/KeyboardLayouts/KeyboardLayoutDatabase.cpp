@@ -0,0 +1,165 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <Arduino.h>
+#include "ImprovedKeylayouts.h"
+
+// Every layout is included into its own namespace, the tables of all
+// locales are generated from these sources below. The layout headers have no
+// include guard: ImprovedKeylayouts.h above already included the one of the
+// LAYOUT_* define, and every locale needs its own copy of the source here.
+namespace {
+
+namespace KeyboardLayoutSourceBE {
+    #include "ImprovedKeylayoutsBE.h"
+}
+namespace KeyboardLayoutSourceDE {
+    #include "ImprovedKeylayoutsDE.h"
+}
+namespace KeyboardLayoutSourceDK {
+    #include "ImprovedKeylayoutsDK.h"
+}
+namespace KeyboardLayoutSourceES {
+    #include "ImprovedKeylayoutsES.h"
+}
+namespace KeyboardLayoutSourceFR {
+    #include "ImprovedKeylayoutsFR.h"
+}
+namespace KeyboardLayoutSourceIT {
+    #include "ImprovedKeylayoutsIT.h"
+}
+namespace KeyboardLayoutSourceJP {
+    #include "ImprovedKeylayoutsJP.h"
+}
+namespace KeyboardLayoutSourceNO {
+    #include "ImprovedKeylayoutsNO.h"
+}
+namespace KeyboardLayoutSourcePT {
+    #include "ImprovedKeylayoutsPT.h"
+}
+namespace KeyboardLayoutSourceSE {
+    #include "ImprovedKeylayoutsSE.h"
+}
+namespace KeyboardLayoutSourceUK {
+    #include "ImprovedKeylayoutsUK.h"
+}
+namespace KeyboardLayoutSourceUS {
+    #include "ImprovedKeylayoutsUS.h"
+}
+
+// The Swiss layout differs in a few characters, include both variants
+#pragma push_macro("LAYOUT_FRENCH_SWISS")
+#pragma push_macro("LAYOUT_GERMAN_SWISS")
+#undef LAYOUT_FRENCH_SWISS
+#undef LAYOUT_GERMAN_SWISS
+
+#define LAYOUT_FRENCH_SWISS
+namespace KeyboardLayoutSourceCHFR {
+    #include "ImprovedKeylayoutsCH.h"
+}
+#undef LAYOUT_FRENCH_SWISS
+
+#define LAYOUT_GERMAN_SWISS
+namespace KeyboardLayoutSourceCHDE {
+    #include "ImprovedKeylayoutsCH.h"
+}
+#undef LAYOUT_GERMAN_SWISS
+
+#pragma pop_macro("LAYOUT_GERMAN_SWISS")
+#pragma pop_macro("LAYOUT_FRENCH_SWISS")
+
+template<uint16_t... I>
+struct KeyboardLayoutIndices {};
+
+template<uint16_t N, uint16_t... I>
+struct KeyboardLayoutMakeIndices : KeyboardLayoutMakeIndices<N - 1, N - 1, I...> {};
+
+template<uint16_t... I>
+struct KeyboardLayoutMakeIndices<0, I...>
+{
+    typedef KeyboardLayoutIndices<I...> type;
+};
+
+constexpr bool keyboardLayoutPackable(const uint16_t* source, uint16_t size, uint16_t i = 0){
+    return i >= size ||
+        (!(source[i] & 0xFF00 & ~KEYBOARD_ASCII_MODIFIERS) && keyboardLayoutPackable(source, size, i + 1));
+}
+
+// Sources of the ASCII characters only end after DEL, the rest of the table is empty
+constexpr uint8_t keyboardLayoutSourceKey(const uint16_t* source, uint16_t size, uint16_t i){
+    return i < size ? uint8_t(source[i] & 0xFF) : 0;
+}
+
+constexpr uint8_t keyboardLayoutSourceClass(const uint16_t* source, uint16_t size, uint16_t i){
+    return i >= size ? 0 :
+        ((source[i] & MOD_LEFT_SHIFT) ? KEYBOARD_LAYOUT_SHIFT : 0) |
+        ((source[i] & MOD_RIGHT_ALT) ? KEYBOARD_LAYOUT_ALTGR : 0);
+}
+
+template<uint16_t... I, uint16_t... J>
+constexpr KeyboardLayoutTables keyboardLayoutTables(const uint16_t* source, uint16_t size,
+    KeyboardLayoutIndices<I...>, KeyboardLayoutIndices<J...>){
+    return {
+        { keyboardLayoutSourceKey(source, size, I)... },
+        { uint8_t(keyboardLayoutSourceClass(source, size, 4 * J) | (keyboardLayoutSourceClass(source, size, 4 * J + 1) << 2) |
+            (keyboardLayoutSourceClass(source, size, 4 * J + 2) << 4) | (keyboardLayoutSourceClass(source, size, 4 * J + 3) << 6))... }
+    };
+}
+
+constexpr KeyboardLayoutTables keyboardLayoutTables(const uint16_t* source, uint16_t size){
+    return keyboardLayoutTables(source, size,
+        typename KeyboardLayoutMakeIndices<KEYBOARD_LAYOUT_SIZE>::type(),
+        typename KeyboardLayoutMakeIndices<KEYBOARD_LAYOUT_SIZE / 4>::type());
+}
+
+}
+
+#define KEYBOARD_LAYOUT_SOURCE_SIZE(source) \
+    (sizeof(KeyboardLayoutSource##source::_asciimapSource) / sizeof(KeyboardLayoutSource##source::_asciimapSource[0]))
+
+#define KEYBOARD_LAYOUT_DATABASE(locale, source) \
+    static_assert(KEYBOARD_LAYOUT_SOURCE_SIZE(source) == 128 || KEYBOARD_LAYOUT_SOURCE_SIZE(source) == KEYBOARD_LAYOUT_SIZE, \
+        "Layouts have to cover ASCII or all characters of ISO-8859-15"); \
+    static_assert(keyboardLayoutPackable(KeyboardLayoutSource##source::_asciimapSource, KEYBOARD_LAYOUT_SOURCE_SIZE(source)), \
+        "Layouts can only use MOD_LEFT_SHIFT and MOD_RIGHT_ALT as modifiers"); \
+    template<> const KeyboardLayoutTables KeyboardLayoutDatabase<locale>::tables PROGMEM = \
+        keyboardLayoutTables(KeyboardLayoutSource##source::_asciimapSource, KEYBOARD_LAYOUT_SOURCE_SIZE(source)); \
+    template<> const KeyboardLayout KeyboardLayoutDatabase<locale>::layout PROGMEM = { \
+        KeyboardLayoutDatabase<locale>::tables.keys, KeyboardLayoutDatabase<locale>::tables.modifiers, \
+        KEYBOARD_LAYOUT_SOURCE_SIZE(source) \
+    }
+
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_DANISH, DK);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_FRENCH, FR);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_FRENCH_BELGIAN, BE);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_FRENCH_SWISS, CHFR);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_GERMAN, DE);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_GERMAN_SWISS, CHDE);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_ITALIAN, IT);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_JAPANESE, JP);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_NORWEGIAN, NO);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_PORTUGUESE, PT);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_SPANISH, ES);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_SWEDISH, SE);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_UNITED_KINGDOM, UK);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_US_ENGLISH, US);
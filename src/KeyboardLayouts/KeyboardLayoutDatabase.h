@@ -0,0 +1,195 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+
+// Layout database of the keyboard APIs. Every locale has a single table in
+// flash, generated from the ImprovedKeylayouts*.h sources in
+// KeyboardLayoutDatabase.cpp. The Keyboard APIs and the TeensyKeyboardAPI read
+// the same table, so a sketch with both does not link the layout twice.
+// This header has no key definitions, it can be included next to either API.
+enum KeyboardLocale : uint8_t {
+    KEYBOARD_LOCALE_DANISH,
+    KEYBOARD_LOCALE_FRENCH,
+    KEYBOARD_LOCALE_FRENCH_BELGIAN,
+    KEYBOARD_LOCALE_FRENCH_SWISS,
+    KEYBOARD_LOCALE_GERMAN,
+    KEYBOARD_LOCALE_GERMAN_SWISS,
+    KEYBOARD_LOCALE_ITALIAN,
+    KEYBOARD_LOCALE_JAPANESE,
+    KEYBOARD_LOCALE_NORWEGIAN,
+    KEYBOARD_LOCALE_PORTUGUESE,
+    KEYBOARD_LOCALE_SPANISH,
+    KEYBOARD_LOCALE_SWEDISH,
+    KEYBOARD_LOCALE_UNITED_KINGDOM,
+    KEYBOARD_LOCALE_US_ENGLISH,
+};
+
+// Locale of the LAYOUT_* define, undefined for layouts without a table.
+// KEYBOARD_LOCALE_ALIAS marks layouts that borrow the table of another one.
+#if defined(LAYOUT_US_ENGLISH)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_US_ENGLISH
+#elif defined(LAYOUT_DANISH)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_DANISH
+#elif defined(LAYOUT_FINNISH)
+    // Finnish layout is the same as Swedish
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_SWEDISH
+    #define KEYBOARD_LOCALE_ALIAS
+#elif defined(LAYOUT_FRENCH)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_FRENCH
+#elif defined(LAYOUT_FRENCH_BELGIAN)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_FRENCH_BELGIAN
+#elif defined(LAYOUT_FRENCH_SWISS)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_FRENCH_SWISS
+#elif defined(LAYOUT_GERMAN)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_GERMAN
+#elif defined(LAYOUT_GERMAN_SWISS)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_GERMAN_SWISS
+#elif defined(LAYOUT_IRISH)
+    // Is this any different from the UK layout?
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_UNITED_KINGDOM
+    #define KEYBOARD_LOCALE_ALIAS
+#elif defined(LAYOUT_ITALIAN)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_ITALIAN
+#elif defined(LAYOUT_JAPANESE)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_JAPANESE
+#elif defined(LAYOUT_NORWEGIAN)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_NORWEGIAN
+#elif defined(LAYOUT_PORTUGUESE)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_PORTUGUESE
+#elif defined(LAYOUT_SPANISH)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_SPANISH
+#elif defined(LAYOUT_SWEDISH)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_SWEDISH
+#elif defined(LAYOUT_UNITED_KINGDOM)
+    #define KEYBOARD_LOCALE KEYBOARD_LOCALE_UNITED_KINGDOM
+#endif
+
+// Every table covers the characters 0-255 of ISO-8859-15. Layouts of the
+// ASCII characters only have a size of 128, the upper half stays empty.
+#define KEYBOARD_LAYOUT_SIZE 256
+
+// Modifier classes of a character
+#define KEYBOARD_LAYOUT_SHIFT 1
+#define KEYBOARD_LAYOUT_ALTGR 2
+
+// One keycode byte and a 2 bit modifier class per character
+struct KeyboardLayoutTables
+{
+    uint8_t keys[KEYBOARD_LAYOUT_SIZE];
+    // Four modifier classes per byte, the first character in the lowest bits
+    uint8_t modifiers[KEYBOARD_LAYOUT_SIZE / 4];
+};
+
+// Packed tables of a layout in flash, see ImprovedKeylayoutsRegistry.h
+struct KeyboardLayout
+{
+    const uint8_t* keys;
+    const uint8_t* modifiers;
+    uint16_t size;
+};
+
+template<KeyboardLocale Locale>
+struct KeyboardLayoutDatabase
+{
+    static const KeyboardLayoutTables tables;
+    static const KeyboardLayout layout;
+};
+
+// Defined in KeyboardLayoutDatabase.cpp. Every table is a separate object,
+// the linker only keeps the tables that are used.
+#define KEYBOARD_LAYOUT_DATABASE(locale) \
+    template<> const KeyboardLayoutTables KeyboardLayoutDatabase<locale>::tables; \
+    template<> const KeyboardLayout KeyboardLayoutDatabase<locale>::layout
+
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_DANISH);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_FRENCH);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_FRENCH_BELGIAN);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_FRENCH_SWISS);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_GERMAN);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_GERMAN_SWISS);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_ITALIAN);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_JAPANESE);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_NORWEGIAN);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_PORTUGUESE);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_SPANISH);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_SWEDISH);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_UNITED_KINGDOM);
+KEYBOARD_LAYOUT_DATABASE(KEYBOARD_LOCALE_US_ENGLISH);
+
+#undef KEYBOARD_LAYOUT_DATABASE
+
+// Modifier class of a character, c has to be less than the size of the layout
+inline uint8_t keyboardLayoutClass(const uint8_t* modifiers, uint8_t c){
+    return (pgm_read_byte(modifiers + (c >> 2)) >> ((c & 3) * 2)) & 3;
+}
+
+// Next code point of a UTF-8 string in flash, size counts down the bytes left.
+// Bytes that do not start a valid sequence are returned as ISO-8859-1,
+// 4 byte sequences are skipped and return 0xFFFD.
+inline uint16_t keyboardReadUTF8_P(const uint8_t*& str, size_t& size){
+    uint8_t c = pgm_read_byte(str);
+    str++;
+    size--;
+    if(c < 0xC2 || c > 0xF4){
+        return c;
+    }
+
+    uint8_t length = c < 0xE0 ? 1 : c < 0xF0 ? 2 : 3;
+    if(size < length){
+        return c;
+    }
+    uint16_t unicode = c & (length == 1 ? 0x1F : 0x0F);
+    for(uint8_t i = 0; i < length; i++){
+        uint8_t next = pgm_read_byte(str + i);
+        if((next & 0xC0) != 0x80){
+            return c;
+        }
+        unicode = (unicode << 6) | (next & 0x3F);
+    }
+    str += length;
+    size -= length;
+    return length == 3 ? 0xFFFD : unicode;
+}
+
+// Character of the ISO-8859-15 tables for a code point, 0 if there is none
+inline uint8_t keyboardLayoutCharacter(uint16_t unicode){
+    switch(unicode){
+    case 0x20AC: return 0xA4; // Euro
+    case 0x0160: return 0xA6;
+    case 0x0161: return 0xA8;
+    case 0x017D: return 0xB4;
+    case 0x017E: return 0xB8;
+    case 0x0152: return 0xBC;
+    case 0x0153: return 0xBD;
+    case 0x0178: return 0xBE;
+    // Replaced by the characters above
+    case 0xA4: case 0xA6: case 0xA8: case 0xB4:
+    case 0xB8: case 0xBC: case 0xBD: case 0xBE:
+        return 0;
+    }
+    return unicode < KEYBOARD_LAYOUT_SIZE ? unicode : 0;
+}
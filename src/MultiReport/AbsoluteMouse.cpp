@@ -22,57 +22,21 @@ THE SOFTWARE.
 */
 
 #include "AbsoluteMouse.h"
+#include "../HID-Batch.h"
 
 
-static const uint8_t _hidMultiReportDescriptorAbsoluteMouse[] PROGMEM = {
-	/*  Mouse absolute */
-    0x05, 0x01,                      /* USAGE_PAGE (Generic Desktop)	  54 */
-    0x09, 0x02,                      /* USAGE (Mouse) */
-    0xA1, 0x01,                      /* COLLECTION (Application) */
-    0x85, HID_REPORTID_MOUSE_ABSOLUTE,	/*     REPORT_ID */
-
-	/* 8 Buttons */
-    0x05, 0x09,                      /*     USAGE_PAGE (Button) */
-    0x19, 0x01,                      /*     USAGE_MINIMUM (Button 1) */
-    0x29, 0x08,                      /*     USAGE_MAXIMUM (Button 8) */
-    0x15, 0x00,                      /*     LOGICAL_MINIMUM (0) */
-    0x25, 0x01,                      /*     LOGICAL_MAXIMUM (1) */
-    0x95, 0x08,                      /*     REPORT_COUNT (8) */
-    0x75, 0x01,                      /*     REPORT_SIZE (1) */
-    0x81, 0x02,                      /*     INPUT (Data,Var,Abs) */
-
-	/* X, Y */
-    0x05, 0x01,                      /*     USAGE_PAGE (Generic Desktop) */
-    0x09, 0x30,                      /*     USAGE (X) */
-    0x09, 0x31,                      /*     USAGE (Y) */
-	0x16, 0x00, 0x00,				 /* 	Logical Minimum (0); NOTE: Windows 7 can't handle negative value */
-	0x26, 0xFF, 0x7F,				 /* 	Logical Maximum (32767) */
-	0x75, 0x10,						 /* 	Report Size (16), */
-	0x95, 0x02,						 /* 	Report Count (2), */
-	0x81, 0x02,						 /* 	Input (Data, Variable, Absolute) */
-
-	/* Wheel */
-    0x09, 0x38,                      /*     USAGE (Wheel) */
-    0x15, 0x81,                      /*     LOGICAL_MINIMUM (-127) */
-    0x25, 0x7f,                      /*     LOGICAL_MAXIMUM (127) */
-    0x75, 0x08,                      /*     REPORT_SIZE (8) */
-    0x95, 0x01,                      /*     REPORT_COUNT (1) */
-    0x81, 0x06,                      /*     INPUT (Data,Var,Rel) */
-
-	/* End */
-    0xc0                            /* END_COLLECTION */ 
-};
+typedef HIDAbsoluteMouseDescriptor<HID_REPORTID_MOUSE_ABSOLUTE> AbsoluteMouseDescriptor;
 
 AbsoluteMouse_::AbsoluteMouse_(void) 
 {
-	static HIDSubDescriptor node(_hidMultiReportDescriptorAbsoluteMouse, sizeof(_hidMultiReportDescriptorAbsoluteMouse));
+	static HIDSubDescriptor node(AbsoluteMouseDescriptor::data, AbsoluteMouseDescriptor::size);
 	HID().AppendDescriptor(&node);
 }
 
 
 void AbsoluteMouse_::SendReport(void* data, int length)
 {
-	HID().SendReport(HID_REPORTID_MOUSE_ABSOLUTE, data, length);
+	HIDReportBatch::send(HID_REPORTID_MOUSE_ABSOLUTE, HID_BATCH_PRIORITY_POINTER, data, length);
 }
 
 AbsoluteMouse_ AbsoluteMouse;
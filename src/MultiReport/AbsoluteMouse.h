@@ -25,18 +25,27 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/AbsoluteMouseAPI.h"
 
 
+#if HID_STATIC_API
+class AbsoluteMouse_ : public StaticAbsoluteMouseAPI<AbsoluteMouse_>
+{
+    friend class StaticAbsoluteMouseAPI<AbsoluteMouse_>;
+#else
 class AbsoluteMouse_ : public AbsoluteMouseAPI
 {
+#endif
 public:
     AbsoluteMouse_(void);
 
 protected: 
+#if HID_STATIC_API
+    void SendReport(void* data, int length);
+#else
     virtual inline void SendReport(void* data, int length) override;
+#endif
 };
 extern AbsoluteMouse_ AbsoluteMouse;
 
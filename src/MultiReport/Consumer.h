@@ -25,18 +25,27 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/ConsumerAPI.h"
 
 
+#if HID_STATIC_API
+class Consumer_ : public StaticConsumerAPI<Consumer_>
+{
+    friend class StaticConsumerAPI<Consumer_>;
+#else
 class Consumer_ : public ConsumerAPI
 {
+#endif
 public:
     Consumer_(void);
 
 protected: 
+#if HID_STATIC_API
+    void SendReport(void* data, int length);
+#else
     virtual inline void SendReport(void* data, int length) override;
+#endif
 };
 extern Consumer_ Consumer;
 
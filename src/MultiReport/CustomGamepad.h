@@ -0,0 +1,60 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "../HID-APIs/GamepadProfileAPI.h"
+#include "../HID-Batch.h"
+#include "../HID-Update.h"
+
+// Multi report gamepad with the layout of a GamepadProfile, for example
+// 8 buttons and 2 axes with 10 bit:
+//
+//	CustomGamepad<GamepadProfile<8, 2, 10>, 11> Pad;
+//
+// The report ID must not be used by another device of the sketch.
+template<class Profile, uint8_t ReportID>
+class CustomGamepad : public StaticGamepadProfileAPI<Profile, CustomGamepad<Profile, ReportID>>, public HIDReportUpdate
+{
+	friend class StaticGamepadProfileAPI<Profile, CustomGamepad<Profile, ReportID>>;
+	typedef typename Profile::template Descriptor<ReportID> Descriptor;
+
+	static_assert(ReportID != HID_REPORTID_NONE, "CustomGamepad needs a report ID.");
+	static_assert(sizeof(typename Profile::Report) < USB_EP_SIZE, "The gamepad profile does not fit into a report.");
+
+public:
+	CustomGamepad(void) : HIDReportUpdate(updateDevice<CustomGamepad>)
+	{
+		static HIDSubDescriptor node(Descriptor::data, Descriptor::size);
+		HID().AppendDescriptor(&node);
+	}
+
+protected:
+	void SendReport(void* data, int length)
+	{
+		HIDReportBatch::send(ReportID, HID_BATCH_PRIORITY_GAMEPAD, data, length);
+	}
+};
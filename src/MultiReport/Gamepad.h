@@ -25,18 +25,28 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/GamepadAPI.h"
+#include "../HID-Update.h"
 
 
-class Gamepad_ : public GamepadAPI
+#if HID_STATIC_API
+class Gamepad_ : public StaticGamepadAPI<Gamepad_>, public HIDReportUpdate
 {
+    friend class StaticGamepadAPI<Gamepad_>;
+#else
+class Gamepad_ : public GamepadAPI, public HIDReportUpdate
+{
+#endif
 public:
     Gamepad_(void);
 
 protected: 
+#if HID_STATIC_API
+    void SendReport(void* data, int length);
+#else
     virtual inline void SendReport(void* data, int length) override;
+#endif
 };
 extern Gamepad_ Gamepad;
 
@@ -0,0 +1,50 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "HybridKeyboard.h"
+#include "../HID-Batch.h"
+
+// Two keyboard collections, the host merges the keys of both
+typedef HIDItems<
+	HIDKeyboardDescriptor<HID_REPORTID_HYBRID_KEYBOARD>,
+	HIDNKROKeyboardDescriptor<HID_REPORTID_HYBRID_OVERFLOW>
+> HybridKeyboardDescriptor;
+
+HybridKeyboard_::HybridKeyboard_(void) 
+{
+	static HIDSubDescriptor node(HybridKeyboardDescriptor::data, HybridKeyboardDescriptor::size);
+	HID().AppendDescriptor(&node);
+}
+
+int HybridKeyboard_::sendReport(bool overflow, const void* data, int length)
+{
+	uint8_t id = overflow ? HID_REPORTID_HYBRID_OVERFLOW : HID_REPORTID_HYBRID_KEYBOARD;
+	return HIDReportBatch::send(id, HID_BATCH_PRIORITY_KEYBOARD, data, length);
+}
+
+void HybridKeyboard_::wakeupHost(void){
+	HIDSuspend::wakeupHost();
+}
+
+HybridKeyboard_ HybridKeyboard;
@@ -25,7 +25,6 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/DefaultKeyboardAPI.h"
 
@@ -22,51 +22,22 @@ THE SOFTWARE.
 */
 
 #include "ImprovedMouse.h"
+#include "../HID-Batch.h"
 
 
-static const uint8_t _hidMultiReportDescriptorMouse[] PROGMEM = {
- /*  Mouse relative */
-    0x05, 0x01,                      /* USAGE_PAGE (Generic Desktop)	  54 */
-    0x09, 0x02,                      /* USAGE (Mouse) */
-    0xa1, 0x01,                      /* COLLECTION (Application) */
-    0x85, HID_REPORTID_MOUSE,				/*     REPORT_ID */
-
-	/* 8 Buttons */
-    0x05, 0x09,                      /*     USAGE_PAGE (Button) */
-    0x19, 0x01,                      /*     USAGE_MINIMUM (Button 1) */
-    0x29, 0x08,                      /*     USAGE_MAXIMUM (Button 8) */
-    0x15, 0x00,                      /*     LOGICAL_MINIMUM (0) */
-    0x25, 0x01,                      /*     LOGICAL_MAXIMUM (1) */
-    0x95, 0x08,                      /*     REPORT_COUNT (8) */
-    0x75, 0x01,                      /*     REPORT_SIZE (1) */
-    0x81, 0x02,                      /*     INPUT (Data,Var,Abs) */
-
-	/* X, Y, Wheel */
-    0x05, 0x01,                      /*     USAGE_PAGE (Generic Desktop) */
-    0x09, 0x30,                      /*     USAGE (X) */
-    0x09, 0x31,                      /*     USAGE (Y) */
-    0x09, 0x38,                      /*     USAGE (Wheel) */
-    0x15, 0x81,                      /*     LOGICAL_MINIMUM (-127) */
-    0x25, 0x7f,                      /*     LOGICAL_MAXIMUM (127) */
-    0x75, 0x08,                      /*     REPORT_SIZE (8) */
-    0x95, 0x03,                      /*     REPORT_COUNT (3) */
-    0x81, 0x06,                      /*     INPUT (Data,Var,Rel) */
-
-	/* End */
-    0xc0                            /* END_COLLECTION */
-};
+typedef HIDMouseDescriptor<HID_REPORTID_MOUSE> MouseDescriptor;
 
 
 Mouse_::Mouse_(void) 
 {
-	static HIDSubDescriptor node(_hidMultiReportDescriptorMouse, sizeof(_hidMultiReportDescriptorMouse));
+	static HIDSubDescriptor node(MouseDescriptor::data, MouseDescriptor::size);
 	HID().AppendDescriptor(&node);
 }
 
 
 void Mouse_::SendReport(void* data, int length)
 {
-	HID().SendReport(HID_REPORTID_MOUSE, data, length);
+	HIDReportBatch::send(HID_REPORTID_MOUSE, HID_BATCH_PRIORITY_POINTER, data, length);
 }
 
 Mouse_ Mouse;
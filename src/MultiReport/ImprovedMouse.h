@@ -25,18 +25,27 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/MouseAPI.h"
 
 
+#if HID_STATIC_API
+class Mouse_ : public StaticMouseAPI<Mouse_>
+{
+    friend class StaticMouseAPI<Mouse_>;
+#else
 class Mouse_ : public MouseAPI
 {
+#endif
 public:
     Mouse_(void);
 
 protected: 
+#if HID_STATIC_API
+    void SendReport(void* data, int length);
+#else
     virtual inline void SendReport(void* data, int length) override;
+#endif
 };
 extern Mouse_ Mouse;
 
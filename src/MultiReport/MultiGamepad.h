@@ -0,0 +1,60 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <Arduino.h>
+#include "HID-Settings.h"
+#include "../HID-APIs/GamepadAPI.h"
+#include "../HID-Batch.h"
+#include "../HID-Update.h"
+
+// Multi report gamepad like Gamepad with its own report ID, for several
+// gamepads on the multi report endpoint:
+//
+//	MultiGamepad<11> Player1;
+//	MultiGamepad<12> Player2;
+//
+// The report ID must not be used by another device of the sketch.
+template<uint8_t ReportID>
+class MultiGamepad : public StaticGamepadAPI<MultiGamepad<ReportID>>, public HIDReportUpdate
+{
+	friend class StaticGamepadAPI<MultiGamepad<ReportID>>;
+	typedef HIDGamepadDescriptor<ReportID> Descriptor;
+
+	static_assert(ReportID != HID_REPORTID_NONE, "MultiGamepad needs a report ID.");
+
+public:
+	MultiGamepad(void) : HIDReportUpdate(updateDevice<MultiGamepad>)
+	{
+		static HIDSubDescriptor node(Descriptor::data, Descriptor::size);
+		HID().AppendDescriptor(&node);
+	}
+
+protected:
+	void SendReport(void* data, int length)
+	{
+		HIDReportBatch::send(ReportID, HID_BATCH_PRIORITY_GAMEPAD, data, length);
+	}
+};
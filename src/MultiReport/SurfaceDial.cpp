@@ -22,6 +22,7 @@ THE SOFTWARE.
 */
 
 #include "SurfaceDial.h"
+#include "../HID-Batch.h"
 
 static const uint8_t _hidMultiReportDescriptorSurfaceDial[] PROGMEM = {
     // Integrated Radial Controller TLC
@@ -81,7 +82,7 @@ SurfaceDial_::SurfaceDial_(void)
 
 void SurfaceDial_::SendReport(void *data, int length)
 {
-    HID().SendReport(HID_REPORTID_SURFACEDIAL, data, length);
+    HIDReportBatch::send(HID_REPORTID_SURFACEDIAL, HID_BATCH_PRIORITY_POINTER, data, length);
 }
 
 SurfaceDial_ SurfaceDial;
@@ -25,18 +25,27 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/SurfaceDialAPI.h"
 
 
+#if HID_STATIC_API
+class SurfaceDial_ : public StaticSurfaceDialAPI<SurfaceDial_>
+{
+    friend class StaticSurfaceDialAPI<SurfaceDial_>;
+#else
 class SurfaceDial_ : public SurfaceDialAPI
 {
+#endif
 public:
     SurfaceDial_(void);
 
 protected: 
+#if HID_STATIC_API
+    void SendReport(void* data, int length);
+#else
     virtual inline void SendReport(void* data, int length) override;
+#endif
 };
 extern SurfaceDial_ SurfaceDial;
 
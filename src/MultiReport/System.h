@@ -25,18 +25,27 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/SystemAPI.h"
 
 
+#if HID_STATIC_API
+class System_ : public StaticSystemAPI<System_>
+{
+    friend class StaticSystemAPI<System_>;
+#else
 class System_ : public SystemAPI
 {
+#endif
 public:
     System_(void);
 
 protected: 
+#if HID_STATIC_API
+    void SendReport(void* data, int length);
+#else
     virtual inline void SendReport(void* data, int length) override;
+#endif
 };
 extern System_ System;
 
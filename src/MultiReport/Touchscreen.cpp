@@ -0,0 +1,41 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Touchscreen.h"
+#include "../HID-Batch.h"
+
+// The core HID module cannot answer the contact count maximum feature report
+typedef HIDTouchscreenDescriptor<HID_REPORTID_TOUCHSCREEN> TouchscreenDescriptor;
+
+Touchscreen_::Touchscreen_(void)
+{
+    static HIDSubDescriptor node(TouchscreenDescriptor::data, TouchscreenDescriptor::size);
+    HID().AppendDescriptor(&node);
+}
+
+void Touchscreen_::SendReport(void *data, int length)
+{
+    HIDReportBatch::send(HID_REPORTID_TOUCHSCREEN, HID_BATCH_PRIORITY_POINTER, data, length);
+}
+
+Touchscreen_ Touchscreen;
@@ -71,144 +71,121 @@ static const uint8_t _hidReportDescriptorKeyboard[] PROGMEM = {
     0xc0                            /* END_COLLECTION */
 };
 
-BootKeyboard_::BootKeyboard_(void) : PluggableUSBModule(1, 1, epType), protocol(HID_REPORT_PROTOCOL), idle(1), leds(0), featureReport(NULL), featureLength(0)
+BootKeyboard_::BootKeyboard_(void) : HIDSingleReportDevice(_hidReportDescriptorKeyboard, sizeof(_hidReportDescriptorKeyboard), HID_INTERVAL_BOOTKEYBOARD,
+	HID_IDLE_KEYBOARD, false, HID_SUBCLASS_BOOT_INTERFACE, HID_PROTOCOL_KEYBOARD), format(formatReport), hostTaken(0), featureReport(NULL), featureLength(0), featureBlocked(false), transfer(NULL)
 {
-	epType[0] = EP_TYPE_INTERRUPT_IN;
-	PluggableUSB().plug(this);
 }
 
-int BootKeyboard_::getInterface(uint8_t* interfaceCount)
+bool BootKeyboard_::onGetReport(USBSetup& setup)
 {
-	*interfaceCount += 1; // uses 1
-	HIDDescriptor hidInterface = {
-		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_BOOT_INTERFACE, HID_PROTOCOL_KEYBOARD),
-		D_HIDREPORT(sizeof(_hidReportDescriptorKeyboard)),
-		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, 0x01)
-	};
-	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
-}
-
-int BootKeyboard_::getDescriptor(USBSetup& setup)
-{
-	// In a HID Class Descriptor wIndex cointains the interface number
-	if (setup.wIndex != pluggedInterface) { return 0; }
-
-	// Check if this is a HID Class Descriptor request
-	if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE) { return 0; }
-
-	if (setup.wValueH == HID_HID_DESCRIPTOR_TYPE) {
-		// Apple UEFI and USBCV wants it
-		HIDDescDescriptor desc = D_HIDREPORT(sizeof(_hidReportDescriptorKeyboard));
-		return USB_SendControl(0, &desc, sizeof(desc));
-	} else if (setup.wValueH == HID_REPORT_DESCRIPTOR_TYPE) {
-		// Reset the protocol on reenumeration. Normally the host should not assume the state of the protocol
-		// due to the USB specs, but Windows and Linux just assumes its in report mode.
-		protocol = HID_REPORT_PROTOCOL;
-		return USB_SendControl(TRANSFER_PGM, _hidReportDescriptorKeyboard, sizeof(_hidReportDescriptorKeyboard));
+	if(setup.wValueH == HID_REPORT_TYPE_FEATURE && transfer){
+		return transfer->getReport(setup.wLength);
 	}
-
-	return 0;
+	return false;
 }
 
-bool BootKeyboard_::setup(USBSetup& setup)
+bool BootKeyboard_::onSetReport(USBSetup& setup)
 {
-	if (pluggedInterface != setup.wIndex) {
-		return false;
-	}
-
-	uint8_t request = setup.bRequest;
-	uint8_t requestType = setup.bmRequestType;
+	// Check if data has the correct length afterwards
+	int length = setup.wLength;
 
-	if (requestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE)
-	{
-		if (request == HID_GET_REPORT) {
-			// TODO: HID_GetReport();
-			return true;
+	// Feature (set feature report)
+	if(setup.wValueH == HID_REPORT_TYPE_FEATURE){
+		if (transfer) {
+			return transfer->setReport(length);
 		}
-		if (request == HID_GET_PROTOCOL) {
-			// TODO improve
-#ifdef __AVR__
-			UEDATX = protocol;
-#endif
-			return true;
-		}
-		if (request == HID_GET_IDLE) {
-			// TODO improve
-#ifdef __AVR__
-			UEDATX = idle;
-#endif
+
+		// The sketch owns the buffer until it enables the report again
+		if (!featureBlocked && featureReport && length == featureLength) {
+			USB_RecvControl(featureReport, featureLength);
+
+			// Block until data is read
+			disableFeatureReport();
 			return true;
 		}
+		// TODO fake clear data?
 	}
 
-	if (requestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE)
+	// Output (set led states)
+	else if(setup.wValueH == HID_REPORT_TYPE_OUTPUT){
+		return leds.receive(length);
+	}
+
+	// Input (set HID report)
+	else if(setup.wValueH == HID_REPORT_TYPE_INPUT)
 	{
-		if (request == HID_SET_PROTOCOL) {
-			protocol = setup.wValueL;
-			return true;
-		}
-		if (request == HID_SET_IDLE) {
-			idle = setup.wValueH;
+		// The sketch may be changing the keys right now
+		if(length == sizeof(hostReport)){
+			hostLock.writeBegin();
+			USB_RecvControl(&hostReport, length);
+			hostLock.writeEnd();
 			return true;
 		}
-		if (request == HID_SET_REPORT)
-		{
-			// Check if data has the correct length afterwards
-			int length = setup.wLength;
-
-			// Feature (set feature report)
-			if(setup.wValueH == HID_REPORT_TYPE_FEATURE){
-				// No need to check for negative featureLength values,
-				// except the host tries to send more then 32k bytes.
-				// We dont have that much ram anyways.
-				if (length == featureLength) {
-					USB_RecvControl(featureReport, featureLength);
-
-					// Block until data is read (make length negative)
-					disableFeatureReport();
-					return true;
-				}
-				// TODO fake clear data?
-			}
-
-			// Output (set led states)
-			else if(setup.wValueH == HID_REPORT_TYPE_OUTPUT){
-				if(length == sizeof(leds)){
-					USB_RecvControl(&leds, length);
-					return true;
-				}
-			}
-
-			// Input (set HID report)
-			else if(setup.wValueH == HID_REPORT_TYPE_INPUT)
-			{
-				if(length == sizeof(_keyReport)){
-					USB_RecvControl(&_keyReport, length);
-					return true;
-				}
-			}
-		}
 	}
 
 	return false;
 }
 
 uint8_t BootKeyboard_::getLeds(void){
-    return leds;
+    return leds.get();
+}
+
+bool BootKeyboard_::readLeds(uint8_t& state){
+    // Unknown until the host sent the first LED report
+    if(!leds.received()){
+        return false;
+    }
+    state = leds.get();
+    return true;
+}
+
+void BootKeyboard_::setProtocol(uint8_t p){
+	protocol = p;
+	format = (p == HID_BOOT_PROTOCOL) ? formatBoot : formatReport;
+}
+
+const HID_KeyboardReport_Data_t* BootKeyboard_::formatReport(const HID_KeyboardReport_Data_t* report, HID_KeyboardReport_Data_t* buffer){
+	(void)buffer;
+	return report;
+}
+
+const HID_KeyboardReport_Data_t* BootKeyboard_::formatBoot(const HID_KeyboardReport_Data_t* report, HID_KeyboardReport_Data_t* buffer){
+	// The reserved byte has to be 0 for BIOS hosts, it holds the consumer key otherwise
+	*buffer = *report;
+	buffer->reserved = 0;
+	return buffer;
+}
+
+void BootKeyboard_::takeHostReport(void){
+	if(hostLock.sequence() == hostTaken){
+		return;
+	}
+	HID_KeyboardReport_Data_t report;
+	hostTaken = hostLock.read(&report, &hostReport, sizeof(report));
+	setReport(report);
 }
 
-uint8_t BootKeyboard_::getProtocol(void){
-    return protocol;
+size_t BootKeyboard_::set(KeyboardKeycode k, bool s){
+	takeHostReport();
+	return DefaultKeyboardAPI::set(k, s);
+}
+
+size_t BootKeyboard_::removeAll(void){
+	takeHostReport();
+	return DefaultKeyboardAPI::removeAll();
 }
 
 int BootKeyboard_::send(void){
-	return USB_Send(pluggedEndpoint | TRANSFER_RELEASE, &_keyReport, sizeof(_keyReport));
+	takeHostReport();
+
+	HID_KeyboardReport_Data_t buffer;
+	const HID_KeyboardReport_Data_t* report = format(&_keyReport, &buffer);
+
+	return sendReport(report, sizeof(_keyReport));
 }
 
 void BootKeyboard_::wakeupHost(void){
-#ifdef __AVR__
-	USBDevice.wakeupHost();
-#endif
+	HIDSuspend::wakeupHost();
 }
 
 
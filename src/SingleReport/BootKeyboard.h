@@ -25,60 +25,94 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/DefaultKeyboardAPI.h"
+#include "../HID-SingleReport.h"
+#include "../HID-Leds.h"
+#include "../HID-Shared.h"
+#include "../HID-Transfer.h"
 
 
-class BootKeyboard_ : public PluggableUSBModule, public DefaultKeyboardAPI
+class BootKeyboard_ : public HIDSingleReportDevice<HID_KeyboardReport_Data_t>, public DefaultKeyboardAPI
 {
 public:
     BootKeyboard_(void);
     uint8_t getLeds(void);
-    uint8_t getProtocol(void);
+
+    // Called from the USB interrupt for every LED report of the host
+    void onLeds(HIDLedReport::Callback callback){
+        leds.onReport(callback);
+    }
+
+    // Number of received LED reports, wraps around at 256
+    uint8_t getLedsSequence(void){
+        return leds.sequence();
+    }
     void wakeupHost(void);
     
     void setFeatureReport(void* report, int length){
         if(length > 0){
+            // Disable feature report by default, before the USB interrupt
+            // can see the new buffer
+            disableFeatureReport();
             featureReport = (uint8_t*)report;
             featureLength = length;
-            
-            // Disable feature report by default
-            disableFeatureReport();
         }
     }
     
     int availableFeatureReport(void){
-        if(featureLength < 0){
-            return featureLength & ~0x8000;
+        if(featureBlocked){
+            return featureLength;
         }
         return 0;
     }
     
+    // The USB interrupt only writes the report while it is enabled, the
+    // flag is a single byte so no interrupts have to be disabled
     void enableFeatureReport(void){
-        featureLength &= ~0x8000;
+        featureBlocked = false;
     }
     
     void disableFeatureReport(void){
-        featureLength |= 0x8000;
+        featureBlocked = true;
+    }
+
+    // Feature reports carry uploads and downloads with offsets instead,
+    // NULL goes back to the single feature report
+    void setFeatureTransfer(HIDFeatureTransfer* t){
+        transfer = t;
     }
     
     virtual int send(void) final;
+    virtual size_t removeAll(void) override;
 
 protected:
-    // Implementation of the PUSBListNode
-    int getInterface(uint8_t* interfaceCount);
-    int getDescriptor(USBSetup& setup);
-    bool setup(USBSetup& setup);
-    
-    EPTYPE_DESCRIPTOR_SIZE epType[1];
-    uint8_t protocol;
-    uint8_t idle;
-    
-    uint8_t leds;
+    // Report builders, chosen when the protocol changes so send() does not
+    // check it. They return the report to send.
+    typedef const HID_KeyboardReport_Data_t* (*Format)(const HID_KeyboardReport_Data_t* report, HID_KeyboardReport_Data_t* buffer);
+    static const HID_KeyboardReport_Data_t* formatReport(const HID_KeyboardReport_Data_t* report, HID_KeyboardReport_Data_t* buffer);
+    static const HID_KeyboardReport_Data_t* formatBoot(const HID_KeyboardReport_Data_t* report, HID_KeyboardReport_Data_t* buffer);
+    Format format;
+    virtual void setProtocol(uint8_t p) override;
+
+    HIDLedReport leds;
+    virtual bool readLeds(uint8_t& state) override;
+
+    // Keys the host set with SET_REPORT. Written by the USB interrupt and
+    // taken over by the sketch with the next change or send().
+    HID_KeyboardReport_Data_t hostReport;
+    HIDSeqLock hostLock;
+    uint8_t hostTaken;
+    void takeHostReport(void);
+    virtual size_t set(KeyboardKeycode k, bool s) override;
     
     uint8_t* featureReport;
     int featureLength;
+    volatile bool featureBlocked;
+    HIDFeatureTransfer* transfer;
+
+    virtual bool onGetReport(USBSetup& setup) override;
+    virtual bool onSetReport(USBSetup& setup) override;
 };
 extern BootKeyboard_ BootKeyboard;
 
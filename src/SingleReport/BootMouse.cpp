@@ -43,6 +43,57 @@ static const uint8_t _hidReportDescriptorMouse[] PROGMEM = {
     0x75, 0x01,                      /*     REPORT_SIZE (1) */
     0x81, 0x02,                      /*     INPUT (Data,Var,Abs) */
 
+#if HID_MOUSE_HIGH_RESOLUTION
+	/* 16 bit X, Y */
+    0x05, 0x01,                      /*     USAGE_PAGE (Generic Desktop) */
+    0x09, 0x30,                      /*     USAGE (X) */
+    0x09, 0x31,                      /*     USAGE (Y) */
+    0x16, 0x01, 0x80,                /*     LOGICAL_MINIMUM (-32767) */
+    0x26, 0xff, 0x7f,                /*     LOGICAL_MAXIMUM (32767) */
+    0x75, 0x10,                      /*     REPORT_SIZE (16) */
+    0x95, 0x02,                      /*     REPORT_COUNT (2) */
+    0x81, 0x06,                      /*     INPUT (Data,Var,Rel) */
+
+	/* Wheel with resolution multiplier */
+    0xa1, 0x02,                      /*     COLLECTION (Logical) */
+    0x09, 0x48,                      /*       USAGE (Resolution Multiplier) */
+    0x15, 0x00,                      /*       LOGICAL_MINIMUM (0) */
+    0x25, 0x01,                      /*       LOGICAL_MAXIMUM (1) */
+    0x35, 0x01,                      /*       PHYSICAL_MINIMUM (1) */
+    0x45, HID_MOUSE_WHEEL_MULTIPLIER,/*       PHYSICAL_MAXIMUM (multiplier) */
+    0x75, 0x02,                      /*       REPORT_SIZE (2) */
+    0x95, 0x01,                      /*       REPORT_COUNT (1) */
+    0xb1, 0x02,                      /*       FEATURE (Data,Var,Abs) */
+    0x09, 0x38,                      /*       USAGE (Wheel) */
+    0x15, 0x81,                      /*       LOGICAL_MINIMUM (-127) */
+    0x25, 0x7f,                      /*       LOGICAL_MAXIMUM (127) */
+    0x35, 0x00,                      /*       PHYSICAL_MINIMUM (0) */
+    0x45, 0x00,                      /*       PHYSICAL_MAXIMUM (0) */
+    0x75, 0x08,                      /*       REPORT_SIZE (8) */
+    0x81, 0x06,                      /*       INPUT (Data,Var,Rel) */
+    0xc0,                            /*     END_COLLECTION (Logical) */
+
+	/* Pan with resolution multiplier */
+    0xa1, 0x02,                      /*     COLLECTION (Logical) */
+    0x09, 0x48,                      /*       USAGE (Resolution Multiplier) */
+    0x15, 0x00,                      /*       LOGICAL_MINIMUM (0) */
+    0x25, 0x01,                      /*       LOGICAL_MAXIMUM (1) */
+    0x35, 0x01,                      /*       PHYSICAL_MINIMUM (1) */
+    0x45, HID_MOUSE_WHEEL_MULTIPLIER,/*       PHYSICAL_MAXIMUM (multiplier) */
+    0x75, 0x02,                      /*       REPORT_SIZE (2) */
+    0xb1, 0x02,                      /*       FEATURE (Data,Var,Abs) */
+    0x35, 0x00,                      /*       PHYSICAL_MINIMUM (0) */
+    0x45, 0x00,                      /*       PHYSICAL_MAXIMUM (0) */
+    0x75, 0x04,                      /*       REPORT_SIZE (4) */
+    0xb1, 0x03,                      /*       FEATURE (Cnst,Var,Abs) */
+    0x05, 0x0c,                      /*       USAGE_PAGE (Consumer) */
+    0x0a, 0x38, 0x02,                /*       USAGE (AC Pan) */
+    0x15, 0x81,                      /*       LOGICAL_MINIMUM (-127) */
+    0x25, 0x7f,                      /*       LOGICAL_MAXIMUM (127) */
+    0x75, 0x08,                      /*       REPORT_SIZE (8) */
+    0x81, 0x06,                      /*       INPUT (Data,Var,Rel) */
+    0xc0,                            /*     END_COLLECTION (Logical) */
+#else
 	/* X, Y, Wheel */
     0x05, 0x01,                      /*     USAGE_PAGE (Generic Desktop) */
     0x09, 0x30,                      /*     USAGE (X) */
@@ -53,113 +104,95 @@ static const uint8_t _hidReportDescriptorMouse[] PROGMEM = {
     0x75, 0x08,                      /*     REPORT_SIZE (8) */
     0x95, 0x03,                      /*     REPORT_COUNT (3) */
     0x81, 0x06,                      /*     INPUT (Data,Var,Rel) */
+#endif
 
 	/* End */
     0xc0,                           /* END_COLLECTION (Physical) */
     0xc0                            /* END_COLLECTION */
 };
 
-BootMouse_::BootMouse_(void) : PluggableUSBModule(1, 1, epType), protocol(HID_REPORT_PROTOCOL), idle(1)
+BootMouse_::BootMouse_(void) : HIDSingleReportDevice(_hidReportDescriptorMouse, sizeof(_hidReportDescriptorMouse), HID_INTERVAL_BOOTMOUSE,
+	0, true, HID_SUBCLASS_BOOT_INTERFACE, HID_PROTOCOL_MOUSE), format(formatReport)
+#if HID_MOUSE_HIGH_RESOLUTION
+, resolution(0)
+#endif
 {
-	epType[0] = EP_TYPE_INTERRUPT_IN;
-	PluggableUSB().plug(this);
 }
 
-int BootMouse_::getInterface(uint8_t* interfaceCount)
+#if HID_MOUSE_HIGH_RESOLUTION
+int BootMouse_::getDescriptor(USBSetup& setup)
 {
-	*interfaceCount += 1; // uses 1
-	HIDDescriptor hidInterface = {
-		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_BOOT_INTERFACE, HID_PROTOCOL_MOUSE),
-		D_HIDREPORT(sizeof(_hidReportDescriptorMouse)),
-		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, 0x01)
-	};
-	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
+	int ret = HIDSingleReport::getDescriptor(setup);
+
+	// The host reenumerates, the resolution multipliers start disabled again
+	if (ret > 0 && setup.wValueH == HID_REPORT_DESCRIPTOR_TYPE) {
+		resolution = 0;
+	}
+	return ret;
 }
 
-int BootMouse_::getDescriptor(USBSetup& setup)
+bool BootMouse_::onGetReport(USBSetup& setup)
 {
-	// In a HID Class Descriptor wIndex cointains the interface number
-	if (setup.wIndex != pluggedInterface) { return 0; }
-
-	// Check if this is a HID Class Descriptor request
-	if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE) { return 0; }
-
-	if (setup.wValueH == HID_HID_DESCRIPTOR_TYPE) {
-		// Apple UEFI and USBCV wants it
-		HIDDescDescriptor desc = D_HIDREPORT(sizeof(_hidReportDescriptorMouse));
-		return USB_SendControl(0, &desc, sizeof(desc));
-	} else if (setup.wValueH == HID_REPORT_DESCRIPTOR_TYPE) {
-		// Reset the protocol on reenumeration. Normally the host should not assume the state of the protocol
-		// due to the USB specs, but Windows and Linux just assumes its in report mode.
-		protocol = HID_REPORT_PROTOCOL;
-		return USB_SendControl(TRANSFER_PGM, _hidReportDescriptorMouse, sizeof(_hidReportDescriptorMouse));
+	// Resolution multipliers
+	if (setup.wValueH == HID_REPORT_TYPE_FEATURE) {
+		return USB_SendControl(0, &resolution, min((int)sizeof(resolution), (int)setup.wLength)) >= 0;
 	}
-
-	return 0;
+	return false;
 }
 
-bool BootMouse_::setup(USBSetup& setup)
+bool BootMouse_::onSetReport(USBSetup& setup)
 {
-	if (pluggedInterface != setup.wIndex) {
-		return false;
+	// The host enables the resolution multipliers
+	if (setup.wValueH == HID_REPORT_TYPE_FEATURE && setup.wLength == sizeof(resolution)) {
+		USB_RecvControl(&resolution, sizeof(resolution));
+		return true;
 	}
-
-	uint8_t request = setup.bRequest;
-	uint8_t requestType = setup.bmRequestType;
-
-	if (requestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE)
-	{
-		if (request == HID_GET_REPORT) {
-			// TODO: HID_GetReport();
-			return true;
-		}
-		if (request == HID_GET_PROTOCOL) {
-			// TODO improve
-#ifdef __AVR__
-			UEDATX = protocol;
-#endif
-			return true;
-		}
-		if (request == HID_GET_IDLE) {
-			// TODO improve
-#ifdef __AVR__
-			UEDATX = idle;
+	return false;
+}
 #endif
-			return true;
-		}
-	}
 
-	if (requestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE)
-	{
-		if (request == HID_SET_PROTOCOL) {
-			protocol = setup.wValueL;
-			return true;
-		}
-		if (request == HID_SET_IDLE) {
-			idle = setup.wValueH;
-			return true;
-		}
-		if (request == HID_SET_REPORT)
-		{
-		}
-	}
+void BootMouse_::setProtocol(uint8_t p){
+	protocol = p;
+	format = (p == HID_BOOT_PROTOCOL) ? formatBoot : formatReport;
+}
 
-	return false;
+int BootMouse_::formatReport(void* data, int length){
+	(void)data;
+	return length;
 }
 
-uint8_t BootMouse_::getProtocol(void){
-    return protocol;
+int BootMouse_::formatBoot(void* data, int length){
+	(void)length;
+#if HID_MOUSE_HIGH_RESOLUTION
+	// The boot report only has 8 bit movement
+	HID_MouseReport_Data_t* report = (HID_MouseReport_Data_t*)data;
+	HID_BootMouseReport_Data_t bootReport;
+	bootReport.buttons = report->buttons;
+	bootReport.xAxis = constrain(report->xAxis, -127, 127);
+	bootReport.yAxis = constrain(report->yAxis, -127, 127);
+	memcpy(data, &bootReport, sizeof(bootReport));
+#else
+	// Buttons, X and Y are the start of the report, the wheel is cut off
+	(void)data;
+#endif
+	return sizeof(HID_BootMouseReport_Data_t);
 }
 
 void BootMouse_::SendReport(void* data, int length){
-	if(protocol == HID_BOOT_PROTOCOL){
-		USB_Send(pluggedEndpoint | TRANSFER_RELEASE, data, sizeof(HID_BootMouseReport_Data_t));
-	}
-	else{
-		USB_Send(pluggedEndpoint | TRANSFER_RELEASE, data, length);
-	}
+	sendReport(data, format(data, length));
+}
+
+bool BootMouse_::ReadyToSend(void){
+	return readyToSend(sizeof(HID_MouseReport_Data_t));
 }
 
+#if HID_MOUSE_HIGH_RESOLUTION
+bool BootMouse_::HighResolutionWheel(void){
+	// Bits 0-1 are the multiplier of the wheel
+	return protocol == HID_REPORT_PROTOCOL && (resolution & 0x03);
+}
+#endif
+
 BootMouse_ BootMouse;
 
 
@@ -25,28 +25,38 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/MouseAPI.h"
+#include "../HID-SingleReport.h"
 
 
-class BootMouse_ : public PluggableUSBModule, public MouseAPI
+class BootMouse_ : public HIDSingleReportDevice<HID_MouseReport_Data_t>, public MouseAPI
 {
 public:
     BootMouse_(void);
-    uint8_t getProtocol(void);
+
+    // Public as in the MouseAPI
+    virtual bool ReadyToSend(void) override;
 
 protected:
-    // Implementation of the PUSBListNode
-    int getInterface(uint8_t* interfaceCount);
-    int getDescriptor(USBSetup& setup);
-    bool setup(USBSetup& setup);
-    
-    EPTYPE_DESCRIPTOR_SIZE epType[1];
-    uint8_t protocol;
-    uint8_t idle;
-    
+    // Report builders, chosen when the protocol changes so sending does not
+    // check it. They convert the report in place and return its length.
+    typedef int (*Format)(void* data, int length);
+    static int formatReport(void* data, int length);
+    static int formatBoot(void* data, int length);
+    Format format;
+    virtual void setProtocol(uint8_t p) override;
+
     virtual void SendReport(void* data, int length) override;
+#if HID_MOUSE_HIGH_RESOLUTION
+    virtual bool HighResolutionWheel(void) override;
+
+    // Resolution multipliers set by the host
+    uint8_t resolution;
+    virtual int getDescriptor(USBSetup& setup) override;
+    virtual bool onGetReport(USBSetup& setup) override;
+    virtual bool onSetReport(USBSetup& setup) override;
+#endif
 };
 extern BootMouse_ BootMouse;
 
@@ -23,45 +23,127 @@ THE SOFTWARE.
 
 #include "RawHID.h"
 
-static const uint8_t  _hidReportDescriptorRawHID[] PROGMEM = {
-	/*    RAW HID */
-    0x06, lowByte(RAWHID_USAGE_PAGE), highByte(RAWHID_USAGE_PAGE),      /* 30 */
-    0x0A, lowByte(RAWHID_USAGE), highByte(RAWHID_USAGE),
-
-    0xA1, 0x01,                  /* Collection 0x01 */
-    // RawHID is not multireport compatible.
-    // On Linux it might work with some modifications,
-    // however you are not happy to use it like that.
-    //0x85, HID_REPORTID_RAWHID,			 /* REPORT_ID */
-    0x75, 0x08,                  /* report size = 8 bits */
-    0x15, 0x00,                  /* logical minimum = 0 */
-    0x26, 0xFF, 0x00,            /* logical maximum = 255 */
-
-    0x95, RAWHID_TX_SIZE,        /* report count TX */
-    0x09, 0x01,                  /* usage */
-    0x81, 0x02,                  /* Input (array) */
-
-    0x95, RAWHID_RX_SIZE,        /* report count RX */
-    0x09, 0x02,                  /* usage */
-    0x91, 0x02,                  /* Output (array) */
-    0xC0                         /* end collection */ 
-};
-
-RawHID_::RawHID_(void) : PluggableUSBModule(1, 1, epType), protocol(HID_REPORT_PROTOCOL), idle(1), dataLength(0), dataAvailable(0), featureReport(NULL), featureLength(0)
+// RawHID is not multireport compatible.
+// On Linux it might work with some modifications,
+// however you are not happy to use it like that.
+typedef HIDItems<
+	HIDUsagePage<RAWHID_USAGE_PAGE>,
+	HIDUsage<RAWHID_USAGE>,
+	HIDCollection<HID_COLLECTION_APPLICATION,
+		HIDReportSize<8>,
+		HIDLogicalMinimum<0>,
+		HIDLogicalMaximum<255>,
+
+		/* TX */
+		HIDReportCount<sizeof(HID_RawKeyboardTXReport_Data_t)>,
+		HIDUsage<0x01>,
+		HIDInput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+
+		/* RX */
+		HIDReportCount<sizeof(HID_RawKeyboardRXReport_Data_t)>,
+		HIDUsage<0x02>,
+		HIDOutput<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>,
+
+		/* Feature */
+		HIDOptional<(RAWHID_FEATURE_SIZE > 0),
+			HIDReportCount<RAWHID_FEATURE_SIZE>,
+			HIDUsage<0x03>,
+			HIDFeature<HID_DATA | HID_VARIABLE | HID_ABSOLUTE>
+		>
+	>
+> RawHIDReportDescriptor;
+
+#if RAWHID_STREAMING && defined(ARDUINO_ARCH_SAM)
+// The DMA channels switch the banks, not the core
+#define RAWHID_EP_AUTOSW UOTGHS_DEVEPTCFG_AUTOSW
+#else
+#define RAWHID_EP_AUTOSW 0
+#endif
+
+#if RAWHID_STREAMING
+// The controller splits a transfer into endpoint sized packets. If reports
+// are smaller than that, every report has to be a transfer of its own.
+#if defined(ARDUINO_ARCH_SAMD)
+#define RAWHID_STREAM_MAX 16383 // PCKSIZE.BYTE_COUNT
+#else
+#define RAWHID_STREAM_MAX 65535 // DEVDMACONTROL.BUFF_LENGTH
+#endif
+// The controllers can not read the flash, it is mapped below the RAM
+#define RAWHID_STREAM_RAM 0x20000000
+#if RAWHID_TX_SIZE == RAWHID_EP_SIZE
+#define RAWHID_STREAM_CHUNK ((RAWHID_STREAM_MAX / RAWHID_TX_SIZE) * RAWHID_TX_SIZE)
+#else
+#define RAWHID_STREAM_CHUNK RAWHID_TX_SIZE
+#endif
+#endif
+
+#if RAWHID_HIGH_SPEED
+// Use both banks of the endpoints, so the next report can be written while one is sent
+#define RAWHID_EP_TYPE_IN  ((EP_TYPE_INTERRUPT_IN & ~UOTGHS_DEVEPTCFG_EPBK_Msk) | UOTGHS_DEVEPTCFG_EPBK_2_BANK | RAWHID_EP_AUTOSW)
+#define RAWHID_EP_TYPE_OUT ((EP_TYPE_INTERRUPT_OUT & ~UOTGHS_DEVEPTCFG_EPBK_Msk) | UOTGHS_DEVEPTCFG_EPBK_2_BANK | RAWHID_EP_AUTOSW)
+
+extern "C" uint32_t UDD_Send(uint32_t ep, const void* data, uint32_t len);
+#elif RAWHID_STREAMING && defined(ARDUINO_ARCH_SAM)
+#define RAWHID_EP_TYPE_IN  (EP_TYPE_INTERRUPT_IN | RAWHID_EP_AUTOSW)
+#define RAWHID_EP_TYPE_OUT (EP_TYPE_INTERRUPT_OUT | RAWHID_EP_AUTOSW)
+#else
+#define RAWHID_EP_TYPE_IN  EP_TYPE_INTERRUPT_IN
+#define RAWHID_EP_TYPE_OUT EP_TYPE_INTERRUPT_OUT
+#endif
+
+#if RAWHID_USE_OUT_ENDPOINT
+typedef struct
+{
+	InterfaceDescriptor hid;
+	HIDDescDescriptor desc;
+	EndpointDescriptor in;
+	EndpointDescriptor out;
+} RawHIDDescriptor;
+#endif
+
+RawHID_::RawHID_(void) : PluggableUSBModule(RAWHID_ENDPOINT_COUNT, 1, epType), protocol(HID_REPORT_PROTOCOL), idle(1), dataLength(0), dataAvailable(0), data(NULL), rxHead(0), rxTail(0), featureReport(NULL), featureLength(0), featureBlocked(false), transfer(NULL), snapshotData(NULL), snapshotLength(0), snapshotFront(0)
+#if RAWHID_TX_BUFFER
+	, txLength(0), txStart(0), txAcquired(false)
+#if RAWHID_TIMESTAMP
+	, txQueued(0)
+#endif
+#endif
+#if RAWHID_TIMESTAMP
+	, txSequence(0)
+#endif
+#if RAWHID_STREAMING
+	, streamData(NULL), streamRemaining(0)
+#endif
 {
-	epType[0] = EP_TYPE_INTERRUPT_IN;
+	epType[0] = RAWHID_EP_TYPE_IN;
+#if RAWHID_USE_OUT_ENDPOINT
+	epType[1] = RAWHID_EP_TYPE_OUT;
+#endif
 	PluggableUSB().plug(this);
+#if HID_STATS
+	stats.interface = pluggedInterface;
+#endif
 }
 
 int RawHID_::getInterface(uint8_t* interfaceCount)
 {
 	// Maybe as optional device FastRawHID with different USAGE PAGE
 	*interfaceCount += 1; // uses 1
+#if RAWHID_USE_OUT_ENDPOINT
+	// The OUT endpoint is allocated right after the IN endpoint
+	RawHIDDescriptor hidInterface = {
+		D_INTERFACE(pluggedInterface, 2, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_NONE, HID_PROTOCOL_NONE),
+		D_HIDREPORT(RawHIDReportDescriptor::size),
+		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, RAWHID_EP_SIZE, HID_INTERVAL_RAWHID),
+		D_ENDPOINT(USB_ENDPOINT_OUT(pluggedEndpoint + 1), USB_ENDPOINT_TYPE_INTERRUPT, RAWHID_EP_SIZE, HID_INTERVAL_RAWHID)
+	};
+#else
 	HIDDescriptor hidInterface = {
 		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_NONE, HID_PROTOCOL_NONE),
-		D_HIDREPORT(sizeof(_hidReportDescriptorRawHID)),
-		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, 0x01)
+		D_HIDREPORT(RawHIDReportDescriptor::size),
+		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, RAWHID_EP_SIZE, HID_INTERVAL_RAWHID)
 	};
+#endif
 	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
 }
 
@@ -78,7 +160,7 @@ int RawHID_::getDescriptor(USBSetup& setup)
 	// due to the USB specs, but Windows and Linux just assumes its in report mode.
 	protocol = HID_REPORT_PROTOCOL;
 
-	return USB_SendControl(TRANSFER_PGM, _hidReportDescriptorRawHID, sizeof(_hidReportDescriptorRawHID));
+	return USB_SendControl(TRANSFER_PGM, RawHIDReportDescriptor::data, RawHIDReportDescriptor::size);
 }
 
 bool RawHID_::setup(USBSetup& setup)
@@ -93,11 +175,55 @@ bool RawHID_::setup(USBSetup& setup)
 	if (requestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE)
 	{
 		if (request == HID_GET_REPORT) {
-			// TODO: HID_GetReport();
-			return true;
+			if (setup.wValueH != HID_REPORT_TYPE_FEATURE && setup.wValueH != HID_REPORT_TYPE_INPUT) {
+				return false;
+			}
+
+#if RAWHID_TIMESTAMP
+			// Device clock for the synchronization of the host, sampled as
+			// late as possible. The reply starts with its ID like a numbered report.
+			if (setup.wValueH == HID_REPORT_TYPE_FEATURE && setup.wValueL == RAWHID_CLOCK_ID) {
+				uint32_t now = micros();
+				uint16_t sequence = txSequence;
+				uint8_t report[RAWHID_CLOCK_SIZE] = {
+					RAWHID_CLOCK_ID,
+					uint8_t(now), uint8_t(now >> 8), uint8_t(now >> 16), uint8_t(now >> 24),
+					uint8_t(sequence), uint8_t(sequence >> 8),
+					0
+				};
+				USB_SendControl(0, report, min(RAWHID_CLOCK_SIZE, (int)setup.wLength));
+				return true;
+			}
+#endif
+
+			// Download of a feature transfer
+			if (transfer && setup.wValueH == HID_REPORT_TYPE_FEATURE) {
+				return transfer->getReport(setup.wLength);
+			}
+
+			// The published snapshot, the sketch only writes the other buffer.
+			// With HID_STATS the feature report belongs to the statistics.
+			if (snapshotLength && (!HID_STATS || setup.wValueH == HID_REPORT_TYPE_INPUT)) {
+				USB_SendControl(0, snapshotData + snapshotFront * snapshotLength, min(snapshotLength, (int)setup.wLength));
+				return true;
+			}
+#if HID_STATS
+			// Vendor feature report with the counters of all interfaces
+			if (setup.wValueH == HID_REPORT_TYPE_FEATURE) {
+				uint8_t report[HID_STATS_REPORT_SIZE];
+				int length = HIDStats::getReport(report);
+				USB_SendControl(0, report, min(length, (int)setup.wLength));
+				return true;
+			}
+#endif
+			return false;
 		}
 		if (request == HID_GET_PROTOCOL) {
-			// TODO: Send8(protocol);
+			USB_SendControl(0, &protocol, 1);
+			return true;
+		}
+		if (request == HID_GET_IDLE) {
+			USB_SendControl(0, &idle, 1);
 			return true;
 		}
 	}
@@ -119,13 +245,15 @@ bool RawHID_::setup(USBSetup& setup)
 
 			// Feature (set feature report)
 			if(setup.wValueH == HID_REPORT_TYPE_FEATURE){
-				// No need to check for negative featureLength values,
-				// except the host tries to send more then 32k bytes.
-				// We dont have that much ram anyways.
-				if (length == featureLength) {
+				if (transfer) {
+					return transfer->setReport(length);
+				}
+
+				// The sketch owns the buffer until it enables the report again
+				if (!featureBlocked && featureReport && length == featureLength) {
 					USB_RecvControl(featureReport, featureLength);
 
-					// Block until data is read (make length negative)
+					// Block until data is read
 					disableFeatureReport();
 					return true;
 				}
@@ -133,12 +261,17 @@ bool RawHID_::setup(USBSetup& setup)
 
 			// Output (set out report)
 			else if(setup.wValueH == HID_REPORT_TYPE_OUTPUT){
-				if(!dataAvailable && length <= dataLength){
-					// Write data to fit to the end (not the beginning) of the array
-					USB_RecvControl(data + dataLength - length, length);
-					dataAvailable = length;
+				// Only accept data if enabled and a slot is free
+				if(dataAvailable >= 0 && length <= dataLength && (uint8_t)(rxHead - rxTail) < RAWHID_RX_SLOTS){
+					// Write data to fit to the end (not the beginning) of the slot
+					USB_RecvControl(slot(rxHead) + dataLength - length, length);
+					rxLength[rxHead % RAWHID_RX_SLOTS] = length;
+					rxHead++;
 					return true;
 				}
+#if HID_STATS
+				stats.dropped++;
+#endif
 			}
 		}
 	}
@@ -146,4 +279,227 @@ bool RawHID_::setup(USBSetup& setup)
 	return false;
 }
 
+void RawHID_::fetchReport(void)
+{
+	// Current report is still being read or receiving is disabled
+	if (dataAvailable) {
+		return;
+	}
+
+#if RAWHID_USE_OUT_ENDPOINT
+	// Move reports from the endpoint bank into free slots.
+	// Until a slot gets free the data stays in the bank and the host gets NAKed.
+	// The head is owned by the USB interrupt, so keep it away meanwhile.
+	noInterrupts();
+	while ((uint8_t)(rxHead - rxTail) < RAWHID_RX_SLOTS) {
+		int length = USB_Available(pluggedEndpoint + 1);
+		if (length <= 0) {
+			break;
+		}
+
+		if (length <= dataLength) {
+#if RAWHID_STREAMING && defined(ARDUINO_ARCH_SAM)
+			receiveStream(length);
+#else
+			// Write data to fit to the end (not the beginning) of the slot
+			USB_Recv(pluggedEndpoint + 1, slot(rxHead) + dataLength - length, length);
+#endif
+			rxLength[rxHead % RAWHID_RX_SLOTS] = length;
+			rxHead++;
+		}
+		else {
+			// Report does not fit into the slot, discard it
+			while (USB_Available(pluggedEndpoint + 1)) {
+#if RAWHID_STREAMING && defined(ARDUINO_ARCH_SAM)
+				receiveStream(min((int)USB_Available(pluggedEndpoint + 1), dataLength));
+#else
+				USB_Recv(pluggedEndpoint + 1);
+#endif
+			}
+#if HID_STATS
+			stats.dropped++;
+#endif
+		}
+	}
+	interrupts();
+#endif
+
+	// Load the next report
+	if (rxHead != rxTail) {
+		dataAvailable = rxLength[rxTail % RAWHID_RX_SLOTS];
+	}
+}
+
+#if RAWHID_TIMESTAMP
+size_t RawHID_::sendStamped(const uint8_t* buffer, size_t size, uint32_t queued)
+{
+	uint8_t report[RAWHID_SIZE];
+	size_t sent = 0;
+	while (sent < size) {
+		size_t length = min(size - sent, (size_t)RAWHID_TX_SIZE);
+		memcpy(report, buffer + sent, length);
+		memset(report + length, 0x00, RAWHID_TX_SIZE - length);
+
+		// Later reports of a long write() also count the time of the ones before
+		uint32_t now = micros();
+		uint32_t waited = now - queued;
+		if (waited > 0xFFFF) {
+			waited = 0xFFFF;
+		}
+		uint16_t sequence = txSequence;
+		uint8_t* trailer = report + RAWHID_TX_SIZE;
+		trailer[0] = now;
+		trailer[1] = now >> 8;
+		trailer[2] = now >> 16;
+		trailer[3] = now >> 24;
+		trailer[4] = waited;
+		trailer[5] = waited >> 8;
+		trailer[6] = sequence;
+		trailer[7] = sequence >> 8;
+
+		if ((int)sendReports(report, RAWHID_SIZE) <= 0) {
+			break;
+		}
+		txSequence = sequence + 1;
+		sent += length;
+	}
+	return sent;
+}
+#endif
+
+#if RAWHID_HIGH_SPEED
+int RawHID_::sendHighSpeed(const uint8_t* buffer, size_t size)
+{
+	if (!USBDevice.configured()) {
+		return -1;
+	}
+
+	// Write up to one full report per packet and release the bank
+	size_t sent = 0;
+	while (sent < size) {
+		uint32_t length = min(size - sent, (size_t)RAWHID_SIZE);
+		UDD_Send(pluggedEndpoint, buffer + sent, length);
+		USB_Flush(pluggedEndpoint);
+		sent += length;
+	}
+	return sent;
+}
+#endif
+
+#if RAWHID_STREAMING
+bool RawHID_::writeStream(const void* buffer, size_t length)
+{
+	if (writing() || !USBDevice.configured()) {
+		return false;
+	}
+#if RAWHID_TX_BUFFER
+	// Keep the order of the collected bytes
+	flush();
+#endif
+	HID_STATS_START();
+#if defined(ARDUINO_ARCH_SAMD)
+	// The controller also only reads from word aligned addresses
+	if ((uintptr_t)buffer < RAWHID_STREAM_RAM || ((uintptr_t)buffer & 3)) {
+		return (size_t)HID_STATS_RECORD(stats, length, USB_Send(pluggedEndpoint | TRANSFER_RELEASE, buffer, length)) == length;
+	}
+#else
+	if ((uintptr_t)buffer < RAWHID_STREAM_RAM) {
+		return (size_t)HID_STATS_RECORD(stats, length, sendStream((const uint8_t*)buffer, length)) == length;
+	}
+#endif
+	streamData = (const uint8_t*)buffer;
+	streamRemaining = length;
+	startStream();
+#if HID_STATS
+	HID_STATS_RECORD(stats, length, length);
+#endif
+	return true;
+}
+
+bool RawHID_::writing(void)
+{
+#if defined(ARDUINO_ARCH_SAMD)
+	if (USB->DEVICE.DeviceEndpoint[pluggedEndpoint].EPSTATUS.bit.BK1RDY) {
+		return true;
+	}
+#else
+	if (UOTGHS->UOTGHS_DEVDMA[pluggedEndpoint - 1].UOTGHS_DEVDMASTATUS & UOTGHS_DEVDMASTATUS_CHANN_ENB) {
+		return true;
+	}
+#endif
+	if (streamRemaining && USBDevice.configured()) {
+		startStream();
+		return true;
+	}
+	streamRemaining = 0;
+	return false;
+}
+
+void RawHID_::startStream(void)
+{
+	size_t length = min(streamRemaining, (size_t)RAWHID_STREAM_CHUNK);
+#if defined(ARDUINO_ARCH_SAMD)
+	// Multi-packet transfer straight from the buffer, the core sets
+	// its own buffer address again with the next USB_Send().
+	UsbDeviceDescriptor* desc = (UsbDeviceDescriptor*)USB->DEVICE.DESCADD.reg;
+	UsbDeviceDescBank* bank = &desc[pluggedEndpoint].DeviceDescBank[1];
+	bank->ADDR.reg = (uintptr_t)streamData;
+	bank->PCKSIZE.bit.MULTI_PACKET_SIZE = 0;
+	bank->PCKSIZE.bit.BYTE_COUNT = length;
+	bank->PCKSIZE.bit.AUTO_ZLP = 0;
+	USB->DEVICE.DeviceEndpoint[pluggedEndpoint].EPINTFLAG.reg = USB_DEVICE_EPINTFLAG_TRCPT1;
+	USB->DEVICE.DeviceEndpoint[pluggedEndpoint].EPSTATUSSET.reg = USB_DEVICE_EPSTATUSSET_BK1RDY;
+#else
+	// The channel fills the banks, a short report is sent at the end of the buffer
+	UotghsDevdma* dma = &UOTGHS->UOTGHS_DEVDMA[pluggedEndpoint - 1];
+	dma->UOTGHS_DEVDMAADDRESS = (uintptr_t)streamData;
+	dma->UOTGHS_DEVDMACONTROL = UOTGHS_DEVDMACONTROL_BUFF_LENGTH(length) |
+		UOTGHS_DEVDMACONTROL_END_B_EN | UOTGHS_DEVDMACONTROL_CHANN_ENB;
+#endif
+	streamData += length;
+	streamRemaining -= length;
+}
+
+#if defined(ARDUINO_ARCH_SAM)
+int RawHID_::sendStream(const uint8_t* buffer, size_t size)
+{
+	if (!USBDevice.configured()) {
+		return -1;
+	}
+
+	// Data from the flash is copied report by report
+	bool ram = (uintptr_t)buffer >= RAWHID_STREAM_RAM;
+	uint8_t report[RAWHID_TX_SIZE];
+	size_t sent = 0;
+	while (sent < size) {
+		size_t length = ram ? size - sent : min(size - sent, (size_t)RAWHID_TX_SIZE);
+		if (!ram) {
+			memcpy(report, buffer + sent, length);
+		}
+		streamData = ram ? buffer + sent : report;
+		streamRemaining = length;
+		startStream();
+		while (writing());
+		sent += length;
+	}
+	return sent;
+}
+
+#if RAWHID_USE_OUT_ENDPOINT
+void RawHID_::receiveStream(int length)
+{
+	// The report ends the transfer, a short one is moved to the end of the slot
+	UotghsDevdma* dma = &UOTGHS->UOTGHS_DEVDMA[pluggedEndpoint];
+	dma->UOTGHS_DEVDMAADDRESS = (uintptr_t)slot(rxHead);
+	dma->UOTGHS_DEVDMACONTROL = UOTGHS_DEVDMACONTROL_BUFF_LENGTH(length) |
+		UOTGHS_DEVDMACONTROL_END_TR_EN | UOTGHS_DEVDMACONTROL_END_B_EN | UOTGHS_DEVDMACONTROL_CHANN_ENB;
+	while (dma->UOTGHS_DEVDMASTATUS & UOTGHS_DEVDMASTATUS_CHANN_ENB);
+	if (length < dataLength) {
+		memmove(slot(rxHead) + dataLength - length, slot(rxHead), length);
+	}
+}
+#endif
+#endif
+#endif
+
 RawHID_ RawHID;
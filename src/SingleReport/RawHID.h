@@ -25,8 +25,11 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
+#include "../HID-Descriptor.h"
+#include "../HID-Stats.h"
+#include "../HID-Queue.h"
+#include "../HID-Transfer.h"
 
 // RawHID might never work with multireports, because of OS problems
 // therefore we have to make it a single report with no ID. No other HID device will be supported then.
@@ -36,27 +39,64 @@ THE SOFTWARE.
 #undef RAWHID_USAGE
 #define RAWHID_USAGE		0x0C00 // recommended: 0x0100 to 0xFFFF
 
+#if RAWHID_USE_OUT_ENDPOINT
+#define RAWHID_ENDPOINT_COUNT 2
+#else
+#define RAWHID_ENDPOINT_COUNT 1
+#endif
+
+#if (RAWHID_RX_SLOTS & (RAWHID_RX_SLOTS - 1)) || (RAWHID_RX_SLOTS > 128)
+#error RAWHID_RX_SLOTS needs to be a power of two (1 - 128).
+#endif
+
+#if RAWHID_HIGH_SPEED
+#if !defined(ARDUINO_ARCH_SAM)
+#error RAWHID_HIGH_SPEED is only supported on SAM (Arduino Due).
+#endif
+#define RAWHID_EP_SIZE 512
+#else
+#define RAWHID_EP_SIZE USB_EP_SIZE
+#endif
+
+#if RAWHID_STREAMING && !defined(ARDUINO_ARCH_SAMD) && !defined(ARDUINO_ARCH_SAM)
+#error RAWHID_STREAMING is only supported on SAMD and SAM.
+#endif
+
 // Keep one byte offset for the reportID if used
 #if (HID_REPORTID_RAWHID)
-#define RAWHID_SIZE (USB_EP_SIZE-1)
+#define RAWHID_SIZE (RAWHID_EP_SIZE-1)
 #error RAWHID does not work properly with a report ID and multiple reports.
 #error Please remove this manually if you know what you are doing.
 #else
-#define RAWHID_SIZE (USB_EP_SIZE)
+#define RAWHID_SIZE (RAWHID_EP_SIZE)
+#endif
+
+#if RAWHID_TIMESTAMP && RAWHID_STREAMING
+#error RAWHID_TIMESTAMP can not be used with RAWHID_STREAMING.
 #endif
 
+// Report ID (wValueL) of the clock feature report: the ID, micros() (4 bytes),
+// the next sequence number (2 bytes) and one reserved byte
+#define RAWHID_CLOCK_ID 0x43
+#define RAWHID_CLOCK_SIZE 8
+#define RAWHID_TRAILER_SIZE 8
+
 #undef RAWHID_TX_SIZE
+#if RAWHID_TIMESTAMP
+#define RAWHID_TX_SIZE (RAWHID_SIZE - RAWHID_TRAILER_SIZE)
+#else
 #define RAWHID_TX_SIZE RAWHID_SIZE
+#endif
 
 #undef RAWHID_RX_SIZE
 #define RAWHID_RX_SIZE RAWHID_SIZE
 
 typedef union ATTRIBUTE_PACKED {
-	// a RAWHID_TX_SIZE byte buffer for tx
+	// a RAWHID_SIZE byte buffer for tx, the sketch fills RAWHID_TX_SIZE of it
 	uint8_t whole8[0];
 	uint16_t whole16[0];
 	uint32_t whole32[0];
-	uint8_t buff[RAWHID_TX_SIZE];
+	uint8_t buff[RAWHID_SIZE];
 } HID_RawKeyboardTXReport_Data_t;
 
 typedef union ATTRIBUTE_PACKED {
@@ -74,34 +114,73 @@ public:
 
     void setFeatureReport(void* report, int length){
         if(length > 0){
+            // Disable feature report by default, before the USB interrupt
+            // can see the new buffer
+            disableFeatureReport();
             featureReport = (uint8_t*)report;
             featureLength = length;
-
-            // Disable feature report by default
-            disableFeatureReport();
         }
     }
 
     int availableFeatureReport(void){
-        if(featureLength < 0){
-            return featureLength & ~0x8000;
+        if(featureBlocked){
+            return featureLength;
         }
         return 0;
     }
 
+    // The USB interrupt only writes the report while it is enabled, the
+    // flag is a single byte so no interrupts have to be disabled
     void enableFeatureReport(void){
-        featureLength &= ~0x8000;
+        featureBlocked = false;
     }
 
     void disableFeatureReport(void){
-        featureLength |= 0x8000;
+        featureBlocked = true;
+    }
+
+    // Feature reports carry uploads and downloads with offsets instead,
+    // NULL goes back to the single feature report
+    void setFeatureTransfer(HIDFeatureTransfer* t){
+        transfer = t;
+    }
+
+    // Device state the host can poll with GET_REPORT (Feature or Input),
+    // without using the interrupt endpoint. The buffer holds two copies of
+    // length bytes: the host reads the published one, the sketch fills
+    // the other one via snapshot() and swaps them with publishSnapshot().
+    // With HID_STATS the Feature report stays the statistics report, the
+    // snapshot is then only read as Input report.
+    void setSnapshot(void* buffer, int length){
+        snapshotLength = 0;
+        snapshotData = (uint8_t*)buffer;
+        snapshotFront = 0;
+        memset(snapshotData, 0, 2 * length);
+        snapshotLength = length;
+    }
+
+    // Back buffer, starts with the content of the published snapshot
+    uint8_t* snapshot(void){
+        return snapshotData + (snapshotFront ^ 1) * snapshotLength;
+    }
+
+    void publishSnapshot(void){
+        if(!snapshotLength){
+            return;
+        }
+        // GET_REPORT is answered in the USB interrupt, swap atomically
+        noInterrupts();
+        snapshotFront ^= 1;
+        interrupts();
+        memcpy(snapshot(), snapshotData + snapshotFront * snapshotLength, snapshotLength);
     }
 
 	void begin(void* report, int length){
-        if(length > 0){
+        if(length >= RAWHID_RX_SLOTS){
+            disable();
             data = (uint8_t*)report;
-            dataLength = length;
-            dataAvailable = 0;
+            dataLength = length / RAWHID_RX_SLOTS;
+            enable();
         }
 	}
 
@@ -111,14 +190,22 @@ public:
 	}
 
 	void enable(void){
+		// Drop the rest of the current report (if any)
+		releasePacket();
 		dataAvailable = 0;
 	}
 
 	void disable(void){
+		// Stop receiving first, then drop all pending reports
 		dataAvailable = -1;
+		rxTail = rxHead;
 	}
 
 	virtual int available(void){
+#if RAWHID_TX_BUFFER
+		poll();
+#endif
+		fetchReport();
 		if(dataAvailable < 0){
 			return 0;
 		}
@@ -127,43 +214,207 @@ public:
 
 	virtual int read(){
 		// Check if we have data available
+		fetchReport();
 		if(dataAvailable > 0)
 		{
 			// Get next data byte (from the start to the end)
-			return data[dataLength - dataAvailable--];
+			int b = slot(rxTail)[dataLength - dataAvailable--];
+
+			// Release the slot once the report was read completely
+			if(!dataAvailable){
+				rxTail++;
+			}
+			return b;
 		}
 		return -1;
 	}
 
 	virtual int peek(){
 		// Check if we have data available
+		fetchReport();
 		if(dataAvailable > 0){
-			return data[dataLength - dataAvailable];
+			return slot(rxTail)[dataLength - dataAvailable];
 		}
 		return -1;
 	}
 
+	// Get the unread part of the current report in place, without copying.
+	// The data stays valid until releasePacket() is called.
+	int readPacket(const uint8_t** report){
+		fetchReport();
+		if(dataAvailable > 0){
+			*report = slot(rxTail) + dataLength - dataAvailable;
+			return dataAvailable;
+		}
+		return 0;
+	}
+
+	// Free the slot of the current report for the next one
+	void releasePacket(void){
+		if(dataAvailable > 0){
+			dataAvailable = 0;
+			rxTail++;
+		}
+	}
+
+	// Fill the returned buffer directly and send it with commitPacket()
+	uint8_t* acquirePacket(void){
+#if RAWHID_TX_BUFFER
+		// write(uint8_t) collects into the same buffer, it fails until the commit
+		flush();
+		txAcquired = true;
+#endif
+		return txReport.buff;
+	}
+
+	int commitPacket(int length = RAWHID_TX_SIZE){
+#if RAWHID_TX_BUFFER
+		txAcquired = false;
+#endif
+		if(length > RAWHID_TX_SIZE){
+			length = RAWHID_TX_SIZE;
+		}
+		return write(txReport.buff, length);
+	}
+
+	// Room for a whole report, 0 while the endpoint is busy.
+	// Only AVR can check the endpoint, other cores always have room.
+	virtual int availableForWrite(void){
+		return HIDReportQueue::sendSpace(pluggedEndpoint, RAWHID_TX_SIZE) ? RAWHID_TX_SIZE : 0;
+	}
+
 	virtual void flush(void){
-		// Writing will always flush by the USB driver
+#if RAWHID_TX_BUFFER
+		// Send the collected bytes as one (short) report
+		if(txLength){
+			int length = txLength;
+			txLength = 0;
+#if RAWHID_TIMESTAMP
+			sendStamped(txReport.buff, length, txQueued);
+#else
+			send(txReport.buff, length);
+#endif
+		}
+#endif
+		// Everything else is flushed by the USB driver
 	}
 
+#if RAWHID_TX_BUFFER
+	// Send the collected bytes once they are older than RAWHID_TX_TIMEOUT
+	void poll(void){
+		if(txLength && (uint16_t)((uint16_t)millis() - txStart) >= RAWHID_TX_TIMEOUT){
+			flush();
+		}
+	}
+#endif
+
 	// Wrapper for a single byte
 	using Print::write;
 	virtual size_t write(uint8_t b){
+#if RAWHID_TX_BUFFER
+		if(txAcquired){
+			return 0;
+		}
+		poll();
+		if(!txLength){
+			txStart = millis();
+#if RAWHID_TIMESTAMP
+			txQueued = micros();
+#endif
+		}
+		txReport.buff[txLength++] = b;
+
+		// Send whole lines and full reports right away
+		if(b == '\n' || txLength >= RAWHID_TX_SIZE){
+			flush();
+		}
+		return 1;
+#else
 		return write(&b, 1);
+#endif
 	}
 
 	virtual size_t write(uint8_t *buffer, size_t size){
-		return USB_Send(pluggedEndpoint | TRANSFER_RELEASE, buffer, size);
+#if RAWHID_TX_BUFFER
+		// Keep the order of the collected bytes
+		flush();
+#endif
+		return send(buffer, size);
 	}
 
+#if RAWHID_STREAMING
+	// Send length bytes as back to back reports, only the last one may be short.
+	// Returns false while the previous transfer is running. The data has to
+	// stay valid until writing() returns false. SAMD needs a 4 byte aligned buffer.
+	bool writeStream(const void* buffer, size_t length);
+
+	// Continues long transfers, returns true while data is being sent
+	bool writing(void);
+#endif
+
 protected:
     // Implementation of the PUSBListNode
     int getInterface(uint8_t* interfaceCount);
     int getDescriptor(USBSetup& setup);
     bool setup(USBSetup& setup);
 
-    EPTYPE_DESCRIPTOR_SIZE epType[1];
+    // Load the next buffered report if the current one was read completely
+    void fetchReport(void);
+
+    // Send a report (or several) right away
+    size_t send(uint8_t* buffer, size_t size){
+#if RAWHID_TIMESTAMP
+        return sendStamped(buffer, size, micros());
+#else
+        return sendReports(buffer, size);
+#endif
+    }
+
+    size_t sendReports(uint8_t* buffer, size_t size){
+        HID_STATS_START();
+#if RAWHID_STREAMING
+        // The controller might still read the buffer of writeStream()
+        while (writing());
+#endif
+#if RAWHID_STREAMING && defined(ARDUINO_ARCH_SAM)
+        return HID_STATS_RECORD(stats, size, sendStream(buffer, size));
+#elif RAWHID_HIGH_SPEED
+        return HID_STATS_RECORD(stats, size, sendHighSpeed(buffer, size));
+#else
+        return HID_STATS_RECORD(stats, size, USB_Send(pluggedEndpoint | TRANSFER_RELEASE, buffer, size));
+#endif
+    }
+
+#if RAWHID_TIMESTAMP
+    // Split into RAWHID_TX_SIZE payloads and send each with its trailer,
+    // queued is the micros() timestamp of the write()
+    size_t sendStamped(const uint8_t* buffer, size_t size, uint32_t queued);
+#endif
+
+#if RAWHID_HIGH_SPEED
+    // USB_Send() splits into EPX_SIZE packets, this writes whole reports
+    int sendHighSpeed(const uint8_t* buffer, size_t size);
+#endif
+
+#if RAWHID_STREAMING
+    // Start the next part of the transfer, the controller limits its length
+    void startStream(void);
+#if defined(ARDUINO_ARCH_SAM)
+    // Blocking write() without the FIFO copy
+    int sendStream(const uint8_t* buffer, size_t size);
+#if RAWHID_USE_OUT_ENDPOINT
+    // Move one OUT report of the bank into the head slot
+    void receiveStream(int length);
+#endif
+#endif
+#endif
+
+    // Reports are stored at the end of their slot, like with a single buffer
+    uint8_t* slot(uint8_t index){
+        return data + (index % RAWHID_RX_SLOTS) * dataLength;
+    }
+
+    EPTYPE_DESCRIPTOR_SIZE epType[RAWHID_ENDPOINT_COUNT];
     uint8_t protocol;
     uint8_t idle;
 
@@ -172,7 +423,48 @@ protected:
 	int dataAvailable;
 	uint8_t* data;
 
+	// Ring of received reports. The head is only written by the USB interrupt,
+	// the tail only by the sketch. Both count up and wrap around at 256.
+	volatile uint8_t rxHead;
+	volatile uint8_t rxTail;
+	int rxLength[RAWHID_RX_SLOTS];
+
 	uint8_t* featureReport;
 	int featureLength;
+	volatile bool featureBlocked;
+	HIDFeatureTransfer* transfer;
+
+	// Double buffered snapshot for GET_REPORT
+	uint8_t* snapshotData;
+	int snapshotLength;
+	volatile uint8_t snapshotFront;
+
+	// Send buffer for acquirePacket(), also collects the bytes of write(uint8_t)
+	HID_RawKeyboardTXReport_Data_t txReport;
+#if RAWHID_TX_BUFFER
+	int txLength;
+	uint16_t txStart;
+	bool txAcquired;
+#if RAWHID_TIMESTAMP
+	uint32_t txQueued;
+#endif
+#endif
+
+#if RAWHID_TIMESTAMP
+	// Sequence number of the next report
+	volatile uint16_t txSequence;
+#endif
+
+#if RAWHID_STREAMING
+	// Rest of the writeStream() transfer
+	const uint8_t* streamData;
+	size_t streamRemaining;
+#endif
+
+#if HID_STATS
+public:
+	// Send counters of this interface, dropped counts discarded OUT reports
+	HIDStats stats;
+#endif
 };
 extern RawHID_ RawHID;
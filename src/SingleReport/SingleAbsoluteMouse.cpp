@@ -67,87 +67,18 @@ static const uint8_t _hidSingleReportDescriptorAbsoluteMouse[] PROGMEM = {
 };
 
 
-SingleAbsoluteMouse_::SingleAbsoluteMouse_(void) : PluggableUSBModule(1, 1, epType), protocol(HID_REPORT_PROTOCOL), idle(1)
+SingleAbsoluteMouse_::SingleAbsoluteMouse_(void) : HIDSingleReportDevice(_hidSingleReportDescriptorAbsoluteMouse, sizeof(_hidSingleReportDescriptorAbsoluteMouse),
+	HID_INTERVAL_MOUSE_ABSOLUTE, 0, true)
 {
-	epType[0] = EP_TYPE_INTERRUPT_IN;
-	PluggableUSB().plug(this);
 }
 
-int SingleAbsoluteMouse_::getInterface(uint8_t* interfaceCount)
-{
-	*interfaceCount += 1; // uses 1
-	HIDDescriptor hidInterface = {
-		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_NONE, HID_PROTOCOL_NONE),
-		D_HIDREPORT(sizeof(_hidSingleReportDescriptorAbsoluteMouse)),
-		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, 0x01)
-	};
-	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
-}
-
-int SingleAbsoluteMouse_::getDescriptor(USBSetup& setup)
-{
-	// In a HID Class Descriptor wIndex cointains the interface number
-	if (setup.wIndex != pluggedInterface) { return 0; }
-
-	// Check if this is a HID Class Descriptor request
-	if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE) { return 0; }
-
-	if (setup.wValueH == HID_HID_DESCRIPTOR_TYPE) {
-		// Apple UEFI and USBCV wants it
-		HIDDescDescriptor desc = D_HIDREPORT(sizeof(_hidSingleReportDescriptorAbsoluteMouse));
-		return USB_SendControl(0, &desc, sizeof(desc));
-	} else if (setup.wValueH == HID_REPORT_DESCRIPTOR_TYPE) {
-		// Reset the protocol on reenumeration. Normally the host should not assume the state of the protocol
-		// due to the USB specs, but Windows and Linux just assumes its in report mode.
-		protocol = HID_REPORT_PROTOCOL;
-		return USB_SendControl(TRANSFER_PGM, _hidSingleReportDescriptorAbsoluteMouse, sizeof(_hidSingleReportDescriptorAbsoluteMouse));
-	}
-
-	return 0;
-}
-
-bool SingleAbsoluteMouse_::setup(USBSetup& setup)
+void SingleAbsoluteMouse_::SendReport(void* data, int length)
 {
-	if (pluggedInterface != setup.wIndex) {
-		return false;
-	}
-
-	uint8_t request = setup.bRequest;
-	uint8_t requestType = setup.bmRequestType;
-
-	if (requestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE)
-	{
-		if (request == HID_GET_REPORT) {
-			// TODO: HID_GetReport();
-			return true;
-		}
-		if (request == HID_GET_PROTOCOL) {
-			// TODO: Send8(protocol);
-			return true;
-		}
-	}
-
-	if (requestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE)
-	{
-		if (request == HID_SET_PROTOCOL) {
-			protocol = setup.wValueL;
-			return true;
-		}
-		if (request == HID_SET_IDLE) {
-			idle = setup.wValueH;
-			return true;
-		}
-		if (request == HID_SET_REPORT)
-		{
-		}
-	}
-
-	return false;
+	sendReport(data, length);
 }
 
-void SingleAbsoluteMouse_::SendReport(void* data, int length)
-{
-	USB_Send(pluggedEndpoint | TRANSFER_RELEASE, data, length);
+bool SingleAbsoluteMouse_::ReadyToSend(void){
+	return readyToSend(sizeof(HID_MouseAbsoluteReport_Data_t));
 }
 
 SingleAbsoluteMouse_ SingleAbsoluteMouse;
@@ -25,29 +25,20 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/AbsoluteMouseAPI.h"
+#include "../HID-SingleReport.h"
 
 
-class SingleAbsoluteMouse_ : public PluggableUSBModule, public AbsoluteMouseAPI
+class SingleAbsoluteMouse_ : public HIDSingleReportDevice<HID_MouseAbsoluteReport_Data_t>, public AbsoluteMouseAPI
 {
 public:
     SingleAbsoluteMouse_(void);
     uint8_t getLeds(void);
-    uint8_t getProtocol(void);
 
 protected:
-    // Implementation of the PUSBListNode
-    int getInterface(uint8_t* interfaceCount);
-    int getDescriptor(USBSetup& setup);
-    bool setup(USBSetup& setup);
-    
-    EPTYPE_DESCRIPTOR_SIZE epType[1];
-    uint8_t protocol;
-    uint8_t idle;
-    
     virtual inline void SendReport(void* data, int length) override;
+    virtual bool ReadyToSend(void) override;
 };
 extern SingleAbsoluteMouse_ SingleAbsoluteMouse;
 
@@ -25,28 +25,18 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/ConsumerAPI.h"
+#include "../HID-SingleReport.h"
 
 
-class SingleConsumer_ : public PluggableUSBModule, public ConsumerAPI
+class SingleConsumer_ : public HIDSingleReportDevice<HID_ConsumerControlReport_Data_t>, public ConsumerAPI
 {
 public:
     SingleConsumer_(void);
     uint8_t getLeds(void);
-    uint8_t getProtocol(void);
 
 protected:
-    // Implementation of the PUSBListNode
-    int getInterface(uint8_t* interfaceCount);
-    int getDescriptor(USBSetup& setup);
-    bool setup(USBSetup& setup);
-    
-    EPTYPE_DESCRIPTOR_SIZE epType[1];
-    uint8_t protocol;
-    uint8_t idle;
-    
     virtual inline void SendReport(void* data, int length) override;
 };
 extern SingleConsumer_ SingleConsumer;
@@ -25,26 +25,18 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/GamepadAPI.h"
+#include "../HID-SingleReport.h"
+#include "../HID-Update.h"
 
 
-class SingleGamepad_ : public PluggableUSBModule, public GamepadAPI
+class SingleGamepad_ : public HIDSingleReportDevice<HID_GamepadReport_Data_t>, public GamepadAPI, public HIDReportUpdate
 {
 public:
     SingleGamepad_(void);
 
 protected:
-    // Implementation of the PUSBListNode
-    int getInterface(uint8_t* interfaceCount);
-    int getDescriptor(USBSetup& setup);
-    bool setup(USBSetup& setup);
-    
-    EPTYPE_DESCRIPTOR_SIZE epType[1];
-    uint8_t protocol;
-    uint8_t idle;
-    
     virtual void SendReport(void* data, int length) override;
 };
 extern SingleGamepad_ Gamepad1;
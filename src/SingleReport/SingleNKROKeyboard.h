@@ -25,31 +25,35 @@ THE SOFTWARE.
 #pragma once
 
 #include <Arduino.h>
-#include "HID.h"
 #include "HID-Settings.h"
 #include "../HID-APIs/NKROKeyboardAPI.h"
+#include "../HID-SingleReport.h"
+#include "../HID-Leds.h"
 
 
-class SingleNKROKeyboard_ : public PluggableUSBModule, public NKROKeyboardAPI
+class SingleNKROKeyboard_ : public HIDSingleReportDevice<HID_NKROKeyboardReport_Data_t>, public NKROKeyboardAPI
 {
 public:
     SingleNKROKeyboard_(void);
     uint8_t getLeds(void);
-    uint8_t getProtocol(void);
+
+    // Called from the USB interrupt for every LED report of the host
+    void onLeds(HIDLedReport::Callback callback){
+        leds.onReport(callback);
+    }
+
+    // Number of received LED reports, wraps around at 256
+    uint8_t getLedsSequence(void){
+        return leds.sequence();
+    }
     
     virtual int send(void) final;
 
 protected:
-    // Implementation of the PUSBListNode
-    int getInterface(uint8_t* interfaceCount);
-    int getDescriptor(USBSetup& setup);
-    bool setup(USBSetup& setup);
-    
-    EPTYPE_DESCRIPTOR_SIZE epType[1];
-    uint8_t protocol;
-    uint8_t idle;
-    
-    uint8_t leds;
+    HIDLedReport leds;
+    virtual bool readLeds(uint8_t& state) override;
+
+    virtual bool onSetReport(USBSetup& setup) override;
 };
 extern SingleNKROKeyboard_ SingleNKROKeyboard;
 
@@ -41,81 +41,13 @@ static const uint8_t _hidSingleReportDescriptorSystem[] PROGMEM = {
 };
 
 
-SingleSystem_::SingleSystem_(void) : PluggableUSBModule(1, 1, epType), protocol(HID_REPORT_PROTOCOL), idle(1)
+SingleSystem_::SingleSystem_(void) : HIDSingleReportDevice(_hidSingleReportDescriptorSystem, sizeof(_hidSingleReportDescriptorSystem), HID_INTERVAL_SYSTEMCONTROL)
 {
-	epType[0] = EP_TYPE_INTERRUPT_IN;
-	PluggableUSB().plug(this);
-}
-
-int SingleSystem_::getInterface(uint8_t* interfaceCount)
-{
-	*interfaceCount += 1; // uses 1
-	HIDDescriptor hidInterface = {
-		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_NONE, HID_PROTOCOL_NONE),
-		D_HIDREPORT(sizeof(_hidSingleReportDescriptorSystem)),
-		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, 0x01)
-	};
-	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
-}
-
-int SingleSystem_::getDescriptor(USBSetup& setup)
-{
-	// Check if this is a HID Class Descriptor request
-	if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE) { return 0; }
-	if (setup.wValueH != HID_REPORT_DESCRIPTOR_TYPE) { return 0; }
-
-	// In a HID Class Descriptor wIndex cointains the interface number
-	if (setup.wIndex != pluggedInterface) { return 0; }
-
-	// Reset the protocol on reenumeration. Normally the host should not assume the state of the protocol
-	// due to the USB specs, but Windows and Linux just assumes its in report mode.
-	protocol = HID_REPORT_PROTOCOL;
-
-	return USB_SendControl(TRANSFER_PGM, _hidSingleReportDescriptorSystem, sizeof(_hidSingleReportDescriptorSystem));
-}
-
-bool SingleSystem_::setup(USBSetup& setup)
-{
-	if (pluggedInterface != setup.wIndex) {
-		return false;
-	}
-
-	uint8_t request = setup.bRequest;
-	uint8_t requestType = setup.bmRequestType;
-
-	if (requestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE)
-	{
-		if (request == HID_GET_REPORT) {
-			// TODO: HID_GetReport();
-			return true;
-		}
-		if (request == HID_GET_PROTOCOL) {
-			// TODO: Send8(protocol);
-			return true;
-		}
-	}
-
-	if (requestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE)
-	{
-		if (request == HID_SET_PROTOCOL) {
-			protocol = setup.wValueL;
-			return true;
-		}
-		if (request == HID_SET_IDLE) {
-			idle = setup.wValueH;
-			return true;
-		}
-		if (request == HID_SET_REPORT)
-		{
-		}
-	}
-
-	return false;
 }
 
 void SingleSystem_::SendReport(void* data, int length)
 {
-	USB_Send(pluggedEndpoint | TRANSFER_RELEASE, data, length);
+	sendReport(data, length);
 }
 
 SingleSystem_ SingleSystem;
@@ -0,0 +1,50 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "SingleTouchscreen.h"
+
+typedef HIDTouchscreenDescriptor<HID_REPORTID_NONE> TouchscreenDescriptor;
+
+
+SingleTouchscreen_::SingleTouchscreen_(void) : HIDSingleReportDevice(TouchscreenDescriptor::data, TouchscreenDescriptor::size, HID_INTERVAL_TOUCHSCREEN, 0, true)
+{
+}
+
+bool SingleTouchscreen_::onGetReport(USBSetup& setup)
+{
+	// Contact count maximum
+	if (setup.wValueH == HID_REPORT_TYPE_FEATURE) {
+		uint8_t maximum = HID_TOUCH_CONTACTS;
+		return USB_SendControl(0, &maximum, min(1, (int)setup.wLength)) >= 0;
+	}
+	return false;
+}
+
+void SingleTouchscreen_::SendReport(void* data, int length)
+{
+	sendReport(data, length);
+}
+
+SingleTouchscreen_ SingleTouchscreen;
+
+
@@ -7,7 +7,7 @@ int USB_SendControl(void* b, unsigned char c) {
     return USBDevice.sendControl(b, c);
 }
 
-int USB_SendControl(uint8_t a, const void* b, uint8_t c) {
+int USB_SendControl(uint8_t a, const void* b, int c) {
     return USBDevice.sendControl(b, c);
 }
 #endif
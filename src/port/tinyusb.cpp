@@ -0,0 +1,476 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "../HID-Settings.h"
+
+#if defined(HID_TINYUSB)
+
+// Like the core, wait at most this long for the host to take the last report
+#define TINYUSB_SEND_TIMEOUT 250
+
+static Adafruit_USBD_HID tinyusbHID[CFG_TUD_HID];
+static PluggableUSBModule* tinyusbModule[CFG_TUD_HID];
+
+// USB_SendControl() writes into this buffer during the requests
+static uint8_t* controlData = NULL;
+static uint16_t controlSize = 0;
+static uint16_t controlLength = 0;
+
+// USB_RecvControl() reads the SET_REPORT data from here,
+// the report ID TinyUSB removed is put in front again
+static const uint8_t* recvData = NULL;
+static uint16_t recvLength = 0;
+static uint8_t recvId = 0;
+
+static void startControl(uint8_t* data, uint16_t size)
+{
+	controlData = data;
+	controlSize = size;
+	controlLength = 0;
+}
+
+static USBSetup classRequest(uint8_t requestType, uint8_t request, uint8_t high, uint8_t low,
+	uint8_t interface, uint16_t length)
+{
+	USBSetup setup;
+	setup.bmRequestType = requestType;
+	setup.bRequest = request;
+	setup.wValueH = high;
+	setup.wValueL = low;
+	setup.wIndex = interface;
+	setup.wLength = length;
+	return setup;
+}
+
+// The Adafruit callbacks do not pass the instance, every interface gets its own
+template<uint8_t Index>
+static uint16_t getReportCallback(uint8_t id, hid_report_type_t type, uint8_t* buffer, uint16_t length)
+{
+	return PluggableUSB().getReport(Index, id, type, buffer, length);
+}
+
+template<uint8_t Index>
+static void setReportCallback(uint8_t id, hid_report_type_t type, uint8_t const* buffer, uint16_t length)
+{
+	PluggableUSB().setReport(Index, id, type, buffer, length);
+}
+
+template<uint8_t Index>
+static void setCallbacks(void)
+{
+	tinyusbHID[Index].setReportCallback(getReportCallback<Index>, setReportCallback<Index>);
+	setCallbacks<Index + 1>();
+}
+
+template<>
+void setCallbacks<CFG_TUD_HID>(void)
+{
+}
+
+extern "C" void tud_hid_set_protocol_cb(uint8_t instance, uint8_t protocol)
+{
+	PluggableUSB().request(instance, HID_SET_PROTOCOL, protocol);
+}
+
+extern "C" bool tud_hid_set_idle_cb(uint8_t instance, uint8_t idle)
+{
+	PluggableUSB().request(instance, HID_SET_IDLE, idle);
+	return true;
+}
+
+PluggableUSB_::PluggableUSB_(void) : rootNode(NULL), lastIf(0), lastEp(1), interfaces(0), started(false)
+{
+}
+
+bool PluggableUSB_::plug(PluggableUSBModule* node)
+{
+	// Numbers of the modules only, TinyUSB assigns the real ones
+	node->pluggedInterface = lastIf;
+	node->pluggedEndpoint = lastEp;
+	lastIf += node->numInterfaces;
+	lastEp += node->numEndpoints;
+
+	if (!rootNode) {
+		rootNode = node;
+	} else {
+		PluggableUSBModule* current = rootNode;
+		while (current->next) {
+			current = current->next;
+		}
+		current->next = node;
+	}
+	return true;
+}
+
+bool PluggableUSB_::begin(void)
+{
+	if (started) {
+		return interfaces > 0;
+	}
+	started = true;
+	setCallbacks<0>();
+
+	for (PluggableUSBModule* node = rootNode; node && interfaces < CFG_TUD_HID; node = node->next) {
+		// Modules which only watch the requests
+		if (!node->numInterfaces) {
+			continue;
+		}
+
+		// Interface, HID and endpoint descriptors
+		uint8_t descriptor[64];
+		uint8_t count = 0;
+		startControl(descriptor, sizeof(descriptor));
+		node->getInterface(&count);
+		uint16_t length = controlLength;
+
+		uint8_t protocol = HID_PROTOCOL_NONE;
+		uint8_t interval = 1;
+		uint16_t reportSize = 0;
+		bool out = false;
+		for (uint16_t i = 0; i + 1 < length && descriptor[i]; i += descriptor[i]) {
+			uint8_t* d = descriptor + i;
+			if (d[1] == 4 && i + 7 < length) {
+				protocol = d[7];
+			}
+			else if (d[1] == HID_HID_DESCRIPTOR_TYPE && i + 8 < length) {
+				reportSize = d[7] | (d[8] << 8);
+			}
+			else if (d[1] == 5 && i + 6 < length) {
+				if (d[2] & 0x80) {
+					interval = d[6];
+				} else {
+					out = true;
+				}
+			}
+		}
+
+		// TinyUSB keeps the pointer to the report descriptor
+		uint8_t* report = (uint8_t*)malloc(reportSize);
+		if (!report) {
+			break;
+		}
+		USBSetup setup = classRequest(REQUEST_DEVICETOHOST_STANDARD_INTERFACE, 0x06,
+			HID_REPORT_DESCRIPTOR_TYPE, 0, node->pluggedInterface, reportSize);
+		startControl(report, reportSize);
+		node->getDescriptor(setup);
+		controlData = NULL;
+
+		Adafruit_USBD_HID& hid = tinyusbHID[interfaces];
+		hid.setReportDescriptor(report, controlLength);
+		hid.setBootProtocol(protocol);
+		hid.setPollInterval(interval);
+		hid.enableOutEndpoint(out);
+		if (!hid.begin()) {
+			free(report);
+			break;
+		}
+		tinyusbModule[interfaces++] = node;
+	}
+
+	// The host does not know the interfaces yet
+	if (TinyUSBDevice.mounted()) {
+		TinyUSBDevice.detach();
+		delay(10);
+		TinyUSBDevice.attach();
+	}
+	return interfaces > 0;
+}
+
+PluggableUSBModule* PluggableUSB_::module(uint8_t index)
+{
+	return index < interfaces ? tinyusbModule[index] : NULL;
+}
+
+int8_t PluggableUSB_::find(uint8_t ep)
+{
+	for (int8_t index = 0; index < interfaces; index++) {
+		PluggableUSBModule* node = tinyusbModule[index];
+		if (ep >= node->pluggedEndpoint && ep < node->pluggedEndpoint + node->numEndpoints) {
+			return index;
+		}
+	}
+	return -1;
+}
+
+bool PluggableUSB_::ready(uint8_t ep)
+{
+	begin();
+	int8_t index = find(ep & 0x0F);
+	return index >= 0 && tinyusbHID[index].ready();
+}
+
+int PluggableUSB_::send(uint8_t ep, uint8_t id, const void* data, int len)
+{
+	begin();
+	int8_t index = find(ep & 0x0F);
+	if (index < 0 || !TinyUSBDevice.mounted()) {
+		return -1;
+	}
+
+	// Longer writes are split into endpoint sized reports like on the other cores
+	Adafruit_USBD_HID& hid = tinyusbHID[index];
+	const uint8_t* report = (const uint8_t*)data;
+	int sent = 0;
+	do {
+		int length = min(len - sent, (int)USB_EP_SIZE - (id ? 1 : 0));
+		uint32_t start = millis();
+		while (!hid.ready()) {
+			if (!TinyUSBDevice.mounted() || millis() - start > TINYUSB_SEND_TIMEOUT) {
+				return -1;
+			}
+			yield();
+		}
+		if (!hid.sendReport(id, report + sent, length)) {
+			return -1;
+		}
+		sent += length;
+	} while (sent < len);
+	return sent + (id ? 1 : 0);
+}
+
+uint16_t PluggableUSB_::getReport(uint8_t index, uint8_t id, uint8_t type, uint8_t* buffer, uint16_t length)
+{
+	PluggableUSBModule* node = module(index);
+	if (!node) {
+		return 0;
+	}
+	USBSetup setup = classRequest(REQUEST_DEVICETOHOST_CLASS_INTERFACE, HID_GET_REPORT,
+		type, id, node->pluggedInterface, length);
+	startControl(buffer, length);
+	bool handled = node->setup(setup);
+	controlData = NULL;
+
+	// Nothing stalls the request
+	return handled ? controlLength : 0;
+}
+
+void PluggableUSB_::setReport(uint8_t index, uint8_t id, uint8_t type, const uint8_t* buffer, uint16_t length)
+{
+	PluggableUSBModule* node = module(index);
+	if (!node) {
+		return;
+	}
+
+	// Reports of the OUT endpoint are passed on like SET_REPORT output
+	if (type == HID_REPORT_TYPE_INVALID) {
+		type = HID_REPORT_TYPE_OUTPUT;
+	}
+	recvData = buffer;
+	recvLength = length;
+	recvId = id;
+	USBSetup setup = classRequest(REQUEST_HOSTTODEVICE_CLASS_INTERFACE, HID_SET_REPORT,
+		type, id, node->pluggedInterface, length + (id ? 1 : 0));
+	node->setup(setup);
+	recvLength = 0;
+	recvId = 0;
+}
+
+void PluggableUSB_::request(uint8_t index, uint8_t request, uint8_t value)
+{
+	PluggableUSBModule* node = module(index);
+	if (!node) {
+		return;
+	}
+
+	// SET_IDLE has the rate in the high byte
+	USBSetup setup = classRequest(REQUEST_HOSTTODEVICE_CLASS_INTERFACE, request,
+		request == HID_SET_IDLE ? value : 0, request == HID_SET_IDLE ? 0 : value,
+		node->pluggedInterface, 0);
+	node->setup(setup);
+}
+
+PluggableUSB_& PluggableUSB()
+{
+	static PluggableUSB_ obj;
+	return obj;
+}
+
+HID_::HID_(void) : PluggableUSBModule(1, 1, epType), rootNode(NULL), descriptorSize(0),
+	protocol(HID_REPORT_PROTOCOL), idle(1)
+{
+	epType[0] = EP_TYPE_INTERRUPT_IN;
+	PluggableUSB().plug(this);
+}
+
+int HID_::begin(void)
+{
+	return 0;
+}
+
+int HID_::getInterface(uint8_t* interfaceCount)
+{
+	*interfaceCount += 1;
+	HIDDescriptor hidInterface = {
+		D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_NONE, HID_PROTOCOL_NONE),
+		D_HIDREPORT(descriptorSize),
+		D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, 1)
+	};
+	return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
+}
+
+int HID_::getDescriptor(USBSetup& setup)
+{
+	if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE) { return 0; }
+	if (setup.wValueH != HID_REPORT_DESCRIPTOR_TYPE) { return 0; }
+	if (setup.wIndex != pluggedInterface) { return 0; }
+
+	int total = 0;
+	for (HIDSubDescriptor* node = rootNode; node; node = node->next) {
+		int res = USB_SendControl(TRANSFER_PGM, node->data, node->length);
+		if (res == -1) {
+			return -1;
+		}
+		total += res;
+	}
+	protocol = HID_REPORT_PROTOCOL;
+	return total;
+}
+
+bool HID_::setup(USBSetup& setup)
+{
+	if (pluggedInterface != setup.wIndex) {
+		return false;
+	}
+
+	if (setup.bmRequestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE) {
+		if (setup.bRequest == HID_SET_PROTOCOL) {
+			protocol = setup.wValueL;
+			return true;
+		}
+		if (setup.bRequest == HID_SET_IDLE) {
+			idle = setup.wValueH;
+			return true;
+		}
+	}
+	return false;
+}
+
+int HID_::SendReport(uint8_t id, const void* data, int len)
+{
+	return PluggableUSB().send(pluggedEndpoint, id, data, len);
+}
+
+void HID_::AppendDescriptor(HIDSubDescriptor* node)
+{
+	if (!rootNode) {
+		rootNode = node;
+	} else {
+		HIDSubDescriptor* current = rootNode;
+		while (current->next) {
+			current = current->next;
+		}
+		current->next = node;
+	}
+	descriptorSize += node->length;
+}
+
+HID_& HID(void)
+{
+	static HID_ obj;
+	return obj;
+}
+
+int USB_SendControl(uint8_t flags, const void* d, int len)
+{
+	(void)flags;
+	if (!controlData) {
+		return -1;
+	}
+
+	// The flash is mapped into the address space, longer requests are cut
+	uint16_t length = min((uint16_t)len, (uint16_t)(controlSize - controlLength));
+	memcpy(controlData + controlLength, d, length);
+	controlLength += length;
+	return len;
+}
+
+int USB_RecvControl(void* d, int len)
+{
+	uint8_t* data = (uint8_t*)d;
+	int received = 0;
+	if (recvId && len > 0) {
+		*data++ = recvId;
+		recvId = 0;
+		len--;
+		received++;
+	}
+	uint16_t length = min((uint16_t)len, recvLength);
+	memcpy(data, recvData, length);
+	recvData += length;
+	recvLength -= length;
+	return received + length;
+}
+
+int USB_Send(uint8_t ep, const void* data, int len)
+{
+	return PluggableUSB().send(ep, 0, data, len);
+}
+
+int USB_SendSpace(uint8_t ep)
+{
+	return PluggableUSB().ready(ep) ? USB_EP_SIZE : 0;
+}
+
+// OUT reports arrive through setup() as SET_REPORT output
+int USB_Available(uint8_t ep)
+{
+	(void)ep;
+	return 0;
+}
+
+int USB_Recv(uint8_t ep, void* data, int len)
+{
+	(void)ep;
+	(void)data;
+	(void)len;
+	return -1;
+}
+
+int USB_Recv(uint8_t ep)
+{
+	(void)ep;
+	return -1;
+}
+
+void USB_Flush(uint8_t ep)
+{
+	(void)ep;
+}
+
+bool USB_Configured(void)
+{
+	PluggableUSB().begin();
+	return TinyUSBDevice.mounted();
+}
+
+bool USB_Suspended(void)
+{
+	return TinyUSBDevice.suspended();
+}
+
+bool USB_WakeupHost(void)
+{
+	return TinyUSBDevice.suspended() && TinyUSBDevice.remoteWakeup();
+}
+
+#endif
@@ -0,0 +1,260 @@
+/*
+Copyright (c) 2014-2015 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+// TinyUSB defines some of the HID names below as enums,
+// so its headers have to come before the macros.
+#include <Arduino.h>
+#include <Adafruit_TinyUSB.h>
+
+// USB core API of the AVR and SAM cores on top of the Adafruit TinyUSB stack
+// (RP2040, nRF52840, ESP32-S2/S3). Every plugged module becomes one TinyUSB
+// HID interface: its report descriptor, boot protocol and endpoints are read
+// once from getInterface() and getDescriptor(), the class requests TinyUSB
+// passes on are answered by setup() as on the other cores.
+//
+// The interfaces are added to the device with PluggableUSB().begin(). Call it
+// at the start of setup(), otherwise the first report does it. If the host
+// already enumerated the device, it is attached again.
+//
+// At most CFG_TUD_HID interfaces (the MultiReport HID and each SingleReport
+// device count as one), further modules are ignored. TinyUSB cannot hold back
+// OUT reports, if the module refuses one it is lost. The sketch must not add
+// HID interfaces of its own, the requests are mapped by instance number.
+
+#define EPTYPE_DESCRIPTOR_SIZE      uint8_t
+#define EP_TYPE_INTERRUPT_IN        0xC1
+#define EP_TYPE_INTERRUPT_OUT       0xC0
+#define USB_EP_SIZE                 CFG_TUD_HID_EP_BUFSIZE
+
+#define TRANSFER_PGM                0x80
+#define TRANSFER_RELEASE            0x40
+#define TRANSFER_ZERO               0x20
+
+#define REQUEST_HOSTTODEVICE        0x00
+#define REQUEST_DEVICETOHOST        0x80
+#define REQUEST_STANDARD            0x00
+#define REQUEST_CLASS               0x20
+#define REQUEST_INTERFACE           0x01
+
+#define REQUEST_DEVICETOHOST_CLASS_INTERFACE    (REQUEST_DEVICETOHOST | REQUEST_CLASS | REQUEST_INTERFACE)
+#define REQUEST_HOSTTODEVICE_CLASS_INTERFACE    (REQUEST_HOSTTODEVICE | REQUEST_CLASS | REQUEST_INTERFACE)
+#define REQUEST_DEVICETOHOST_STANDARD_INTERFACE (REQUEST_DEVICETOHOST | REQUEST_STANDARD | REQUEST_INTERFACE)
+
+#define USB_DEVICE_DESCRIPTOR_TYPE        1
+#define USB_CONFIGURATION_DESCRIPTOR_TYPE 2
+#define USB_STRING_DESCRIPTOR_TYPE        3
+
+#define USB_DEVICE_CLASS_HUMAN_INTERFACE 0x03
+#define USB_ENDPOINT_TYPE_INTERRUPT 0x03
+#define USB_ENDPOINT_OUT(addr)      (lowByte((addr) | 0x00))
+#define USB_ENDPOINT_IN(addr)       (lowByte((addr) | 0x80))
+
+#define HID_GET_REPORT              0x01
+#define HID_GET_IDLE                0x02
+#define HID_GET_PROTOCOL            0x03
+#define HID_SET_REPORT              0x09
+#define HID_SET_IDLE                0x0A
+#define HID_SET_PROTOCOL            0x0B
+
+#define HID_HID_DESCRIPTOR_TYPE     0x21
+#define HID_REPORT_DESCRIPTOR_TYPE  0x22
+
+#define HID_SUBCLASS_NONE           0
+#define HID_SUBCLASS_BOOT_INTERFACE 1
+
+#define HID_PROTOCOL_NONE           0
+#define HID_PROTOCOL_KEYBOARD       1
+#define HID_PROTOCOL_MOUSE          2
+
+#define HID_BOOT_PROTOCOL           0
+#define HID_REPORT_PROTOCOL         1
+
+#define HID_REPORT_TYPE_INPUT       1
+#define HID_REPORT_TYPE_OUTPUT      2
+#define HID_REPORT_TYPE_FEATURE     3
+
+typedef struct
+{
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	uint8_t wValueL;
+	uint8_t wValueH;
+	uint16_t wIndex;
+	uint16_t wLength;
+} USBSetup;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t len;
+	uint8_t dtype;
+	uint8_t number;
+	uint8_t alternate;
+	uint8_t numEndpoints;
+	uint8_t interfaceClass;
+	uint8_t interfaceSubClass;
+	uint8_t protocol;
+	uint8_t iInterface;
+} InterfaceDescriptor;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t len;
+	uint8_t dtype;
+	uint8_t addr;
+	uint8_t attr;
+	uint16_t packetSize;
+	uint8_t interval;
+} EndpointDescriptor;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t len;
+	uint8_t dtype;
+	uint8_t addr;
+	uint8_t versionL;
+	uint8_t versionH;
+	uint8_t country;
+	uint8_t desctype;
+	uint8_t descLenL;
+	uint8_t descLenH;
+} HIDDescDescriptor;
+
+typedef struct __attribute__((packed))
+{
+	InterfaceDescriptor hid;
+	HIDDescDescriptor desc;
+	EndpointDescriptor in;
+} HIDDescriptor;
+
+#define D_INTERFACE(_n,_numEndpoints,_class,_subClass,_protocol) \
+	{ 9, 4, _n, 0, _numEndpoints, _class, _subClass, _protocol, 0 }
+#define D_ENDPOINT(_addr,_attr,_packetSize,_interval) \
+	{ 7, 5, _addr, _attr, _packetSize, _interval }
+#define D_HIDREPORT(length) \
+	{ 9, 0x21, 0x01, 0x01, 0, 1, 0x22, lowByte(length), highByte(length) }
+
+class PluggableUSBModule {
+public:
+	PluggableUSBModule(uint8_t numEps, uint8_t numIfs, EPTYPE_DESCRIPTOR_SIZE* epType) :
+		numEndpoints(numEps), numInterfaces(numIfs), endpointType(epType)
+	{ }
+
+protected:
+	virtual bool setup(USBSetup& setup) = 0;
+	virtual int getInterface(uint8_t* interfaceCount) = 0;
+	virtual int getDescriptor(USBSetup& setup) = 0;
+	virtual uint8_t getShortName(char* name) { name[0] = 'A' + pluggedInterface; return 1; }
+
+	uint8_t pluggedInterface;
+	uint8_t pluggedEndpoint;
+
+	const uint8_t numEndpoints;
+	const uint8_t numInterfaces;
+	const EPTYPE_DESCRIPTOR_SIZE* endpointType;
+
+	PluggableUSBModule* next = NULL;
+
+	friend class PluggableUSB_;
+};
+
+class PluggableUSB_ {
+public:
+	PluggableUSB_(void);
+	bool plug(PluggableUSBModule* node);
+
+	// Adds the interfaces of all plugged modules to the TinyUSB device
+	bool begin(void);
+
+	// Sends one report, with the report ID in front if not 0
+	int send(uint8_t ep, uint8_t id, const void* data, int len);
+	bool ready(uint8_t ep);
+
+	// Called from the TinyUSB callbacks of the interface
+	uint16_t getReport(uint8_t index, uint8_t id, uint8_t type, uint8_t* buffer, uint16_t length);
+	void setReport(uint8_t index, uint8_t id, uint8_t type, const uint8_t* buffer, uint16_t length);
+	void request(uint8_t index, uint8_t request, uint8_t value);
+
+private:
+	PluggableUSBModule* module(uint8_t index);
+	int8_t find(uint8_t ep);
+
+	PluggableUSBModule* rootNode;
+	uint8_t lastIf;
+	uint8_t lastEp;
+	uint8_t interfaces;
+	bool started;
+};
+
+PluggableUSB_& PluggableUSB();
+
+// Report descriptor of a MultiReport device, joined by HID()
+class HIDSubDescriptor {
+public:
+	HIDSubDescriptor* next = NULL;
+	HIDSubDescriptor(const void* d, const uint16_t l) : data(d), length(l) { }
+
+	const void* data;
+	const uint16_t length;
+};
+
+// Interface of all MultiReport devices like the HID library of the core
+class HID_ : public PluggableUSBModule
+{
+public:
+	HID_(void);
+	int begin(void);
+	int SendReport(uint8_t id, const void* data, int len);
+	void AppendDescriptor(HIDSubDescriptor* node);
+
+protected:
+	int getInterface(uint8_t* interfaceCount);
+	int getDescriptor(USBSetup& setup);
+	bool setup(USBSetup& setup);
+
+private:
+	EPTYPE_DESCRIPTOR_SIZE epType[1];
+
+	HIDSubDescriptor* rootNode;
+	uint16_t descriptorSize;
+
+	uint8_t protocol;
+	uint8_t idle;
+};
+
+HID_& HID(void);
+
+int USB_SendControl(uint8_t flags, const void* d, int len);
+int USB_RecvControl(void* d, int len);
+int USB_Send(uint8_t ep, const void* data, int len);
+int USB_SendSpace(uint8_t ep);
+int USB_Available(uint8_t ep);
+int USB_Recv(uint8_t ep, void* data, int len);
+int USB_Recv(uint8_t ep);
+void USB_Flush(uint8_t ep);
+
+bool USB_Configured(void);
+bool USB_Suspended(void);
+bool USB_WakeupHost(void);